@@ -467,10 +467,13 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/qgcunittest
 
     HEADERS += \
+        src/AnalyzeView/LogDownloadTest.h \
         src/Audio/AudioOutputTest.h \
+        src/FactSystem/FactGroupTest.h \
         src/FactSystem/FactSystemTestBase.h \
         src/FactSystem/FactSystemTestGeneric.h \
         src/FactSystem/FactSystemTestPX4.h \
+        src/FactSystem/ParameterDownloadEngineTest.h \
         src/FactSystem/ParameterManagerTest.h \
         src/MissionManager/CameraCalcTest.h \
         src/MissionManager/CameraSectionTest.h \
@@ -493,27 +496,47 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/MissionManager/TransectStyleComplexItemTest.h \
         src/MissionManager/TransectStyleComplexItemTestBase.h \
         src/MissionManager/VisualMissionItemTest.h \
+        src/qgcunittest/CompressedTlogTest.h \
+        src/qgcunittest/ExifParserTest.h \
+        src/qgcunittest/FileManagerTest.h \
         src/qgcunittest/GeoTest.h \
         src/qgcunittest/LinkManagerTest.h \
+        src/qgcunittest/LinkSendQueueTest.h \
+        src/qgcunittest/LinkStatisticsTest.h \
+        src/qgcunittest/LogReplayLinkTest.h \
         src/qgcunittest/MavlinkLogTest.h \
+        src/qgcunittest/MAVLinkHandlerStatsTest.h \
+        src/qgcunittest/MAVLinkIngestBenchmark.h \
+        src/qgcunittest/MAVLinkLogProcessorTest.h \
+        src/qgcunittest/MAVLinkMessageHandleTest.h \
+        src/qgcunittest/MockLinkSwarmBenchmark.h \
         src/qgcunittest/MultiSignalSpy.h \
         src/qgcunittest/TCPLinkTest.h \
+        src/qgcunittest/TelemetryLogWriterTest.h \
+        src/qgcunittest/TlogExporterTest.h \
+        src/qgcunittest/TlogIndexTest.h \
+        src/qgcunittest/TlogSearchIndexTest.h \
+        src/qgcunittest/TlogTestWriter.h \
         src/qgcunittest/TCPLoopBackServer.h \
+        src/qgcunittest/ULogParserTest.h \
         src/qgcunittest/UnitTest.h \
         src/Vehicle/SendMavCommandTest.h \
+        src/Vehicle/TelemetryHistoryTest.h \
+        src/Vehicle/TrajectoryPointsTest.h \
         #src/qgcunittest/RadioConfigTest.h \
-        #src/AnalyzeView/LogDownloadTest.h \
         #src/qgcunittest/FileDialogTest.h \
-        #src/qgcunittest/FileManagerTest.h \
         #src/qgcunittest/FlightGearTest.h \
         #src/qgcunittest/MainWindowTest.h \
         #src/qgcunittest/MessageBoxTest.h \
 
     SOURCES += \
+        src/AnalyzeView/LogDownloadTest.cc \
         src/Audio/AudioOutputTest.cc \
+        src/FactSystem/FactGroupTest.cc \
         src/FactSystem/FactSystemTestBase.cc \
         src/FactSystem/FactSystemTestGeneric.cc \
         src/FactSystem/FactSystemTestPX4.cc \
+        src/FactSystem/ParameterDownloadEngineTest.cc \
         src/FactSystem/ParameterManagerTest.cc \
         src/MissionManager/CameraCalcTest.cc \
         src/MissionManager/CameraSectionTest.cc \
@@ -536,19 +559,36 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/MissionManager/TransectStyleComplexItemTest.cc \
         src/MissionManager/TransectStyleComplexItemTestBase.cc \
         src/MissionManager/VisualMissionItemTest.cc \
+        src/qgcunittest/CompressedTlogTest.cc \
+        src/qgcunittest/ExifParserTest.cc \
+        src/qgcunittest/FileManagerTest.cc \
         src/qgcunittest/GeoTest.cc \
         src/qgcunittest/LinkManagerTest.cc \
+        src/qgcunittest/LinkSendQueueTest.cc \
+        src/qgcunittest/LinkStatisticsTest.cc \
+        src/qgcunittest/LogReplayLinkTest.cc \
         src/qgcunittest/MavlinkLogTest.cc \
+        src/qgcunittest/MAVLinkHandlerStatsTest.cc \
+        src/qgcunittest/MAVLinkIngestBenchmark.cc \
+        src/qgcunittest/MAVLinkLogProcessorTest.cc \
+        src/qgcunittest/MAVLinkMessageHandleTest.cc \
+        src/qgcunittest/MockLinkSwarmBenchmark.cc \
         src/qgcunittest/MultiSignalSpy.cc \
         src/qgcunittest/TCPLinkTest.cc \
+        src/qgcunittest/TelemetryLogWriterTest.cc \
+        src/qgcunittest/TlogExporterTest.cc \
+        src/qgcunittest/TlogIndexTest.cc \
+        src/qgcunittest/TlogSearchIndexTest.cc \
+        src/qgcunittest/TlogTestWriter.cc \
         src/qgcunittest/TCPLoopBackServer.cc \
+        src/qgcunittest/ULogParserTest.cc \
         src/qgcunittest/UnitTest.cc \
         src/qgcunittest/UnitTestList.cc \
         src/Vehicle/SendMavCommandTest.cc \
+        src/Vehicle/TelemetryHistoryTest.cc \
+        src/Vehicle/TrajectoryPointsTest.cc \
         #src/qgcunittest/RadioConfigTest.cc \
-        #src/AnalyzeView/LogDownloadTest.cc \
         #src/qgcunittest/FileDialogTest.cc \
-        #src/qgcunittest/FileManagerTest.cc \
         #src/qgcunittest/FlightGearTest.cc \
         #src/qgcunittest/MainWindowTest.cc \
         #src/qgcunittest/MessageBoxTest.cc \
@@ -577,7 +617,6 @@ HEADERS += \
     src/JsonHelper.h \
     src/KMLDomDocument.h \
     src/KMLHelper.h \
-    src/LogCompressor.h \
     src/MissionManager/CameraCalc.h \
     src/MissionManager/CameraSection.h \
     src/MissionManager/CameraSpec.h \
@@ -673,19 +712,30 @@ HEADERS += \
     src/Vehicle/GPSRTKFactGroup.h \
     src/Vehicle/MAVLinkLogManager.h \
     src/Vehicle/MultiVehicleManager.h \
+    src/Vehicle/TelemetryHistory.h \
     src/Vehicle/TerrainFactGroup.h \
     src/Vehicle/TerrainProtocolHandler.h \
     src/Vehicle/TrajectoryPoints.h \
     src/Vehicle/Vehicle.h \
     src/Vehicle/VehicleObjectAvoidance.h \
     src/VehicleSetup/JoystickConfigController.h \
+    src/comm/CompressedTlogDevice.h \
     src/comm/LinkConfiguration.h \
     src/comm/LinkInterface.h \
     src/comm/LinkManager.h \
+    src/comm/LinkSendQueue.h \
+    src/comm/LinkStatistics.h \
     src/comm/LogReplayLink.h \
+    src/comm/MAVLinkHandlerStats.h \
+    src/comm/MAVLinkMessageHandle.h \
+    src/comm/MAVLinkParserThread.h \
     src/comm/MAVLinkProtocol.h \
     src/comm/QGCMAVLink.h \
     src/comm/TCPLink.h \
+    src/comm/TelemetryLogWriter.h \
+    src/comm/TlogExporter.h \
+    src/comm/TlogIndex.h \
+    src/comm/TlogSearchIndex.h \
     src/comm/UDPLink.h \
     src/comm/UdpIODevice.h \
     src/uas/UAS.h \
@@ -710,6 +760,7 @@ HEADERS += \
     src/comm/MockLink.h \
     src/comm/MockLinkFileServer.h \
     src/comm/MockLinkMissionItemHandler.h \
+    src/comm/MockLinkSwarm.h \
 }
 
 WindowsBuild {
@@ -784,7 +835,6 @@ SOURCES += \
     src/JsonHelper.cc \
     src/KMLDomDocument.cc \
     src/KMLHelper.cc \
-    src/LogCompressor.cc \
     src/MissionManager/CameraCalc.cc \
     src/MissionManager/CameraSection.cc \
     src/MissionManager/CameraSpec.cc \
@@ -877,19 +927,30 @@ SOURCES += \
     src/Vehicle/GPSRTKFactGroup.cc \
     src/Vehicle/MAVLinkLogManager.cc \
     src/Vehicle/MultiVehicleManager.cc \
+    src/Vehicle/TelemetryHistory.cc \
     src/Vehicle/TerrainFactGroup.cc \
     src/Vehicle/TerrainProtocolHandler.cc \
     src/Vehicle/TrajectoryPoints.cc \
     src/Vehicle/Vehicle.cc \
     src/Vehicle/VehicleObjectAvoidance.cc \
     src/VehicleSetup/JoystickConfigController.cc \
+    src/comm/CompressedTlogDevice.cc \
     src/comm/LinkConfiguration.cc \
     src/comm/LinkInterface.cc \
     src/comm/LinkManager.cc \
+    src/comm/LinkSendQueue.cc \
+    src/comm/LinkStatistics.cc \
     src/comm/LogReplayLink.cc \
+    src/comm/MAVLinkHandlerStats.cc \
+    src/comm/MAVLinkMessageHandle.cc \
+    src/comm/MAVLinkParserThread.cc \
     src/comm/MAVLinkProtocol.cc \
     src/comm/QGCMAVLink.cc \
     src/comm/TCPLink.cc \
+    src/comm/TelemetryLogWriter.cc \
+    src/comm/TlogExporter.cc \
+    src/comm/TlogIndex.cc \
+    src/comm/TlogSearchIndex.cc \
     src/comm/UDPLink.cc \
     src/comm/UdpIODevice.cc \
     src/main.cc \
@@ -909,6 +970,7 @@ SOURCES += \
     src/comm/MockLink.cc \
     src/comm/MockLinkFileServer.cc \
     src/comm/MockLinkMissionItemHandler.cc \
+    src/comm/MockLinkSwarm.cc \
 }
 
 !NoSerialBuild {
@@ -1142,9 +1204,11 @@ HEADERS += \
     src/FactSystem/Fact.h \
     src/FactSystem/FactControls/FactPanelController.h \
     src/FactSystem/FactGroup.h \
+    src/FactSystem/FactGroupUpdateScheduler.h \
     src/FactSystem/FactMetaData.h \
     src/FactSystem/FactSystem.h \
     src/FactSystem/FactValueSliderListModel.h \
+    src/FactSystem/ParameterDownloadEngine.h \
     src/FactSystem/ParameterManager.h \
     src/FactSystem/SettingsFact.h \
 
@@ -1152,9 +1216,11 @@ SOURCES += \
     src/FactSystem/Fact.cc \
     src/FactSystem/FactControls/FactPanelController.cc \
     src/FactSystem/FactGroup.cc \
+    src/FactSystem/FactGroupUpdateScheduler.cc \
     src/FactSystem/FactMetaData.cc \
     src/FactSystem/FactSystem.cc \
     src/FactSystem/FactValueSliderListModel.cc \
+    src/FactSystem/ParameterDownloadEngine.cc \
     src/FactSystem/ParameterManager.cc \
     src/FactSystem/SettingsFact.cc \
 
@@ -79,7 +79,7 @@ AirMapVehicleManager::endFlight()
 
 //-----------------------------------------------------------------------------
 void
-AirMapVehicleManager::vehicleMavlinkMessageReceived(const mavlink_message_t& message)
+AirMapVehicleManager::vehicleMavlinkMessageReceived(const MAVLinkMessageHandle& message)
 {
     if (isTelemetryStreaming()) {
         _telemetry.vehicleMessageReceived(message);
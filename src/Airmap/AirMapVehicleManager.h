@@ -36,7 +36,7 @@ public slots:
     void endFlight              () override;
 
 protected slots:
-    void vehicleMavlinkMessageReceived(const mavlink_message_t& message) override;
+    void vehicleMavlinkMessageReceived(const MAVLinkMessageHandle& message) override;
 
 private slots:
     void _flightIDChanged       (QString flightID);
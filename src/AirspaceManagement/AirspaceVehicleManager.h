@@ -11,6 +11,7 @@
 
 #include "AirspaceFlightPlanProvider.h"
 #include "QGCMAVLink.h"
+#include "MAVLinkMessageHandle.h"
 
 #include <QObject>
 #include <QList>
@@ -45,7 +46,7 @@ signals:
     void flightPermitStatusChanged      ();
 
 protected slots:
-    virtual void vehicleMavlinkMessageReceived(const mavlink_message_t& message) = 0;
+    virtual void vehicleMavlinkMessageReceived(const MAVLinkMessageHandle& message) = 0;
 
 protected:
     const Vehicle& _vehicle;
@@ -2,6 +2,8 @@
 #include <math.h>
 #include <QtEndian>
 #include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
 
 ExifParser::ExifParser()
 {
@@ -222,3 +224,83 @@ bool ExifParser::write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geot
     buf.replace(tiffHeaderInd + 8, 2, converter.c, 2);
     return true;
 }
+
+bool ExifParser::readHeader(QIODevice& image, QByteArray& header, QString& errorString)
+{
+    static const char kMarker =         '\xff';
+    static const char kStartOfImage =   '\xd8';
+    static const char kStartOfScan =    '\xda';
+    static const char kApp1 =           '\xe1';
+    static const QByteArray exifId("Exif\0\0", 6);
+
+    header = image.read(2);
+    if (header.size() != 2 || header[0] != kMarker || header[1] != kStartOfImage) {
+        errorString = tr("Image is not a JPEG");
+        return false;
+    }
+
+    // Walk the segments until the EXIF APP1 segment, each is marker, big endian length (including itself), data
+    while (header.size() < _maxHeaderSize) {
+        QByteArray segmentHeader = image.read(4);
+        if (segmentHeader.size() != 4 || segmentHeader[0] != kMarker || segmentHeader[1] == kStartOfScan) {
+            break;
+        }
+        int segmentLength = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(segmentHeader.constData() + 2));
+        if (segmentLength < 2) {
+            break;
+        }
+        QByteArray segmentData = image.read(segmentLength - 2);
+        if (segmentData.size() != segmentLength - 2) {
+            break;
+        }
+        header.append(segmentHeader);
+        header.append(segmentData);
+        if (segmentHeader[1] == kApp1 && segmentData.startsWith(exifId)) {
+            return true;
+        }
+    }
+
+    errorString = tr("Image does not contain an EXIF header");
+    return false;
+}
+
+bool ExifParser::writeTagged(const QString& sourceFilename, const QString& destinationFilename, GeoTagWorker::cameraFeedbackPacket& geotag, qint64& bytesCopied, QString& errorString)
+{
+    bytesCopied = 0;
+
+    QFile source(sourceFilename);
+    if (!source.open(QIODevice::ReadOnly)) {
+        errorString = tr("Couldn't open image '%1'").arg(sourceFilename);
+        return false;
+    }
+    QByteArray header;
+    if (!readHeader(source, header, errorString)) {
+        return false;
+    }
+    bytesCopied = header.size();
+    if (!write(header, geotag)) {
+        errorString = tr("Couldn't geotag image '%1'").arg(sourceFilename);
+        return false;
+    }
+
+    // Written to a temporary file first so a failure never leaves a partial image behind
+    QSaveFile destination(destinationFilename);
+    if (!destination.open(QIODevice::WriteOnly) || destination.write(header) != header.size()) {
+        errorString = tr("Couldn't write image '%1'").arg(destinationFilename);
+        return false;
+    }
+    QByteArray chunk;
+    while (!(chunk = source.read(_copyChunkSize)).isEmpty()) {
+        if (destination.write(chunk) != chunk.size()) {
+            errorString = tr("Couldn't write image '%1'").arg(destinationFilename);
+            return false;
+        }
+        bytesCopied += chunk.size();
+    }
+    if (!destination.commit()) {
+        errorString = tr("Couldn't write image '%1'").arg(destinationFilename);
+        return false;
+    }
+
+    return true;
+}
@@ -3,16 +3,37 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QIODevice>
+#include <QCoreApplication>
 
 #include "GeoTagController.h"
 
 class ExifParser
 {
+    Q_DECLARE_TR_FUNCTIONS(ExifParser)
+
 public:
     ExifParser();
     ~ExifParser();
+
+    /// buf only needs to hold the header returned by readHeader
     double readTime(QByteArray& buf);
     bool write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag);
+
+    /// Reads the JPEG segments up to and including the EXIF APP1 segment. This is the only part of an image which
+    /// readTime and write need, the compressed image data which follows is never read.
+    ///     @return true: success, false: failed, errorString set
+    static bool readHeader(QIODevice& image, QByteArray& header, QString& errorString);
+
+    /// Writes a geotagged copy of the image. The header is patched in memory, the rest of the image is streamed
+    /// through in chunks.
+    ///     @param bytesCopied Set to the number of image bytes read
+    ///     @return true: success, false: failed, errorString set
+    bool writeTagged(const QString& sourceFilename, const QString& destinationFilename, GeoTagWorker::cameraFeedbackPacket& geotag, qint64& bytesCopied, QString& errorString);
+
+private:
+    static const int    _maxHeaderSize  = 256 * 1024;
+    static const qint64 _copyChunkSize  = 1024 * 1024;
 };
 
 #endif // EXIFPARSER_H
@@ -15,6 +15,7 @@
 #include <cfloat>
 #include <QDir>
 #include <QUrl>
+#include <QtConcurrent>
 
 #include "ExifParser.h"
 #include "ULogParser.h"
@@ -25,8 +26,11 @@ static const char* kTagged = "/TAGGED";
 GeoTagController::GeoTagController()
     : _progress(0)
     , _inProgress(false)
+    , _imagesPerSecond(0)
+    , _bytesPerSecond(0)
 {
     connect(&_worker, &GeoTagWorker::progressChanged,   this, &GeoTagController::_workerProgressChanged);
+    connect(&_worker, &GeoTagWorker::throughputChanged, this, &GeoTagController::_workerThroughputChanged);
     connect(&_worker, &GeoTagWorker::error,             this, &GeoTagController::_workerError);
     connect(&_worker, &GeoTagWorker::started,           this, &GeoTagController::inProgressChanged);
     connect(&_worker, &GeoTagWorker::finished,          this, &GeoTagController::inProgressChanged);
@@ -120,6 +124,13 @@ void GeoTagController::_workerProgressChanged(double progress)
     emit progressChanged(progress);
 }
 
+void GeoTagController::_workerThroughputChanged(double imagesPerSecond, double bytesPerSecond)
+{
+    _imagesPerSecond = imagesPerSecond;
+    _bytesPerSecond = bytesPerSecond;
+    emit throughputChanged();
+}
+
 void GeoTagController::_workerError(QString errorMessage)
 {
     _errorMessage = errorMessage;
@@ -160,48 +171,56 @@ void GeoTagWorker::run()
     }
     emit progressChanged((100/nSteps));
 
-    // Parse EXIF
-    ExifParser exifParser;
-    _imageTime.clear();
-    for (int i = 0; i < _imageList.size(); ++i) {
-        QFile file(_imageList.at(i).absoluteFilePath());
+    // Parse EXIF, only the header of each image is read
+    QStringList imageFilenames;
+    for (const QFileInfo& imageInfo: _imageList) {
+        imageFilenames.append(imageInfo.absoluteFilePath());
+    }
+    QList<ImageResult_t> results;
+    bool imagesProcessed = _processImages(imageFilenames.count(), [imageFilenames](int index) {
+        ImageResult_t result = { false, -1.0, 0, QString() };
+        QFile file(imageFilenames[index]);
         if (!file.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
+            result.errorString = tr("Geotagging failed. Couldn't open an image.");
+            return result;
         }
-        QByteArray imageBuffer = file.readAll();
-        file.close();
-
-        _imageTime.append(exifParser.readTime(imageBuffer));
-
-        emit progressChanged((100/nSteps) + ((100/nSteps) / _imageList.size())*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
-            return;
+        QByteArray header;
+        if (!ExifParser::readHeader(file, header, result.errorString)) {
+            result.errorString = tr("Geotagging failed. %1: %2").arg(imageFilenames[index]).arg(result.errorString);
+            return result;
         }
-    }
-
-    // Load log
-    bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
-    QFile file(_logFile);
-    if (!file.open(QIODevice::ReadOnly)) {
-        emit error(tr("Geotagging failed. Couldn't open log file."));
+        ExifParser exifParser;
+        result.imageTime = exifParser.readTime(header);
+        result.bytes = header.size();
+        result.success = true;
+        return result;
+    }, 100/nSteps, 100/nSteps, results);
+    if (!imagesProcessed) {
         return;
     }
-    QByteArray log = file.readAll();
-    file.close();
+    _imageTime.clear();
+    for (const ImageResult_t& result: results) {
+        _imageTime.append(result.imageTime);
+    }
 
-    // Instantiate appropriate parser
+    // Load log, ULogs are memory mapped rather than read
+    bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
     _triggerList.clear();
     bool parseComplete = false;
     QString errorString;
     if (isULog) {
         ULogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList, errorString);
+        parseComplete = parser.open(_logFile, errorString) && parser.getTagsFromLog(_triggerList, errorString);
 
     } else {
+        QFile file(_logFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+            emit error(tr("Geotagging failed. Couldn't open log file."));
+            return;
+        }
+        QByteArray log = file.readAll();
+        file.close();
+
         PX4LogParser parser;
         parseComplete = parser.getTagsFromLog(log, _triggerList);
 
@@ -246,53 +265,82 @@ void GeoTagWorker::run()
     // Tag images
     int maxIndex = std::min(_imageIndices.count(), _triggerIndices.count());
     maxIndex = std::min(maxIndex, _imageList.count());
+    QString taggedDirectory = _saveDirectory.isEmpty() ? _imageDirectory + kTagged : _saveDirectory;
+    if (!QDir().mkpath(taggedDirectory)) {
+        emit error(tr("Geotagging failed. Couldn't create %1.").arg(taggedDirectory));
+        return;
+    }
+    QStringList sourceFilenames;
+    QStringList destinationFilenames;
+    QList<cameraFeedbackPacket> geotags;
     for(int i = 0; i < maxIndex; i++) {
         int imageIndex = _imageIndices[i];
         if (imageIndex >= _imageList.count()) {
             emit error(tr("Geotagging failed. Requesting image #%1, but only %2 images present.").arg(imageIndex).arg(_imageList.count()));
             return;
         }
-        QFile fileRead(_imageList.at(_imageIndices[i]).absoluteFilePath());
-        if (!fileRead.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
+        sourceFilenames.append(_imageList.at(imageIndex).absoluteFilePath());
+        destinationFilenames.append(taggedDirectory + "/" + _imageList.at(imageIndex).fileName());
+        geotags.append(_triggerList[_triggerIndices[i]]);
+    }
+    imagesProcessed = _processImages(maxIndex, [sourceFilenames, destinationFilenames, geotags](int index) {
+        ImageResult_t           result = { false, 0, 0, QString() };
+        ExifParser              exifParser;
+        cameraFeedbackPacket    geotag = geotags[index];
+        result.success = exifParser.writeTagged(sourceFilenames[index], destinationFilenames[index], geotag, result.bytes, result.errorString);
+        if (!result.success) {
+            result.errorString = tr("Geotagging failed. %1").arg(result.errorString);
         }
-        QByteArray imageBuffer = fileRead.readAll();
-        fileRead.close();
+        return result;
+    }, 4*(100/nSteps), 100/nSteps, results);
+    if (!imagesProcessed) {
+        return;
+    }
 
-        if (!exifParser.write(imageBuffer, _triggerList[_triggerIndices[i]])) {
-            emit error(tr("Geotagging failed. Couldn't write to image."));
-            return;
-        } else {
-            QFile fileWrite;
-            if(_saveDirectory == "") {
-                fileWrite.setFileName(_imageDirectory + "/TAGGED/" + _imageList.at(_imageIndices[i]).fileName());
-            } else {
-                fileWrite.setFileName(_saveDirectory + "/" + _imageList.at(_imageIndices[i]).fileName());
-            }
-            if (!fileWrite.open(QFile::WriteOnly)) {
-                emit error(tr("Geotagging failed. Couldn't write to an image."));
-                return;
-            }
-            fileWrite.write(imageBuffer);
-            fileWrite.close();
+    emit progressChanged(100);
+}
+
+/// Runs process for each image index on the thread pool, with a bounded number of images in flight. Results are
+/// collected in image order. Progress and throughput are signalled as images complete.
+///     @return false: cancelled or an image failed, error has been signalled
+bool GeoTagWorker::_processImages(int count, std::function<ImageResult_t(int)> process, double progressStart, double progressRange, QList<ImageResult_t>& results)
+{
+    QList<QFuture<ImageResult_t>>   inFlight;
+    const int                       maxInFlight = _threadPool.maxThreadCount() * _imagesInFlightPerThread;
+    int                             nextImage = 0;
+    qint64                          totalBytes = 0;
+    QElapsedTimer                   timer;
+
+    results.clear();
+    timer.start();
+    for (int i = 0; i < count; i++) {
+        while (nextImage < count && inFlight.count() < maxInFlight) {
+            inFlight.append(QtConcurrent::run(&_threadPool, process, nextImage++));
         }
-        emit progressChanged(4*(100/nSteps) + ((100/nSteps) / maxIndex)*i);
 
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
-            return;
+        ImageResult_t result = inFlight.takeFirst().result();
+        if (_cancel || !result.success) {
+            // Images already started are short lived, let them finish
+            _threadPool.waitForDone();
+            if (_cancel) {
+                qCDebug(GeotaggingLog) << "Tagging cancelled";
+                emit error(tr("Tagging cancelled"));
+            } else {
+                qCDebug(GeotaggingLog) << result.errorString;
+                emit error(result.errorString);
+            }
+            return false;
         }
-    }
+        results.append(result);
+        totalBytes += result.bytes;
 
-    if (_cancel) {
-        qCDebug(GeotaggingLog) << "Tagging cancelled";
-        emit error(tr("Tagging cancelled"));
-        return;
+        double seconds = std::max(timer.elapsed(), static_cast<qint64>(1)) / 1000.0;
+        emit throughputChanged((i + 1) / seconds, totalBytes / seconds);
+        emit progressChanged(progressStart + ((progressRange * (i + 1)) / count));
     }
 
-    emit progressChanged(100);
+    qCDebug(GeotaggingLog) << "Processed" << count << "images" << totalBytes << "bytes in" << timer.elapsed() << "ms";
+    return true;
 }
 
 bool GeoTagWorker::triggerFiltering()
@@ -16,11 +16,16 @@
 #include <QObject>
 #include <QString>
 #include <QThread>
+#include <QThreadPool>
 #include <QFileInfoList>
 #include <QElapsedTimer>
 #include <QDebug>
 #include <QGeoCoordinate>
 
+#include <functional>
+
+/// Images are processed on a thread pool. Matching reads only the EXIF header of each image, tagging writes a copy
+/// with a patched header and streams the rest of the image through.
 class GeoTagWorker : public QThread
 {
     Q_OBJECT
@@ -57,9 +62,18 @@ signals:
     void error              (QString errorMsg);
     void taggingComplete    ();
     void progressChanged    (double progress);
+    void throughputChanged  (double imagesPerSecond, double bytesPerSecond);
 
 private:
+    typedef struct {
+        bool    success;
+        double  imageTime;
+        qint64  bytes;          ///< Image bytes read
+        QString errorString;
+    } ImageResult_t;
+
     bool triggerFiltering();
+    bool _processImages(int count, std::function<ImageResult_t(int)> process, double progressStart, double progressRange, QList<ImageResult_t>& results);
 
     bool                    _cancel;
     QString                 _logFile;
@@ -70,7 +84,9 @@ private:
     QList<cameraFeedbackPacket> _triggerList;
     QList<int>              _imageIndices;
     QList<int>              _triggerIndices;
+    QThreadPool             _threadPool;
 
+    static const int        _imagesInFlightPerThread = 2;
 };
 
 /// Controller for GeoTagPage.qml. Supports geotagging images based on logfile camera tags.
@@ -94,6 +110,10 @@ public:
     /// true: Currently in the process of tagging
     Q_PROPERTY(bool     inProgress      READ inProgress     NOTIFY inProgressChanged)
 
+    /// Throughput of the current step
+    Q_PROPERTY(double   imagesPerSecond READ imagesPerSecond NOTIFY throughputChanged)
+    Q_PROPERTY(double   bytesPerSecond  READ bytesPerSecond  NOTIFY throughputChanged)
+
     Q_INVOKABLE void startTagging();
     Q_INVOKABLE void cancelTagging() { _worker.cancelTagging(); }
 
@@ -103,6 +123,8 @@ public:
     double  progress            () const { return _progress; }
     bool    inProgress          () const { return _worker.isRunning(); }
     QString errorMessage        () const { return _errorMessage; }
+    double  imagesPerSecond     () const { return _imagesPerSecond; }
+    double  bytesPerSecond      () const { return _bytesPerSecond; }
 
     void    setLogFile          (QString file);
     void    setImageDirectory   (QString dir);
@@ -115,16 +137,20 @@ signals:
     void progressChanged        (double progress);
     void inProgressChanged      ();
     void errorMessageChanged    (QString errorMessage);
+    void throughputChanged      ();
 
 private slots:
     void _workerProgressChanged (double progress);
     void _workerError           (QString errorMsg);
+    void _workerThroughputChanged(double imagesPerSecond, double bytesPerSecond);
     void _setErrorMessage       (const QString& error);
 
 private:
     QString             _errorMessage;
     double              _progress;
     bool                _inProgress;
+    double              _imagesPerSecond;
+    double              _bytesPerSecond;
 
     GeoTagWorker        _worker;
 };
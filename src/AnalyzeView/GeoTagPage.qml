@@ -53,6 +53,13 @@ AnalyzePage {
                 Layout.alignment:   Qt.AlignVCenter
             }
             //-----------------------------------------------------------------
+            QGCLabel {
+                text:               qsTr("%1 images/s, %2 MB/s").arg(geoController.imagesPerSecond.toFixed(1)).arg((geoController.bytesPerSecond / (1024 * 1024)).toFixed(1))
+                visible:            geoController.inProgress
+                Layout.alignment:   Qt.AlignHCenter
+                Layout.columnSpan:  2
+            }
+            //-----------------------------------------------------------------
             QGCLabel {
                 text:               geoController.errorMessage
                 color:              "red"
@@ -25,19 +25,40 @@
 #include <QBitArray>
 #include <QtCore/qmath.h>
 
-#define kTimeOutMilliseconds 500
-#define kGUIRateMilliseconds 17
-#define kTableBins           512
-#define kChunkSize           (kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)
+#define kTimeOutMilliseconds            500
+#define kMinGapTimeOutMilliseconds      50
+#define kGUIRateMilliseconds            17
+#define kBinSize                        MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN
+#define kMinWindowBins                  64
+#define kInitialWindowBins              512
+#define kMaxWindowBins                  (64 * 1024)
+#define kWindowSeconds                  2
+#define kMaxWindowLoss                  0.05
+#define kRepairMergeBins                8
+#define kWriteBufferSize                (256 * 1024)
 
 QGC_LOGGING_CATEGORY(LogDownloadLog, "LogDownloadLog")
 
 //-----------------------------------------------------------------------------
+// Logs are downloaded in windows: a single LOG_REQUEST_DATA for a range of bins which the vehicle then streams
+// without further requests. Vehicles serve one request at a time, a new request replaces the one in progress, so
+// the next window is requested the moment the last bin of the current one arrives rather than after a timeout.
+// Bins which were lost are tracked over the whole log and repaired by the following windows, the stream never
+// stops to wait for a chunk to fill in.
 struct LogDownloadData {
     LogDownloadData(QGCLogEntry* entry);
-    QBitArray     chunk_table;
-    uint32_t      current_chunk;
+    QBitArray     bins;             ///< One bit per kBinSize bin of the log, set once received
+    uint32_t      binsReceived;
+    uint32_t      firstMissing;     ///< All bins before this one have been received
+    uint32_t      windowStart;      ///< First bin of the window requested last
+    uint32_t      windowEnd;        ///< One past the last bin of the window requested last
+    uint32_t      windowBins;       ///< Window size, adapted to loss
+    uint32_t      windowPackets;    ///< Packets received for the window requested last
+    qreal         gapAvg;           ///< Average msecs between packets
+    QElapsedTimer gapTimer;
     QFile         file;
+    QByteArray    writeBuffer;      ///< Contiguous received data not yet written to the file
+    uint32_t      writeBufferOffset;
     QString       filename;
     uint          ID;
     QGCLogEntry*  entry;
@@ -46,42 +67,60 @@ struct LogDownloadData {
     qreal         rate_avg;
     QElapsedTimer elapsed;
 
-    void advanceChunk()
+    // The number of kBinSize bins in the file
+    uint32_t numBins() const
     {
-           current_chunk++;
-           chunk_table = QBitArray(chunkBins(), false);
+        return qCeil(entry->size() / static_cast<qreal>(kBinSize));
     }
 
-    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the current chunk
-    uint32_t chunkBins() const
+    bool complete() const
     {
-        return qMin(qCeil((entry->size() - current_chunk*kChunkSize)/static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)),
-                    kTableBins);
+        return binsReceived == numBins();
     }
 
-    // The number of kChunkSize chunks in the file
-    uint32_t numChunks() const
+    // Buffers data for the file, only writing once the buffer is full or the data is not contiguous
+    bool bufferedWrite(uint32_t ofs, const char* data, int count)
     {
-        return qCeil(entry->size() / static_cast<qreal>(kChunkSize));
+        if (!writeBuffer.isEmpty() && ofs != writeBufferOffset + static_cast<uint32_t>(writeBuffer.size())) {
+            if (!flush()) {
+                return false;
+            }
+        }
+        if (writeBuffer.isEmpty()) {
+            writeBufferOffset = ofs;
+        }
+        writeBuffer.append(data, count);
+        return writeBuffer.size() < kWriteBufferSize || flush();
     }
 
-    // True if all bins in the chunk have been set to val
-    bool chunkEquals(const bool val) const
+    bool flush()
     {
-        return chunk_table == QBitArray(chunk_table.size(), val);
+        if (writeBuffer.isEmpty()) {
+            return true;
+        }
+        const bool success = file.seek(writeBufferOffset) && file.write(writeBuffer) == writeBuffer.size();
+        writeBuffer.resize(0);
+        return success;
     }
-
 };
 
 //----------------------------------------------------------------------------------------
 LogDownloadData::LogDownloadData(QGCLogEntry* entry_)
-    : ID(entry_->id())
+    : binsReceived(0)
+    , firstMissing(0)
+    , windowStart(0)
+    , windowEnd(0)
+    , windowBins(kInitialWindowBins)
+    , windowPackets(0)
+    , gapAvg(0)
+    , writeBufferOffset(0)
+    , ID(entry_->id())
     , entry(entry_)
     , written(0)
     , rate_bytes(0)
     , rate_avg(0)
 {
-
+    writeBuffer.reserve(kWriteBufferSize);
 }
 
 //----------------------------------------------------------------------------------------
@@ -325,80 +364,117 @@ LogDownloadController::_logData(UASInterface* uas, uint32_t ofs, uint16_t id, ui
         return;
     }
 
-    if ((ofs % MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) != 0) {
+    if ((ofs % kBinSize) != 0) {
         qWarning() << "Ignored misaligned incoming packet @" << ofs;
         return;
     }
 
-    bool result = false;
-    uint32_t timeout_time = kTimeOutMilliseconds;
-    if(ofs <= _downloadData->entry->size()) {
-        const uint32_t chunk = ofs / kChunkSize;
-        if (chunk != _downloadData->current_chunk) {
-            qWarning() << "Ignored packet for out of order chunk actual:expected" << chunk << _downloadData->current_chunk;
+    if (ofs > _downloadData->entry->size()) {
+        qWarning() << "Received log offset greater than expected";
+        _downloadData->entry->setStatus(tr("Error"));
+        return;
+    }
+    const uint32_t bin = ofs / kBinSize;
+    if (count == 0 || bin >= _downloadData->numBins()) {
+        // End of log marker
+        return;
+    }
+
+    //-- Packets from earlier windows may still be in flight, they are just as good
+    if (!_downloadData->bins.testBit(bin)) {
+        if (!_downloadData->bufferedWrite(ofs, (const char*)data, count)) {
+            qWarning() << "Error while writing log file chunk";
+            _downloadData->entry->setStatus(tr("Error"));
             return;
         }
-        const uint16_t bin = (ofs - chunk*kChunkSize) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-        if (bin >= _downloadData->chunk_table.size()) {
-            qWarning() << "Out of range bin received";
-        } else
-            _downloadData->chunk_table.setBit(bin);
-        if (_downloadData->file.pos() != ofs) {
-            // Seek to correct position
-            if (!_downloadData->file.seek(ofs)) {
-                qWarning() << "Error while seeking log file offset";
-                return;
-            }
+        _downloadData->bins.setBit(bin);
+        _downloadData->binsReceived++;
+        _downloadData->written += count;
+        _downloadData->rate_bytes += count;
+    }
+    //-- Only bins of the current window tell how it is doing
+    const bool inWindow = bin >= _downloadData->windowStart && bin < _downloadData->windowEnd;
+    if (inWindow) {
+        _downloadData->windowPackets++;
+        if (_downloadData->gapTimer.isValid()) {
+            _downloadData->gapAvg = (_downloadData->gapAvg * 0.9) + (_downloadData->gapTimer.elapsed() * 0.1);
         }
+        _downloadData->gapTimer.start();
+    }
+    _updateDataRate();
+    //-- reset retries
+    _retries = 0;
 
-        //-- Write chunk to file
-        if(_downloadData->file.write((const char*)data, count)) {
-            _downloadData->written += count;
-            _downloadData->rate_bytes += count;
-            _updateDataRate();
-            result = true;
-            //-- reset retries
-            _retries = 0;
-            //-- Reset timer
-            _timer.start(timeout_time);
-            //-- Do we have it all?
-            if(_logComplete()) {
-                _downloadData->entry->setStatus(tr("Downloaded"));
-                //-- Check for more
-                _receivedAllData();
-            } else if (_chunkComplete()) {
-                _downloadData->advanceChunk();
-                _requestLogData(_downloadData->ID,
-                                _downloadData->current_chunk*kChunkSize,
-                                _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            } else if (bin < _downloadData->chunk_table.size() - 1 && _downloadData->chunk_table.at(bin+1)) {
-                // Likely to be grabbing fragments and got to the end of a gap
-                _findMissingData();
-            }
+    //-- Do we have it all?
+    if (_downloadData->complete()) {
+        if (_downloadData->flush()) {
+            _downloadData->entry->setStatus(tr("Downloaded"));
         } else {
             qWarning() << "Error while writing log file chunk";
+            _downloadData->entry->setStatus(tr("Error"));
         }
+        //-- Check for more
+        _receivedAllData();
+    } else if (!inWindow) {
+        //-- Stale or duplicate, the timer keeps watching the current window
+    } else if (bin + 1 == _downloadData->windowEnd) {
+        //-- End of the window, keep the vehicle streaming
+        _requestWindow(false);
     } else {
-        qWarning() << "Received log offset greater than expected";
-    }
-    if(!result) {
-        _downloadData->entry->setStatus(tr("Error"));
+        //-- Lost packets show up as a longer than usual gap
+        _timer.start(qBound(kMinGapTimeOutMilliseconds, qCeil(_downloadData->gapAvg * 10), kTimeOutMilliseconds));
     }
 }
 
-
 //----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_chunkComplete() const
-{
-    return _downloadData->chunkEquals(true);
-}
+void
+LogDownloadController::_requestWindow(bool timedOut)
+{
+    LogDownloadData* const data = _downloadData;
+
+    //-- Adapt the window to the loss in the previous one
+    const uint32_t requestedBins = data->windowEnd - data->windowStart;
+    if (requestedBins != 0) {
+        const qreal loss = 1.0 - qMin(1.0, data->windowPackets / static_cast<qreal>(requestedBins));
+        if (timedOut || loss > kMaxWindowLoss) {
+            data->windowBins = qMax(data->windowBins / 2, static_cast<uint32_t>(kMinWindowBins));
+        } else if (loss == 0) {
+            data->windowBins = qMin(data->windowBins * 2, static_cast<uint32_t>(kMaxWindowBins));
+        }
+    }
+    //-- Don't ask for more than arrives in kWindowSeconds, a lost window tail is only noticed once it should have arrived
+    uint32_t windowBins = data->windowBins;
+    if (data->rate_avg > 0) {
+        windowBins = qMin(windowBins, qMax(static_cast<uint32_t>(data->rate_avg * kWindowSeconds / kBinSize), static_cast<uint32_t>(kMinWindowBins)));
+    }
 
-//----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_logComplete() const
-{
-    return _chunkComplete() && (_downloadData->current_chunk+1) == _downloadData->numChunks();
+    const uint32_t numBins = data->numBins();
+    while (data->firstMissing < numBins && data->bins.testBit(data->firstMissing)) {
+        data->firstMissing++;
+    }
+
+    //-- Repairs and new data go in the same window: short runs of received bins are sent again since that is
+    //-- cheaper than the round trip of another request
+    const uint32_t start = data->firstMissing;
+    const uint32_t limit = qMin(numBins, start + windowBins);
+    uint32_t lastMissing = start;
+    uint32_t receivedRun = 0;
+    for (uint32_t bin = start; bin < limit; bin++) {
+        if (!data->bins.testBit(bin)) {
+            lastMissing = bin;
+            receivedRun = 0;
+        } else if (++receivedRun >= kRepairMergeBins) {
+            break;
+        }
+    }
+
+    data->windowStart = start;
+    data->windowEnd = lastMissing + 1;
+    data->windowPackets = 0;
+    data->gapTimer.invalidate();
+    qCDebug(LogDownloadLog) << "Window" << start << data->windowEnd << "size" << data->windowBins << "timedOut" << timedOut;
+    _requestLogData(data->ID, start * kBinSize, (data->windowEnd - start) * kBinSize, _retries);
+    _timer.start(kTimeOutMilliseconds);
 }
 
 //----------------------------------------------------------------------------------------
@@ -407,25 +483,26 @@ LogDownloadController::_receivedAllData()
 {
     _timer.stop();
     //-- Anything queued up for download?
-    if(_prepareLogDownload()) {
-        //-- Request Log
-        _requestLogData(_downloadData->ID, 0, _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-        _timer.start(kTimeOutMilliseconds);
-    } else {
-        _resetSelection();
-        _setDownloading(false);
+    while(_prepareLogDownload()) {
+        if (!_downloadData->complete()) {
+            //-- Request Log
+            _requestWindow(false);
+            return;
+        }
+        //-- Nothing to request for an empty log
+        _downloadData->entry->setStatus(tr("Downloaded"));
     }
+    _resetSelection();
+    _setDownloading(false);
 }
 
 //----------------------------------------------------------------------------------------
 void
 LogDownloadController::_findMissingData()
 {
-    if (_logComplete()) {
+    if (_downloadData->complete()) {
          _receivedAllData();
          return;
-    } else if (_chunkComplete()) {
-        _downloadData->advanceChunk();
     }
 
     _retries++;
@@ -442,24 +519,7 @@ LogDownloadController::_findMissingData()
 #endif
 
     _updateDataRate();
-
-    uint16_t start = 0, end = 0;
-    const int size = _downloadData->chunk_table.size();
-    for (; start < size; start++) {
-        if (!_downloadData->chunk_table.testBit(start)) {
-            break;
-        }
-    }
-
-    for (end = start; end < size; end++) {
-        if (_downloadData->chunk_table.testBit(end)) {
-            break;
-        }
-    }
-
-    const uint32_t pos = _downloadData->current_chunk*kChunkSize + start*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-                   len = (end - start)*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-    _requestLogData(_downloadData->ID, pos, len, _retries);
+    _requestWindow(true);
 }
 
 //----------------------------------------------------------------------------------------
@@ -623,8 +683,7 @@ LogDownloadController::_prepareLogDownload()
         if(!_downloadData->file.resize(entry->size())) {
             qWarning() << "Failed to allocate space for log file:" <<  _downloadData->filename;
         } else {
-            _downloadData->current_chunk = 0;
-            _downloadData->chunk_table = QBitArray(_downloadData->chunkBins(), false);
+            _downloadData->bins = QBitArray(_downloadData->numBins(), false);
             _downloadData->elapsed.start();
             result = true;
         }
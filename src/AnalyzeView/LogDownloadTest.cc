@@ -20,9 +20,24 @@ LogDownloadTest::LogDownloadTest(void)
 
 void LogDownloadTest::downloadTest(void)
 {
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _downloadLog();
+}
 
+void LogDownloadTest::downloadLossyTest(void)
+{
     _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadLossy(true);
+    _downloadLog();
 
+    // Each dropped packet costs a repair request and at most one timeout, the rest are windows of new data. Packets
+    // of an earlier request still arriving after a repair was requested must not request the window again.
+    QVERIFY(_mockLink->logDownloadDropCount() > 0);
+    QVERIFY(_mockLink->logDownloadRequestCount() <= (2 * _mockLink->logDownloadDropCount()) + _maxNewDataWindows);
+}
+
+void LogDownloadTest::_downloadLog(void)
+{
     LogDownloadController* controller = new LogDownloadController();
 
     _rgLogDownloadControllerSignals[requestingListChangedSignalIndex] =     SIGNAL(requestingListChanged());
@@ -52,7 +67,7 @@ void LogDownloadTest::downloadTest(void)
     QVERIFY(_multiSpyLogDownloadController->waitForSignalByIndex(downloadingLogsChangedSignalIndex, 10000));
     _multiSpyLogDownloadController->clearAllSignals();
     if (controller->downloadingLogs()) {
-        QVERIFY(_multiSpyLogDownloadController->waitForSignalByIndex(downloadingLogsChangedSignalIndex, 10000));
+        QVERIFY(_multiSpyLogDownloadController->waitForSignalByIndex(downloadingLogsChangedSignalIndex, _downloadTimeoutMsecs));
         QCOMPARE(controller->downloadingLogs(), false);
     }
     _multiSpyLogDownloadController->clearAllSignals();
@@ -63,4 +78,6 @@ void LogDownloadTest::downloadTest(void)
     QFile::remove(downloadFile);
 
     delete controller;
+    delete _multiSpyLogDownloadController;
+    _multiSpyLogDownloadController = nullptr;
 }
@@ -25,8 +25,14 @@ private slots:
     //void cleanup(void) { _cleanup(); }
 
     void downloadTest(void);
+    void downloadLossyTest(void);
 
 private:
+    void _downloadLog(void);
+
+    static const int _downloadTimeoutMsecs = 30000;
+    static const int _maxNewDataWindows = 20;       ///< Simulated log size over the smallest download window, plus slack
+
     // LogDownloadController signals
 
     enum {
@@ -19,6 +19,7 @@ QT_CHARTS_USE_NAMESPACE
 Q_DECLARE_METATYPE(QAbstractSeries*)
 
 #define UPDATE_FREQUENCY (1000 / 15)    // 15Hz
+#define CHART_PIXEL_BUDGET 1000         // Points queried per series, about the width of a chart
 
 //-----------------------------------------------------------------------------
 QGCMAVLinkMessageField::QGCMAVLinkMessageField(QGCMAVLinkMessage *parent, QString name, QString type)
@@ -38,7 +39,6 @@ QGCMAVLinkMessageField::addSeries(MAVLinkChartController* chart, QAbstractSeries
         _chart = chart;
         _pSeries = series;
         emit seriesChanged();
-        _dataIndex = 0;
         _msg->updateFieldSelection();
     }
 }
@@ -48,9 +48,9 @@ void
 QGCMAVLinkMessageField::delSeries()
 {
     if(_pSeries) {
-        _values.clear();
+        _points.clear();
         QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(_values);
+        lineSeries->replace(_points);
         _pSeries = nullptr;
         _chart   = nullptr;
         emit seriesChanged();
@@ -93,40 +93,14 @@ QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
         _value = newValue;
         emit valueChanged();
     }
-    if(_pSeries && _chart) {
-        int count = _values.count();
-        //-- Arbitrary limit of 1 minute of data at 50Hz for now
-        if(count < (50 * 60)) {
-            QPointF p(QGC::bootTimeMilliseconds(), v);
-            _values.append(p);
-        } else {
-            if(_dataIndex >= count) _dataIndex = 0;
-            _values[_dataIndex].setX(QGC::bootTimeMilliseconds());
-            _values[_dataIndex].setY(v);
-            _dataIndex++;
-        }
-        //-- Auto Range
-        if(_chart->rangeYIndex() == 0) {
-            qreal vmin  = std::numeric_limits<qreal>::max();
-            qreal vmax  = std::numeric_limits<qreal>::min();
-            for(int i = 0; i < _values.count(); i++) {
-                qreal v = _values[i].y();
-                if(vmax < v) vmax = v;
-                if(vmin > v) vmin = v;
-            }
-            bool changed = false;
-            if(std::abs(_rangeMin - vmin) > 0.000001) {
-                _rangeMin = vmin;
-                changed = true;
-            }
-            if(std::abs(_rangeMax - vmax) > 0.000001) {
-                _rangeMax = vmax;
-                changed = true;
-            }
-            if(changed) {
-                _chart->updateYRange();
-            }
+    //-- Numeric values go to the vehicle history, charts are drawn from there
+    TelemetryHistory* history = _msg->history();
+    if(_selectable && history) {
+        if(history != _history) {
+            _history  = history;
+            _seriesId = history->series(QStringLiteral("mavlink.%1.%2.%3").arg(_msg->cid()).arg(_msg->name()).arg(_name));
         }
+        history->append(_seriesId, static_cast<double>(v));
     }
 }
 
@@ -134,27 +108,42 @@ QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
 void
 QGCMAVLinkMessageField::updateSeries()
 {
-    int count = _values.count();
-    if (count > 1) {
-        QList<QPointF> s;
-        s.reserve(count);
-        int idx = _dataIndex;
-        for(int i = 0; i < count; i++, idx++) {
-            if(idx >= count) idx = 0;
-            QPointF p(_values[idx]);
-            s.append(p);
+    if(!_history || _seriesId == -1 || !_chart) {
+        return;
+    }
+    _history->query(_seriesId, _chart->rangeXMin().toMSecsSinceEpoch(), _chart->rangeXMax().toMSecsSinceEpoch(), CHART_PIXEL_BUDGET, _points);
+    QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
+    lineSeries->replace(_points);
+    //-- Auto Range, from what is shown
+    if(_chart->rangeYIndex() == 0 && _points.count()) {
+        qreal vmin  = std::numeric_limits<qreal>::max();
+        qreal vmax  = std::numeric_limits<qreal>::lowest();
+        for(const QPointF& p: _points) {
+            if(vmax < p.y()) vmax = p.y();
+            if(vmin > p.y()) vmin = p.y();
+        }
+        bool changed = false;
+        if(std::abs(_rangeMin - vmin) > 0.000001) {
+            _rangeMin = vmin;
+            changed = true;
+        }
+        if(std::abs(_rangeMax - vmax) > 0.000001) {
+            _rangeMax = vmax;
+            changed = true;
+        }
+        if(changed) {
+            _chart->updateYRange();
         }
-        QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(s);
     }
 }
 
 //-----------------------------------------------------------------------------
-QGCMAVLinkMessage::QGCMAVLinkMessage(QObject *parent, mavlink_message_t* message)
+QGCMAVLinkMessage::QGCMAVLinkMessage(QObject *parent, const MAVLinkMessageHandle& message)
     : QObject(parent)
+    , _id(message->msgid)
+    , _cid(message->compid)
 {
-    _message = *message;
-    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(message);
+    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&message.message());
     if (!msgInfo) {
         qWarning() << QStringLiteral("QGCMAVLinkMessage NULL msgInfo msgid(%1)").arg(message->msgid);
         return;
@@ -219,15 +208,15 @@ QGCMAVLinkMessage::updateFreq()
 
 //-----------------------------------------------------------------------------
 void
-QGCMAVLinkMessage::update(mavlink_message_t* message)
+QGCMAVLinkMessage::update(const MAVLinkMessageHandle& message, QGCMAVLinkVehicle* vehicle)
 {
     _count++;
     //-- If we are not consuming this message, no need to parse it
     if(!_selected && !_fieldSelected) {
         return;
     }
-    _message = *message;
-    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(message);
+    _history = vehicle->history();
+    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&message.message());
     if (!msgInfo) {
         qWarning() << QStringLiteral("QGCMAVLinkMessage::update NULL msgInfo msgid(%1)").arg(message->msgid);
         return;
@@ -236,7 +225,8 @@ QGCMAVLinkMessage::update(mavlink_message_t* message)
         qWarning() << QStringLiteral("QGCMAVLinkMessage::update msgInfo field count mismatch msgid(%1)").arg(message->msgid);
         return;
     }
-    uint8_t* m = reinterpret_cast<uint8_t*>(&message->payload64[0]);
+    // The message buffer is shared with all other subscribers so it must not be modified
+    const uint8_t* m = reinterpret_cast<const uint8_t*>(&message->payload64[0]);
     for (unsigned int i = 0; i < msgInfo->num_fields; ++i) {
         QGCMAVLinkMessageField* f = qobject_cast<QGCMAVLinkMessageField*>(_fields.get(static_cast<int>(i)));
         if(f) {
@@ -247,21 +237,20 @@ QGCMAVLinkMessage::update(mavlink_message_t* message)
             case MAVLINK_TYPE_CHAR:
                 f->setSelectable(false);
                 if (array_length > 0) {
-                    char* str = reinterpret_cast<char*>(m + offset);
-                    // Enforce null termination
-                    str[array_length - 1] = '\0';
-                    QString v(str);
+                    const char* str = reinterpret_cast<const char*>(m + offset);
+                    // Strings are not null terminated if they fill the whole array
+                    QString v(QString::fromLatin1(str, static_cast<int>(qstrnlen(str, array_length))));
                     f->updateValue(v, 0);
                 } else {
                     // Single char
-                    char b = *(reinterpret_cast<char*>(m + offset));
+                    char b = *(reinterpret_cast<const char*>(m + offset));
                     QString v(b);
                     f->updateValue(v, 0);
                 }
                 break;
             case MAVLINK_TYPE_UINT8_T:
                 if (array_length > 0) {
-                    uint8_t* nums = m + offset;
+                    const uint8_t* nums = m + offset;
                     QString tmp("%1, ");
                     QString string;
                     for (unsigned int j = 0; j < array_length - 1; ++j) {
@@ -277,7 +266,7 @@ QGCMAVLinkMessage::update(mavlink_message_t* message)
                 break;
             case MAVLINK_TYPE_INT8_T:
                 if (array_length > 0) {
-                    int8_t* nums = reinterpret_cast<int8_t*>(m + offset);
+                    const int8_t* nums = reinterpret_cast<const int8_t*>(m + offset);
                     QString tmp("%1, ");
                     QString string;
                     for (unsigned int j = 0; j < array_length - 1; ++j) {
@@ -287,7 +276,7 @@ QGCMAVLinkMessage::update(mavlink_message_t* message)
                     f->updateValue(string, static_cast<qreal>(nums[0]));
                 } else {
                     // Single value
-                    int8_t n = *(reinterpret_cast<int8_t*>(m + offset));
+                    int8_t n = *(reinterpret_cast<const int8_t*>(m + offset));
                     f->updateValue(QString::number(n), static_cast<qreal>(n));
                 }
                 break;
@@ -343,7 +332,7 @@ QGCMAVLinkMessage::update(mavlink_message_t* message)
                     uint32_t n;
                     memcpy(&n, m + offset, sizeof(uint32_t));
                     //-- Special case
-                    if(_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
+                    if(_id == MAVLINK_MSG_ID_SYSTEM_TIME) {
                         QDateTime d = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(n),Qt::UTC,0);
                         f->updateValue(d.toString("HH:mm:ss"), static_cast<qreal>(n));
                     } else {
@@ -421,7 +410,7 @@ QGCMAVLinkMessage::update(mavlink_message_t* message)
                     uint64_t n;
                     memcpy(&n, m + offset, sizeof(uint64_t));
                     //-- Special case
-                    if(_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
+                    if(_id == MAVLINK_MSG_ID_SYSTEM_TIME) {
                         QDateTime d = QDateTime::fromMSecsSinceEpoch(n/1000,Qt::UTC,0);
                         f->updateValue(d.toString("yyyy MM dd HH:mm:ss"), static_cast<qreal>(n));
                     } else {
@@ -467,6 +456,21 @@ QGCMAVLinkVehicle::~QGCMAVLinkVehicle()
     _messages.clearAndDeleteContents();
 }
 
+//-----------------------------------------------------------------------------
+TelemetryHistory*
+QGCMAVLinkVehicle::history()
+{
+    //-- Share the vehicle history so MAVLink fields and Facts are kept side by side
+    Vehicle* vehicle = qgcApp()->toolbox()->multiVehicleManager()->getVehicleById(_id);
+    if(vehicle && vehicle->telemetryHistory()) {
+        return vehicle->telemetryHistory();
+    }
+    if(!_ownHistory) {
+        _ownHistory = new TelemetryHistory(this);
+    }
+    return _ownHistory;
+}
+
 //-----------------------------------------------------------------------------
 QGCMAVLinkMessage*
 QGCMAVLinkVehicle::findMessage(uint32_t id, uint8_t cid)
@@ -721,7 +725,7 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     connect(multiVehicleManager, &MultiVehicleManager::vehicleAdded,   this, &MAVLinkInspectorController::_vehicleAdded);
     connect(multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkInspectorController::_vehicleRemoved);
     MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
-    connect(mavlinkProtocol, &MAVLinkProtocol::messageReceived, this, &MAVLinkInspectorController::_receiveMessage);
+    connect(mavlinkProtocol, &MAVLinkProtocol::sharedMessageReceived, this, &MAVLinkInspectorController::_receiveMessage);
     connect(&_updateFrequencyTimer, &QTimer::timeout, this, &MAVLinkInspectorController::_refreshFrequency);
     _updateFrequencyTimer.start(1000);
     MultiVehicleManager *manager = qgcApp()->toolbox()->multiVehicleManager();
@@ -730,6 +734,8 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     _timeScaleSt.append(new TimeScale_st(this, tr("10 Sec"), 10 * 1000));
     _timeScaleSt.append(new TimeScale_st(this, tr("30 Sec"), 30 * 1000));
     _timeScaleSt.append(new TimeScale_st(this, tr("60 Sec"), 60 * 1000));
+    _timeScaleSt.append(new TimeScale_st(this, tr("10 Min"), 10 * 60 * 1000));
+    _timeScaleSt.append(new TimeScale_st(this, tr("1 Hour"), 60 * 60 * 1000));
     emit timeScalesChanged();
     _rangeSt.append(new Range_st(this, tr("Auto"),    0));
     _rangeSt.append(new Range_st(this, tr("10,000"),  10000));
@@ -856,27 +862,27 @@ MAVLinkInspectorController::_vehicleRemoved(Vehicle* vehicle)
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkInspectorController::_receiveMessage(LinkInterface*, mavlink_message_t message)
+MAVLinkInspectorController::_receiveMessage(LinkInterface*, MAVLinkMessageHandle message)
 {
     QGCMAVLinkMessage* m = nullptr;
-    QGCMAVLinkVehicle* v = _findVehicle(message.sysid);
+    QGCMAVLinkVehicle* v = _findVehicle(message->sysid);
     if(!v) {
-        v = new QGCMAVLinkVehicle(this, message.sysid);
+        v = new QGCMAVLinkVehicle(this, message->sysid);
         _vehicles.append(v);
-        _vehicleNames.append(tr("Vehicle %1").arg(message.sysid));
+        _vehicleNames.append(tr("Vehicle %1").arg(message->sysid));
         emit vehiclesChanged();
         if(!_activeVehicle) {
             _activeVehicle = v;
             emit activeVehiclesChanged();
         }
     } else {
-        m = v->findMessage(message.msgid, message.compid);
+        m = v->findMessage(message->msgid, message->compid);
     }
     if(!m) {
-        m = new QGCMAVLinkMessage(this, &message);
+        m = new QGCMAVLinkMessage(this, message);
         v->append(m);
     } else {
-        m->update(&message);
+        m->update(message, v);
     }
 }
 
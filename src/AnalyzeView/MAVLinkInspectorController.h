@@ -15,11 +15,13 @@
 
 #include "MAVLinkProtocol.h"
 #include "Vehicle.h"
+#include "TelemetryHistory.h"
 
 #include <QObject>
 #include <QString>
 #include <QDebug>
 #include <QVariantList>
+#include <QPointer>
 #include <QtCharts/QAbstractSeries>
 
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkInspectorLog)
@@ -53,7 +55,6 @@ public:
     bool            selectable      () { return _selectable; }
     bool            selected        () { return _pSeries != nullptr; }
     QAbstractSeries*series          () { return _pSeries; }
-    QList<QPointF>* values          () { return &_values;}
     qreal           rangeMin        () { return _rangeMin; }
     qreal           rangeMax        () { return _rangeMax; }
     int             chartIndex      ();
@@ -75,14 +76,15 @@ private:
     QString     _name;
     QString     _value;
     bool        _selectable = true;
-    int         _dataIndex  = 0;
     qreal       _rangeMin   = 0;
     qreal       _rangeMax   = 0;
 
     QAbstractSeries*    _pSeries = nullptr;
     QGCMAVLinkMessage*  _msg     = nullptr;
     MAVLinkChartController*      _chart   = nullptr;
-    QList<QPointF>      _values;
+    QPointer<TelemetryHistory>  _history;           ///< History the series below belongs to
+    int                 _seriesId = -1;             ///< Series "mavlink.<compid>.<message>.<field>"
+    QVector<QPointF>    _points;                    ///< Last query result
 };
 
 //-----------------------------------------------------------------------------
@@ -99,11 +101,11 @@ public:
     Q_PROPERTY(bool                 fieldSelected   READ fieldSelected  NOTIFY fieldSelectedChanged)
     Q_PROPERTY(bool                 selected        READ selected       NOTIFY selectedChanged)
 
-    QGCMAVLinkMessage   (QObject* parent, mavlink_message_t* message);
+    QGCMAVLinkMessage   (QObject* parent, const MAVLinkMessageHandle& message);
     ~QGCMAVLinkMessage  ();
 
-    quint32             id              () { return _message.msgid;  }
-    quint8              cid             () { return _message.compid; }
+    quint32             id              () { return _id;  }
+    quint8              cid             () { return _cid; }
     QString             name            () { return _name;  }
     qreal               messageHz       () { return _messageHz; }
     quint64             count           () { return _count; }
@@ -111,9 +113,10 @@ public:
     QmlObjectListModel* fields          () { return &_fields; }
     bool                fieldSelected   () { return _fieldSelected; }
     bool                selected        () { return _selected; }
+    TelemetryHistory*   history         () { return _history; }
 
     void                updateFieldSelection();
-    void                update          (mavlink_message_t* message);
+    void                update          (const MAVLinkMessageHandle& message, QGCMAVLinkVehicle* vehicle);
     void                updateFreq      ();
     void                setSelected     (bool sel) { _selected = sel; }
 
@@ -130,9 +133,11 @@ private:
     qreal               _messageHz  = 0.0;
     uint64_t            _count      = 0;
     uint64_t            _lastCount  = 0;
-    mavlink_message_t   _message;   //-- List of QGCMAVLinkMessageField
+    quint32             _id         = 0;
+    quint8              _cid        = 0;
     bool                _fieldSelected   = false;
     bool                _selected   = false;
+    QPointer<TelemetryHistory> _history;    ///< Where parsed field values are recorded
 };
 
 //-----------------------------------------------------------------------------
@@ -156,6 +161,9 @@ public:
     QStringList         compIDsStr      () { return _compIDsStr; }
     int                 selected        () { return _selected; }
 
+    /// @return The Vehicle's telemetry history, or a history of our own if there is no Vehicle for this system id
+    TelemetryHistory*   history         ();
+
     void                setSelected     (int sel);
     QGCMAVLinkMessage*  findMessage     (uint32_t id, uint8_t cid);
     int                 findMessage     (QGCMAVLinkMessage* message);
@@ -176,6 +184,7 @@ private:
     QStringList         _compIDsStr;
     QmlObjectListModel  _messages;      //-- List of QGCMAVLinkMessage
     int                 _selected = 0;
+    TelemetryHistory*   _ownHistory = nullptr;
 };
 
 //-----------------------------------------------------------------------------
@@ -290,7 +299,7 @@ signals:
     void rangeListChanged           ();
 
 private slots:
-    void _receiveMessage            (LinkInterface* link, mavlink_message_t message);
+    void _receiveMessage            (LinkInterface* link, MAVLinkMessageHandle message);
     void _vehicleAdded              (Vehicle* vehicle);
     void _vehicleRemoved            (Vehicle* vehicle);
     void _setActiveVehicle          (Vehicle* vehicle);
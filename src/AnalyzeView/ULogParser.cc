@@ -1,179 +1,604 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
 #include "ULogParser.h"
+#include "QGCLoggingCategory.h"
+
 #include <math.h>
-#include <QDateTime>
+#include <algorithm>
+#include <QtEndian>
+
+QGC_LOGGING_CATEGORY(ULogParserLog, "ULogParserLog")
+
+const char ULogParser::_ULogMagic[7] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
+
+static const uchar  kSyncMagic[8] = { 0x2F, 0x73, 0x13, 0x20, 0x25, 0x0C, 0xBB, 0x12 };
+static const int    kMsgIdLen = 2;
 
 ULogParser::ULogParser()
+    : _data             (nullptr)
+    , _size             (0)
+    , _startTimeUSecs   (0)
+    , _version          (0)
+    , _truncated        (false)
 {
 
 }
 
 ULogParser::~ULogParser()
 {
+    close();
+}
 
+void ULogParser::close(void)
+{
+    if (_data) {
+        _file.unmap(_data);
+        _data = nullptr;
+    }
+    _file.close();
+    _size = 0;
+    _startTimeUSecs = 0;
+    _version = 0;
+    _truncated = false;
+    _infos.clear();
+    _parameters.clear();
+    _rawFormats.clear();
+    _formats.clear();
+    _subscriptions.clear();
 }
 
-int ULogParser::sizeOfType(QString& typeName)
+bool ULogParser::open(const QString& filename, QString& errorMessage)
 {
-    if (typeName == QLatin1Literal("int8_t") || typeName == QLatin1Literal("uint8_t")) {
-        return 1;
+    close();
+    errorMessage.clear();
 
-    } else if (typeName == QLatin1Literal("int16_t") || typeName == QLatin1Literal("uint16_t")) {
-        return 2;
+    _file.setFileName(filename);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        errorMessage = tr("Unable to open log file: '%1', error: %2").arg(filename).arg(_file.errorString());
+        return false;
+    }
+    _size = _file.size();
+    if (_size < ULOG_FILE_HEADER_LEN) {
+        errorMessage = tr("Could not detect ULog file header magic");
+        close();
+        return false;
+    }
+    _data = _file.map(0, _size);
+    if (!_data) {
+        errorMessage = tr("Unable to map log file: '%1', error: %2").arg(filename).arg(_file.errorString());
+        close();
+        return false;
+    }
 
-    } else if (typeName == QLatin1Literal("int32_t") || typeName == QLatin1Literal("uint32_t")) {
-        return 4;
+    if (memcmp(_data, _ULogMagic, sizeof(_ULogMagic)) != 0) {
+        errorMessage = tr("Could not detect ULog file header magic");
+        close();
+        return false;
+    }
+    _version = _data[7];
+    _startTimeUSecs = qFromLittleEndian<quint64>(_data + 8);
+
+    QList<qint64>   appendedOffsets;
+    bool            dataSeen = false;
+    qint64          index = ULOG_FILE_HEADER_LEN;
+
+    // Only the message headers are touched here, except for definitions
+    while (index + ULOG_MSG_HEADER_LEN <= _size) {
+        const uchar*    msg = _data + index;
+        const int       msgSize = qFromLittleEndian<quint16>(msg);
+        const uint8_t   msgType = msg[2];
+        const uchar*    payload = msg + ULOG_MSG_HEADER_LEN;
+
+        if (!appendedOffsets.isEmpty() && index + ULOG_MSG_HEADER_LEN + msgSize > appendedOffsets.first()) {
+            // A log whose writer was interrupted continues with appended data, whatever runs into it is cut off
+            index = appendedOffsets.takeFirst();
+            continue;
+        }
+        if (index + ULOG_MSG_HEADER_LEN + msgSize > _size) {
+            qCDebug(ULogParserLog) << "Log truncated at" << index;
+            _truncated = true;
+            break;
+        }
 
-    } else if (typeName == QLatin1Literal("int64_t") || typeName == QLatin1Literal("uint64_t")) {
-        return 8;
+        switch (msgType) {
+        case static_cast<uint8_t>(ULogMessageType::FLAG_BITS):
+            if (msgSize >= 40) {
+                // Bit 0 of the first incompat byte is appended data, any other incompat bit means we can't read the log
+                const uchar* incompatFlags = payload + 8;
+                if ((incompatFlags[0] & ~0x01) != 0 || std::any_of(incompatFlags + 1, incompatFlags + 8, [](uchar flags) { return flags != 0; })) {
+                    errorMessage = tr("ULog file uses unsupported features");
+                    close();
+                    return false;
+                }
+                for (int i=0; i<3; i++) {
+                    qint64 appendedOffset = static_cast<qint64>(qFromLittleEndian<quint64>(payload + 16 + (i * 8)));
+                    if (appendedOffset > index && appendedOffset < _size) {
+                        appendedOffsets.append(appendedOffset);
+                    }
+                }
+                std::sort(appendedOffsets.begin(), appendedOffsets.end());
+            }
+            break;
+
+        case static_cast<uint8_t>(ULogMessageType::FORMAT):
+            _parseFormat(reinterpret_cast<const char*>(payload), msgSize);
+            break;
+
+        case static_cast<uint8_t>(ULogMessageType::INFO):
+        case static_cast<uint8_t>(ULogMessageType::PARAMETER):
+        {
+            QString     key;
+            QVariant    value;
+            if (_parseKeyValue(payload, msgSize, key, value)) {
+                if (msgType == static_cast<uint8_t>(ULogMessageType::INFO)) {
+                    _infos[key] = value;
+                } else if (!dataSeen && !_parameters.contains(key)) {
+                    _parameters[key] = value;
+                }
+            }
+            break;
+        }
 
-    } else if (typeName == QLatin1Literal("float")) {
-        return 4;
+        case static_cast<uint8_t>(ULogMessageType::ADD_LOGGED_MSG):
+            if (msgSize > 3) {
+                Subscription_t subscription;
+                subscription.multiId    = payload[0];
+                subscription.msgId      = qFromLittleEndian<quint16>(payload + 1);
+                subscription.formatName = QString::fromLatin1(reinterpret_cast<const char*>(payload + 3), msgSize - 3);
+                _subscriptions[subscription.msgId] = subscription;
+            }
+            break;
 
-    } else if (typeName == QLatin1Literal("double")) {
-        return 8;
+        case static_cast<uint8_t>(ULogMessageType::DATA):
+            if (msgSize >= kMsgIdLen) {
+                auto iter = _subscriptions.find(qFromLittleEndian<quint16>(payload));
+                if (iter != _subscriptions.end()) {
+                    iter->dataOffsets.append(index + ULOG_MSG_HEADER_LEN + kMsgIdLen);
+                }
+                dataSeen = true;
+            }
+            break;
+
+        case static_cast<uint8_t>(ULogMessageType::INFO_MULTIPLE):
+        case static_cast<uint8_t>(ULogMessageType::PARAMETER_DEFAULT):
+        case static_cast<uint8_t>(ULogMessageType::REMOVE_LOGGED_MSG):
+        case static_cast<uint8_t>(ULogMessageType::SYNC):
+        case static_cast<uint8_t>(ULogMessageType::DROPOUT):
+        case static_cast<uint8_t>(ULogMessageType::LOGGING):
+        case static_cast<uint8_t>(ULogMessageType::LOGGING_TAGGED):
+            break;
+
+        default:
+        {
+            if ((msgType >= 'A' && msgType <= 'Z') || (msgType >= 'a' && msgType <= 'z')) {
+                // Message types are letters, a type we don't know about yet is skipped by its size
+                qCDebug(ULogParserLog) << "Skipping unknown message type" << msgType << "at" << index;
+                break;
+            }
 
-    } else if (typeName == QLatin1Literal("char") || typeName == QLatin1Literal("bool")) {
-        return 1;
+            // Corrupt data, continue after the next sync message
+            const uchar* sync = std::search(msg, static_cast<const uchar*>(_data + _size), kSyncMagic, kSyncMagic + sizeof(kSyncMagic));
+            qCDebug(ULogParserLog) << "Unknown message type" << msgType << "at" << index << "resyncing";
+            if (sync == _data + _size) {
+                _truncated = true;
+                index = _size;
+            } else {
+                index = (sync - _data) + static_cast<qint64>(sizeof(kSyncMagic));
+            }
+            continue;
+        }
+        }
+
+        index += ULOG_MSG_HEADER_LEN + msgSize;
     }
 
-    qWarning() << "Unknown type in ULog : " << typeName;
-    return 0;
+    for (const QString& formatName: _rawFormats.keys()) {
+        _resolveFormat(formatName);
+    }
+    for (const Subscription_t& subscription: _subscriptions) {
+        if (!_formats.contains(subscription.formatName)) {
+            qCWarning(ULogParserLog) << "Subscription to unknown format" << subscription.formatName;
+        }
+    }
+
+    qCDebug(ULogParserLog) << "Indexed" << filename << "formats" << _formats.count() << "subscriptions" << _subscriptions.count();
+    return true;
 }
 
-int ULogParser::sizeOfFullType(QString& typeNameFull)
+/// Parses "name:type field;type field;..."
+bool ULogParser::_parseFormat(const char* format, int length)
 {
-    int arraySize;
-    QString typeName = extractArraySize(typeNameFull, arraySize);
-    return sizeOfType(typeName) * arraySize;
+    QString fmt = QString::fromLatin1(format, length);
+    int posSeparator = fmt.indexOf(':');
+    if (posSeparator == -1) {
+        return false;
+    }
+
+    QString             formatName = fmt.left(posSeparator);
+    QList<RawField_t>   rawFields;
+    for (const QString& fieldDefinition: fmt.mid(posSeparator + 1).split(';', QString::SkipEmptyParts)) {
+        int spacePos = fieldDefinition.indexOf(' ');
+        if (spacePos == -1) {
+            continue;
+        }
+
+        RawField_t rawField;
+        rawField.typeName   = fieldDefinition.left(spacePos);
+        rawField.name       = fieldDefinition.mid(spacePos + 1);
+        rawField.arraySize  = 1;
+
+        int startPos = rawField.typeName.indexOf('[');
+        int endPos = rawField.typeName.indexOf(']');
+        if (startPos != -1 && endPos > startPos) {
+            rawField.arraySize = rawField.typeName.midRef(startPos + 1, endPos - startPos - 1).toInt();
+            rawField.typeName = rawField.typeName.left(startPos);
+        }
+        rawFields.append(rawField);
+    }
+
+    _rawFormats[formatName] = rawFields;
+    return true;
 }
 
-QString ULogParser::extractArraySize(QString &typeNameFull, int &arraySize)
+/// Computes field offsets, flattening nested types
+const ULogParser::Format_t* ULogParser::_resolveFormat(const QString& formatName, int depth)
 {
-    int startPos = typeNameFull.indexOf('[');
-    int endPos = typeNameFull.indexOf(']');
+    if (_formats.contains(formatName)) {
+        return &_formats[formatName];
+    }
+    if (depth > _maxNestingDepth || !_rawFormats.contains(formatName)) {
+        qCWarning(ULogParserLog) << "Unable to resolve format" << formatName;
+        return nullptr;
+    }
+
+    Format_t    format;
+    int         offset = 0;
 
-    if (startPos == -1 || endPos == -1) {
-        arraySize = 1;
-        return typeNameFull;
+    format.name = formatName;
+    for (const RawField_t& rawField: _rawFormats[formatName]) {
+        FieldType_t type = _typeFromName(rawField.typeName);
+        if (type == TypeUnknown) {
+            const Format_t* nestedFormat = _resolveFormat(rawField.typeName, depth + 1);
+            if (!nestedFormat) {
+                return nullptr;
+            }
+            const Format_t nested = *nestedFormat;
+            for (int i=0; i<rawField.arraySize; i++) {
+                QString prefix = rawField.arraySize > 1 ? QStringLiteral("%1[%2].").arg(rawField.name).arg(i) : rawField.name + QStringLiteral(".");
+                for (Field_t nestedField: nested.fields) {
+                    nestedField.name.prepend(prefix);
+                    nestedField.offset += offset;
+                    format.fields.append(nestedField);
+                }
+                offset += nested.size;
+            }
+        } else {
+            // Padding is part of the layout but not a field. Trailing padding of a top level format is not logged,
+            // which is harmless since nothing follows it.
+            if (!rawField.name.startsWith(QStringLiteral("_padding"))) {
+                format.fields.append({ rawField.name, type, rawField.arraySize, offset });
+            }
+            offset += typeSize(type) * rawField.arraySize;
+        }
     }
+    format.size = offset;
 
-    arraySize = typeNameFull.midRef(startPos + 1, endPos - startPos - 1).toInt();
-    return typeNameFull.mid(0, startPos);
+    _formats[formatName] = format;
+    return &_formats[formatName];
 }
 
-bool ULogParser::parseFieldFormat(QString& fields)
+/// Parses an info or parameter message: u8 key length, key "type name", value
+bool ULogParser::_parseKeyValue(const uchar* data, int length, QString& key, QVariant& value) const
 {
-    int prevFieldEnd = 0;
-    int fieldEnd = fields.indexOf(';');
-    int offset = 0;
+    if (length < 1 || 1 + data[0] > length) {
+        return false;
+    }
+    QString typeAndName = QString::fromLatin1(reinterpret_cast<const char*>(data + 1), data[0]);
+    int spacePos = typeAndName.indexOf(' ');
+    if (spacePos == -1) {
+        return false;
+    }
+    key = typeAndName.mid(spacePos + 1);
+    value = _decodeValue(typeAndName.left(spacePos), data + 1 + data[0], length - 1 - data[0]);
+    return true;
+}
 
-    while (fieldEnd != -1) {
-        int spacePos = fields.indexOf(' ', prevFieldEnd);
+QVariant ULogParser::_decodeValue(const QString& typeName, const uchar* data, int length) const
+{
+    int         arraySize = 1;
+    QString     baseTypeName = typeName;
+    int         startPos = typeName.indexOf('[');
+    if (startPos != -1) {
+        arraySize = typeName.midRef(startPos + 1, typeName.indexOf(']') - startPos - 1).toInt();
+        baseTypeName = typeName.left(startPos);
+    }
 
-        if (spacePos != -1) {
-            QString typeNameFull = fields.mid(prevFieldEnd, spacePos - prevFieldEnd);
-            QString fieldName = fields.mid(spacePos + 1, fieldEnd - spacePos - 1);
+    FieldType_t type = _typeFromName(baseTypeName);
+    if (type == TypeChar) {
+        return QString::fromUtf8(reinterpret_cast<const char*>(data), static_cast<int>(qstrnlen(reinterpret_cast<const char*>(data), static_cast<uint>(qMin(length, arraySize)))));
+    }
+    if (type == TypeUnknown || typeSize(type) * arraySize > length) {
+        return QVariant();
+    }
 
-            if (!fieldName.contains(QLatin1Literal("_padding"))) {
-                _cameraCaptureOffsets.insert(fieldName, offset);
-                offset += sizeOfFullType(typeNameFull);
-            }
+    QVariantList values;
+    for (int i=0; i<arraySize; i++) {
+        const uchar* element = data + (i * typeSize(type));
+        switch (type) {
+        case TypeInt8:      values.append(static_cast<int>(static_cast<int8_t>(*element)));   break;
+        case TypeUInt8:     values.append(static_cast<uint>(*element));                       break;
+        case TypeInt16:     values.append(static_cast<int>(qFromLittleEndian<qint16>(element)));  break;
+        case TypeUInt16:    values.append(static_cast<uint>(qFromLittleEndian<quint16>(element))); break;
+        case TypeInt32:     values.append(qFromLittleEndian<qint32>(element));                break;
+        case TypeUInt32:    values.append(qFromLittleEndian<quint32>(element));               break;
+        case TypeInt64:     values.append(qFromLittleEndian<qint64>(element));                break;
+        case TypeUInt64:    values.append(qFromLittleEndian<quint64>(element));               break;
+        case TypeBool:      values.append(*element != 0);                                     break;
+        case TypeFloat:
+        {
+            float floatValue;
+            memcpy(&floatValue, element, sizeof(floatValue));
+            values.append(floatValue);
+            break;
+        }
+        case TypeDouble:
+        {
+            double doubleValue;
+            memcpy(&doubleValue, element, sizeof(doubleValue));
+            values.append(doubleValue);
+            break;
         }
+        default:
+            break;
+        }
+    }
+    return arraySize == 1 ? values.first() : QVariant(values);
+}
 
-        prevFieldEnd = fieldEnd + 1;
-        fieldEnd = fields.indexOf(';', prevFieldEnd);
+ULogParser::FieldType_t ULogParser::_typeFromName(const QString& typeName)
+{
+    static const QMap<QString, FieldType_t> typeMap = {
+        { QStringLiteral("int8_t"),     TypeInt8 },
+        { QStringLiteral("uint8_t"),    TypeUInt8 },
+        { QStringLiteral("int16_t"),    TypeInt16 },
+        { QStringLiteral("uint16_t"),   TypeUInt16 },
+        { QStringLiteral("int32_t"),    TypeInt32 },
+        { QStringLiteral("uint32_t"),   TypeUInt32 },
+        { QStringLiteral("int64_t"),    TypeInt64 },
+        { QStringLiteral("uint64_t"),   TypeUInt64 },
+        { QStringLiteral("float"),      TypeFloat },
+        { QStringLiteral("double"),     TypeDouble },
+        { QStringLiteral("bool"),       TypeBool },
+        { QStringLiteral("char"),       TypeChar },
+    };
+    return typeMap.value(typeName, TypeUnknown);
+}
+
+int ULogParser::typeSize(FieldType_t type)
+{
+    switch (type) {
+    case TypeInt8:
+    case TypeUInt8:
+    case TypeBool:
+    case TypeChar:
+        return 1;
+    case TypeInt16:
+    case TypeUInt16:
+        return 2;
+    case TypeInt32:
+    case TypeUInt32:
+    case TypeFloat:
+        return 4;
+    case TypeInt64:
+    case TypeUInt64:
+    case TypeDouble:
+        return 8;
+    case TypeUnknown:
+        break;
     }
-    return false;
+    return 0;
 }
 
-bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage)
+const ULogParser::Format_t* ULogParser::format(const QString& formatName) const
 {
-    errorMessage.clear();
+    auto iter = _formats.constFind(formatName);
+    return iter == _formats.constEnd() ? nullptr : &iter.value();
+}
 
-    //verify it's an ULog file
-    if(!log.contains(_ULogMagic)) {
-        errorMessage = tr("Could not detect ULog file header magic");
-        return false;
+const ULogParser::Field_t* ULogParser::field(const QString& formatName, const QString& fieldName) const
+{
+    const Format_t* fieldFormat = format(formatName);
+    if (fieldFormat) {
+        for (const Field_t& formatField: fieldFormat->fields) {
+            if (formatField.name == fieldName) {
+                return &formatField;
+            }
+        }
     }
+    return nullptr;
+}
 
-    int index = ULOG_FILE_HEADER_LEN;
-    bool geotagFound = false;
+QList<uint16_t> ULogParser::subscriptions(const QString& formatName) const
+{
+    QMap<uint8_t, uint16_t> msgIdsByMultiId;
+    for (const Subscription_t& subscription: _subscriptions) {
+        if (subscription.formatName == formatName) {
+            msgIdsByMultiId[subscription.multiId] = subscription.msgId;
+        }
+    }
+    return msgIdsByMultiId.values();
+}
 
-    while(index < log.count() - 1) {
+const ULogParser::Subscription_t* ULogParser::subscription(uint16_t msgId) const
+{
+    auto iter = _subscriptions.constFind(msgId);
+    return iter == _subscriptions.constEnd() ? nullptr : &iter.value();
+}
 
-        ULogMessageHeader header;
-        memset(&header, 0, sizeof(header));
-        memcpy(&header, log.data() + index, ULOG_MSG_HEADER_LEN);
+int ULogParser::messageCount(uint16_t msgId) const
+{
+    const Subscription_t* msgSubscription = subscription(msgId);
+    return msgSubscription ? msgSubscription->dataOffsets.count() : 0;
+}
 
-        switch (header.msgType) {
-            case (int)ULogMessageType::FORMAT:
-            {
-                ULogMessageFormat format_msg;
-                memset(&format_msg, 0, sizeof(format_msg));
-                memcpy(&format_msg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
+/// @return Pointer to the field in the mapped log, nullptr if the message is too short to hold it
+const uchar* ULogParser::_fieldData(uint16_t msgId, int messageIndex, const Field_t& field, int arrayIndex) const
+{
+    const Subscription_t* msgSubscription = subscription(msgId);
+    if (!msgSubscription || messageIndex < 0 || messageIndex >= msgSubscription->dataOffsets.count() || arrayIndex < 0 || arrayIndex >= field.arraySize) {
+        return nullptr;
+    }
 
-                QString fmt(format_msg.format);
-                int posSeparator = fmt.indexOf(':');
-                QString messageName = fmt.left(posSeparator);
-                QString messageFields = fmt.mid(posSeparator + 1, header.msgSize - posSeparator - 1);
+    const qint64    payloadOffset = msgSubscription->dataOffsets[messageIndex];
+    const int       payloadSize = qFromLittleEndian<quint16>(_data + payloadOffset - kMsgIdLen - ULOG_MSG_HEADER_LEN) - kMsgIdLen;
+    const int       elementOffset = field.offset + (arrayIndex * typeSize(field.type));
+    if (elementOffset + typeSize(field.type) > payloadSize) {
+        return nullptr;
+    }
+    return _data + payloadOffset + elementOffset;
+}
 
-                if(messageName == QLatin1Literal("camera_capture")) {
-                    parseFieldFormat(messageFields);
-                }
-                break;
-            }
+double ULogParser::doubleValue(uint16_t msgId, int messageIndex, const Field_t& field, int arrayIndex) const
+{
+    const uchar* data = _fieldData(msgId, messageIndex, field, arrayIndex);
+    if (!data) {
+        return qQNaN();
+    }
 
-            case (int)ULogMessageType::ADD_LOGGED_MSG:
-            {
-                ULogMessageAddLogged addLoggedMsg;
-                memset(&addLoggedMsg, 0, sizeof(addLoggedMsg));
-                memcpy(&addLoggedMsg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
+    switch (field.type) {
+    case TypeInt8:      return static_cast<int8_t>(*data);
+    case TypeUInt8:
+    case TypeBool:
+    case TypeChar:      return *data;
+    case TypeInt16:     return qFromLittleEndian<qint16>(data);
+    case TypeUInt16:    return qFromLittleEndian<quint16>(data);
+    case TypeInt32:     return qFromLittleEndian<qint32>(data);
+    case TypeUInt32:    return qFromLittleEndian<quint32>(data);
+    case TypeInt64:     return qFromLittleEndian<qint64>(data);
+    case TypeUInt64:    return qFromLittleEndian<quint64>(data);
+    case TypeFloat:
+    {
+        float floatValue;
+        memcpy(&floatValue, data, sizeof(floatValue));
+        return static_cast<double>(floatValue);
+    }
+    case TypeDouble:
+    {
+        double result;
+        memcpy(&result, data, sizeof(result));
+        return result;
+    }
+    case TypeUnknown:
+        break;
+    }
+    return qQNaN();
+}
 
-                QString messageName(addLoggedMsg.msgName);
+QString ULogParser::stringValue(uint16_t msgId, int messageIndex, const Field_t& field) const
+{
+    const char* data = reinterpret_cast<const char*>(_fieldData(msgId, messageIndex, field, 0));
+    if (!data || !_fieldData(msgId, messageIndex, field, field.arraySize - 1)) {
+        return QString();
+    }
+    return QString::fromUtf8(data, static_cast<int>(qstrnlen(data, static_cast<uint>(field.arraySize))));
+}
 
-                if(messageName.contains(QLatin1Literal("camera_capture"))) {
-                    _cameraCaptureMsgID = addLoggedMsg.msgID;
-                    geotagFound = true;
-                }
+int ULogParser::findTimestamp(uint16_t msgId, quint64 timestampUSecs) const
+{
+    const Subscription_t* msgSubscription = subscription(msgId);
+    if (!msgSubscription) {
+        return 0;
+    }
+    const Field_t* timestampField = field(msgSubscription->formatName, QStringLiteral("timestamp"));
+    if (!timestampField || timestampField->type != TypeUInt64) {
+        return msgSubscription->dataOffsets.count();
+    }
 
-                break;
-            }
+    int first = 0;
+    int count = msgSubscription->dataOffsets.count();
+    while (count > 0) {
+        int step = count / 2;
+        if (value<quint64>(msgId, first + step, *timestampField) < timestampUSecs) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
 
-            case (int)ULogMessageType::DATA:
-            {
-                uint16_t msgID = -1;
-                memcpy(&msgID, log.data() + index + ULOG_MSG_HEADER_LEN, 2);
-
-                if (geotagFound && msgID == _cameraCaptureMsgID) {
-
-                    // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
-                    GeoTagWorker::cameraFeedbackPacket feedback;
-                    memset(&feedback, 0, sizeof(feedback));
-                    memcpy(&feedback.timestamp, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("timestamp")), 8);
-                    feedback.timestamp /= 1.0e6; // to seconds
-                    memcpy(&feedback.timestampUTC, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("timestamp_utc")), 8);
-                    feedback.timestampUTC /= 1.0e6; // to seconds
-                    memcpy(&feedback.imageSequence, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("seq")), 4);
-                    memcpy(&feedback.latitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("lat")), 8);
-                    memcpy(&feedback.longitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("lon")), 8);
-                    feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                    memcpy(&feedback.altitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("alt")), 4);
-                    memcpy(&feedback.groundDistance, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("ground_distance")), 4);
-                    memcpy(&feedback.captureResult, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("result")), 1);
-
-                    cameraFeedback.append(feedback);
+bool ULogParser::getTagsFromLog(QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage)
+{
+    errorMessage.clear();
 
-                }
+    if (!isOpen()) {
+        errorMessage = tr("Could not detect ULog file header magic");
+        return false;
+    }
 
-                break;
-            }
+    // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
+    static const char* cameraCaptureFormat = "camera_capture";
+    const Field_t* timestampField       = field(cameraCaptureFormat, QStringLiteral("timestamp"));
+    const Field_t* timestampUTCField    = field(cameraCaptureFormat, QStringLiteral("timestamp_utc"));
+    const Field_t* seqField             = field(cameraCaptureFormat, QStringLiteral("seq"));
+    const Field_t* latField             = field(cameraCaptureFormat, QStringLiteral("lat"));
+    const Field_t* lonField             = field(cameraCaptureFormat, QStringLiteral("lon"));
+    const Field_t* altField             = field(cameraCaptureFormat, QStringLiteral("alt"));
+    const Field_t* groundDistanceField  = field(cameraCaptureFormat, QStringLiteral("ground_distance"));
+    const Field_t* qField               = field(cameraCaptureFormat, QStringLiteral("q"));
+    const Field_t* resultField          = field(cameraCaptureFormat, QStringLiteral("result"));
+
+    QList<uint16_t> msgIds = subscriptions(cameraCaptureFormat);
+    if (msgIds.isEmpty() || !timestampField || !seqField || !latField || !lonField || !altField) {
+        errorMessage = tr("Could not detect camera_capture packets in ULog");
+        return false;
+    }
 
-            default:
-                break;
+    // Multiple instances are merged in log order
+    QList<QPair<qint64, QPair<uint16_t, int>>> messages;
+    for (uint16_t msgId: msgIds) {
+        const QVector<qint64>& dataOffsets = subscription(msgId)->dataOffsets;
+        for (int i=0; i<dataOffsets.count(); i++) {
+            messages.append(qMakePair(dataOffsets[i], qMakePair(msgId, i)));
+        }
+    }
+    std::sort(messages.begin(), messages.end());
+
+    for (const auto& message: messages) {
+        const uint16_t  msgId = message.second.first;
+        const int       index = message.second.second;
+
+        GeoTagWorker::cameraFeedbackPacket feedback;
+        memset(&feedback, 0, sizeof(feedback));
+        feedback.timestamp      = doubleValue(msgId, index, *timestampField) / 1.0e6; // to seconds
+        feedback.imageSequence  = static_cast<uint32_t>(doubleValue(msgId, index, *seqField));
+        feedback.latitude       = doubleValue(msgId, index, *latField);
+        feedback.longitude      = fmod(180.0 + doubleValue(msgId, index, *lonField), 360.0) - 180.0;
+        feedback.altitude       = static_cast<float>(doubleValue(msgId, index, *altField));
+        if (timestampUTCField) {
+            feedback.timestampUTC = doubleValue(msgId, index, *timestampUTCField) / 1.0e6; // to seconds
+        }
+        if (groundDistanceField) {
+            feedback.groundDistance = static_cast<float>(doubleValue(msgId, index, *groundDistanceField));
+        }
+        if (qField && qField->arraySize == 4) {
+            for (int i=0; i<4; i++) {
+                feedback.attitudeQuaternion[i] = static_cast<float>(doubleValue(msgId, index, *qField, i));
+            }
+        }
+        if (resultField) {
+            feedback.captureResult = static_cast<uint8_t>(doubleValue(msgId, index, *resultField));
         }
 
-        index += (3 + header.msgSize);
-
+        cameraFeedback.append(feedback);
     }
 
     if (cameraFeedback.count() == 0) {
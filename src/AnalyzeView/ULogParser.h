@@ -1,14 +1,36 @@
-#ifndef ULOGPARSER_H
-#define ULOGPARSER_H
-
-#include <QGeoCoordinate>
-#include <QDebug>
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QMap>
+#include <QVector>
+#include <QVariant>
 #include <QCoreApplication>
+#include <QLoggingCategory>
 
 #include "GeoTagController.h"
 
+Q_DECLARE_LOGGING_CATEGORY(ULogParserLog)
+
 #define ULOG_FILE_HEADER_LEN 16
 
+/// Streaming reader for PX4 ULog files.
+///
+/// The log is memory mapped, never read into memory. Opening the log makes a single pass over the message headers
+/// which parses the format and subscription definitions and builds an index holding the file offset of every data
+/// message, per subscription. Field values are only extracted when asked for, straight from the mapped file, so
+/// multi-GB logs can be browsed with memory use proportional to the message count rather than the log size.
+///
+/// Nested types are flattened, a field "vehicle_gps_position_s gps" becomes "gps.lat", "gps.lon" and so on. Arrays of
+/// nested types are flattened per element: "esc_report_s esc[8]" becomes "esc[0].esc_rpm" and so on.
 class ULogParser
 {
     Q_DECLARE_TR_FUNCTIONS(ULogParser)
@@ -17,56 +39,147 @@ public:
     ULogParser();
     ~ULogParser();
 
-    /// @return true: failed, errorMessage set
-    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage);
+    typedef enum {
+        TypeInt8,
+        TypeUInt8,
+        TypeInt16,
+        TypeUInt16,
+        TypeInt32,
+        TypeUInt32,
+        TypeInt64,
+        TypeUInt64,
+        TypeFloat,
+        TypeDouble,
+        TypeBool,
+        TypeChar,
+        TypeUnknown,
+    } FieldType_t;
+
+    typedef struct {
+        QString     name;
+        FieldType_t type;
+        int         arraySize;          ///< 1 if not an array
+        int         offset;             ///< Offset within the data message payload, which starts after msg_id
+    } Field_t;
+
+    typedef struct {
+        QString         name;
+        QList<Field_t>  fields;         ///< Flattened, in payload order
+        int             size;           ///< Size including padding, used when the format is nested in another
+    } Format_t;
+
+    typedef struct {
+        uint16_t        msgId;
+        uint8_t         multiId;
+        QString         formatName;
+        QVector<qint64> dataOffsets;    ///< File offset of the payload of each data message, in log order
+    } Subscription_t;
+
+    /// Maps and indexes the log
+    ///     @return true: success, false: failed, errorMessage set
+    bool open(const QString& filename, QString& errorMessage);
+
+    void close(void);
+
+    bool    isOpen          (void) const { return _data != nullptr; }
+    quint64 startTimeUSecs  (void) const { return _startTimeUSecs; }
+    int     version         (void) const { return _version; }
+
+    /// @return true: the log ended in the middle of a message, everything before it is indexed
+    bool    truncated       (void) const { return _truncated; }
+
+    /// Info messages ('I'), for example "sys_name" or "ver_sw"
+    const QVariantMap&  infos       (void) const { return _infos; }
+
+    /// Parameter values at the start of the log ('P' messages before the first data message)
+    const QVariantMap&  parameters  (void) const { return _parameters; }
+
+    QStringList             formatNames     (void) const { return _formats.keys(); }
+    const Format_t*         format          (const QString& formatName) const;
+    const Field_t*          field           (const QString& formatName, const QString& fieldName) const;
+
+    /// @return msg ids of all subscriptions to the specified format (one per multi instance), lowest multi id first
+    QList<uint16_t>         subscriptions   (const QString& formatName) const;
+    const Subscription_t*   subscription    (uint16_t msgId) const;
+
+    /// @return Number of data messages for the subscription
+    int messageCount(uint16_t msgId) const;
+
+    /// @return Index of the first data message of the subscription with a timestamp field >= timestampUSecs,
+    ///         messageCount if there is none. Relies on timestamps increasing, as they do for ULog topics.
+    int findTimestamp(uint16_t msgId, quint64 timestampUSecs) const;
+
+    /// Typed access to a field of a data message. T must match the field type. Returns T() if the message is too
+    /// short to hold the field.
+    template<typename T>
+    T value(uint16_t msgId, int messageIndex, const Field_t& field, int arrayIndex = 0) const
+    {
+        T result = T();
+        Q_ASSERT(sizeof(T) == static_cast<size_t>(typeSize(field.type)));
+        const uchar* data = _fieldData(msgId, messageIndex, field, arrayIndex);
+        if (data) {
+            memcpy(&result, data, sizeof(T));
+        }
+        return result;
+    }
+
+    /// @return Field value converted to double, for any numeric type
+    double doubleValue(uint16_t msgId, int messageIndex, const Field_t& field, int arrayIndex = 0) const;
+
+    /// @return char array field as a string
+    QString stringValue(uint16_t msgId, int messageIndex, const Field_t& field) const;
+
+    static int typeSize(FieldType_t type);
+
+    /// Extracts the camera_capture messages for geotagging
+    ///     @return true: success, false: failed, errorMessage set
+    bool getTagsFromLog(QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage);
 
 private:
-
-    QMap<QString, int> _cameraCaptureOffsets; // <fieldName, fieldOffset>
-    int _cameraCaptureMsgID;
-
-    const char _ULogMagic[8] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
-
-    int sizeOfType(QString& typeName);
-    int sizeOfFullType(QString &typeNameFull);
-    QString extractArraySize(QString& typeNameFull, int& arraySize);
-
-    bool parseFieldFormat(QString& fields);
-
     enum class ULogMessageType : uint8_t {
         FORMAT = 'F',
         DATA = 'D',
         INFO = 'I',
+        INFO_MULTIPLE = 'M',
         PARAMETER = 'P',
+        PARAMETER_DEFAULT = 'Q',
         ADD_LOGGED_MSG = 'A',
         REMOVE_LOGGED_MSG = 'R',
         SYNC = 'S',
         DROPOUT = 'O',
         LOGGING = 'L',
+        LOGGING_TAGGED = 'C',
+        FLAG_BITS = 'B',
     };
 
     #define ULOG_MSG_HEADER_LEN 3
-    struct ULogMessageHeader {
-        uint16_t msgSize;
-        uint8_t msgType;
-    };
-
-    struct ULogMessageFormat {
-        uint16_t msgSize;
-        uint8_t msgType;
-
-        char format[2096];
-    };
-
-    struct ULogMessageAddLogged {
-	  uint16_t msgSize;
-      uint8_t msgType;
-
-	  uint8_t multiID;
-	  uint16_t msgID;
-	  char msgName[255];
-	};
 
+    typedef struct {
+        QString typeName;
+        QString name;
+        int     arraySize;
+    } RawField_t;
+
+    bool                _parseFormat        (const char* format, int length);
+    const Format_t*     _resolveFormat      (const QString& formatName, int depth = 0);
+    bool                _parseKeyValue      (const uchar* data, int length, QString& key, QVariant& value) const;
+    QVariant            _decodeValue        (const QString& typeName, const uchar* data, int length) const;
+    const uchar*        _fieldData          (uint16_t msgId, int messageIndex, const Field_t& field, int arrayIndex) const;
+
+    static FieldType_t  _typeFromName       (const QString& typeName);
+
+    QFile                               _file;
+    uchar*                              _data;
+    qint64                              _size;
+    quint64                             _startTimeUSecs;
+    int                                 _version;
+    bool                                _truncated;
+    QVariantMap                         _infos;
+    QVariantMap                         _parameters;
+    QMap<QString, QList<RawField_t>>    _rawFormats;        ///< Format definitions as parsed, before nested types are resolved
+    QMap<QString, Format_t>             _formats;
+    QMap<uint16_t, Subscription_t>      _subscriptions;
+
+    static const char   _ULogMagic[7];
+    static const int    _maxNestingDepth = 8;
 };
-
-#endif // ULOGPARSER_H
@@ -77,7 +77,7 @@ APMSensorsComponentController::APMSensorsComponentController(void)
         qWarning() << "Sensors component is missing";
     }
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::sharedMessageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
 }
 
 APMSensorsComponentController::~APMSensorsComponentController()
@@ -726,7 +726,7 @@ bool APMSensorsComponentController::usingUDPLink(void)
     return _vehicle->priorityLink()->getLinkConfiguration()->type() == LinkConfiguration::TypeUdp;
 }
 
-void APMSensorsComponentController::_handleCommandAck(mavlink_message_t& message)
+void APMSensorsComponentController::_handleCommandAck(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeLevelHorizon) {
         mavlink_command_ack_t commandAck;
@@ -765,7 +765,7 @@ void APMSensorsComponentController::_handleCommandAck(mavlink_message_t& message
     }
 }
 
-void APMSensorsComponentController::_handleMagCalProgress(mavlink_message_t& message)
+void APMSensorsComponentController::_handleMagCalProgress(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeOnboardCompass) {
         mavlink_mag_cal_progress_t magCalProgress;
@@ -793,7 +793,7 @@ void APMSensorsComponentController::_handleMagCalProgress(mavlink_message_t& mes
     }
 }
 
-void APMSensorsComponentController::_handleMagCalReport(mavlink_message_t& message)
+void APMSensorsComponentController::_handleMagCalReport(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeOnboardCompass) {
         mavlink_mag_cal_report_t magCalReport;
@@ -841,10 +841,12 @@ void APMSensorsComponentController::_handleMagCalReport(mavlink_message_t& messa
     }
 }
 
-void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface* link, MAVLinkMessageHandle messageHandle)
 {
     Q_UNUSED(link);
 
+    const mavlink_message_t& message = messageHandle.message();
+
     if (message.sysid != _vehicle->id()) {
         return;
     }
@@ -66,8 +66,10 @@ QGCCameraManager::_vehicleReady(bool ready)
 
 //-----------------------------------------------------------------------------
 void
-QGCCameraManager::_mavlinkMessageReceived(const mavlink_message_t& message)
+QGCCameraManager::_mavlinkMessageReceived(const MAVLinkMessageHandle& messageHandle)
 {
+    const mavlink_message_t& message = messageHandle.message();
+
     //-- Only pay attention to camera components, as identified by their compId
     if(message.sysid == _vehicle->id() && (message.compid >= MAV_COMP_ID_CAMERA && message.compid <= MAV_COMP_ID_CAMERA6)) {
         switch (message.msgid) {
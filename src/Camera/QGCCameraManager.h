@@ -59,7 +59,7 @@ signals:
 
 protected slots:
     virtual void    _vehicleReady           (bool ready);
-    virtual void    _mavlinkMessageReceived (const mavlink_message_t& message);
+    virtual void    _mavlinkMessageReceived (const MAVLinkMessageHandle& messageHandle);
     virtual void    _activeJoystickChanged  (Joystick* joystick);
     virtual void    _stepZoom               (int direction);
     virtual void    _startZoom              (int direction);
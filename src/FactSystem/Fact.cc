@@ -8,6 +8,7 @@
  ****************************************************************************/
 
 #include "Fact.h"
+#include "FactGroup.h"
 #include "FactValueSliderListModel.h"
 #include "QGCMAVLink.h"
 #include "QGCApplication.h"
@@ -112,10 +113,7 @@ void Fact::forceSetRawValue(const QVariant& value)
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
             _rawValue.setValue(typedValue);
-            _sendValueChangedSignal(cookedValue());
-            //-- Must be in this order
-            emit _containerRawValueChanged(rawValue());
-            emit rawValueChanged(_rawValue);
+            _rawValueUpdated();
         }
     } else {
         qWarning() << kMissingMetadata << name();
@@ -131,10 +129,7 @@ void Fact::setRawValue(const QVariant& value)
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
             if (typedValue != _rawValue) {
                 _rawValue.setValue(typedValue);
-                _sendValueChangedSignal(cookedValue());
-                //-- Must be in this order
-                emit _containerRawValueChanged(rawValue());
-                emit rawValueChanged(_rawValue);
+                _rawValueUpdated();
             }
         }
     } else {
@@ -142,6 +137,78 @@ void Fact::setRawValue(const QVariant& value)
     }
 }
 
+void Fact::setRawDouble(double value)
+{
+    switch (_type) {
+    case FactMetaData::valueTypeFloat:
+        _setRawNative<float>(static_cast<float>(value));
+        break;
+    case FactMetaData::valueTypeDouble:
+    case FactMetaData::valueTypeElapsedTimeInSeconds:
+        _setRawNative<double>(value);
+        break;
+    default:
+        setRawValue(value);
+        break;
+    }
+}
+
+void Fact::setRawInt(qint64 value)
+{
+    switch (_type) {
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeInt32:
+        _setRawNative<int>(static_cast<int>(value));
+        break;
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+        _setRawNative<uint>(static_cast<uint>(value));
+        break;
+    case FactMetaData::valueTypeInt64:
+        _setRawNative<qlonglong>(value);
+        break;
+    case FactMetaData::valueTypeUint64:
+        _setRawNative<qulonglong>(static_cast<qulonglong>(value));
+        break;
+    case FactMetaData::valueTypeFloat:
+        _setRawNative<float>(static_cast<float>(value));
+        break;
+    case FactMetaData::valueTypeDouble:
+    case FactMetaData::valueTypeElapsedTimeInSeconds:
+        _setRawNative<double>(static_cast<double>(value));
+        break;
+    default:
+        setRawValue(value);
+        break;
+    }
+}
+
+template<typename T>
+void Fact::_setRawNative(T value)
+{
+    if (_rawValue.userType() == qMetaTypeId<T>()) {
+        T& currentValue = *static_cast<T*>(_rawValue.data());
+        // x != x is only true for NaN, a NaN replacing a NaN is not a change
+        if (currentValue == value || (currentValue != currentValue && value != value)) {
+            return;
+        }
+        currentValue = value;
+    } else {
+        _rawValue.setValue(value);
+    }
+    _rawValueUpdated();
+}
+
+void Fact::_rawValueUpdated(void)
+{
+    _sendValueChangedSignal();
+    //-- Must be in this order
+    emit _containerRawValueChanged(rawValue());
+    emit rawValueChanged(_rawValue);
+}
+
 void Fact::setCookedValue(const QVariant& value)
 {
     if (_metaData) {
@@ -181,7 +248,7 @@ void Fact::_containerSetRawValue(const QVariant& value)
 {
     if(_rawValue != value) {
         _rawValue = value;
-        _sendValueChangedSignal(cookedValue());
+        _sendValueChangedSignal();
         emit rawValueChanged(_rawValue);
     }
 
@@ -637,21 +704,35 @@ void Fact::setSendValueChangedSignals (bool sendValueChangedSignals)
     }
 }
 
-void Fact::_sendValueChangedSignal(QVariant value)
+void Fact::_sendValueChangedSignal(void)
 {
     if (_sendValueChangedSignals) {
-        emit valueChanged(value);
         _deferredValueChangeSignal = false;
-    } else {
+        // The cooked value is only translated if someone observes it
+        if (_valueChangedConnected()) {
+            emit valueChanged(cookedValue());
+        }
+    } else if (!_deferredValueChangeSignal) {
         _deferredValueChangeSignal = true;
+        if (_factGroup) {
+            _factGroup->_factValueDeferred(this);
+        }
     }
 }
 
+bool Fact::_valueChangedConnected(void) const
+{
+    static const QMetaMethod valueChangedSignal = QMetaMethod::fromSignal(&Fact::valueChanged);
+    return isSignalConnected(valueChangedSignal);
+}
+
 void Fact::sendDeferredValueChangedSignal(void)
 {
     if (_deferredValueChangeSignal) {
         _deferredValueChangeSignal = false;
-        emit valueChanged(cookedValue());
+        if (_valueChangedConnected()) {
+            emit valueChanged(cookedValue());
+        }
     }
 }
 
@@ -21,8 +21,10 @@
 #include <QVariant>
 #include <QDebug>
 #include <QAbstractListModel>
+#include <QPointer>
 
 class FactValueSliderListModel;
+class FactGroup;
 
 /// @brief A Fact is used to hold a single value within the system.
 class Fact : public QObject
@@ -141,6 +143,13 @@ public:
 
     void setRawValue        (const QVariant& value);
     void setCookedValue     (const QVariant& value);
+
+    // Fast path for trusted vehicle telemetry. The value is stored in the Fact's native type without going through
+    // FactMetaData conversion and compared natively. Types which do not match the Fact (for example setRawDouble on
+    // a string Fact) fall back to setRawValue.
+
+    void setRawDouble       (double value);
+    void setRawInt          (qint64 value);
     void setEnumIndex       (int index);
     void setEnumStringValue (const QString& value);
     int  valueIndex         (const QString& value);
@@ -200,10 +209,19 @@ private slots:
 
 private:
     void _init(void);
+    void _rawValueUpdated(void);
+    bool _valueChangedConnected(void) const;
+
+    template<typename T>
+    void _setRawNative(T value);
+
+    QPointer<FactGroup>         _factGroup;     ///< Rate limited FactGroup which is told about deferred value changes
+
+    friend class FactGroup;
     
 protected:
     QString _variantToString(const QVariant& variant, int decimalPlaces) const;
-    void _sendValueChangedSignal(QVariant value);
+    void _sendValueChangedSignal(void);
 
     QString                     _name;
     int                         _componentId;
@@ -9,6 +9,7 @@
 
 
 #include "FactGroup.h"
+#include "FactGroupUpdateScheduler.h"
 #include "JsonHelper.h"
 
 #include <QJsonDocument>
@@ -21,18 +22,30 @@
 QGC_LOGGING_CATEGORY(FactGroupLog, "FactGroupLog")
 
 FactGroup::FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent)
-    : QObject(parent)
-    , _updateRateMSecs(updateRateMsecs)
+    : QObject           (parent)
+    , _updateRateMSecs  (updateRateMsecs)
+    , _nextUpdateMsecs  (0)
+    , _updateScheduled  (false)
+    , _liveUpdates      (false)
 {
-    _setupTimer();
     _nameToFactMetaDataMap = FactMetaData::createMapFromJsonFile(metaDataFile, this);
 }
 
 FactGroup::FactGroup(int updateRateMsecs, QObject* parent)
-    : QObject(parent)
-    , _updateRateMSecs(updateRateMsecs)
+    : QObject           (parent)
+    , _updateRateMSecs  (updateRateMsecs)
+    , _nextUpdateMsecs  (0)
+    , _updateScheduled  (false)
+    , _liveUpdates      (false)
 {
-    _setupTimer();
+
+}
+
+FactGroup::~FactGroup()
+{
+    if (_updateRateMSecs > 0) {
+        FactGroupUpdateScheduler::removeGroup(this);
+    }
 }
 
 void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
@@ -41,13 +54,10 @@ void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
     _nameToFactMetaDataMap = FactMetaData::createMapFromJsonArray(jsonArray, defineMap, this);
 }
 
-void FactGroup::_setupTimer()
+void FactGroup::_setPeriodicUpdates(void)
 {
     if (_updateRateMSecs > 0) {
-        connect(&_updateTimer, &QTimer::timeout, this, &FactGroup::_updateAllValues);
-        _updateTimer.setSingleShot(false);
-        _updateTimer.setInterval(_updateRateMSecs);
-        _updateTimer.start();
+        FactGroupUpdateScheduler::instance()->addPeriodicGroup(this);
     }
 }
 
@@ -102,7 +112,10 @@ void FactGroup::_addFact(Fact* fact, const QString& name)
         return;
     }
 
-    fact->setSendValueChangedSignals(_updateRateMSecs == 0);
+    fact->setSendValueChangedSignals(_updateRateMSecs == 0 || _liveUpdates);
+    if (_updateRateMSecs > 0) {
+        fact->_factGroup = this;
+    }
     if (_nameToFactMetaDataMap.contains(name)) {
         fact->setMetaData(_nameToFactMetaDataMap[name]);
     }
@@ -122,23 +135,46 @@ void FactGroup::_addFactGroup(FactGroup* factGroup, const QString& name)
 
 void FactGroup::_updateAllValues(void)
 {
-    for(Fact* fact: _nameToFactMap) {
+    _sendDeferredValues();
+}
+
+void FactGroup::_sendDeferredValues(void)
+{
+    // Signal handlers may set values again, those go to a new list
+    QVector<Fact*> deferredFacts;
+    deferredFacts.swap(_deferredFacts);
+    for (Fact* fact: deferredFacts) {
         fact->sendDeferredValueChangedSignal();
     }
 }
 
+void FactGroup::_factValueDeferred(Fact* fact)
+{
+    _deferredFacts.append(fact);
+    if (!_updateScheduled) {
+        _updateScheduled = true;
+        FactGroupUpdateScheduler::instance()->scheduleGroup(this);
+    }
+}
+
+void FactGroup::_runUpdate(qint64 nowMsecs)
+{
+    _nextUpdateMsecs = nowMsecs + _updateRateMSecs;
+    _updateAllValues();
+}
+
 void FactGroup::setLiveUpdates(bool liveUpdates)
 {
-    if (_updateTimer.interval() == 0) {
+    if (_updateRateMSecs == 0 || liveUpdates == _liveUpdates) {
         return;
     }
 
-    if (liveUpdates) {
-        _updateTimer.stop();
-    } else {
-        _updateTimer.start();
-    }
+    _liveUpdates = liveUpdates;
     for(Fact* fact: _nameToFactMap) {
         fact->setSendValueChangedSignals(liveUpdates);
     }
+    if (liveUpdates) {
+        // Don't leave values which changed before the switch waiting for the scheduler
+        _sendDeferredValues();
+    }
 }
@@ -16,11 +16,15 @@
 
 #include <QStringList>
 #include <QMap>
+#include <QVector>
 #include <QTimer>
 
 Q_DECLARE_LOGGING_CATEGORY(VehicleLog)
 
 /// Used to group Facts together into an object hierarachy.
+///
+/// If the group has an update rate the valueChanged signals of its Facts are deferred. Facts with a deferred change
+/// are kept in a dirty list and FactGroupUpdateScheduler flushes them at most once per update interval.
 class FactGroup : public QObject
 {
     Q_OBJECT
@@ -28,6 +32,7 @@ class FactGroup : public QObject
 public:
     FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent = nullptr);
     FactGroup(int updateRateMsecs, QObject* parent = nullptr);
+    ~FactGroup();
 
     Q_PROPERTY(QStringList factNames        READ factNames      CONSTANT)
     Q_PROPERTY(QStringList factGroupNames   READ factGroupNames CONSTANT)
@@ -49,14 +54,29 @@ protected:
     void _addFactGroup(FactGroup* factGroup, const QString& name);
     void _loadFromJsonArray(const QJsonArray jsonArray);
 
+    /// Requests a call to _updateAllValues every update interval, even if no value changed
+    void _setPeriodicUpdates(void);
+
     int _updateRateMSecs;   ///< Update rate for Fact::valueChanged signals, 0: immediate update
 
 protected slots:
+    /// Called by the scheduler once the update interval elapsed. Sends the deferred valueChanged signals.
     virtual void _updateAllValues(void);
 
 private:
-    void _setupTimer();
-    QTimer _updateTimer;
+    void _factValueDeferred (Fact* fact);
+    bool _hasDeferredValues (void) const { return !_deferredFacts.isEmpty(); }
+    bool _updateDue         (qint64 nowMsecs) const { return nowMsecs >= _nextUpdateMsecs; }
+    void _runUpdate         (qint64 nowMsecs);
+    void _sendDeferredValues(void);
+
+    QVector<Fact*>  _deferredFacts;         ///< Facts with a deferred valueChanged signal
+    qint64          _nextUpdateMsecs;
+    bool            _updateScheduled;
+    bool            _liveUpdates;
+
+    friend class Fact;
+    friend class FactGroupUpdateScheduler;
 
 protected:
     QMap<QString, Fact*>            _nameToFactMap;
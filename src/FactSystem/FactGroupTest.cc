@@ -0,0 +1,143 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupTest.h"
+#include "FactGroup.h"
+#include "FactGroupUpdateScheduler.h"
+
+#include <QSignalSpy>
+
+#include <limits>
+
+class TestFactGroup : public FactGroup
+{
+public:
+    TestFactGroup(int updateRateMsecs)
+        : FactGroup (updateRateMsecs)
+        , fact1     (0, "fact1", FactMetaData::valueTypeDouble)
+        , fact2     (0, "fact2", FactMetaData::valueTypeDouble)
+    {
+        _addFact(&fact1, "fact1");
+        _addFact(&fact2, "fact2");
+    }
+
+    Fact fact1;
+    Fact fact2;
+};
+
+void FactGroupTest::_rateLimit_test(void)
+{
+    TestFactGroup factGroup(_updateRateMsecs);
+    QSignalSpy spy(&factGroup.fact1, &Fact::valueChanged);
+
+    // First change goes out on the next frame
+    factGroup.fact1.setRawValue(1.0);
+    QVERIFY(spy.wait(_updateRateMsecs));
+    QCOMPARE(spy.count(), 1);
+
+    // Changes within the update interval are coalesced into a single signal with the latest value
+    for (int i=2; i<=10; i++) {
+        factGroup.fact1.setRawValue(static_cast<double>(i));
+    }
+    QTest::qWait(_updateRateMsecs / 5);
+    QCOMPARE(spy.count(), 1);
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(spy.last()[0].toDouble(), 10.0);
+
+    // Nothing changed, so nothing is sent
+    QTest::qWait(_updateRateMsecs * 2);
+    QCOMPARE(spy.count(), 2);
+}
+
+void FactGroupTest::_onlyChangedFacts_test(void)
+{
+    TestFactGroup factGroup(_updateRateMsecs);
+    QSignalSpy spy1(&factGroup.fact1, &Fact::valueChanged);
+    QSignalSpy spy2(&factGroup.fact2, &Fact::valueChanged);
+
+    factGroup.fact2.setRawValue(2.0);
+    QVERIFY(spy2.wait(_updateRateMsecs));
+    QCOMPARE(spy1.count(), 0);
+    QCOMPARE(spy2.count(), 1);
+
+    // Setting the same value again is not a change
+    factGroup.fact2.setRawValue(2.0);
+    QTest::qWait(_updateRateMsecs * 2);
+    QCOMPARE(spy1.count(), 0);
+    QCOMPARE(spy2.count(), 1);
+    QCOMPARE(FactGroupUpdateScheduler::instance()->scheduledGroupCount(), 0);
+}
+
+void FactGroupTest::_liveUpdates_test(void)
+{
+    TestFactGroup factGroup(_updateRateMsecs);
+    QSignalSpy spy(&factGroup.fact1, &Fact::valueChanged);
+
+    // A value deferred before switching to live updates is sent by the switch
+    factGroup.fact1.setRawValue(1.0);
+    factGroup.setLiveUpdates(true);
+    QCOMPARE(spy.count(), 1);
+
+    factGroup.fact1.setRawValue(2.0);
+    factGroup.fact1.setRawValue(3.0);
+    QCOMPARE(spy.count(), 3);
+
+    factGroup.setLiveUpdates(false);
+    factGroup.fact1.setRawValue(4.0);
+    QCOMPARE(spy.count(), 3);
+    QVERIFY(spy.wait(_updateRateMsecs * 2));
+    QCOMPARE(spy.last()[0].toDouble(), 4.0);
+}
+
+void FactGroupTest::_destroyScheduled_test(void)
+{
+    FactGroupUpdateScheduler* scheduler = FactGroupUpdateScheduler::instance();
+    int scheduledCount = scheduler->scheduledGroupCount();
+
+    TestFactGroup* factGroup = new TestFactGroup(_updateRateMsecs);
+    factGroup->fact1.setRawValue(1.0);
+    QCOMPARE(scheduler->scheduledGroupCount(), scheduledCount + 1);
+
+    delete factGroup;
+    QCOMPARE(scheduler->scheduledGroupCount(), scheduledCount);
+    QTest::qWait(FactGroupUpdateScheduler::frameIntervalMsecs * 3);
+}
+
+void FactGroupTest::_typedSetRaw_test(void)
+{
+    TestFactGroup factGroup(0);
+    Fact intFact(0, "int", FactMetaData::valueTypeUint16);
+    QSignalSpy doubleSpy(&factGroup.fact1, &Fact::valueChanged);
+    QSignalSpy intSpy(&intFact, &Fact::valueChanged);
+
+    factGroup.fact1.setRawDouble(1.5);
+    QCOMPARE(factGroup.fact1.rawValue().userType(), static_cast<int>(QMetaType::Double));
+    QCOMPARE(factGroup.fact1.rawValue().toDouble(), 1.5);
+    QCOMPARE(doubleSpy.count(), 1);
+
+    // Same value and NaN replacing NaN are not changes
+    factGroup.fact1.setRawDouble(1.5);
+    QCOMPARE(doubleSpy.count(), 1);
+    factGroup.fact1.setRawDouble(std::numeric_limits<double>::quiet_NaN());
+    factGroup.fact1.setRawDouble(std::numeric_limits<double>::quiet_NaN());
+    QCOMPARE(doubleSpy.count(), 2);
+
+    // Integer Facts keep the type setRawValue would have converted to
+    intFact.setRawInt(42);
+    QCOMPARE(intFact.rawValue().userType(), static_cast<int>(QMetaType::UInt));
+    QCOMPARE(intFact.rawValue().toUInt(), 42u);
+    intFact.setRawInt(42);
+    QCOMPARE(intSpy.count(), 1);
+
+    // setRawDouble on an integer Fact takes the converting path
+    intFact.setRawDouble(7.0);
+    QCOMPARE(intFact.rawValue().userType(), static_cast<int>(QMetaType::UInt));
+    QCOMPARE(intFact.rawValue().toUInt(), 7u);
+    QCOMPARE(intSpy.count(), 2);
+}
@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for FactGroup rate limited updates through FactGroupUpdateScheduler
+class FactGroupTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    FactGroupTest(void) { }
+
+private slots:
+    void _rateLimit_test        (void);
+    void _onlyChangedFacts_test (void);
+    void _liveUpdates_test      (void);
+    void _destroyScheduled_test (void);
+    void _typedSetRaw_test      (void);
+
+private:
+    static const int _updateRateMsecs = 500;
+};
@@ -0,0 +1,110 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupUpdateScheduler.h"
+#include "FactGroup.h"
+
+#include <QCoreApplication>
+#include <algorithm>
+
+QPointer<FactGroupUpdateScheduler> FactGroupUpdateScheduler::_instance;
+
+FactGroupUpdateScheduler::FactGroupUpdateScheduler(QObject* parent)
+    : QObject(parent)
+{
+    _frameTimer.setSingleShot(false);
+    _frameTimer.setInterval(frameIntervalMsecs);
+    connect(&_frameTimer, &QTimer::timeout, this, &FactGroupUpdateScheduler::_frame);
+    _clock.start();
+}
+
+FactGroupUpdateScheduler* FactGroupUpdateScheduler::instance(void)
+{
+    if (!_instance) {
+        // Owned by the application so it goes away with the event loop it relies on
+        _instance = new FactGroupUpdateScheduler(QCoreApplication::instance());
+    }
+    return _instance;
+}
+
+void FactGroupUpdateScheduler::removeGroup(FactGroup* factGroup)
+{
+    if (_instance) {
+        _instance->_removeGroup(factGroup);
+    }
+}
+
+void FactGroupUpdateScheduler::scheduleGroup(FactGroup* factGroup)
+{
+    _scheduledGroups.append(factGroup);
+    _updateTimer();
+}
+
+void FactGroupUpdateScheduler::addPeriodicGroup(FactGroup* factGroup)
+{
+    if (!_periodicGroups.contains(factGroup)) {
+        _periodicGroups.append(factGroup);
+        _updateTimer();
+    }
+}
+
+void FactGroupUpdateScheduler::_removeGroup(FactGroup* factGroup)
+{
+    _scheduledGroups.removeAll(factGroup);
+    _periodicGroups.removeAll(factGroup);
+    std::replace(_frameGroups.begin(), _frameGroups.end(), factGroup, static_cast<FactGroup*>(nullptr));
+    _updateTimer();
+}
+
+void FactGroupUpdateScheduler::_updateTimer(void)
+{
+    bool work = !_scheduledGroups.isEmpty() || !_periodicGroups.isEmpty();
+
+    if (work && !_frameTimer.isActive()) {
+        _frameTimer.start();
+    } else if (!work && _frameTimer.isActive()) {
+        _frameTimer.stop();
+    }
+}
+
+void FactGroupUpdateScheduler::_frame(void)
+{
+    qint64 nowMsecs = _clock.elapsed();
+
+    // Signals sent from here can set other Facts, destroy groups or schedule groups again. New work goes to
+    // _scheduledGroups, groups destroyed meanwhile are nulled out of _frameGroups.
+    _frameGroups = _periodicGroups;
+    for (int i=0; i<_frameGroups.count(); i++) {
+        FactGroup* factGroup = _frameGroups[i];
+        if (factGroup && factGroup->_updateDue(nowMsecs)) {
+            factGroup->_runUpdate(nowMsecs);
+        }
+    }
+
+    _frameGroups.clear();
+    _frameGroups.swap(_scheduledGroups);
+    for (int i=0; i<_frameGroups.count(); i++) {
+        FactGroup* factGroup = _frameGroups[i];
+        if (!factGroup) {
+            continue;
+        }
+        if (!factGroup->_hasDeferredValues()) {
+            // Already flushed by a periodic update or live updates being turned on
+            factGroup->_updateScheduled = false;
+        } else if (factGroup->_updateDue(nowMsecs)) {
+            factGroup->_updateScheduled = false;
+            factGroup->_runUpdate(nowMsecs);
+        } else {
+            _scheduledGroups.append(factGroup);
+        }
+    }
+    _frameGroups.clear();
+
+    _updateTimer();
+}
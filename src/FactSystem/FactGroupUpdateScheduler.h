@@ -0,0 +1,62 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QPointer>
+#include <QElapsedTimer>
+
+class FactGroup;
+
+/// Sends the deferred Fact::valueChanged signals for all rate limited FactGroups from a single timer.
+///
+/// A FactGroup registers itself here when one of its Facts first defers a value change, so only groups with changed
+/// values are visited. Once per UI frame the scheduler flushes every registered group whose update interval has
+/// elapsed, a group which is not yet due stays registered until it is. Groups which need a tick every update interval
+/// even when nothing changed (for example a clock) register as periodic. The timer only runs while there is work.
+class FactGroupUpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static FactGroupUpdateScheduler* instance(void);
+
+    /// Removes the group from the scheduler, if the scheduler still exists. Used from FactGroup destructor.
+    static void removeGroup(FactGroup* factGroup);
+
+    /// Adds a group with deferred value changes
+    void scheduleGroup(FactGroup* factGroup);
+
+    void addPeriodicGroup(FactGroup* factGroup);
+
+    /// @return Number of groups waiting for their update interval to elapse
+    int scheduledGroupCount(void) const { return _scheduledGroups.count(); }
+
+    static const int frameIntervalMsecs = 16;
+
+private slots:
+    void _frame(void);
+
+private:
+    FactGroupUpdateScheduler(QObject* parent);
+
+    void _removeGroup   (FactGroup* factGroup);
+    void _updateTimer   (void);
+
+    QTimer              _frameTimer;
+    QElapsedTimer       _clock;
+    QVector<FactGroup*> _scheduledGroups;
+    QVector<FactGroup*> _periodicGroups;
+    QVector<FactGroup*> _frameGroups;       ///< Groups being visited in the current frame, nulled if removed meanwhile
+
+    static QPointer<FactGroupUpdateScheduler> _instance;
+};
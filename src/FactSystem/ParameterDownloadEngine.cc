@@ -0,0 +1,379 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterDownloadEngine.h"
+
+#include <QtGlobal>
+
+const int ParameterDownloadEngine::initialWindow;
+const int ParameterDownloadEngine::maxWindow;
+const int ParameterDownloadEngine::initialTimeoutMsecs;
+const int ParameterDownloadEngine::minTimeoutMsecs;
+const int ParameterDownloadEngine::maxTimeoutMsecs;
+const int ParameterDownloadEngine::maxStreamIdleMsecs;
+
+ParameterDownloadEngine::ParameterDownloadEngine(void)
+    : _missingCount         (0)
+    , _requesting           (false)
+    , _maxRetries           (5)
+    , _inFlightCount        (0)
+    , _nextSlot             (0)
+    , _window               (initialWindow)
+    , _slowStartThreshold   (maxWindow)
+    , _lastDecreaseMsecs    (0)
+    , _srttMsecs            (-1)
+    , _rttVarMsecs          (0)
+    , _arrivalGapMsecs      (-1)
+    , _lastArrivalMsecs     (0)
+    , _lastReceivedMsecs    (0)
+    , _downloadStartMsecs   (0)
+    , _receivedCount        (0)
+    , _requestCount         (0)
+    , _timeoutCount         (0)
+{
+
+}
+
+void ParameterDownloadEngine::addComponent(int componentId, int paramCount, qint64 nowMsecs)
+{
+    if (hasComponent(componentId)) {
+        return;
+    }
+
+    if (_missingCount == 0) {
+        _startDownload(nowMsecs);
+    }
+
+    Component_t component;
+    component.componentId   = componentId;
+    component.paramCount    = qMax(paramCount, 0);
+    component.missingCount  = 0;
+    component.inFlightCount = 0;
+    component.cursor        = 0;
+    component.streamEnded   = false;
+
+    _componentSlots[componentId] = _components.count();
+    _components.append(component);
+    _resetSlot(_components.count() - 1);
+
+    _lastArrivalMsecs = nowMsecs;
+}
+
+void ParameterDownloadEngine::resetComponent(int componentId, qint64 nowMsecs)
+{
+    if (_missingCount == 0) {
+        _startDownload(nowMsecs);
+    }
+
+    for (int slot=0; slot<_components.count(); slot++) {
+        if (componentId == 0 || _components[slot].componentId == componentId) {
+            _resetSlot(slot);
+        }
+    }
+
+    // Requests to the reset components are not waited for anymore
+    QQueue<InFlight_t> inFlight;
+    for (const InFlight_t& request: _inFlight) {
+        if (_components[request.slot].sentMsecs[request.paramIndex] == request.sentMsecs) {
+            inFlight.enqueue(request);
+        }
+    }
+    _inFlight.swap(inFlight);
+
+    // A new PARAM_REQUEST_LIST stream is expected
+    _requesting = false;
+    _lastArrivalMsecs = nowMsecs;
+}
+
+void ParameterDownloadEngine::_resetSlot(int slot)
+{
+    Component_t& component = _components[slot];
+
+    _missingCount   -= component.missingCount;
+    _inFlightCount  -= component.inFlightCount;
+
+    component.missing.fill(true, component.paramCount);
+    component.missingCount  = component.paramCount;
+    component.inFlightCount = 0;
+    component.cursor        = 0;
+    component.streamEnded   = false;
+    component.sentMsecs.fill(-1, component.paramCount);
+    component.retryCount.fill(0, component.paramCount);
+
+    _missingCount += component.missingCount;
+}
+
+void ParameterDownloadEngine::_startDownload(qint64 nowMsecs)
+{
+    _downloadStartMsecs = nowMsecs;
+    _lastReceivedMsecs  = nowMsecs;
+    _receivedCount      = 0;
+    _requestCount       = 0;
+    _timeoutCount       = 0;
+}
+
+bool ParameterDownloadEngine::isMissing(int componentId, int paramIndex) const
+{
+    int slot = _componentSlots.value(componentId, -1);
+    if (slot == -1) {
+        return false;
+    }
+
+    const Component_t& component = _components[slot];
+    return paramIndex >= 0 && paramIndex < component.paramCount && component.missing.testBit(paramIndex);
+}
+
+int ParameterDownloadEngine::missingCount(int componentId) const
+{
+    int slot = _componentSlots.value(componentId, -1);
+    return slot == -1 ? 0 : _components[slot].missingCount;
+}
+
+bool ParameterDownloadEngine::received(int componentId, int paramIndex, qint64 nowMsecs)
+{
+    int slot = _componentSlots.value(componentId, -1);
+    if (slot == -1) {
+        return false;
+    }
+
+    Component_t& component = _components[slot];
+    if (paramIndex < 0 || paramIndex >= component.paramCount) {
+        return false;
+    }
+
+    if (!_requesting) {
+        // Pace of the PARAM_REQUEST_LIST stream, used to tell when it has stopped
+        double gap = static_cast<double>(nowMsecs - _lastArrivalMsecs);
+        _arrivalGapMsecs = _arrivalGapMsecs < 0 ? gap : (0.875 * _arrivalGapMsecs) + (0.125 * gap);
+        if (paramIndex == component.paramCount - 1) {
+            // Streams are sent in index order, this component is done
+            component.streamEnded = true;
+        }
+    }
+    _lastArrivalMsecs = nowMsecs;
+
+    if (!component.missing.testBit(paramIndex)) {
+        return false;
+    }
+
+    component.missing.clearBit(paramIndex);
+    component.missingCount--;
+    _missingCount--;
+    _receivedCount++;
+    _lastReceivedMsecs = nowMsecs;
+
+    qint64 sentMsecs = component.sentMsecs[paramIndex];
+    if (sentMsecs != -1) {
+        component.sentMsecs[paramIndex] = -1;
+        component.inFlightCount--;
+        _inFlightCount--;
+
+        // Karn's algorithm: a response to a retried request can't be matched to a send time
+        if (component.retryCount[paramIndex] == 1) {
+            _rttSample(nowMsecs - sentMsecs);
+        }
+
+        // Slow start doubles the window each round trip, then it grows by one request per round trip
+        if (_window < _slowStartThreshold) {
+            _window += 1;
+        } else {
+            _window += 1 / _window;
+        }
+        _window = qMin(_window, static_cast<double>(maxWindow));
+    }
+
+    return true;
+}
+
+void ParameterDownloadEngine::_rttSample(qint64 rttMsecs)
+{
+    // RFC 6298 smoothing
+    double rtt = static_cast<double>(qMax(rttMsecs, static_cast<qint64>(0)));
+    if (_srttMsecs < 0) {
+        _srttMsecs      = rtt;
+        _rttVarMsecs    = rtt / 2;
+    } else {
+        _rttVarMsecs    = (0.75 * _rttVarMsecs) + (0.25 * qAbs(_srttMsecs - rtt));
+        _srttMsecs      = (0.875 * _srttMsecs) + (0.125 * rtt);
+    }
+}
+
+int ParameterDownloadEngine::timeoutMsecs(void) const
+{
+    if (_srttMsecs < 0) {
+        return initialTimeoutMsecs;
+    }
+    return qBound(minTimeoutMsecs, static_cast<int>(_srttMsecs + (4 * _rttVarMsecs)), maxTimeoutMsecs);
+}
+
+int ParameterDownloadEngine::streamIdleMsecs(void) const
+{
+    if (_arrivalGapMsecs < 0) {
+        return maxStreamIdleMsecs;
+    }
+    return qBound(250, static_cast<int>(8 * _arrivalGapMsecs), maxStreamIdleMsecs);
+}
+
+void ParameterDownloadEngine::_expireRequests(qint64 nowMsecs)
+{
+    int timeout = timeoutMsecs();
+
+    while (!_inFlight.isEmpty()) {
+        const InFlight_t& inFlight = _inFlight.head();
+        Component_t& component = _components[inFlight.slot];
+
+        if (component.sentMsecs[inFlight.paramIndex] != inFlight.sentMsecs) {
+            // Answered or reset meanwhile
+            _inFlight.dequeue();
+            continue;
+        }
+        if (nowMsecs - inFlight.sentMsecs < timeout) {
+            break;
+        }
+
+        // Lost, the scan goes back so lost indices are requested again before new ones
+        component.sentMsecs[inFlight.paramIndex] = -1;
+        component.cursor = qMin(component.cursor, inFlight.paramIndex);
+        component.inFlightCount--;
+        _inFlightCount--;
+        _timeoutCount++;
+
+        // Only losses from requests sent after the last decrease count, a burst of losses halves the window once
+        if (inFlight.sentMsecs >= _lastDecreaseMsecs) {
+            _slowStartThreshold = qMax(_window / 2, 2.0);
+            _window             = qMax(_window / 2, 1.0);
+            _lastDecreaseMsecs  = nowMsecs;
+        }
+
+        _inFlight.dequeue();
+    }
+}
+
+bool ParameterDownloadEngine::_nextRequest(int slot, qint64 nowMsecs, Request_t& request)
+{
+    Component_t& component = _components[slot];
+
+    // Every missing index which is not in flight can be requested, so the scan below always finds one
+    while (component.missingCount - component.inFlightCount > 0) {
+        int paramIndex = component.cursor;
+        component.cursor = (component.cursor + 1) % component.paramCount;
+
+        if (!component.missing.testBit(paramIndex) || component.sentMsecs[paramIndex] != -1) {
+            continue;
+        }
+
+        if (++component.retryCount[paramIndex] > _maxRetries) {
+            // Give up on this index
+            component.missing.clearBit(paramIndex);
+            component.missingCount--;
+            _missingCount--;
+            _failed.append({ component.componentId, paramIndex });
+            continue;
+        }
+
+        component.sentMsecs[paramIndex] = nowMsecs;
+        component.inFlightCount++;
+        _inFlightCount++;
+        _requestCount++;
+        _inFlight.enqueue({ slot, paramIndex, nowMsecs });
+
+        request.componentId = component.componentId;
+        request.paramIndex  = paramIndex;
+        return true;
+    }
+
+    return false;
+}
+
+QList<ParameterDownloadEngine::Request_t> ParameterDownloadEngine::takeRequests(qint64 nowMsecs)
+{
+    QList<Request_t> requests;
+
+    _expireRequests(nowMsecs);
+
+    if (!_requesting && _missingCount) {
+        bool allStreamsEnded = true;
+        for (const Component_t& component: _components) {
+            if (component.missingCount && !component.streamEnded) {
+                allStreamsEnded = false;
+                break;
+            }
+        }
+        if (allStreamsEnded || nowMsecs - _lastArrivalMsecs >= streamIdleMsecs()) {
+            _requesting = true;
+        }
+    }
+    if (!_requesting) {
+        return requests;
+    }
+
+    // Components share the window round robin so they all progress in parallel
+    int freeCount   = static_cast<int>(_window) - _inFlightCount;
+    int idleSlots   = 0;
+    while (freeCount > 0 && idleSlots < _components.count()) {
+        int slot = _nextSlot;
+        _nextSlot = (_nextSlot + 1) % _components.count();
+
+        Request_t request;
+        if (_nextRequest(slot, nowMsecs, request)) {
+            requests.append(request);
+            freeCount--;
+            idleSlots = 0;
+        } else {
+            idleSlots++;
+        }
+    }
+
+    return requests;
+}
+
+QList<ParameterDownloadEngine::Request_t> ParameterDownloadEngine::takeFailed(void)
+{
+    QList<Request_t> failed;
+    failed.swap(_failed);
+    return failed;
+}
+
+qint64 ParameterDownloadEngine::nextDeadlineMsecs(void) const
+{
+    if (_missingCount == 0) {
+        return -1;
+    }
+    if (!_requesting) {
+        return _lastArrivalMsecs + streamIdleMsecs();
+    }
+    if (_inFlight.isEmpty()) {
+        // Requests can go out right away
+        return 0;
+    }
+    return _inFlight.head().sentMsecs + timeoutMsecs();
+}
+
+ParameterDownloadEngine::Stats_t ParameterDownloadEngine::stats(void) const
+{
+    Stats_t stats;
+
+    stats.receivedCount = _receivedCount;
+    stats.elapsedMsecs  = _lastReceivedMsecs - _downloadStartMsecs;
+    stats.requestCount  = _requestCount;
+    stats.timeoutCount  = _timeoutCount;
+    stats.rttMsecs      = _srttMsecs < 0 ? -1 : static_cast<int>(_srttMsecs);
+    stats.window        = static_cast<int>(_window);
+
+    return stats;
+}
+
+double ParameterDownloadEngine::paramsPerSecond(void) const
+{
+    qint64 elapsedMsecs = _lastReceivedMsecs - _downloadStartMsecs;
+    if (_receivedCount == 0 || elapsedMsecs <= 0) {
+        return 0;
+    }
+    return (_receivedCount * 1000.0) / elapsedMsecs;
+}
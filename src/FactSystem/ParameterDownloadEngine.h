@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QVector>
+
+/// Tracks the index based parameters still missing from each component and decides which ones to request next.
+///
+/// The vehicle first streams its parameters in response to PARAM_REQUEST_LIST. Once that stream goes quiet the
+/// missing indices are requested with PARAM_REQUEST_READ, all components sharing a window of requests in flight.
+/// The window is sized like a TCP congestion window: it grows with each response and halves (at most once per
+/// round trip) when a request times out. The timeout follows the measured round trip time, so a fast link is kept
+/// busy and a lossy, slow one is not flooded with retries.
+///
+/// Missing indices are kept in a bitset per component with running counts, so receiving a parameter and asking
+/// for the missing count are constant time. The engine does no I/O and has no timers, the caller passes in the
+/// current time and sends the requests it hands out.
+class ParameterDownloadEngine
+{
+public:
+    ParameterDownloadEngine(void);
+
+    typedef struct {
+        int componentId;
+        int paramIndex;
+    } Request_t;
+
+    typedef struct {
+        int     receivedCount;          ///< Missing parameters received since the download started
+        qint64  elapsedMsecs;           ///< From the download start to the last received parameter
+        int     requestCount;           ///< PARAM_REQUEST_READ sent
+        int     timeoutCount;           ///< Requests which timed out
+        int     rttMsecs;               ///< Smoothed round trip time, -1 if not measured yet
+        int     window;                 ///< Requests allowed in flight
+    } Stats_t;
+
+    /// Adds a component with all of its parameters missing
+    void addComponent(int componentId, int paramCount, qint64 nowMsecs);
+
+    /// Marks all parameters of the component missing again, MAV_COMP_ID_ALL (0) for all components
+    void resetComponent(int componentId, qint64 nowMsecs);
+
+    bool hasComponent   (int componentId) const { return _componentSlots.contains(componentId); }
+    bool isMissing      (int componentId, int paramIndex) const;
+
+    /// @return Missing parameter count for the component
+    int missingCount(int componentId) const;
+
+    /// @return Missing parameter count across all components
+    int missingCount(void) const { return _missingCount; }
+
+    /// Marks the parameter as received
+    /// @return true: parameter was missing
+    bool received(int componentId, int paramIndex, qint64 nowMsecs);
+
+    /// Switches from waiting on the PARAM_REQUEST_LIST stream to requesting missing indices
+    void startRequests(void) { _requesting = true; }
+    bool requesting(void) const { return _requesting; }
+
+    /// Expires timed out requests and hands out the requests to send now, up to the free space in the window.
+    /// Parameters which ran out of retries are given up on, see takeFailed.
+    QList<Request_t> takeRequests(qint64 nowMsecs);
+
+    /// @return Parameters given up on since the last call
+    QList<Request_t> takeFailed(void);
+
+    /// @return Time at which takeRequests should be called next: end of the stream wait or the oldest request
+    ///         timing out, -1 for nothing to do
+    qint64 nextDeadlineMsecs(void) const;
+
+    /// Maximum re-requests of a single parameter, 0 gives up on missing parameters without requesting them
+    void setMaxRetries(int maxRetries) { _maxRetries = maxRetries; }
+
+    int inFlightCount   (void) const { return _inFlightCount; }
+    int timeoutMsecs    (void) const;
+    int streamIdleMsecs (void) const;
+    Stats_t stats       (void) const;
+
+    /// @return Parameters per second received since the download started
+    double paramsPerSecond(void) const;
+
+    static const int initialWindow          = 4;
+    static const int maxWindow              = 64;
+    static const int initialTimeoutMsecs    = 1000;
+    static const int minTimeoutMsecs        = 100;
+    static const int maxTimeoutMsecs        = 3000;
+    static const int maxStreamIdleMsecs     = 3000;
+
+private:
+    typedef struct {
+        int             componentId;
+        int             paramCount;
+        QBitArray       missing;
+        int             missingCount;
+        int             inFlightCount;
+        int             cursor;             ///< Next index to consider for a request
+        bool            streamEnded;        ///< Last index arrived from the PARAM_REQUEST_LIST stream
+        QVector<qint64> sentMsecs;          ///< -1: not in flight
+        QVector<quint8> retryCount;
+    } Component_t;
+
+    typedef struct {
+        int     slot;
+        int     paramIndex;
+        qint64  sentMsecs;
+    } InFlight_t;
+
+    void _resetSlot         (int slot);
+    void _expireRequests    (qint64 nowMsecs);
+    bool _nextRequest       (int slot, qint64 nowMsecs, Request_t& request);
+    void _rttSample         (qint64 rttMsecs);
+    void _startDownload     (qint64 nowMsecs);
+
+    QVector<Component_t>    _components;
+    QHash<int, int>         _componentSlots;        ///< Key: component id, Value: index into _components
+    int                     _missingCount;
+    bool                    _requesting;
+    int                     _maxRetries;
+
+    QQueue<InFlight_t>      _inFlight;              ///< Send order, entries answered meanwhile are skipped when expiring
+    int                     _inFlightCount;
+    int                     _nextSlot;              ///< Round robin between components
+    QList<Request_t>        _failed;
+
+    double                  _window;
+    double                  _slowStartThreshold;
+    qint64                  _lastDecreaseMsecs;     ///< Requests sent before the last decrease don't shrink the window again
+    double                  _srttMsecs;             ///< < 0: no sample yet
+    double                  _rttVarMsecs;
+
+    double                  _arrivalGapMsecs;       ///< Smoothed gap between streamed parameters, < 0: none yet
+    qint64                  _lastArrivalMsecs;
+    qint64                  _lastReceivedMsecs;     ///< Last missing parameter received
+
+    qint64                  _downloadStartMsecs;
+    int                     _receivedCount;
+    int                     _requestCount;
+    int                     _timeoutCount;
+};
@@ -0,0 +1,187 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterDownloadEngineTest.h"
+#include "ParameterDownloadEngine.h"
+
+void ParameterDownloadEngineTest::_missing_test(void)
+{
+    ParameterDownloadEngine engine;
+
+    engine.addComponent(1, 100, 0);
+    engine.addComponent(2, 10, 0);
+    QCOMPARE(engine.missingCount(), 110);
+    QCOMPARE(engine.missingCount(1), 100);
+    QVERIFY(engine.isMissing(1, 99));
+    QVERIFY(!engine.isMissing(1, 100));
+    QVERIFY(!engine.isMissing(3, 0));
+
+    QVERIFY(engine.received(1, 5, 10));
+    QVERIFY(!engine.received(1, 5, 20));        // Duplicate
+    QVERIFY(!engine.received(1, 65535, 30));    // Unrequested ArduPilot stream
+    QVERIFY(!engine.received(3, 0, 40));        // Unknown component
+    QVERIFY(!engine.isMissing(1, 5));
+    QCOMPARE(engine.missingCount(1), 99);
+    QCOMPARE(engine.missingCount(), 109);
+
+    // Adding a known component again does not reset it
+    engine.addComponent(1, 100, 50);
+    QCOMPARE(engine.missingCount(1), 99);
+
+    engine.resetComponent(1, 60);
+    QCOMPARE(engine.missingCount(1), 100);
+    QCOMPARE(engine.missingCount(), 110);
+
+    for (int i=0; i<10; i++) {
+        engine.received(2, i, 70);
+    }
+    QCOMPARE(engine.missingCount(2), 0);
+    engine.resetComponent(0 /* MAV_COMP_ID_ALL */, 80);
+    QCOMPARE(engine.missingCount(), 110);
+}
+
+void ParameterDownloadEngineTest::_streamEnd_test(void)
+{
+    // Nothing is requested while the PARAM_REQUEST_LIST stream is running
+    {
+        ParameterDownloadEngine engine;
+        qint64 now = 0;
+
+        engine.addComponent(1, 50, now);
+        for (int i=0; i<40; i+=2) {
+            now += 10;
+            engine.received(1, i, now);
+            QVERIFY(engine.takeRequests(now).isEmpty());
+        }
+        QVERIFY(!engine.requesting());
+
+        // The stream going quiet for a few arrival gaps starts the requests
+        QVERIFY(engine.nextDeadlineMsecs() > now);
+        QVERIFY(engine.nextDeadlineMsecs() <= now + ParameterDownloadEngine::maxStreamIdleMsecs);
+        now = engine.nextDeadlineMsecs();
+        QList<ParameterDownloadEngine::Request_t> requests = engine.takeRequests(now);
+        QVERIFY(engine.requesting());
+        QCOMPARE(requests.count(), static_cast<int>(ParameterDownloadEngine::initialWindow));
+        QCOMPARE(requests[0].componentId, 1);
+        QCOMPARE(requests[0].paramIndex, 1);
+        QCOMPARE(requests[1].paramIndex, 3);
+    }
+
+    // The last index ends the stream right away
+    {
+        ParameterDownloadEngine engine;
+
+        engine.addComponent(1, 10, 0);
+        engine.received(1, 0, 10);
+        engine.received(1, 9, 20);
+        QCOMPARE(engine.takeRequests(20).count(), static_cast<int>(ParameterDownloadEngine::initialWindow));
+    }
+}
+
+void ParameterDownloadEngineTest::_window_test(void)
+{
+    ParameterDownloadEngine engine;
+    qint64 now = 0;
+
+    engine.addComponent(1, 1000, now);
+    engine.startRequests();
+
+    // Every response opens the window further on a clean link
+    int window = engine.stats().window;
+    for (int round=0; round<4; round++) {
+        QList<ParameterDownloadEngine::Request_t> requests = engine.takeRequests(now);
+        QCOMPARE(requests.count(), window);
+        now += 20;
+        for (const ParameterDownloadEngine::Request_t& request: requests) {
+            QVERIFY(engine.received(request.componentId, request.paramIndex, now));
+        }
+        QVERIFY(engine.stats().window > window);
+        window = engine.stats().window;
+    }
+    QCOMPARE(engine.stats().rttMsecs, 20);
+    QVERIFY(engine.timeoutMsecs() < ParameterDownloadEngine::initialTimeoutMsecs);
+    QCOMPARE(engine.inFlightCount(), 0);
+
+    // Losing a full window of requests halves the window once
+    QList<ParameterDownloadEngine::Request_t> requests = engine.takeRequests(now);
+    QCOMPARE(requests.count(), window);
+    QCOMPARE(engine.inFlightCount(), window);
+    QCOMPARE(engine.nextDeadlineMsecs(), now + engine.timeoutMsecs());
+    now = engine.nextDeadlineMsecs();
+    requests = engine.takeRequests(now);
+    QCOMPARE(engine.stats().timeoutCount, window);
+    QCOMPARE(engine.stats().window, window / 2);
+    QCOMPARE(requests.count(), window / 2);
+
+    // The lost indices are requested again first
+    QCOMPARE(requests[0].paramIndex, 1000 - engine.missingCount());
+}
+
+void ParameterDownloadEngineTest::_parallelComponents_test(void)
+{
+    ParameterDownloadEngine engine;
+    qint64 now = 0;
+
+    engine.addComponent(1, 100, now);
+    engine.addComponent(100, 3, now);
+    engine.startRequests();
+
+    QList<ParameterDownloadEngine::Request_t> requests = engine.takeRequests(now);
+    QCOMPARE(requests.count(), static_cast<int>(ParameterDownloadEngine::initialWindow));
+    QCOMPARE(requests[0].componentId, 1);
+    QCOMPARE(requests[1].componentId, 100);
+    QCOMPARE(requests[2].componentId, 1);
+    QCOMPARE(requests[3].componentId, 100);
+
+    // Once a component has everything in flight the others use the window
+    now += 10;
+    for (const ParameterDownloadEngine::Request_t& request: requests) {
+        engine.received(request.componentId, request.paramIndex, now);
+    }
+    requests = engine.takeRequests(now);
+    QCOMPARE(requests[0].componentId, 1);
+    QCOMPARE(requests[1].componentId, 100);
+    for (int i=2; i<requests.count(); i++) {
+        QCOMPARE(requests[i].componentId, 1);
+    }
+    QCOMPARE(engine.missingCount(100), 1);
+}
+
+void ParameterDownloadEngineTest::_giveUp_test(void)
+{
+    const int maxRetries = 2;
+
+    ParameterDownloadEngine engine;
+    qint64 now = 0;
+
+    engine.setMaxRetries(maxRetries);
+    engine.addComponent(1, 3, now);
+    engine.startRequests();
+
+    // Nothing ever answers
+    int requestCount = 0;
+    while (engine.missingCount()) {
+        requestCount += engine.takeRequests(now).count();
+        QVERIFY(engine.nextDeadlineMsecs() >= now || engine.missingCount() == 0);
+        now = qMax(now + 1, engine.nextDeadlineMsecs());
+        QVERIFY(now < 60 * 1000);
+    }
+    QCOMPARE(requestCount, 3 * maxRetries);
+    QCOMPARE(engine.takeFailed().count(), 3);
+    QCOMPARE(engine.nextDeadlineMsecs(), static_cast<qint64>(-1));
+
+    // No retries at all gives up without requesting
+    ParameterDownloadEngine noRetryEngine;
+    noRetryEngine.setMaxRetries(0);
+    noRetryEngine.addComponent(1, 3, 0);
+    noRetryEngine.startRequests();
+    QVERIFY(noRetryEngine.takeRequests(0).isEmpty());
+    QCOMPARE(noRetryEngine.takeFailed().count(), 3);
+    QCOMPARE(noRetryEngine.missingCount(), 0);
+}
@@ -0,0 +1,28 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for ParameterDownloadEngine
+class ParameterDownloadEngineTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ParameterDownloadEngineTest(void) { }
+
+private slots:
+    void _missing_test          (void);
+    void _streamEnd_test        (void);
+    void _window_test           (void);
+    void _parallelComponents_test(void);
+    void _giveUp_test           (void);
+};
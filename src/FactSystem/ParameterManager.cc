@@ -88,7 +88,6 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     , _prevWaitingWriteParamNameCount   (0)
     , _initialRequestRetryCount         (0)
     , _disableAllRetries                (false)
-    , _indexBatchQueueActive            (false)
     , _totalParamCount                  (0)
 {
     _versionParam = vehicle->firmwarePlugin()->getVersionParam();
@@ -108,6 +107,11 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     _waitingParamTimeoutTimer.setInterval(3000);
     connect(&_waitingParamTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
 
+    _indexDownload.setMaxRetries(_disableAllRetries ? 0 : _maxInitialLoadRetrySingleParam);
+    _indexDownloadClock.start();
+    _indexRequestTimer.setSingleShot(true);
+    connect(&_indexRequestTimer, &QTimer::timeout, this, &ParameterManager::_sendIndexRequests);
+
     connect(_vehicle->uas(), &UASInterface::parameterUpdate, this, &ParameterManager::_parameterUpdate);
 
     // Ensure the cache directory exists
@@ -137,9 +141,7 @@ void ParameterManager::_updateProgressBar(void)
     int waitingReadParamNameCount = 0;
     int waitingWriteParamCount = 0;
 
-    for (int compId: _waitingReadParamIndexMap.keys()) {
-        waitingReadParamIndexCount += _waitingReadParamIndexMap[compId].count();
-    }
+    waitingReadParamIndexCount = _indexDownload.missingCount();
     for(int compId: _waitingReadParamNameMap.keys()) {
         waitingReadParamNameCount += _waitingReadParamNameMap[compId].count();
     }
@@ -156,6 +158,7 @@ void ParameterManager::_updateProgressBar(void)
     } else {
         _readParamIndexProgressActive = true;
         _setLoadProgress((double)(_totalParamCount - waitingReadParamIndexCount) / (double)_totalParamCount);
+        emit downloadStatsChanged();
         return;
     }
 
@@ -215,7 +218,7 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
     _initialRequestTimeoutTimer.stop();
 
 #if 0
-    if (!_initialLoadComplete && !_indexBatchQueueActive) {
+    if (!_initialLoadComplete && !_indexDownload.requesting()) {
         // Handy for testing retry logic
         static int counter = 0;
         if (counter++ & 0x8) {
@@ -270,12 +273,9 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
     }
 
     // If we've never seen this component id before, setup the wait lists.
-    if (!_waitingReadParamIndexMap.contains(componentId)) {
-        // Add all indices to the wait list, parameter index is 0-based
-        for (int waitingIndex=0; waitingIndex<parameterCount; waitingIndex++) {
-            // This will add the new component id, as well as the the new waiting index and set the retry count for that index to 0
-            _waitingReadParamIndexMap[componentId][waitingIndex] = 0;
-        }
+    if (!_indexDownload.hasComponent(componentId)) {
+        // All indices start out missing, parameter index is 0-based
+        _indexDownload.addComponent(componentId, parameterCount, _indexDownloadClock.elapsed());
 
         // The read and write waiting lists for this component are initialized the empty
         _waitingReadParamNameMap[componentId] = QMap<QString, int>();
@@ -284,28 +284,22 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Seeing component for first time - paramcount:" << parameterCount;
     }
 
-    bool componentParamsComplete = false;
-    if (_waitingReadParamIndexMap[componentId].count() == 1) {
-        // We need to know when we get the last param from a component in order to complete setup
-        componentParamsComplete = true;
-    }
-
-    if (!_waitingReadParamIndexMap[componentId].contains(parameterId) &&
+    if (!_indexDownload.isMissing(componentId, parameterId) &&
             !_waitingReadParamNameMap[componentId].contains(parameterName) &&
             !_waitingWriteParamNameMap[componentId].contains(parameterName)) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Unrequested param update" << parameterName;
     }
 
     // Remove this parameter from the waiting lists
-    if (_waitingReadParamIndexMap[componentId].contains(parameterId)) {
-        _waitingReadParamIndexMap[componentId].remove(parameterId);
-        _indexBatchQueue.removeOne(parameterId);
-        _fillIndexBatchQueue(false /* waitingParamTimeout */);
+    bool componentParamsComplete = false;
+    if (_indexDownload.received(componentId, parameterId, _indexDownloadClock.elapsed())) {
+        // We need to know when we get the last param from a component in order to complete setup
+        componentParamsComplete = _indexDownload.missingCount(componentId) == 0;
     }
     _waitingReadParamNameMap[componentId].remove(parameterName);
     _waitingWriteParamNameMap[componentId].remove(parameterName);
-    if (_waitingReadParamIndexMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap:" << _waitingReadParamIndexMap[componentId];
+    if (_indexDownload.missingCount(componentId)) {
+        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "index download missing count:" << _indexDownload.missingCount(componentId);
     }
     if (_waitingReadParamNameMap[componentId].count()) {
         qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamNameMap" << _waitingReadParamNameMap[componentId];
@@ -320,9 +314,7 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
     int waitingReadParamNameCount = 0;
     int waitingWriteParamNameCount = 0;
 
-    for(int waitingComponentId: _waitingReadParamIndexMap.keys()) {
-        waitingReadParamIndexCount += _waitingReadParamIndexMap[waitingComponentId].count();
-    }
+    waitingReadParamIndexCount = _indexDownload.missingCount();
     if (waitingReadParamIndexCount) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingReadParamIndexCount:" << waitingReadParamIndexCount;
     }
@@ -451,6 +443,9 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
     _prevWaitingReadParamNameCount = waitingReadParamNameCount;
     _prevWaitingWriteParamNameCount = waitingWriteParamNameCount;
 
+    // A response opens up the request window, the end of the initial stream starts requests
+    _sendIndexRequests();
+
     _checkInitialLoadComplete();
 
     qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "_parameterUpdate complete";
@@ -504,19 +499,13 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
         _initialRequestTimeoutTimer.start();
     }
 
-    // Reset index wait lists
-    for (int cid: _paramCountMap.keys()) {
-        // Add/Update all indices to the wait list, parameter index is 0-based
-        if(componentId != MAV_COMP_ID_ALL && componentId != cid)
-            continue;
-        for (int waitingIndex = 0; waitingIndex < _paramCountMap[cid]; waitingIndex++) {
-            // This will add a new waiting index if needed and set the retry count for that index to 0
-            _waitingReadParamIndexMap[cid][waitingIndex] = 0;
-        }
-    }
+    // Reset index wait lists, all indices are missing again until the new stream delivers them
+    _indexDownload.resetComponent(componentId, _indexDownloadClock.elapsed());
 
     _dataMutex.unlock();
 
+    _scheduleIndexRequests();
+
     MAVLinkProtocol* mavlink = qgcApp()->toolbox()->mavlinkProtocol();
 
     mavlink_message_t msg;
@@ -683,57 +672,53 @@ int  ParameterManager::getComponentId(const QString& category)
     return (_componentCategoryHash.contains(category)) ? _componentCategoryHash.value(category) : _vehicle->defaultComponentId();
 }
 
-/// Requests missing index based parameters from the vehicle.
-///     @param waitingParamTimeout: true: being called due to timeout, false: being called to re-fill the batch queue
-/// return true: Parameters were requested, false: No more requests needed
-bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
+/// Requests missing index based parameters from the vehicle, as far as the download window allows.
+void ParameterManager::_sendIndexRequests(void)
 {
-    if (!_indexBatchQueueActive) {
-        return false;
+    if (_logReplay) {
+        return;
     }
 
-    const int maxBatchSize = 10;
+    _dataMutex.lock();
+    QList<ParameterDownloadEngine::Request_t> requests  = _indexDownload.takeRequests(_indexDownloadClock.elapsed());
+    QList<ParameterDownloadEngine::Request_t> failed    = _indexDownload.takeFailed();
+    for (const ParameterDownloadEngine::Request_t& request: failed) {
+        _failedReadParamIndexMap[request.componentId] << request.paramIndex;
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(request.componentId) << "Giving up on (paramIndex:" << request.paramIndex << ")";
+    }
+    _dataMutex.unlock();
 
-    if (waitingParamTimeout) {
-        // We timed out, clear the queue and try again
-        qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to timeout";
-        _indexBatchQueue.clear();
-    } else {
-        qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to received parameter";
+    for (const ParameterDownloadEngine::Request_t& request: requests) {
+        _readParameterRaw(request.componentId, "", request.paramIndex);
+        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(request.componentId) << "Read re-request for (paramIndex:" << request.paramIndex << ")";
+    }
+    if (requests.count()) {
+        ParameterDownloadEngine::Stats_t stats = _indexDownload.stats();
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Index re-requests:" << requests.count() <<
+                                        "missing:" << _indexDownload.missingCount() <<
+                                        "inFlight:" << _indexDownload.inFlightCount() <<
+                                        "window:" << stats.window <<
+                                        "rtt:" << stats.rttMsecs <<
+                                        "timeouts:" << stats.timeoutCount;
     }
 
-    for(int componentId: _waitingReadParamIndexMap.keys()) {
-        if (_waitingReadParamIndexMap[componentId].count()) {
-            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap count" << _waitingReadParamIndexMap[componentId].count();
-            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap" << _waitingReadParamIndexMap[componentId];
-        }
+    if (failed.count()) {
+        _updateProgressBar();
+        _checkInitialLoadComplete();
+    }
 
-        for(int paramIndex: _waitingReadParamIndexMap[componentId].keys()) {
-            if (_indexBatchQueue.contains(paramIndex)) {
-                // Don't add more than once
-                continue;
-            }
+    _scheduleIndexRequests();
+}
 
-            if (_indexBatchQueue.count() > maxBatchSize) {
-                break;
-            }
+void ParameterManager::_scheduleIndexRequests(void)
+{
+    qint64 deadlineMsecs = _indexDownload.nextDeadlineMsecs();
 
-            _waitingReadParamIndexMap[componentId][paramIndex]++;   // Bump retry count
-            if (_disableAllRetries || _waitingReadParamIndexMap[componentId][paramIndex] > _maxInitialLoadRetrySingleParam) {
-                // Give up on this index
-                _failedReadParamIndexMap[componentId] << paramIndex;
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
-                _waitingReadParamIndexMap[componentId].remove(paramIndex);
-            } else {
-                // Retry again
-                _indexBatchQueue.append(paramIndex);
-                _readParameterRaw(componentId, "", paramIndex);
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
-            }
-        }
+    if (deadlineMsecs == -1) {
+        _indexRequestTimer.stop();
+    } else {
+        _indexRequestTimer.start(static_cast<int>(qMax(deadlineMsecs - _indexDownloadClock.elapsed(), static_cast<qint64>(0))));
     }
-
-    return _indexBatchQueue.count() != 0;
 }
 
 void ParameterManager::_waitingParamTimeout(void)
@@ -748,11 +733,15 @@ void ParameterManager::_waitingParamTimeout(void)
 
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "_waitingParamTimeout";
 
-    // Now that we have timed out for possibly the first time we can activate the index batch queue
-    _indexBatchQueueActive = true;
-
-    // First check for any missing parameters from the initial index based load
-    paramsRequested = _fillIndexBatchQueue(true /* waitingParamTimeout */);
+    // Missing parameters from the initial index based load come first. They are requested by _sendIndexRequests,
+    // which normally has started well before this, the stream has ended for sure by now.
+    if (_indexDownload.missingCount()) {
+        paramsRequested = true;
+        if (!_indexDownload.requesting()) {
+            _indexDownload.startRequests();
+            _sendIndexRequests();
+        }
+    }
 
     if (!paramsRequested && !_waitingForDefaultComponent && !_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
         // Initial load is complete but we still don't have any default component params. Wait one more cycle to see if the
@@ -1245,11 +1234,9 @@ void ParameterManager::_checkInitialLoadComplete(void)
         return;
     }
 
-    for (int componentId: _waitingReadParamIndexMap.keys()) {
-        if (_waitingReadParamIndexMap[componentId].count()) {
-            // We are still waiting on some parameters, not done yet
-            return;
-        }
+    if (_indexDownload.missingCount()) {
+        // We are still waiting on some parameters, not done yet
+        return;
     }
 
     if (!_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
@@ -1272,7 +1259,15 @@ void ParameterManager::_checkInitialLoadComplete(void)
     }
     _debugCacheCRC.clear();
 
-    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Initial load complete";
+    ParameterDownloadEngine::Stats_t stats = _indexDownload.stats();
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Initial load complete -" <<
+                                    "params:" << stats.receivedCount <<
+                                    "msecs:" << stats.elapsedMsecs <<
+                                    "params/sec:" << _indexDownload.paramsPerSecond() <<
+                                    "re-requests:" << stats.requestCount <<
+                                    "timeouts:" << stats.timeoutCount <<
+                                    "rtt:" << stats.rttMsecs;
+    emit downloadStatsChanged();
 
     // Check for index based load failures
     QString indexList;
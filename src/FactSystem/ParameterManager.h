@@ -16,8 +16,10 @@
 #include <QMutex>
 #include <QDir>
 #include <QJsonObject>
+#include <QElapsedTimer>
 
 #include "FactSystem.h"
+#include "ParameterDownloadEngine.h"
 #include "MAVLinkProtocol.h"
 #include "AutoPilotPlugin.h"
 #include "QGCMAVLink.h"
@@ -40,10 +42,16 @@ public:
     Q_PROPERTY(bool     missingParameters   READ missingParameters  NOTIFY missingParametersChanged)    ///< true: Parameters are missing from firmware response, false: all parameters received from firmware
     Q_PROPERTY(double   loadProgress        READ loadProgress       NOTIFY loadProgressChanged)
     Q_PROPERTY(bool     pendingWrites       READ pendingWrites      NOTIFY pendingWritesChanged)        ///< true: There are still pending write updates against the vehicle
+    Q_PROPERTY(double   downloadRate        READ downloadRate       NOTIFY downloadStatsChanged)        ///< Parameters per second received by the current or last download
+    Q_PROPERTY(int      downloadRttMsecs    READ downloadRttMsecs   NOTIFY downloadStatsChanged)        ///< Measured parameter request round trip time, -1 if not known
+    Q_PROPERTY(int      downloadWindow      READ downloadWindow     NOTIFY downloadStatsChanged)        ///< Parameter requests allowed in flight
 
     bool parametersReady    (void) const { return _parametersReady; }
     bool missingParameters  (void) const { return _missingParameters; }
     double loadProgress     (void) const { return _loadProgress; }
+    double downloadRate     (void) const { return _indexDownload.paramsPerSecond(); }
+    int downloadRttMsecs    (void) const { return _indexDownload.stats().rttMsecs; }
+    int downloadWindow      (void) const { return _indexDownload.stats().window; }
 
     /// @return Directory of parameter caches
     static QDir parameterCacheDir();
@@ -123,6 +131,7 @@ signals:
     void missingParametersChanged   (bool missingParameters);
     void loadProgressChanged        (float value);
     void pendingWritesChanged       (bool pendingWrites);
+    void downloadStatsChanged       (void);
 
 protected:
     Vehicle*            _vehicle;
@@ -133,6 +142,7 @@ protected:
     void _waitingParamTimeout(void);
     void _tryCacheLookup(void);
     void _initialRequestTimeout(void);
+    void _sendIndexRequests(void);
 
 private:
     static QVariant         _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool failOk = false);
@@ -152,7 +162,7 @@ private:
     void    _loadOfflineEditingParams(void);
     QString _logVehiclePrefix(int componentId);
     void    _setLoadProgress(double loadProgress);
-    bool    _fillIndexBatchQueue(bool waitingParamTimeout);
+    void    _scheduleIndexRequests(void);
     void    _updateProgressBar(void);
 
     MAV_PARAM_TYPE _factTypeToMavType(FactMetaData::ValueType_t factType);
@@ -202,11 +212,11 @@ private:
     static const int    _maxReadWriteRetry = 5;                 ///< Maximum retries read/write
     bool                _disableAllRetries;                     ///< true: Don't retry any requests (used for testing)
 
-    bool        _indexBatchQueueActive; ///< true: we are actively batching re-requests for missing index base params, false: index based re-request has not yet started
-    QList<int>  _indexBatchQueue;       ///< The current queue of index re-requests
+    ParameterDownloadEngine _indexDownload;         ///< Index based parameters still missing, re-requests them once the initial stream ends
+    QElapsedTimer           _indexDownloadClock;    ///< Time base for _indexDownload
+    QTimer                  _indexRequestTimer;     ///< Fires at the next _indexDownload deadline
 
     QMap<int, int>                  _paramCountMap;             ///< Key: Component id, Value: count of parameters in this component
-    QMap<int, QMap<int, int> >      _waitingReadParamIndexMap;  ///< Key: Component id, Value: Map { Key: parameter index still waiting for, Value: retry count }
     QMap<int, QMap<QString, int> >  _waitingReadParamNameMap;   ///< Key: Component id, Value: Map { Key: parameter name still waiting for, Value: retry count }
     QMap<int, QMap<QString, int> >  _waitingWriteParamNameMap;  ///< Key: Component id, Value: Map { Key: parameter name still waiting for, Value: retry count }
     QMap<int, QList<int> >          _failedReadParamIndexMap;   ///< Key: Component id, Value: failed parameter index
@@ -451,7 +451,7 @@ bool APMFirmwarePlugin::_handleIncomingStatusText(Vehicle* vehicle, mavlink_mess
     return true;
 }
 
-void APMFirmwarePlugin::_handleIncomingHeartbeat(Vehicle* vehicle, mavlink_message_t* message)
+void APMFirmwarePlugin::_handleIncomingHeartbeat(Vehicle* vehicle, const mavlink_message_t* message)
 {
     bool flying = false;
 
@@ -479,11 +479,11 @@ void APMFirmwarePlugin::_handleIncomingHeartbeat(Vehicle* vehicle, mavlink_messa
     _ardupilotComponentMap[message->sysid][MAV_COMP_ID_UDP_BRIDGE] = false;
 }
 
-bool APMFirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_message_t* message)
+bool APMFirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, MAVLinkMessageHandle& message)
 {
     if (message->msgid == MAVLINK_MSG_ID_HEARTBEAT) {
         // We need to look at all heartbeats that go by from any component
-        _handleIncomingHeartbeat(vehicle, message);
+        _handleIncomingHeartbeat(vehicle, &message.message());
         return true;
     }
 
@@ -491,15 +491,15 @@ bool APMFirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_m
     if (_ardupilotComponentMap[vehicle->id()][message->compid]) {
         switch (message->msgid) {
         case MAVLINK_MSG_ID_PARAM_VALUE:
-            _handleIncomingParamValue(vehicle, message);
+            _handleIncomingParamValue(vehicle, message.detach());
             break;
         case MAVLINK_MSG_ID_STATUSTEXT:
-            return _handleIncomingStatusText(vehicle, message);
+            return _handleIncomingStatusText(vehicle, message.detach());
         case MAVLINK_MSG_ID_RC_CHANNELS:
-            _handleRCChannels(vehicle, message);
+            _handleRCChannels(vehicle, message.detach());
             break;
         case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
-            _handleRCChannelsRaw(vehicle, message);
+            _handleRCChannelsRaw(vehicle, message.detach());
             break;
         }
     }
@@ -233,7 +233,7 @@ const QVariantList& ArduSubFirmwarePlugin::toolBarIndicators(const Vehicle* vehi
     return _toolBarIndicators;
 }
 
-void ArduSubFirmwarePlugin::_handleNamedValueFloat(mavlink_message_t* message)
+void ArduSubFirmwarePlugin::_handleNamedValueFloat(const mavlink_message_t* message)
 {
     mavlink_named_value_float_t value;
     mavlink_msg_named_value_float_decode(message, &value);
@@ -255,7 +255,7 @@ void ArduSubFirmwarePlugin::_handleNamedValueFloat(mavlink_message_t* message)
     }
 }
 
-void ArduSubFirmwarePlugin::_handleMavlinkMessage(mavlink_message_t* message)
+void ArduSubFirmwarePlugin::_handleMavlinkMessage(const mavlink_message_t* message)
 {
     switch (message->msgid) {
     case (MAVLINK_MSG_ID_NAMED_VALUE_FLOAT):
@@ -271,9 +271,9 @@ void ArduSubFirmwarePlugin::_handleMavlinkMessage(mavlink_message_t* message)
     }
 }
 
-bool ArduSubFirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_message_t* message)
+bool ArduSubFirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, MAVLinkMessageHandle& message)
 {
-    _handleMavlinkMessage(message);
+    _handleMavlinkMessage(&message.message());
     return APMFirmwarePlugin::adjustIncomingMavlinkMessage(vehicle, message);
 }
 
@@ -135,7 +135,7 @@ public:
     const FirmwarePlugin::remapParamNameMajorVersionMap_t& paramNameRemapMajorVersionMap(void) const final { return _remapParamName; }
     int remapParamNameHigestMinorVersionNumber(int majorVersionNumber) const final;
     const QVariantList& toolBarIndicators(const Vehicle* vehicle) final;
-    bool  adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_message_t* message) final;
+    bool  adjustIncomingMavlinkMessage(Vehicle* vehicle, MAVLinkMessageHandle& message) final;
     virtual QMap<QString, FactGroup*>* factGroups(void) final;
     void adjustMetaData(MAV_TYPE vehicleType, FactMetaData* metaData) override final;
 
@@ -145,8 +145,8 @@ private:
     static bool _remapParamNameIntialized;
     QMap<QString, QString> _factRenameMap;
     static FirmwarePlugin::remapParamNameMajorVersionMap_t  _remapParamName;
-    void _handleNamedValueFloat(mavlink_message_t* message);
-    void _handleMavlinkMessage(mavlink_message_t* message);
+    void _handleNamedValueFloat(const mavlink_message_t* message);
+    void _handleMavlinkMessage(const mavlink_message_t* message);
 
     QMap<QString, FactGroup*> _nameToFactGroupMap;
     APMSubmarineFactGroup _infoFactGroup;
@@ -148,7 +148,7 @@ bool FirmwarePlugin::supportsJSButton(void)
     return false;
 }
 
-bool FirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_message_t* message)
+bool FirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, MAVLinkMessageHandle& message)
 {
     Q_UNUSED(vehicle);
     Q_UNUSED(message);
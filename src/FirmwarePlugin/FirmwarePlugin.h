@@ -15,6 +15,7 @@
 #define FirmwarePlugin_H
 
 #include "QGCMAVLink.h"
+#include "MAVLinkMessageHandle.h"
 #include "VehicleComponent.h"
 #include "AutoPilotPlugin.h"
 #include "GeoFenceManager.h"
@@ -186,9 +187,10 @@ public:
     /// can adjust any message characteristics. This is handy to adjust or differences in mavlink
     /// spec implementations such that the base code can remain mavlink generic.
     ///     @param vehicle Vehicle message came from
-    ///     @param message[in,out] Mavlink message to adjust if needed.
+    ///     @param message[in,out] Mavlink message to adjust if needed. The message is shared with other subscribers,
+    ///                             call message.detach() to get a private copy before changing it.
     /// @return false: skip message, true: process message
-    virtual bool adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_message_t* message);
+    virtual bool adjustIncomingMavlinkMessage(Vehicle* vehicle, MAVLinkMessageHandle& message);
 
     /// Called before any mavlink message is sent to the Vehicle so plugin can adjust any message characteristics.
     /// This is handy to adjust or differences in mavlink spec implementations such that the base code can remain
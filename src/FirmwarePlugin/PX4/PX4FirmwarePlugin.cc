@@ -508,7 +508,7 @@ bool PX4FirmwarePlugin::isGuidedMode(const Vehicle* vehicle) const
             || vehicle->flightMode() == _landingFlightMode);
 }
 
-bool PX4FirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_message_t* message)
+bool PX4FirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, MAVLinkMessageHandle& message)
 {
     //-- Don't process messages to/from UDP Bridge. It doesn't suffer from these issues
     if (message->compid == MAV_COMP_ID_UDP_BRIDGE) {
@@ -517,14 +517,14 @@ bool PX4FirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_m
 
     switch (message->msgid) {
     case MAVLINK_MSG_ID_AUTOPILOT_VERSION:
-        _handleAutopilotVersion(vehicle, message);
+        _handleAutopilotVersion(vehicle, &message.message());
         break;
     }
 
     return true;
 }
 
-void PX4FirmwarePlugin::_handleAutopilotVersion(Vehicle* vehicle, mavlink_message_t* message)
+void PX4FirmwarePlugin::_handleAutopilotVersion(Vehicle* vehicle, const mavlink_message_t* message)
 {
     Q_UNUSED(vehicle);
 
@@ -229,7 +229,20 @@ FlightMap {
 
         Connections {
             target:                 QGroundControl.multiVehicleManager
-            onActiveVehicleChanged: trajectoryPolyline.path = activeVehicle ? activeVehicle.trajectoryPoints.list() : []
+            onActiveVehicleChanged: {
+                if (activeVehicle) {
+                    activeVehicle.trajectoryPoints.setMapZoomLevel(flightMap.zoomLevel)
+                    trajectoryPolyline.path = activeVehicle.trajectoryPoints.list()
+                } else {
+                    trajectoryPolyline.path = []
+                }
+            }
+        }
+
+        // The trajectory is simplified to match the zoom level, the path is fetched again when the level changes
+        Connections {
+            target:                 flightMap
+            onZoomLevelChanged:     if (activeVehicle) activeVehicle.trajectoryPoints.setMapZoomLevel(flightMap.zoomLevel)
         }
 
         Connections {
@@ -237,6 +250,7 @@ FlightMap {
             onPointAdded:           trajectoryPolyline.addCoordinate(coordinate)
             onUpdateLastPoint:      trajectoryPolyline.replaceCoordinate(trajectoryPolyline.pathLength() - 1, coordinate)
             onPointsCleared:        trajectoryPolyline.path = []
+            onLevelChanged:         trajectoryPolyline.path = activeVehicle.trajectoryPoints.list()
         }
     }
 
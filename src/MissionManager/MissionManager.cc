@@ -217,8 +217,10 @@ void MissionManager::generateResumeMission(int resumeIndex)
 }
 
 /// Called when a new mavlink message for out vehicle is received
-void MissionManager::_mavlinkMessageReceived(const mavlink_message_t& message)
+void MissionManager::_mavlinkMessageReceived(const MAVLinkMessageHandle& messageHandle)
 {
+    const mavlink_message_t& message = messageHandle.message();
+
     switch (message.msgid) {
     case MAVLINK_MSG_ID_MISSION_CURRENT:
         _handleMissionCurrent(message);
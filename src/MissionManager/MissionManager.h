@@ -39,7 +39,7 @@ public:
     void generateResumeMission(int resumeIndex);
 
 private slots:
-    void _mavlinkMessageReceived(const mavlink_message_t& message);
+    void _mavlinkMessageReceived(const MAVLinkMessageHandle& messageHandle);
 
 private:
     void _handleMissionCurrent(const mavlink_message_t& message);
@@ -678,8 +678,10 @@ void PlanManager::_handleMissionAck(const mavlink_message_t& message)
 }
 
 /// Called when a new mavlink message for out vehicle is received
-void PlanManager::_mavlinkMessageReceived(const mavlink_message_t& message)
+void PlanManager::_mavlinkMessageReceived(const MAVLinkMessageHandle& messageHandle)
 {
+    const mavlink_message_t& message = messageHandle.message();
+
     switch (message.msgid) {
     case MAVLINK_MSG_ID_MISSION_COUNT:
         _handleMissionCount(message);
@@ -16,6 +16,7 @@
 
 #include "MissionItem.h"
 #include "QGCMAVLink.h"
+#include "MAVLinkMessageHandle.h"
 #include "QGCLoggingCategory.h"
 #include "LinkInterface.h"
 
@@ -90,7 +91,7 @@ signals:
     void resumeMissionUploadFail    (void);
 
 private slots:
-    void _mavlinkMessageReceived(const mavlink_message_t& message);
+    void _mavlinkMessageReceived(const MAVLinkMessageHandle& messageHandle);
     void _ackTimeout(void);
 
 protected:
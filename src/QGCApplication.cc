@@ -73,6 +73,7 @@
 #include "VideoManager.h"
 #include "VideoReceiver.h"
 #include "LogDownloadController.h"
+#include "MAVLinkHandlerStats.h"
 #if defined(QGC_ENABLE_MAVLINK_INSPECTOR)
 #include "MAVLinkInspectorController.h"
 #endif
@@ -98,6 +99,7 @@
 #include "MavlinkConsoleController.h"
 #include "GeoTagController.h"
 #include "LogReplayLink.h"
+#include "CompressedTlogDevice.h"
 #include "VehicleObjectAvoidance.h"
 #include "TrajectoryPoints.h"
 #include "ValuesWidgetController.h"
@@ -506,6 +508,8 @@ void QGCApplication::_initCommon()
     qmlRegisterUncreatableType<MissionCommandTree>  (kQGroundControl,                       1, 0, "MissionCommandTree",         kRefOnly);
     qmlRegisterUncreatableType<CameraCalc>          (kQGroundControl,                       1, 0, "CameraCalc",                 kRefOnly);
     qmlRegisterUncreatableType<LogReplayLink>       (kQGroundControl,                       1, 0, "LogReplayLink",              kRefOnly);
+    qmlRegisterUncreatableType<MAVLinkHandlerStats> (kQGroundControl,                       1, 0, "MAVLinkHandlerStats",        kRefOnly);
+    qmlRegisterUncreatableType<MAVLinkProtocol>     (kQGroundControl,                       1, 0, "MAVLinkProtocol",            kRefOnly);
     qmlRegisterType<LogReplayLinkController>        (kQGroundControl,                       1, 0, "LogReplayLinkController");
 #if defined(QGC_ENABLE_MAVLINK_INSPECTOR)
     qmlRegisterUncreatableType<MAVLinkChartController> (kQGroundControl,                    1, 0, "MAVLinkChart",               kRefOnly);
@@ -658,13 +662,14 @@ void QGCApplication::saveTelemetryLogOnMainThread(QString tempLogfile)
 
         QString nameFormat("%1%2.%3");
         QString dtFormat("yyyy-MM-dd hh-mm-ss");
+        QString extension = CompressedTlogDevice::isCompressedTlog(tempLogfile) ? AppSettings::telemetryCompressedFileExtension : AppSettings::telemetryFileExtension;
 
         int tryIndex = 1;
         QString saveFileName = nameFormat.arg(
-            QDateTime::currentDateTime().toString(dtFormat)).arg(QStringLiteral("")).arg(toolbox()->settingsManager()->appSettings()->telemetryFileExtension);
+            QDateTime::currentDateTime().toString(dtFormat)).arg(QStringLiteral("")).arg(extension);
         while (saveDir.exists(saveFileName)) {
             saveFileName = nameFormat.arg(
-                QDateTime::currentDateTime().toString(dtFormat)).arg(QStringLiteral(".%1").arg(tryIndex++)).arg(toolbox()->settingsManager()->appSettings()->telemetryFileExtension);
+                QDateTime::currentDateTime().toString(dtFormat)).arg(QStringLiteral(".%1").arg(tryIndex++)).arg(extension);
         }
         QString saveFilePath = saveDir.absoluteFilePath(saveFileName);
 
@@ -28,7 +28,7 @@ Rectangle {
     QGCFileDialog {
         id:                 filePicker
         title:              qsTr("Select Telemetery Log")
-        nameFilters:        [qsTr("Telemetry Logs (*.%1)").arg(QGroundControl.settingsManager.appSettings.telemetryFileExtension), qsTr("All Files (*)")]
+        nameFilters:        [qsTr("Telemetry Logs (*.%1 *.%2)").arg(QGroundControl.settingsManager.appSettings.telemetryFileExtension).arg(QGroundControl.settingsManager.appSettings.telemetryCompressedFileExtension), qsTr("All Files (*)")]
         selectExisting:     true
         folder:             QGroundControl.settingsManager.appSettings.telemetrySavePath
         onAcceptedForLoad: {
@@ -71,6 +71,8 @@ public:
     Q_PROPERTY(MissionCommandTree*  missionCommandTree  READ missionCommandTree     CONSTANT)
     Q_PROPERTY(VideoManager*        videoManager        READ videoManager           CONSTANT)
     Q_PROPERTY(MAVLinkLogManager*   mavlinkLogManager   READ mavlinkLogManager      CONSTANT)
+    Q_PROPERTY(MAVLinkHandlerStats* mavlinkHandlerStats READ mavlinkHandlerStats    CONSTANT)
+    Q_PROPERTY(MAVLinkProtocol*     mavlinkProtocol     READ mavlinkProtocol        CONSTANT)
     Q_PROPERTY(QGCCorePlugin*       corePlugin          READ corePlugin             CONSTANT)
     Q_PROPERTY(SettingsManager*     settingsManager     READ settingsManager        CONSTANT)
     Q_PROPERTY(FactGroup*           gpsRtk              READ gpsRtkFactGroup        CONSTANT)
@@ -180,6 +182,8 @@ public:
     MissionCommandTree*     missionCommandTree  ()  { return _missionCommandTree; }
     VideoManager*           videoManager        ()  { return _videoManager; }
     MAVLinkLogManager*      mavlinkLogManager   ()  { return _mavlinkLogManager; }
+    MAVLinkHandlerStats*    mavlinkHandlerStats ()  { return _toolbox->mavlinkProtocol()->handlerStats(); }
+    MAVLinkProtocol*        mavlinkProtocol     ()  { return _toolbox->mavlinkProtocol(); }
     QGCCorePlugin*          corePlugin          ()  { return _corePlugin; }
     SettingsManager*        settingsManager     ()  { return _settingsManager; }
     FactGroup*              gpsRtkFactGroup     ()  { return _gpsRtkFactGroup; }
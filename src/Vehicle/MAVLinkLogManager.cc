@@ -23,6 +23,8 @@
 
 QGC_LOGGING_CATEGORY(MAVLinkLogManagerLog, "MAVLinkLogManagerLog")
 
+const int MAVLinkLogWriter::blockSize;
+
 static const char* kMAVLinkLogGroup         = "MAVLinkLogGroup";
 static const char* kEmailAddressKey         = "Email";
 static const char* kDescriptionsKey         = "Description";
@@ -39,6 +41,7 @@ static const char* kRateKey                 = "RateKey";
 static const char* kPublicLogKey            = "PublicLog";
 static const char* kFeedback                = "feedback";
 static const char* kVideoURL                = "videoUrl";
+static const int   kLogStatsIntervalMsecs   = 1000;
 
 //-----------------------------------------------------------------------------
 MAVLinkLogFiles::MAVLinkLogFiles(MAVLinkLogManager* manager, const QString& filePath, bool newFile)
@@ -110,13 +113,120 @@ MAVLinkLogFiles::setUploaded(bool uploaded)
     emit uploadedChanged();
 }
 
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+MAVLinkLogWriter::MAVLinkLogWriter()
+    : _open(false)
+    , _closing(false)
+    , _error(false)
+    , _lagBytes(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+MAVLinkLogWriter::~MAVLinkLogWriter()
+{
+    close();
+}
+
+//-----------------------------------------------------------------------------
+bool
+MAVLinkLogWriter::open(const QString& fileName)
+{
+    _file.setFileName(fileName);
+    //-- Unbuffered, blocks are already large
+    if(!_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        return false;
+    }
+    _open = true;
+    _closing = false;
+    _error = false;
+    _lagBytes = 0;
+    _block.reserve(blockSize);
+    start();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogWriter::write(const void* data, int len)
+{
+    const char* ptr = static_cast<const char*>(data);
+    while(len > 0) {
+        const int count = qMin(len, blockSize - _block.size());
+        _block.append(ptr, count);
+        ptr += count;
+        len -= count;
+        if(_block.size() == blockSize) {
+            _queueBlock();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogWriter::_queueBlock()
+{
+    QMutexLocker locker(&_mutex);
+    _lagBytes += static_cast<quint64>(_block.size());
+    _blocks.enqueue(_block);
+    _blockQueued.wakeOne();
+    _block = QByteArray();
+    _block.reserve(blockSize);
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogWriter::close()
+{
+    if(!_open) {
+        return;
+    }
+    if(!_block.isEmpty()) {
+        _queueBlock();
+    }
+    {
+        QMutexLocker locker(&_mutex);
+        _closing = true;
+        _blockQueued.wakeOne();
+    }
+    wait();
+    _file.close();
+    _open = false;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogWriter::run()
+{
+    forever {
+        QByteArray block;
+        {
+            QMutexLocker locker(&_mutex);
+            while(_blocks.isEmpty() && !_closing) {
+                _blockQueued.wait(&_mutex);
+            }
+            if(_blocks.isEmpty()) {
+                return;
+            }
+            block = _blocks.dequeue();
+        }
+        if(!_error && _file.write(block) != block.size()) {
+            qCWarning(MAVLinkLogManagerLog) << "File IO error:" << _file.errorString() << _file.fileName();
+            _error = true;
+        }
+        _lagBytes -= static_cast<quint64>(block.size());
+    }
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 MAVLinkLogProcessor::MAVLinkLogProcessor()
-    : _fd(nullptr)
-    , _written(0)
+    : _written(0)
     , _sequence(-1)
     , _numDrops(0)
+    , _numReordered(0)
+    , _numLate(0)
     , _gotHeader(false)
     , _error(false)
     , _record(nullptr)
@@ -133,9 +243,13 @@ MAVLinkLogProcessor::~MAVLinkLogProcessor()
 void
 MAVLinkLogProcessor::close()
 {
-    if(_fd) {
-        fclose(_fd);
-        _fd = nullptr;
+    if(_writer.isOpen()) {
+        //-- Whatever is still waiting for a missing packet goes out now
+        _releasePending(true /* releaseAll */);
+        _writer.close();
+        if(_record) {
+            _record->setSize(_written);
+        }
     }
 }
 
@@ -143,7 +257,7 @@ MAVLinkLogProcessor::close()
 bool
 MAVLinkLogProcessor::valid()
 {
-    return (_fd != nullptr) && (_record != nullptr);
+    return _writer.isOpen() && (_record != nullptr);
 }
 
 //-----------------------------------------------------------------------------
@@ -155,8 +269,7 @@ MAVLinkLogProcessor::create(MAVLinkLogManager* manager, const QString path, uint
                       id,
                       QDateTime::currentDateTime().toString("yyyy-MM-dd-hh-mm-ss-zzz").toLocal8Bit().data(),
                       manager->logExtension().toLocal8Bit().data());
-    _fd = fopen(_fileName.toLocal8Bit().data(), "wb");
-    if(_fd) {
+    if(_writer.open(_fileName)) {
         _record = new MAVLinkLogFiles(manager, _fileName, true);
         _record->setWriting(true);
         _sequence = -1;
@@ -165,6 +278,18 @@ MAVLinkLogProcessor::create(MAVLinkLogManager* manager, const QString path, uint
     return false;
 }
 
+//-----------------------------------------------------------------------------
+MAVLinkLogProcessor::Stats_t
+MAVLinkLogProcessor::stats() const
+{
+    Stats_t stats;
+    stats.droppedSequences      = _numDrops;
+    stats.reorderedSequences    = _numReordered;
+    stats.lateSequences         = _numLate;
+    stats.writerLagBytes        = _writer.lagBytes();
+    return stats;
+}
+
 //-----------------------------------------------------------------------------
 bool
 MAVLinkLogProcessor::_checkSequence(uint16_t seq, int& num_drops)
@@ -201,15 +326,13 @@ MAVLinkLogProcessor::_checkSequence(uint16_t seq, int& num_drops)
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkLogProcessor::_writeData(void* data, int len)
+MAVLinkLogProcessor::_writeData(const void* data, int len)
 {
     if(!_error) {
-        _error = fwrite(data, 1, len, _fd) != (size_t)len;
+        _error = _writer.error();
         if(!_error) {
+            _writer.write(data, len);
             _written += len;
-            if(_record) {
-                _record->setSize(_written);
-            }
         } else {
             qCDebug(MAVLinkLogManagerLog) << "File IO error:" << len << "bytes into" << _fileName;
         }
@@ -237,14 +360,77 @@ MAVLinkLogProcessor::_writeUlogMessage(QByteArray& data)
 bool
 MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message, QByteArray data)
 {
-    int num_drops = 0;
     _error = false;
+    if(_sequence != -1) {
+        const uint16_t ahead = sequence - static_cast<uint16_t>(_sequence + 1);
+        if(ahead >= (1 << 15) || _pending.contains(sequence)) {
+            //-- Behind what was already written: a duplicate or a packet already counted as dropped
+            _numLate++;
+            return !_error;
+        }
+        if(ahead > 0) {
+            //-- Hold on to it for a while in case the missing packets show up
+            _pending.insert(sequence, { first_message, data });
+            if(_pending.count() > reorderDepth) {
+                _releasePending(false /* releaseAll */);
+            }
+            return !_error;
+        }
+        if(!_pending.isEmpty()) {
+            //-- The missing packet showed up
+            _numReordered++;
+        }
+    }
+    if(_processPacket(sequence, first_message, data)) {
+        _releasePending(false /* releaseAll */);
+    }
+    if(_record) {
+        _record->setSize(_written);
+    }
+    return !_error;
+}
+
+//-----------------------------------------------------------------------------
+/// Processes held back packets which are now in sequence. If too many are held back (or releaseAll is set) the
+/// oldest ones are processed regardless, the packets they were waiting for are counted as dropped.
+///     @return false: processing failed
+bool
+MAVLinkLogProcessor::_releasePending(bool releaseAll)
+{
+    while(!_pending.isEmpty()) {
+        uint16_t next = static_cast<uint16_t>(_sequence + 1);
+        if(!_pending.contains(next)) {
+            if(!releaseAll && _pending.count() <= reorderDepth) {
+                break;
+            }
+            //-- Give up on the gap, continue from the oldest packet held back
+            uint16_t oldestAhead = 0xFFFF;
+            for(auto iter = _pending.constBegin(); iter != _pending.constEnd(); iter++) {
+                oldestAhead = qMin(oldestAhead, static_cast<uint16_t>(iter.key() - next));
+            }
+            next = static_cast<uint16_t>(next + oldestAhead);
+        }
+        const Packet_t packet = _pending.take(next);
+        if(!_processPacket(next, packet.firstMessage, packet.data)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/// Writes a packet which is newer than the last one written
+bool
+MAVLinkLogProcessor::_processPacket(uint16_t sequence, uint8_t first_message, QByteArray data)
+{
+    int num_drops = 0;
     while(_checkSequence(sequence, num_drops)) {
         //-- The first 16 bytes need special treatment (this sounds awfully brittle)
         if(!_gotHeader) {
             if(data.size() < 16) {
                 //-- Shouldn't happen but if it does, we might as well close shop.
                 qCWarning(MAVLinkLogManagerLog) << "Corrupt log header. Canceling log download.";
+                _error = true;
                 return false;
             }
             //-- Write header
@@ -310,6 +496,7 @@ MAVLinkLogManager::MAVLinkLogManager(QGCApplication* app, QGCToolbox* toolbox)
     , _windSpeed(-1)
     , _publicLog(false)
     , _logginDenied(false)
+    , _logStats()
 {
     //-- Get saved settings
     QSettings settings;
@@ -637,6 +824,7 @@ MAVLinkLogManager::stopLogging()
     }
     if(_logProcessor) {
         _logProcessor->close();
+        _updateLogStats(true /* force */);
         if(_logProcessor->record()) {
             _logProcessor->record()->setWriting(false);
             if(_enableAutoUpload) {
@@ -873,6 +1061,8 @@ MAVLinkLogManager::_mavlinkLogData(Vehicle* /*vehicle*/, uint8_t /*target_system
             _logRunning = false;
             _vehicle->stopMavlinkLog();
             emit logRunningChanged();
+        } else {
+            _updateLogStats(false /* force */);
         }
     } else {
         qCWarning(MAVLinkLogManagerLog) << "MAVLink log data received when not expected.";
@@ -932,6 +1122,7 @@ MAVLinkLogManager::_createNewLog()
     _logProcessor = new MAVLinkLogProcessor;
     if(_logProcessor->create(this, _logPath, static_cast<uint8_t>(_vehicle->id()))) {
         _insertNewLog(_logProcessor->record());
+        _updateLogStats(true /* force */);
         emit logFilesChanged();
     } else {
         qCWarning(MAVLinkLogManagerLog) << "Could not create MAVLink log file:" << _logProcessor->fileName();
@@ -968,3 +1159,15 @@ MAVLinkLogManager::_makeFilename(const QString& baseName)
     filePath += _ulogExtension;
     return filePath;
 }
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::_updateLogStats(bool force)
+{
+    //-- Throttled, this is called for every log packet
+    if(_logProcessor && (force || !_logStatsTimer.isValid() || _logStatsTimer.elapsed() >= kLogStatsIntervalMsecs)) {
+        _logStats = _logProcessor->stats();
+        _logStatsTimer.start();
+        emit logStatsChanged();
+    }
+}
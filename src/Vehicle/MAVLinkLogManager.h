@@ -12,6 +12,15 @@
 #define MAVLinkLogManager_H
 
 #include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QHash>
+#include <QFile>
+#include <QElapsedTimer>
+
+#include <atomic>
 
 #include "QmlObjectListModel.h"
 #include "QGCLoggingCategory.h"
@@ -72,6 +81,46 @@ private:
     bool                _uploaded;
 };
 
+//-----------------------------------------------------------------------------
+/// Writes a streamed log to file from its own thread. Data is collected into blockSize blocks which are written
+/// whole, so the file is written in large aligned writes and only the last write at close is partial.
+class MAVLinkLogWriter : public QThread
+{
+    Q_OBJECT
+public:
+    MAVLinkLogWriter();
+    ~MAVLinkLogWriter();
+
+    bool                open        (const QString& fileName);
+    bool                isOpen      () const { return _open; }
+    /// Copies the data into the current block, full blocks are queued for the writer thread
+    void                write       (const void* data, int len);
+    /// Writes everything which is queued, stops the writer thread and closes the file
+    void                close       ();
+    bool                error       () const { return _error; }
+    /// Bytes queued to the writer thread which are not in the file yet. The block still being filled is not included.
+    quint64             lagBytes    () const { return _lagBytes; }
+
+    static const int    blockSize = 64 * 1024;
+
+protected:
+    // Overrides from QThread
+    void                run         () override;
+
+private:
+    void                _queueBlock ();
+
+    QFile                   _file;
+    bool                    _open;
+    QByteArray              _block;         ///< Block being filled, only used from the caller's thread
+    QMutex                  _mutex;
+    QWaitCondition          _blockQueued;
+    QQueue<QByteArray>      _blocks;        ///< Full blocks waiting to be written, protected by _mutex
+    bool                    _closing;       ///< Protected by _mutex
+    std::atomic<bool>       _error;
+    std::atomic<quint64>    _lagBytes;
+};
+
 //-----------------------------------------------------------------------------
 class MAVLinkLogProcessor
 {
@@ -84,18 +133,42 @@ public:
     MAVLinkLogFiles*    record      () { return _record; }
     QString             fileName    () { return _fileName; }
     bool                processStreamData(uint16_t _sequence, uint8_t first_message, QByteArray data);
+
+    typedef struct {
+        int     droppedSequences;       ///< Never received, replaced by a dropout message
+        int     reorderedSequences;     ///< Received out of order but in time to be put back in sequence
+        int     lateSequences;          ///< Received after they were counted as dropped, or duplicates
+        quint64 writerLagBytes;         ///< Queued to the writer thread but not written to the file yet
+    } Stats_t;
+
+    Stats_t             stats       () const;
+
+    /// Number of packets received ahead of a missing one which are held back waiting for it. Once more are held
+    /// the missing packet is counted as dropped.
+    static const int    reorderDepth = 16;
+
 private:
+    typedef struct {
+        uint8_t     firstMessage;
+        QByteArray  data;
+    } Packet_t;
+
     bool                _checkSequence(uint16_t seq, int &num_drops);
     QByteArray          _writeUlogMessage(QByteArray &data);
-    void                _writeData(void* data, int len);
+    void                _writeData(const void* data, int len);
+    bool                _processPacket(uint16_t sequence, uint8_t first_message, QByteArray data);
+    bool                _releasePending(bool releaseAll);
 private:
-    FILE*               _fd;
+    MAVLinkLogWriter    _writer;
     quint32             _written;
     int                 _sequence;
     int                 _numDrops;
+    int                 _numReordered;
+    int                 _numLate;
     bool                _gotHeader;
     bool                _error;
     QByteArray          _ulogMessage;
+    QHash<uint16_t, Packet_t> _pending;     ///< Packets received ahead of a missing one, by sequence
     QString             _fileName;
     MAVLinkLogFiles*    _record;
 };
@@ -124,6 +197,10 @@ public:
     Q_PROPERTY(QmlObjectListModel*  logFiles            READ    logFiles                                        NOTIFY logFilesChanged)
     Q_PROPERTY(int                  windSpeed           READ    windSpeed           WRITE setWindSpeed          NOTIFY windSpeedChanged)
     Q_PROPERTY(QString              rating              READ    rating              WRITE setRating             NOTIFY ratingChanged)
+    Q_PROPERTY(int                  droppedSequences    READ    droppedSequences                                NOTIFY logStatsChanged)
+    Q_PROPERTY(int                  reorderedSequences  READ    reorderedSequences                              NOTIFY logStatsChanged)
+    Q_PROPERTY(int                  lateSequences       READ    lateSequences                                   NOTIFY logStatsChanged)
+    Q_PROPERTY(quint32              writerLagBytes      READ    writerLagBytes                                  NOTIFY logStatsChanged)
 
     Q_INVOKABLE void uploadLog      ();
     Q_INVOKABLE void deleteLog      ();
@@ -146,6 +223,10 @@ public:
     int         windSpeed           () { return _windSpeed; }
     QString     rating              () { return _rating; }
     QString     logExtension        () { return _ulogExtension; }
+    int         droppedSequences    () { return _logStats.droppedSequences; }
+    int         reorderedSequences  () { return _logStats.reorderedSequences; }
+    int         lateSequences       () { return _logStats.lateSequences; }
+    quint32     writerLagBytes      () { return static_cast<quint32>(_logStats.writerLagBytes); }
 
     QmlObjectListModel* logFiles    () { return &_logFiles; }
 
@@ -185,6 +266,7 @@ signals:
     void ratingChanged              ();
     void videoURLChanged            ();
     void publicLogChanged           ();
+    void logStatsChanged            ();
 
 private slots:
     void _uploadFinished            ();
@@ -204,6 +286,7 @@ private:
     void _deleteLog                 (MAVLinkLogFiles* log);
     void _discardLog                ();
     QString _makeFilename           (const QString& baseName);
+    void _updateLogStats            (bool force);
 
 private:
     QString                 _description;
@@ -227,6 +310,8 @@ private:
     bool                    _publicLog;
     QString                 _ulogExtension;
     bool                    _logginDenied;
+    MAVLinkLogProcessor::Stats_t _logStats;
+    QElapsedTimer           _logStatsTimer;
 
 };
 
@@ -63,6 +63,8 @@ void MultiVehicleManager::setToolbox(QGCToolbox *toolbox)
     qmlRegisterUncreatableType<MultiVehicleManager>("QGroundControl.MultiVehicleManager", 1, 0, "MultiVehicleManager", "Reference only");
 
     connect(_mavlinkProtocol, &MAVLinkProtocol::vehicleHeartbeatInfo, this, &MultiVehicleManager::_vehicleHeartbeatInfo);
+    connect(_mavlinkProtocol, &MAVLinkProtocol::sharedMessageReceived,this, &MultiVehicleManager::_mavlinkMessageReceived);
+    connect(_mavlinkProtocol, &MAVLinkProtocol::mavlinkMessageStatus, this, &MultiVehicleManager::_mavlinkMessageStatus);
 
     SettingsManager* settingsManager = toolbox->settingsManager();
     _offlineEditingVehicle = new Vehicle(static_cast<MAV_AUTOPILOT>(settingsManager->appSettings()->offlineEditingFirmwareType()->rawValue().toInt()),
@@ -131,6 +133,7 @@ void MultiVehicleManager::_vehicleHeartbeatInfo(LinkInterface* link, int vehicle
     connect(vehicle->parameterManager(), &ParameterManager::parametersReadyChanged, this, &MultiVehicleManager::_vehicleParametersReadyChanged);
 
     _vehicles.append(vehicle);
+    _vehicleRouteMap[vehicleId] = vehicle;
 
     // Send QGC heartbeat ASAP, this allows PX4 to start accepting commands
     _sendGCSHeartbeat();
@@ -199,6 +202,7 @@ void MultiVehicleManager::_deleteVehiclePhase1(Vehicle* vehicle)
     if (!found) {
         qWarning() << "Vehicle not found in map!";
     }
+    _vehicleRouteMap.remove(vehicle->id());
 
     vehicle->setActive(false);
     vehicle->uas()->shutdownVehicle();
@@ -392,11 +396,46 @@ void MultiVehicleManager::_sendGCSHeartbeat(void)
             uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
             int len = mavlink_msg_to_send_buffer(buffer, &message);
 
-            link->writeBytesSafe((const char*)buffer, len);
+            link->writeMessageSafe(message, (const char*)buffer, len);
         }
     }
 }
 
+/// Routes an incoming message to the Vehicle which owns the system id, instead of every Vehicle looking at
+/// every message. Subscribers which need all traffic (e.g. MAVLinkInspectorController) connect to
+/// MAVLinkProtocol::sharedMessageReceived themselves and share the same MAVLinkMessageHandle. Vehicle scoped subscribers (PlanManager, QGCCameraManager, ...)
+/// use Vehicle::mavlinkMessageReceived which now only fires for that vehicle's traffic.
+void MultiVehicleManager::_mavlinkMessageReceived(LinkInterface* link, MAVLinkMessageHandle message)
+{
+    if (message->sysid != 0) {
+        Vehicle* vehicle = _vehicleRouteMap.value(message->sysid, nullptr);
+        if (vehicle) {
+            vehicle->_mavlinkMessageReceived(link, message);
+            return;
+        }
+        // RADIO_STATUS comes from the radio's own system id. It goes to all vehicles using the link the radio is on.
+        if (message->msgid != MAVLINK_MSG_ID_RADIO_STATUS) {
+            return;
+        }
+    }
+
+    // Broadcast case. Take a copy of the list since a message handler can cause a vehicle to go away.
+    const QList<Vehicle*> vehicles = _vehicleRouteMap.values();
+    for (Vehicle* vehicle: vehicles) {
+        if (message->sysid == 0 || vehicle->containsLink(link)) {
+            vehicle->_mavlinkMessageReceived(link, message);
+        }
+    }
+}
+
+void MultiVehicleManager::_mavlinkMessageStatus(int uasId, uint64_t totalSent, uint64_t totalReceived, uint64_t totalLoss, float lossPercent)
+{
+    Vehicle* vehicle = _vehicleRouteMap.value(uasId, nullptr);
+    if (vehicle) {
+        vehicle->_mavlinkMessageStatus(uasId, totalSent, totalReceived, totalLoss, lossPercent);
+    }
+}
+
 bool MultiVehicleManager::linkInUse(LinkInterface* link, Vehicle* skipVehicle)
 {
     for (int i=0; i< _vehicles.count(); i++) {
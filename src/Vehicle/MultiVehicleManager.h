@@ -105,6 +105,8 @@ private slots:
     void _vehicleHeartbeatInfo          (LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
     void _requestProtocolVersion        (unsigned version);
     void _coordinateChanged             (QGeoCoordinate coordinate);
+    void _mavlinkMessageReceived        (LinkInterface* link, MAVLinkMessageHandle message);
+    void _mavlinkMessageStatus          (int uasId, uint64_t totalSent, uint64_t totalReceived, uint64_t totalLoss, float lossPercent);
 
 private:
     bool _vehicleExists(int vehicleId);
@@ -120,6 +122,7 @@ private:
     QList<int>  _ignoreVehicleIds;          ///< List of vehicle id for which we ignore further communication
 
     QmlObjectListModel  _vehicles;
+    QHash<int, Vehicle*> _vehicleRouteMap;         ///< Vehicles keyed by system id, used to route incoming messages
 
     FirmwarePluginManager*      _firmwarePluginManager;
     JoystickManager*            _joystickManager;
@@ -0,0 +1,351 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryHistory.h"
+#include "FactGroup.h"
+#include "QGC.h"
+#include "QGCLoggingCategory.h"
+
+#include <limits>
+
+QGC_LOGGING_CATEGORY(TelemetryHistoryLog, "TelemetryHistoryLog")
+
+const int TelemetryHistory::rawCapacity;
+const int TelemetryHistory::tierCount;
+
+// 1 hour at 1 second, 6 hours at 10 seconds, 24 hours at 1 minute
+const int TelemetryHistory::tierBucketMsecs[TelemetryHistory::tierCount]   = { 1000, 10 * 1000, 60 * 1000 };
+const int TelemetryHistory::tierCapacity[TelemetryHistory::tierCount]      = { 3600, 6 * 360,   24 * 60 };
+
+TelemetryHistory::TelemetryHistory(QObject* parent)
+    : QObject       (parent)
+    , _timeBaseMsecs(static_cast<qint64>(QGC::bootTimeMilliseconds()))
+{
+    _clock.start();
+}
+
+int TelemetryHistory::series(const QString& name)
+{
+    int seriesId = _seriesIds.value(name, -1);
+
+    if (seriesId == -1) {
+        Series_t newSeries;
+
+        newSeries.raw.capacity = rawCapacity;
+        newSeries.raw.head = 0;
+        newSeries.firstTime = 0;
+        for (int i=0; i<tierCount; i++) {
+            Tier_t& tier = newSeries.tiers[i];
+            tier.ring.capacity  = tierCapacity[i];
+            tier.ring.head      = 0;
+            tier.openStart      = 0;
+            tier.openMin        = 0;
+            tier.openMax        = 0;
+            tier.openValid      = false;
+        }
+
+        seriesId = _series.count();
+        _series.append(newSeries);
+        _seriesIds[name] = seriesId;
+        qCDebug(TelemetryHistoryLog) << "New series" << name << seriesId;
+    }
+
+    return seriesId;
+}
+
+void TelemetryHistory::append(int seriesId, qint64 timeMsecs, double value)
+{
+    if (seriesId < 0 || seriesId >= _series.count()) {
+        return;
+    }
+
+    Series_t& series = _series[seriesId];
+
+    qint32 time = static_cast<qint32>(qBound(static_cast<qint64>(std::numeric_limits<qint32>::min()), timeMsecs - _timeBaseMsecs, static_cast<qint64>(std::numeric_limits<qint32>::max())));
+
+    // Binary searches rely on each level being in time order
+    int rawCount = series.raw.times.count();
+    if (rawCount) {
+        time = qMax(time, series.raw.times[_ringIndex(series.raw, rawCount - 1)]);
+    } else {
+        series.firstTime = time;
+    }
+
+    _ringPush(series.raw, time, value, value, false /* withMax */);
+
+    if (qIsNaN(value)) {
+        return;
+    }
+
+    for (int i=0; i<tierCount; i++) {
+        Tier_t& tier = series.tiers[i];
+
+        qint32 offset = time % tierBucketMsecs[i];
+        if (offset < 0) {
+            offset += tierBucketMsecs[i];
+        }
+        qint32 bucketStart = time - offset;
+
+        if (tier.openValid && bucketStart != tier.openStart) {
+            _ringPush(tier.ring, tier.openStart, tier.openMin, tier.openMax, true /* withMax */);
+            tier.openValid = false;
+        }
+        if (tier.openValid) {
+            tier.openMin = qMin(tier.openMin, value);
+            tier.openMax = qMax(tier.openMax, value);
+        } else {
+            tier.openStart  = bucketStart;
+            tier.openMin    = value;
+            tier.openMax    = value;
+            tier.openValid  = true;
+        }
+    }
+}
+
+void TelemetryHistory::addFactGroup(FactGroup* factGroup, const QString& prefix)
+{
+    for (const QString& factName: factGroup->factNames()) {
+        Fact* fact = factGroup->getFact(factName);
+        if (!fact || fact->type() == FactMetaData::valueTypeString || fact->type() == FactMetaData::valueTypeCustom) {
+            continue;
+        }
+        int seriesId = series(prefix + factName);
+        connect(fact, &Fact::rawValueChanged, this, [this, seriesId](QVariant value) { append(seriesId, value.toDouble()); });
+    }
+
+    for (const QString& factGroupName: factGroup->factGroupNames()) {
+        FactGroup* childGroup = factGroup->getFactGroup(factGroupName);
+        if (childGroup) {
+            addFactGroup(childGroup, prefix + factGroupName + QStringLiteral("."));
+        }
+    }
+}
+
+void TelemetryHistory::query(int seriesId, qint64 startMsecs, qint64 endMsecs, int pixelBudget, QVector<QPointF>& points) const
+{
+    points.clear();
+
+    if (seriesId < 0 || seriesId >= _series.count() || pixelBudget <= 0 || endMsecs < startMsecs) {
+        return;
+    }
+
+    const Series_t& series = _series[seriesId];
+
+    qint64 int32Min = std::numeric_limits<qint32>::min();
+    qint64 int32Max = std::numeric_limits<qint32>::max();
+    qint32 start    = static_cast<qint32>(qBound(int32Min, startMsecs - _timeBaseMsecs, int32Max));
+    qint32 end      = static_cast<qint32>(qBound(int32Min, endMsecs - _timeBaseMsecs, int32Max));
+
+    // Level 0 is raw, level n is tier n-1. Raw samples are reduced per pixel column like the tiers, so they are used
+    // whenever they hold data back to the start of the range. Otherwise pick the finest tier which fits the budget and
+    // does. A level which does not reach back far enough is skipped if the next coarser one does. Levels are compared
+    // by the oldest sample they hold, the first bucket of a tier starts on a bucket boundary before the first sample.
+    int     levelFirst[tierCount + 1];
+    int     levelLast[tierCount + 1];          // exclusive
+    qint64  levelOldest[tierCount + 1];
+    int     levelCount[tierCount + 1];
+
+    for (int level=0; level<=tierCount; level++) {
+        const Ring_t&   ring        = level == 0 ? series.raw : series.tiers[level - 1].ring;
+        int             ringCount   = ring.times.count();
+
+        levelFirst[level]   = _ringLowerBound(ring, start);
+        levelLast[level]    = end == std::numeric_limits<qint32>::max() ? ringCount : _ringLowerBound(ring, end + 1);
+        levelCount[level]   = levelLast[level] - levelFirst[level];
+        levelOldest[level]  = ringCount ? ring.times[_ringIndex(ring, 0)] : int32Max;
+        if (level > 0) {
+            const Tier_t& tier = series.tiers[level - 1];
+            if (tier.openValid) {
+                if (tier.openStart >= start && tier.openStart <= end) {
+                    levelCount[level]++;
+                }
+                levelOldest[level] = qMin(levelOldest[level], static_cast<qint64>(tier.openStart));
+            }
+        }
+        levelOldest[level] = qMax(levelOldest[level], static_cast<qint64>(series.firstTime));
+    }
+
+    int level = tierCount;
+    for (int candidate=0; candidate<tierCount; candidate++) {
+        bool withinBudget   = candidate == 0 || levelCount[candidate] <= pixelBudget;
+        bool reachesStart   = levelOldest[candidate] <= start || levelOldest[candidate + 1] >= levelOldest[candidate];
+        if (withinBudget && reachesStart) {
+            level = candidate;
+            break;
+        }
+    }
+
+    if (level == 0 && levelCount[0] <= 2 * pixelBudget) {
+        const Ring_t& ring = series.raw;
+        points.reserve(levelCount[0]);
+        for (int i=levelFirst[0]; i<levelLast[0]; i++) {
+            int index = _ringIndex(ring, i);
+            if (!qIsNaN(ring.mins[index])) {
+                points.append(QPointF(static_cast<qreal>(_timeBaseMsecs + ring.times[index]), ring.mins[index]));
+            }
+        }
+        return;
+    }
+
+    // Merge the samples or buckets into pixel columns, each column is drawn as its min and max
+    const Ring_t&   ring        = level == 0 ? series.raw : series.tiers[level - 1].ring;
+    double          columnMsecs = qMax(1.0, (static_cast<double>(end) - start) / pixelBudget);
+    int             column      = -1;
+    qint32          columnTime  = 0;
+    double          columnMin   = 0;
+    double          columnMax   = 0;
+
+    points.reserve(2 * qMin(pixelBudget, levelCount[level]));
+
+    auto flushColumn = [&]() {
+        if (column != -1) {
+            qreal x = static_cast<qreal>(_timeBaseMsecs + columnTime);
+            points.append(QPointF(x, columnMin));
+            if (columnMax != columnMin) {
+                points.append(QPointF(x, columnMax));
+            }
+        }
+    };
+    auto addBucket = [&](qint32 time, double minValue, double maxValue) {
+        int bucketColumn = static_cast<int>((static_cast<double>(time) - start) / columnMsecs);
+        if (bucketColumn != column) {
+            flushColumn();
+            column      = bucketColumn;
+            columnTime  = time;
+            columnMin   = minValue;
+            columnMax   = maxValue;
+        } else {
+            columnMin   = qMin(columnMin, minValue);
+            columnMax   = qMax(columnMax, maxValue);
+        }
+    };
+
+    if (level == 0) {
+        for (int i=levelFirst[0]; i<levelLast[0]; i++) {
+            int index = _ringIndex(ring, i);
+            if (!qIsNaN(ring.mins[index])) {
+                addBucket(ring.times[index], ring.mins[index], ring.mins[index]);
+            }
+        }
+    } else {
+        const Tier_t& tier = series.tiers[level - 1];
+        for (int i=levelFirst[level]; i<levelLast[level]; i++) {
+            int index = _ringIndex(ring, i);
+            addBucket(ring.times[index], ring.mins[index], ring.maxs[index]);
+        }
+        if (tier.openValid && tier.openStart >= start && tier.openStart <= end) {
+            addBucket(tier.openStart, tier.openMin, tier.openMax);
+        }
+    }
+    flushColumn();
+}
+
+int TelemetryHistory::rawSampleCount(int seriesId) const
+{
+    if (seriesId < 0 || seriesId >= _series.count()) {
+        return 0;
+    }
+    return _series[seriesId].raw.times.count();
+}
+
+qint64 TelemetryHistory::oldestTimeMsecs(int seriesId) const
+{
+    if (seriesId < 0 || seriesId >= _series.count()) {
+        return -1;
+    }
+
+    const Series_t& series = _series[seriesId];
+
+    bool    found   = false;
+    qint32  oldest  = std::numeric_limits<qint32>::max();
+
+    if (series.raw.times.count()) {
+        oldest = series.raw.times[_ringIndex(series.raw, 0)];
+        found = true;
+    }
+    for (int i=0; i<tierCount; i++) {
+        const Tier_t& tier = series.tiers[i];
+        if (tier.ring.times.count()) {
+            oldest = qMin(oldest, tier.ring.times[_ringIndex(tier.ring, 0)]);
+            found = true;
+        } else if (tier.openValid) {
+            oldest = qMin(oldest, tier.openStart);
+            found = true;
+        }
+    }
+
+    return found ? _timeBaseMsecs + oldest : -1;
+}
+
+qint64 TelemetryHistory::memoryBytes(void) const
+{
+    qint64 bytes = 0;
+
+    for (const Series_t& series: _series) {
+        bytes += sizeof(Series_t) + _ringBytes(series.raw);
+        for (int i=0; i<tierCount; i++) {
+            bytes += _ringBytes(series.tiers[i].ring);
+        }
+    }
+
+    return bytes;
+}
+
+void TelemetryHistory::_ringPush(Ring_t& ring, qint32 time, double minValue, double maxValue, bool withMax)
+{
+    int count = ring.times.count();
+
+    if (count < ring.capacity) {
+        if (count == ring.times.capacity()) {
+            // Grow towards the fixed capacity but never beyond it
+            int newCapacity = qMin(ring.capacity, qMax(64, 2 * count));
+            ring.times.reserve(newCapacity);
+            ring.mins.reserve(newCapacity);
+            if (withMax) {
+                ring.maxs.reserve(newCapacity);
+            }
+        }
+        ring.times.append(time);
+        ring.mins.append(minValue);
+        if (withMax) {
+            ring.maxs.append(maxValue);
+        }
+    } else {
+        ring.times[ring.head] = time;
+        ring.mins[ring.head] = minValue;
+        if (withMax) {
+            ring.maxs[ring.head] = maxValue;
+        }
+        ring.head = (ring.head + 1) % ring.capacity;
+    }
+}
+
+int TelemetryHistory::_ringLowerBound(const Ring_t& ring, qint32 time)
+{
+    int first = 0;
+    int count = ring.times.count();
+
+    while (count > 0) {
+        int step = count / 2;
+        int middle = first + step;
+        if (ring.times[_ringIndex(ring, middle)] < time) {
+            first = middle + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+qint64 TelemetryHistory::_ringBytes(const Ring_t& ring)
+{
+    return ring.times.capacity() * static_cast<qint64>(sizeof(qint32)) + (ring.mins.capacity() + ring.maxs.capacity()) * static_cast<qint64>(sizeof(double));
+}
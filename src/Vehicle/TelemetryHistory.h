@@ -0,0 +1,113 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QPointF>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryHistoryLog)
+
+class FactGroup;
+
+/// Time series history of a vehicle's numeric telemetry: Facts and MAVLink message fields.
+///
+/// Each series is stored as columns (timestamps, values) in fixed capacity ring buffers, so memory is bounded no
+/// matter how long the vehicle is connected. Next to the raw samples every series keeps tiers of min/max buckets
+/// (1 second, 10 seconds, 1 minute), which retain hours of history after the raw samples have been overwritten.
+/// Buffers are allocated as they fill, series which rarely change stay small.
+///
+/// Queries ask for a time range at a pixel budget. Raw samples are used whenever they reach back to the start of the
+/// range, otherwise the finest tier which covers the range without exceeding the budget. The work per query is bounded
+/// by the raw capacity and the budget, not by the history length.
+///
+/// Times are QGC::bootTimeMilliseconds based, which is what the charts use for their time axis.
+class TelemetryHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+    TelemetryHistory(QObject* parent = nullptr);
+
+    /// @return Id of the series with the specified name, the series is created if it does not exist
+    int series(const QString& name);
+
+    /// @return Id of the series with the specified name, -1 if it does not exist
+    int findSeries(const QString& name) const { return _seriesIds.value(name, -1); }
+
+    QStringList seriesNames(void) const { return _seriesIds.keys(); }
+
+    /// Records a sample at the current time
+    void append(int seriesId, double value) { append(seriesId, currentTimeMsecs(), value); }
+
+    /// Records a sample. Samples must be appended in time order per series.
+    void append(int seriesId, qint64 timeMsecs, double value);
+
+    /// Records every numeric Fact of the group and its sub groups as series "<prefix><fact>", "<prefix><group>.<fact>"
+    void addFactGroup(FactGroup* factGroup, const QString& prefix = QString());
+
+    /// Returns the series within [startMsecs, endMsecs] reduced to at most about two points per pixel. Raw samples which
+    /// fit the budget are returned as they are, anything else as a min and max point per pixel column.
+    void query(int seriesId, qint64 startMsecs, qint64 endMsecs, int pixelBudget, QVector<QPointF>& points) const;
+
+    /// @return Number of raw samples currently held for the series
+    int rawSampleCount(int seriesId) const;
+
+    /// @return Time of the oldest data still held for the series at any level, -1 if there is none
+    qint64 oldestTimeMsecs(int seriesId) const;
+
+    /// @return Bytes currently allocated by all series
+    qint64 memoryBytes(void) const;
+
+    qint64 currentTimeMsecs(void) const { return _timeBaseMsecs + _clock.elapsed(); }
+
+    static const int rawCapacity = 4096;
+    static const int tierCount = 3;
+    static const int tierBucketMsecs[tierCount];
+    static const int tierCapacity[tierCount];
+
+private:
+    /// Fixed capacity ring of columns. The raw level only uses mins for the value.
+    typedef struct {
+        int                 capacity;
+        int                 head;           ///< Physical index of the oldest entry once the ring is full
+        QVector<qint32>     times;          ///< Relative to _timeBaseMsecs
+        QVector<double>     mins;
+        QVector<double>     maxs;
+    } Ring_t;
+
+    typedef struct {
+        Ring_t  ring;
+        qint32  openStart;                  ///< Bucket which is still being filled
+        double  openMin;
+        double  openMax;
+        bool    openValid;
+    } Tier_t;
+
+    typedef struct {
+        Ring_t  raw;
+        Tier_t  tiers[tierCount];
+        qint32  firstTime;                  ///< First sample ever appended, tier buckets may start before it
+    } Series_t;
+
+    static void     _ringPush       (Ring_t& ring, qint32 time, double minValue, double maxValue, bool withMax);
+    static int      _ringIndex      (const Ring_t& ring, int logicalIndex) { return (ring.head + logicalIndex) % ring.times.count(); }
+    static int      _ringLowerBound (const Ring_t& ring, qint32 time);
+    static qint64   _ringBytes      (const Ring_t& ring);
+
+    QVector<Series_t>   _series;
+    QHash<QString, int> _seriesIds;
+    qint64              _timeBaseMsecs;
+    QElapsedTimer       _clock;
+};
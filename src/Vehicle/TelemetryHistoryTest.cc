@@ -0,0 +1,171 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryHistoryTest.h"
+#include "TelemetryHistory.h"
+
+#include <limits>
+
+void TelemetryHistoryTest::_rawQuery_test(void)
+{
+    TelemetryHistory    history;
+    QVector<QPointF>    points;
+
+    int seriesId = history.series("gps.lat");
+    QCOMPARE(history.series("gps.lat"), seriesId);
+    QCOMPARE(history.findSeries("gps.lat"), seriesId);
+    QCOMPARE(history.findSeries("gps.lon"), -1);
+
+    // 100 samples at 10Hz, one NaN which is kept but not drawn
+    qint64 startMsecs = history.currentTimeMsecs();
+    for (int i=0; i<100; i++) {
+        history.append(seriesId, startMsecs + (i * 100), i == 50 ? std::numeric_limits<double>::quiet_NaN() : i);
+    }
+    QCOMPARE(history.rawSampleCount(seriesId), 100);
+    // Tier buckets start on a bucket boundary at or before the first sample
+    QVERIFY(history.oldestTimeMsecs(seriesId) <= startMsecs);
+
+    // Small enough for the budget, raw samples come back as they are
+    history.query(seriesId, startMsecs, startMsecs + 10 * 1000, 1000, points);
+    QCOMPARE(points.count(), 99);
+    QCOMPARE(points.first(), QPointF(startMsecs, 0));
+    QCOMPARE(points.last(), QPointF(startMsecs + 9900, 99));
+
+    // Sub range
+    history.query(seriesId, startMsecs + 1000, startMsecs + 1900, 1000, points);
+    QCOMPARE(points.count(), 10);
+    QCOMPARE(points.first().y(), 10.0);
+
+    // Out of order samples are clamped to the newest time
+    history.append(seriesId, startMsecs, 200);
+    history.query(seriesId, startMsecs + 9900, startMsecs + 9900, 1000, points);
+    QCOMPARE(points.count(), 2);
+    QCOMPARE(points.last().y(), 200.0);
+}
+
+void TelemetryHistoryTest::_rawReduce_test(void)
+{
+    TelemetryHistory    history;
+    QVector<QPointF>    points;
+    const int           pixelBudget = 100;
+    const int           rateHz      = 50;
+
+    int seriesId = history.series("attitude.roll");
+
+    // 10 seconds at 50Hz of a square wave with a 200 msecs period, which the 1 second tier flattens
+    qint64 startMsecs = history.currentTimeMsecs();
+    for (int i=0; i<10 * rateHz; i++) {
+        history.append(seriesId, startMsecs + (i * 1000 / rateHz), (i / 5) % 2);
+    }
+
+    // Over budget but still held raw, each 100 msecs column keeps its own value
+    history.query(seriesId, startMsecs, startMsecs + 10 * 1000, pixelBudget, points);
+    QCOMPARE(points.count(), pixelBudget);
+    for (int column=0; column<pixelBudget; column++) {
+        QCOMPARE(points[column], QPointF(startMsecs + (column * 100), column % 2));
+    }
+}
+
+void TelemetryHistoryTest::_newSeries_test(void)
+{
+    TelemetryHistory    history;
+    QVector<QPointF>    points;
+    const int           pixelBudget = 500;
+    const int           rateHz      = 50;
+
+    int seriesId = history.series("vfrHud.airspeed");
+
+    // 10 seconds of a series which only started recording just now
+    qint64 startMsecs = history.currentTimeMsecs();
+    for (int i=0; i<10 * rateHz; i++) {
+        history.append(seriesId, startMsecs + (i * 1000 / rateHz), i);
+    }
+
+    // A chart's time scale reaches back before the first sample, the raw samples still hold everything there is
+    history.query(seriesId, startMsecs - (60 * 1000), startMsecs + (10 * 1000), pixelBudget, points);
+    QCOMPARE(points.count(), 10 * rateHz);
+    QCOMPARE(points.first(), QPointF(startMsecs, 0));
+    QCOMPARE(points.last().y(), static_cast<double>((10 * rateHz) - 1));
+
+    // Over budget the raw samples are reduced, not replaced by a tier
+    history.query(seriesId, startMsecs - (60 * 1000), startMsecs + (10 * 1000), 50, points);
+    QVERIFY(points.count() > 2 * 2);
+    QVERIFY(points.count() <= 2 * (50 + 1));
+}
+
+void TelemetryHistoryTest::_downsample_test(void)
+{
+    TelemetryHistory    history;
+    QVector<QPointF>    points;
+    const int           pixelBudget = 500;
+    const int           rateHz      = 50;
+    const qint64        durationMsecs = 60 * 60 * 1000;
+
+    int seriesId = history.series("altitudeRelative");
+
+    // One hour at 50Hz with a single spike in the middle
+    qint64 startMsecs = history.currentTimeMsecs();
+    qint64 spikeMsecs = startMsecs + (durationMsecs / 2);
+    for (qint64 t=0; t<durationMsecs; t+=1000 / rateHz) {
+        qint64 timeMsecs = startMsecs + t;
+        history.append(seriesId, timeMsecs, timeMsecs == spikeMsecs ? 1000.0 : (t / 1000) % 10);
+    }
+    QCOMPARE(history.rawSampleCount(seriesId), TelemetryHistory::rawCapacity);
+    QVERIFY(history.oldestTimeMsecs(seriesId) <= startMsecs);
+
+    // The whole hour comes from the min/max tiers, within the budget and keeping the extremes
+    history.query(seriesId, startMsecs, startMsecs + durationMsecs, pixelBudget, points);
+    QVERIFY(points.count() > pixelBudget / 2);
+    QVERIFY(points.count() <= 2 * (pixelBudget + 1));
+    double minValue = std::numeric_limits<double>::max();
+    double maxValue = std::numeric_limits<double>::lowest();
+    for (const QPointF& point: points) {
+        minValue = qMin(minValue, point.y());
+        maxValue = qMax(maxValue, point.y());
+        QVERIFY(point.x() >= startMsecs && point.x() <= startMsecs + durationMsecs);
+    }
+    QCOMPARE(minValue, 0.0);
+    QCOMPARE(maxValue, 1000.0);
+
+    // The last few seconds are still raw
+    history.query(seriesId, startMsecs + durationMsecs - 5000, startMsecs + durationMsecs, pixelBudget, points);
+    QCOMPARE(points.count(), 5 * rateHz);
+}
+
+void TelemetryHistoryTest::_memoryBound_test(void)
+{
+    TelemetryHistory    history;
+    QVector<QPointF>    points;
+
+    int seriesId = history.series("vibration.xAxis");
+
+    // Two days at 10Hz, more than the coarsest tier holds
+    qint64 startMsecs = history.currentTimeMsecs();
+    qint64 durationMsecs = 48LL * 60 * 60 * 1000;
+    for (qint64 t=0; t<durationMsecs; t+=100) {
+        history.append(seriesId, startMsecs + t, static_cast<double>(t % 1000));
+    }
+
+    qint64 maxBytes = TelemetryHistory::rawCapacity * static_cast<qint64>(sizeof(qint32) + sizeof(double));
+    for (int i=0; i<TelemetryHistory::tierCount; i++) {
+        maxBytes += TelemetryHistory::tierCapacity[i] * static_cast<qint64>(sizeof(qint32) + 2 * sizeof(double));
+    }
+    maxBytes += 4096; // Bookkeeping
+    QVERIFY(history.memoryBytes() <= maxBytes);
+
+    // About the last 24 hours are still there at one minute resolution
+    qint64 coarsestMsecs = static_cast<qint64>(TelemetryHistory::tierCapacity[TelemetryHistory::tierCount - 1]) * TelemetryHistory::tierBucketMsecs[TelemetryHistory::tierCount - 1];
+    qint64 oldestMsecs = history.oldestTimeMsecs(seriesId);
+    QVERIFY(oldestMsecs >= startMsecs + durationMsecs - coarsestMsecs - TelemetryHistory::tierBucketMsecs[TelemetryHistory::tierCount - 1]);
+    QVERIFY(oldestMsecs <= startMsecs + durationMsecs - coarsestMsecs + TelemetryHistory::tierBucketMsecs[TelemetryHistory::tierCount - 1]);
+
+    history.query(seriesId, startMsecs, startMsecs + durationMsecs, 1000, points);
+    QVERIFY(points.count() > 0);
+    QVERIFY(points.count() <= 2 * TelemetryHistory::tierCapacity[TelemetryHistory::tierCount - 1] + 2);
+}
@@ -0,0 +1,28 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for TelemetryHistory
+class TelemetryHistoryTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TelemetryHistoryTest(void) { }
+
+private slots:
+    void _rawQuery_test     (void);
+    void _rawReduce_test    (void);
+    void _newSeries_test    (void);
+    void _downsample_test   (void);
+    void _memoryBound_test  (void);
+};
@@ -23,7 +23,7 @@ TerrainProtocolHandler::TerrainProtocolHandler(Vehicle* vehicle, TerrainFactGrou
     connect(&_terrainDataSendTimer, &QTimer::timeout, this, &TerrainProtocolHandler::_sendNextTerrainData);
 }
 
-bool TerrainProtocolHandler::mavlinkMessageReceived(const mavlink_message_t message)
+bool TerrainProtocolHandler::mavlinkMessageReceived(const mavlink_message_t& message)
 {
     switch (message.msgid) {
     case MAVLINK_MSG_ID_TERRAIN_REQUEST:
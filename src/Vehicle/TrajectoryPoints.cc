@@ -10,11 +10,24 @@
 #include "TrajectoryPoints.h"
 #include "Vehicle.h"
 
+#include <QtMath>
+
+const int TrajectoryPoints::levelCount;
+const int TrajectoryPoints::maxMapPoints;
+const int TrajectoryPoints::_maxTailPoints;
+
 TrajectoryPoints::TrajectoryPoints(Vehicle* vehicle, QObject* parent)
     : QObject       (parent)
     , _vehicle      (vehicle)
     , _lastAzimuth  (qQNaN())
+    , _level        (0)
+    , _mapZoomLevel (qQNaN())
 {
+    // Level 0 is the full path, each following level allows four times the error of the previous one
+    static const double tolerances[levelCount] = { 0.0, 4.0, 16.0, 64.0, 256.0 };
+    for (int i=0; i<levelCount; i++) {
+        _levels[i].tolerance = tolerances[i];
+    }
 }
 
 void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
@@ -26,29 +39,194 @@ void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
         double distance = _lastPoint.distanceTo(coordinate);
         if (distance > _distanceTolerance) {
             //-- Update flight distance
-            _vehicle->updateFlightDistance(distance);
+            if (_vehicle) {
+                _vehicle->updateFlightDistance(distance);
+            }
             // Vehicle has moved far enough from previous point for an update
             double newAzimuth = _lastPoint.azimuthTo(coordinate);
             if (qIsNaN(_lastAzimuth) || qAbs(newAzimuth - _lastAzimuth) > _azimuthTolerance) {
                 // The new position IS NOT colinear with the last segment. Append the new position to the list.
                 _lastAzimuth = _lastPoint.azimuthTo(coordinate);
                 _lastPoint = coordinate;
-                _points.append(QVariant::fromValue(coordinate));
-                emit pointAdded(coordinate);
+                _appendPoint(coordinate);
             } else {
                 // The new position IS colinear with the last segment. Don't add a new point, just update
                 // the last point to be the new position.
                 _lastPoint = coordinate;
-                _points[_points.count() - 1] = QVariant::fromValue(coordinate);
-                emit updateLastPoint(coordinate);
+                _replaceLastPoint(coordinate);
             }
         }
     } else {
         // Add the very first trajectory point to the list
         _lastPoint = coordinate;
-        _points.append(QVariant::fromValue(coordinate));
+        _appendPoint(coordinate);
+    }
+}
+
+void TrajectoryPoints::_appendPoint(const QGeoCoordinate& coordinate)
+{
+    _lats.append(coordinate.latitude());
+    _lons.append(coordinate.longitude());
+    _alts.append(static_cast<float>(coordinate.altitude()));
+
+    int newIndex = _lats.count() - 1;
+
+    if (_level == 0) {
         emit pointAdded(coordinate);
     }
+
+    for (int i=1; i<levelCount; i++) {
+        Level_t& level = _levels[i];
+
+        if (level.indices.isEmpty()) {
+            level.indices.append(newIndex);
+            if (i == _level) {
+                emit pointAdded(coordinate);
+            }
+            continue;
+        }
+
+        int anchorIndex = level.indices.last();
+        if (newIndex - 1 == anchorIndex) {
+            // Nothing in the tail yet, the new point becomes the moving end of the polyline
+            if (i == _level) {
+                emit pointAdded(coordinate);
+            }
+        } else if (_tailWithinTolerance(level, anchorIndex, newIndex)) {
+            // The tail is still represented well enough by a single segment, move its end
+            if (i == _level) {
+                emit updateLastPoint(coordinate);
+            }
+        } else {
+            // Keep the previous end and start a new segment from it
+            level.indices.append(newIndex - 1);
+            if (i == _level) {
+                emit pointAdded(coordinate);
+            }
+        }
+    }
+
+    _selectLevel();
+}
+
+void TrajectoryPoints::_replaceLastPoint(const QGeoCoordinate& coordinate)
+{
+    int lastIndex = _lats.count() - 1;
+
+    _lats[lastIndex] = coordinate.latitude();
+    _lons[lastIndex] = coordinate.longitude();
+    _alts[lastIndex] = static_cast<float>(coordinate.altitude());
+
+    // The last point is never kept by a simplified level, it is the moving end of the polyline at every level
+    emit updateLastPoint(coordinate);
+}
+
+bool TrajectoryPoints::_tailWithinTolerance(const Level_t& level, int anchorIndex, int endIndex) const
+{
+    if (endIndex - anchorIndex - 1 > _maxTailPoints) {
+        return false;
+    }
+    for (int i=anchorIndex + 1; i<endIndex; i++) {
+        if (_segmentDistance(i, anchorIndex, endIndex) > level.tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double TrajectoryPoints::_segmentDistance(int pointIndex, int startIndex, int endIndex) const
+{
+    // Local equirectangular projection around the segment start, plenty accurate at trajectory scale
+    static const double earthRadius = 6371000.0;
+
+    double cosLat   = qCos(qDegreesToRadians(_lats[startIndex]));
+    double endX     = qDegreesToRadians(_lons[endIndex] - _lons[startIndex]) * cosLat * earthRadius;
+    double endY     = qDegreesToRadians(_lats[endIndex] - _lats[startIndex]) * earthRadius;
+    double pointX   = qDegreesToRadians(_lons[pointIndex] - _lons[startIndex]) * cosLat * earthRadius;
+    double pointY   = qDegreesToRadians(_lats[pointIndex] - _lats[startIndex]) * earthRadius;
+
+    double lengthSquared = (endX * endX) + (endY * endY);
+    double t = 0;
+    if (lengthSquared > 0) {
+        t = qBound(0.0, ((pointX * endX) + (pointY * endY)) / lengthSquared, 1.0);
+    }
+    double dx = pointX - (t * endX);
+    double dy = pointY - (t * endY);
+
+    return qSqrt((dx * dx) + (dy * dy));
+}
+
+QGeoCoordinate TrajectoryPoints::_coordinate(int index) const
+{
+    return QGeoCoordinate(_lats[index], _lons[index], static_cast<double>(_alts[index]));
+}
+
+int TrajectoryPoints::pointCount(int level) const
+{
+    if (level <= 0 || level >= levelCount) {
+        return _lats.count();
+    }
+
+    const QVector<int>& indices = _levels[level].indices;
+    if (indices.isEmpty()) {
+        return 0;
+    }
+    return indices.count() + (_lats.count() - 1 > indices.last() ? 1 : 0);
+}
+
+QVariantList TrajectoryPoints::list(void) const
+{
+    QVariantList points;
+
+    if (_level == 0) {
+        points.reserve(_lats.count());
+        for (int i=0; i<_lats.count(); i++) {
+            points.append(QVariant::fromValue(_coordinate(i)));
+        }
+    } else {
+        const QVector<int>& indices = _levels[_level].indices;
+        points.reserve(pointCount(_level));
+        for (int index: indices) {
+            points.append(QVariant::fromValue(_coordinate(index)));
+        }
+        if (!indices.isEmpty() && _lats.count() - 1 > indices.last()) {
+            points.append(QVariant::fromValue(_coordinate(_lats.count() - 1)));
+        }
+    }
+
+    return points;
+}
+
+void TrajectoryPoints::setMapZoomLevel(double zoomLevel)
+{
+    if (zoomLevel != _mapZoomLevel) {
+        _mapZoomLevel = zoomLevel;
+        _selectLevel();
+    }
+}
+
+void TrajectoryPoints::_selectLevel(void)
+{
+    int newLevel = 0;
+
+    if (!qIsNaN(_mapZoomLevel)) {
+        // Web mercator ground resolution, the simplification error of the level should stay below a pixel
+        double latitude = _lats.isEmpty() ? 0.0 : _lats.last();
+        double metersPerPixel = 156543.03392 * qCos(qDegreesToRadians(latitude)) / qPow(2.0, _mapZoomLevel);
+        for (int i=1; i<levelCount; i++) {
+            if (_levels[i].tolerance <= metersPerPixel) {
+                newLevel = i;
+            }
+        }
+    }
+    while (newLevel < levelCount - 1 && pointCount(newLevel) > maxMapPoints) {
+        newLevel++;
+    }
+
+    if (newLevel != _level) {
+        _level = newLevel;
+        emit levelChanged();
+    }
 }
 
 void TrajectoryPoints::start(void)
@@ -59,14 +237,20 @@ void TrajectoryPoints::start(void)
 
 void TrajectoryPoints::stop(void)
 {
-    qDebug() << "Stop" << _points.count();
+    qDebug() << "Stop" << _lats.count();
     disconnect(_vehicle, &Vehicle::coordinateChanged, this, &TrajectoryPoints::_vehicleCoordinateChanged);
 }
 
 void TrajectoryPoints::clear(void)
 {
-    _points.clear();
+    _lats.clear();
+    _lons.clear();
+    _alts.clear();
+    for (int i=0; i<levelCount; i++) {
+        _levels[i].indices.clear();
+    }
     _lastPoint = QGeoCoordinate();
     _lastAzimuth = qQNaN();
+    _selectLevel();
     emit pointsCleared();
 }
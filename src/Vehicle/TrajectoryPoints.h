@@ -12,9 +12,20 @@
 #include "QmlObjectListModel.h"
 
 #include <QGeoCoordinate>
+#include <QVector>
 
 class Vehicle;
 
+/// Flown path of a vehicle.
+///
+/// Points are stored in contiguous lat/lon/alt arrays. On top of the full resolution path there are simplified levels
+/// of detail, each built incrementally as points arrive with a sliding window Douglas-Peucker: the open tail of the
+/// path is extended while every tail point stays within the level's tolerance of the segment from the last kept point
+/// to the newest one. Each level only stores indices into the point arrays.
+///
+/// The map is given a single level: the coarsest whose tolerance stays below a pixel at the map zoom, going coarser
+/// still if the level has more than maxMapPoints points. The pointAdded/updateLastPoint signals describe changes to
+/// that level's polyline, levelChanged means the map has to fetch list() again.
 class TrajectoryPoints : public QObject
 {
     Q_OBJECT
@@ -22,11 +33,21 @@ class TrajectoryPoints : public QObject
 public:
     TrajectoryPoints(Vehicle* vehicle, QObject* parent = nullptr);
 
-    Q_INVOKABLE QVariantList list(void) const { return _points; }
+    /// @return Polyline for the map at the current level of detail
+    Q_INVOKABLE QVariantList list(void) const;
+
+    /// Selects the level of detail for the map
+    Q_INVOKABLE void setMapZoomLevel(double zoomLevel);
 
     void start  (void);
     void stop   (void);
 
+    int level       (void) const { return _level; }
+    int pointCount  (int level) const;
+
+    static const int levelCount = 5;
+    static const int maxMapPoints = 5000;
+
 public slots:
     void clear  (void);
 
@@ -34,16 +55,37 @@ signals:
     void pointAdded     (QGeoCoordinate coordinate);
     void updateLastPoint(QGeoCoordinate coordinate);
     void pointsCleared  (void);
+    void levelChanged   (void);
 
 private slots:
     void _vehicleCoordinateChanged(QGeoCoordinate coordinate);
 
 private:
+    typedef struct {
+        double          tolerance;      ///< Meters
+        QVector<int>    indices;        ///< Kept points, the last one is the newest point and still moves
+    } Level_t;
+
+    void            _appendPoint        (const QGeoCoordinate& coordinate);
+    void            _replaceLastPoint   (const QGeoCoordinate& coordinate);
+    bool            _tailWithinTolerance(const Level_t& level, int anchorIndex, int endIndex) const;
+    double          _segmentDistance    (int pointIndex, int startIndex, int endIndex) const;
+    QGeoCoordinate  _coordinate         (int index) const;
+    void            _selectLevel        (void);
+
     Vehicle*        _vehicle;
-    QVariantList    _points;
     QGeoCoordinate  _lastPoint;
     double          _lastAzimuth;
+    QVector<double> _lats;
+    QVector<double> _lons;
+    QVector<float>  _alts;
+    Level_t         _levels[levelCount];
+    int             _level;
+    double          _mapZoomLevel;
 
     static constexpr double _distanceTolerance = 2.0;
     static constexpr double _azimuthTolerance = 1.5;
+    static const int        _maxTailPoints = 128;   ///< Bounds the work per point, longer tails are cut
+
+    friend class TrajectoryPointsTest;
 };
@@ -0,0 +1,124 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryPointsTest.h"
+#include "TrajectoryPoints.h"
+
+#include <QSignalSpy>
+
+const QGeoCoordinate TrajectoryPointsTest::_startCoordinate(47.3977, 8.5456, 500);
+
+/// Flies north then east, 10 meters per point with a 1 meter wiggle to either side. The wiggle changes the azimuth
+/// enough for every point to be kept at full resolution.
+void TrajectoryPointsTest::_flyWigglyPath(TrajectoryPoints& trajectoryPoints, int legPoints)
+{
+    QGeoCoordinate legStart = _startCoordinate;
+
+    for (double legAzimuth: { 0.0, 90.0 }) {
+        QGeoCoordinate coordinate;
+        for (int i=0; i<legPoints; i++) {
+            coordinate = legStart.atDistanceAndAzimuth(i * 10.0, legAzimuth);
+            coordinate = coordinate.atDistanceAndAzimuth(1.0, legAzimuth + (i % 2 ? 90.0 : -90.0));
+            trajectoryPoints._vehicleCoordinateChanged(coordinate);
+        }
+        legStart = coordinate;
+    }
+}
+
+void TrajectoryPointsTest::_simplify_test(void)
+{
+    TrajectoryPoints trajectoryPoints(nullptr);
+    const int legPoints = 1000;
+
+    _flyWigglyPath(trajectoryPoints, legPoints);
+
+    // Full resolution keeps everything, the wiggles are below every simplified level's tolerance
+    QVERIFY(trajectoryPoints.pointCount(0) >= (2 * legPoints) - 2);
+    for (int level=1; level<TrajectoryPoints::levelCount; level++) {
+        int count = trajectoryPoints.pointCount(level);
+        QVERIFY(count >= 3);
+        QVERIFY(count <= trajectoryPoints.pointCount(0) / 50);
+        QVERIFY(count <= trajectoryPoints.pointCount(level - 1));
+    }
+
+    // Both ends are kept at every level
+    for (int level=1; level<TrajectoryPoints::levelCount; level++) {
+        trajectoryPoints._level = level;
+        QVariantList points = trajectoryPoints.list();
+        QCOMPARE(points.count(), trajectoryPoints.pointCount(level));
+        QVERIFY(points.first().value<QGeoCoordinate>().distanceTo(_startCoordinate.atDistanceAndAzimuth(1.0, -90.0)) < 0.1);
+        trajectoryPoints._level = 0;
+        QVariantList fullPoints = trajectoryPoints.list();
+        QVERIFY(points.last().value<QGeoCoordinate>().distanceTo(fullPoints.last().value<QGeoCoordinate>()) < 0.1);
+    }
+}
+
+void TrajectoryPointsTest::_levelSelection_test(void)
+{
+    TrajectoryPoints trajectoryPoints(nullptr);
+    QSignalSpy spy(&trajectoryPoints, &TrajectoryPoints::levelChanged);
+
+    _flyWigglyPath(trajectoryPoints, 100);
+    QCOMPARE(trajectoryPoints.level(), 0);
+
+    // Close up shows everything, zoomed out shows the coarsest level
+    trajectoryPoints.setMapZoomLevel(20);
+    QCOMPARE(trajectoryPoints.level(), 0);
+    QCOMPARE(spy.count(), 0);
+    trajectoryPoints.setMapZoomLevel(3);
+    QCOMPARE(trajectoryPoints.level(), TrajectoryPoints::levelCount - 1);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(trajectoryPoints.list().count(), trajectoryPoints.pointCount(trajectoryPoints.level()));
+
+    // A level with too many points for the map is skipped even when zoomed in
+    trajectoryPoints.setMapZoomLevel(20);
+    QCOMPARE(trajectoryPoints.level(), 0);
+    _flyWigglyPath(trajectoryPoints, TrajectoryPoints::maxMapPoints);
+    QVERIFY(trajectoryPoints.pointCount(0) > TrajectoryPoints::maxMapPoints);
+    QVERIFY(trajectoryPoints.level() > 0);
+    QVERIFY(trajectoryPoints.list().count() <= TrajectoryPoints::maxMapPoints);
+
+    trajectoryPoints.clear();
+    QCOMPARE(trajectoryPoints.level(), 0);
+    QCOMPARE(trajectoryPoints.pointCount(0), 0);
+    QCOMPARE(trajectoryPoints.list().count(), 0);
+}
+
+void TrajectoryPointsTest::_signals_test(void)
+{
+    // The signals must describe the polyline of the selected level exactly, as the map builds its path from them
+    // Map zoom levels which select each level of detail
+    static const double zoomLevels[TrajectoryPoints::levelCount] = { 20, 14, 12, 10, 8 };
+
+    for (int level=0; level<TrajectoryPoints::levelCount; level++) {
+        TrajectoryPoints        trajectoryPoints(nullptr);
+        QList<QGeoCoordinate>   polyline;
+
+        trajectoryPoints.setMapZoomLevel(zoomLevels[level]);
+        QCOMPARE(trajectoryPoints.level(), level);
+        connect(&trajectoryPoints, &TrajectoryPoints::pointAdded,       this, [&polyline](QGeoCoordinate coordinate) { polyline.append(coordinate); });
+        connect(&trajectoryPoints, &TrajectoryPoints::updateLastPoint,  this, [&polyline](QGeoCoordinate coordinate) { polyline.last() = coordinate; });
+
+        // Colinear points replace the last point
+        QGeoCoordinate coordinate = _startCoordinate;
+        for (int i=0; i<50; i++) {
+            trajectoryPoints._vehicleCoordinateChanged(coordinate.atDistanceAndAzimuth(i * 5.0, 45.0));
+        }
+        _flyWigglyPath(trajectoryPoints, 300);
+
+        QCOMPARE(trajectoryPoints.level(), level);
+        QVariantList points = trajectoryPoints.list();
+        QCOMPARE(polyline.count(), points.count());
+        for (int i=0; i<points.count(); i++) {
+            QVERIFY(polyline[i].distanceTo(points[i].value<QGeoCoordinate>()) < 0.01);
+        }
+
+        disconnect(&trajectoryPoints, nullptr, this, nullptr);
+    }
+}
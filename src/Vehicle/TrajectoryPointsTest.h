@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QGeoCoordinate>
+
+class TrajectoryPoints;
+
+/// Unit test for TrajectoryPoints levels of detail
+class TrajectoryPointsTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TrajectoryPointsTest(void) { }
+
+private slots:
+    void _simplify_test         (void);
+    void _levelSelection_test   (void);
+    void _signals_test          (void);
+
+private:
+    void _flyWigglyPath(TrajectoryPoints& trajectoryPoints, int legPoints);
+
+    static const QGeoCoordinate _startCoordinate;
+};
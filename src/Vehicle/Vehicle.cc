@@ -43,6 +43,7 @@
 #include "PositionManager.h"
 #include "VehicleObjectAvoidance.h"
 #include "TrajectoryPoints.h"
+#include "TelemetryHistory.h"
 #include "QGCGeo.h"
 #include "TerrainProtocolHandler.h"
 
@@ -167,7 +168,9 @@ Vehicle::Vehicle(LinkInterface*             link,
     , _base_mode(0)
     , _custom_mode(0)
     , _nextSendMessageMultipleIndex(0)
+    , _flightTimerStartReplayUSecs(0)
     , _trajectoryPoints(new TrajectoryPoints(this, this))
+    , _telemetryHistory(nullptr)
     , _firmwarePluginManager(firmwarePluginManager)
     , _joystickManager(joystickManager)
     , _flowImageIndex(0)
@@ -230,8 +233,7 @@ Vehicle::Vehicle(LinkInterface*             link,
     _mavlink = _toolbox->mavlinkProtocol();
     qCDebug(VehicleLog) << "Link started with Mavlink " << (_mavlink->getCurrentVersion() >= 200 ? "V2" : "V1");
 
-    connect(_mavlink, &MAVLinkProtocol::messageReceived,        this, &Vehicle::_mavlinkMessageReceived);
-    connect(_mavlink, &MAVLinkProtocol::mavlinkMessageStatus,   this, &Vehicle::_mavlinkMessageStatus);
+    // Incoming messages and link status are routed to us by MultiVehicleManager based on our system id
 
     _addLink(link);
 
@@ -249,6 +251,10 @@ Vehicle::Vehicle(LinkInterface*             link,
     _commonInit();
     _autopilotPlugin = _firmwarePlugin->autopilotPlugin(this);
 
+    // Record the history of every numeric Fact, including firmware specific groups added by _commonInit
+    _telemetryHistory = new TelemetryHistory(this);
+    _telemetryHistory->addFactGroup(this);
+
     // PreArm Error self-destruct timer
     connect(&_prearmErrorTimer, &QTimer::timeout, this, &Vehicle::_prearmErrorTimeout);
     _prearmErrorTimer.setInterval(_prearmErrorTimeoutMSecs);
@@ -376,7 +382,9 @@ Vehicle::Vehicle(MAV_AUTOPILOT              firmwareType,
     , _base_mode(0)
     , _custom_mode(0)
     , _nextSendMessageMultipleIndex(0)
+    , _flightTimerStartReplayUSecs(0)
     , _trajectoryPoints(new TrajectoryPoints(this, this))
+    , _telemetryHistory(nullptr)
     , _firmwarePluginManager(firmwarePluginManager)
     , _joystickManager(nullptr)
     , _flowImageIndex(0)
@@ -655,8 +663,11 @@ void Vehicle::resetCounters()
     _heardFrom          = false;
 }
 
-void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+void Vehicle::_mavlinkMessageReceived(LinkInterface* link, const MAVLinkMessageHandle& receivedMessage)
 {
+    // Shares the received buffer. Only firmware plugins which rewrite the message end up with a private copy.
+    MAVLinkMessageHandle messageHandle(receivedMessage);
+
     // If the link is already running at Mavlink V2 set our max proto version to it.
     unsigned mavlinkVersion = _mavlink->getCurrentVersion();
     if (_maxProtoVersion != mavlinkVersion && mavlinkVersion >= 200) {
@@ -664,9 +675,9 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         qCDebug(VehicleLog) << "Vehicle::_mavlinkMessageReceived Link already running Mavlink v2. Setting _maxProtoVersion" << _maxProtoVersion;
     }
 
-    if (message.sysid != _id && message.sysid != 0) {
+    if (messageHandle->sysid != _id && messageHandle->sysid != 0) {
         // We allow RADIO_STATUS messages which come from a link the vehicle is using to pass through and be handled
-        if (!(message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _containsLink(link))) {
+        if (!(messageHandle->msgid == MAVLINK_MSG_ID_RADIO_STATUS && _containsLink(link))) {
             return;
         }
     }
@@ -679,14 +690,14 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     _messagesReceived++;
     emit messagesReceivedChanged();
     if(!_heardFrom) {
-        if(message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        if(messageHandle->msgid == MAVLINK_MSG_ID_HEARTBEAT) {
             _heardFrom = true;
-            _compID = message.compid;
-            _messageSeq = message.seq + 1;
+            _compID = messageHandle->compid;
+            _messageSeq = messageHandle->seq + 1;
         }
     } else {
-        if(_compID == message.compid) {
-            uint16_t seq_received = static_cast<uint16_t>(message.seq);
+        if(_compID == messageHandle->compid) {
+            uint16_t seq_received = static_cast<uint16_t>(messageHandle->seq);
             uint16_t packet_lost_count = 0;
             //-- Account for overflow during packet loss
             if(seq_received < _messageSeq) {
@@ -694,7 +705,7 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
             } else {
                 packet_lost_count = seq_received - _messageSeq;
             }
-            _messageSeq = message.seq + 1;
+            _messageSeq = messageHandle->seq + 1;
             _messagesLost += packet_lost_count;
             if(packet_lost_count)
                 emit messagesLostChanged();
@@ -702,9 +713,10 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     }
 
     // Give the plugin a change to adjust the message contents
-    if (!_firmwarePlugin->adjustIncomingMavlinkMessage(this, &message)) {
+    if (!_firmwarePlugin->adjustIncomingMavlinkMessage(this, messageHandle)) {
         return;
     }
+    const mavlink_message_t& message = messageHandle.message();
 
     // Give the Core Plugin access to all mavlink traffic
     if (!_toolbox->corePlugin()->mavlinkMessage(this, link, message)) {
@@ -889,7 +901,7 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
 
     // This must be emitted after the vehicle processes the message. This way the vehicle state is up to date when anyone else
     // does processing.
-    emit mavlinkMessageReceived(message);
+    emit mavlinkMessageReceived(messageHandle);
 
     _uas->receiveMessage(message);
 }
@@ -1009,7 +1021,7 @@ void Vehicle::_chunkedStatusTextCompleted(uint8_t compId)
     emit textMessageReceived(id(), compId, severity, messageText);
 }
 
-void Vehicle::_handleStatusText(mavlink_message_t& message)
+void Vehicle::_handleStatusText(const mavlink_message_t& message)
 {
     QByteArray  b;
     QString     messageText;
@@ -1066,18 +1078,18 @@ void Vehicle::_handleStatusText(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleVfrHud(mavlink_message_t& message)
+void Vehicle::_handleVfrHud(const mavlink_message_t& message)
 {
     mavlink_vfr_hud_t vfrHud;
     mavlink_msg_vfr_hud_decode(&message, &vfrHud);
 
-    _airSpeedFact.setRawValue(qIsNaN(vfrHud.airspeed) ? 0 : vfrHud.airspeed);
-    _groundSpeedFact.setRawValue(qIsNaN(vfrHud.groundspeed) ? 0 : vfrHud.groundspeed);
-    _climbRateFact.setRawValue(qIsNaN(vfrHud.climb) ? 0 : vfrHud.climb);
-    _throttlePctFact.setRawValue(static_cast<int16_t>(vfrHud.throttle));
+    _airSpeedFact.setRawDouble(qIsNaN(vfrHud.airspeed) ? 0 : vfrHud.airspeed);
+    _groundSpeedFact.setRawDouble(qIsNaN(vfrHud.groundspeed) ? 0 : vfrHud.groundspeed);
+    _climbRateFact.setRawDouble(qIsNaN(vfrHud.climb) ? 0 : vfrHud.climb);
+    _throttlePctFact.setRawInt(static_cast<int16_t>(vfrHud.throttle));
 }
 
-void Vehicle::_handleEstimatorStatus(mavlink_message_t& message)
+void Vehicle::_handleEstimatorStatus(const mavlink_message_t& message)
 {
     mavlink_estimator_status_t estimatorStatus;
     mavlink_msg_estimator_status_decode(&message, &estimatorStatus);
@@ -1135,7 +1147,7 @@ void Vehicle::_handleEstimatorStatus(mavlink_message_t& message)
 #endif
 }
 
-void Vehicle::_handleDistanceSensor(mavlink_message_t& message)
+void Vehicle::_handleDistanceSensor(const mavlink_message_t& message)
 {
     mavlink_distance_sensor_t distanceSensor;
 
@@ -1168,7 +1180,7 @@ void Vehicle::_handleDistanceSensor(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleAttitudeTarget(mavlink_message_t& message)
+void Vehicle::_handleAttitudeTarget(const mavlink_message_t& message)
 {
     mavlink_attitude_target_t attitudeTarget;
 
@@ -1204,12 +1216,12 @@ void Vehicle::_handleAttitudeWorker(double rollRadians, double pitchRadians, dou
     // truncate to integer so widget never displays 360
     yaw = trunc(yaw);
 
-    _rollFact.setRawValue(roll);
-    _pitchFact.setRawValue(pitch);
-    _headingFact.setRawValue(yaw);
+    _rollFact.setRawDouble(roll);
+    _pitchFact.setRawDouble(pitch);
+    _headingFact.setRawDouble(yaw);
 }
 
-void Vehicle::_handleAttitude(mavlink_message_t& message)
+void Vehicle::_handleAttitude(const mavlink_message_t& message)
 {
     if (_receivingAttitudeQuaternion) {
         return;
@@ -1221,7 +1233,7 @@ void Vehicle::_handleAttitude(mavlink_message_t& message)
     _handleAttitudeWorker(attitude.roll, attitude.pitch, attitude.yaw);
 }
 
-void Vehicle::_handleAttitudeQuaternion(mavlink_message_t& message)
+void Vehicle::_handleAttitudeQuaternion(const mavlink_message_t& message)
 {
     _receivingAttitudeQuaternion = true;
 
@@ -1244,12 +1256,12 @@ void Vehicle::_handleAttitudeQuaternion(mavlink_message_t& message)
 
     _handleAttitudeWorker(roll, pitch, yaw);
 
-    rollRate()->setRawValue(qRadiansToDegrees(rates[0]));
-    pitchRate()->setRawValue(qRadiansToDegrees(rates[1]));
-    yawRate()->setRawValue(qRadiansToDegrees(rates[2]));
+    rollRate()->setRawDouble(qRadiansToDegrees(rates[0]));
+    pitchRate()->setRawDouble(qRadiansToDegrees(rates[1]));
+    yawRate()->setRawDouble(qRadiansToDegrees(rates[2]));
 }
 
-void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
+void Vehicle::_handleGpsRawInt(const mavlink_message_t& message)
 {
     mavlink_gps_raw_int_t gpsRawInt;
     mavlink_msg_gps_raw_int_decode(&message, &gpsRawInt);
@@ -1263,27 +1275,27 @@ void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
                 _coordinate = newPosition;
                 emit coordinateChanged(_coordinate);
             }
-            _altitudeAMSLFact.setRawValue(gpsRawInt.alt / 1000.0);
+            _altitudeAMSLFact.setRawDouble(gpsRawInt.alt / 1000.0);
         }
     }
 
-    _gpsFactGroup.lat()->setRawValue(gpsRawInt.lat * 1e-7);
-    _gpsFactGroup.lon()->setRawValue(gpsRawInt.lon * 1e-7);
+    _gpsFactGroup.lat()->setRawDouble(gpsRawInt.lat * 1e-7);
+    _gpsFactGroup.lon()->setRawDouble(gpsRawInt.lon * 1e-7);
     _gpsFactGroup.mgrs()->setRawValue(convertGeoToMGRS(QGeoCoordinate(gpsRawInt.lat * 1e-7, gpsRawInt.lon * 1e-7)));
-    _gpsFactGroup.count()->setRawValue(gpsRawInt.satellites_visible == 255 ? 0 : gpsRawInt.satellites_visible);
-    _gpsFactGroup.hdop()->setRawValue(gpsRawInt.eph == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.eph / 100.0);
-    _gpsFactGroup.vdop()->setRawValue(gpsRawInt.epv == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.epv / 100.0);
-    _gpsFactGroup.courseOverGround()->setRawValue(gpsRawInt.cog == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.cog / 100.0);
-    _gpsFactGroup.lock()->setRawValue(gpsRawInt.fix_type);
+    _gpsFactGroup.count()->setRawInt(gpsRawInt.satellites_visible == 255 ? 0 : gpsRawInt.satellites_visible);
+    _gpsFactGroup.hdop()->setRawDouble(gpsRawInt.eph == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.eph / 100.0);
+    _gpsFactGroup.vdop()->setRawDouble(gpsRawInt.epv == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.epv / 100.0);
+    _gpsFactGroup.courseOverGround()->setRawDouble(gpsRawInt.cog == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.cog / 100.0);
+    _gpsFactGroup.lock()->setRawInt(gpsRawInt.fix_type);
 }
 
-void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
+void Vehicle::_handleGlobalPositionInt(const mavlink_message_t& message)
 {
     mavlink_global_position_int_t globalPositionInt;
     mavlink_msg_global_position_int_decode(&message, &globalPositionInt);
 
-    _altitudeRelativeFact.setRawValue(globalPositionInt.relative_alt / 1000.0);
-    _altitudeAMSLFact.setRawValue(globalPositionInt.alt / 1000.0);
+    _altitudeRelativeFact.setRawDouble(globalPositionInt.relative_alt / 1000.0);
+    _altitudeAMSLFact.setRawDouble(globalPositionInt.alt / 1000.0);
 
     // ArduPilot sends bogus GLOBAL_POSITION_INT messages with lat/lat 0/0 even when it has no gps signal
     // Apparently, this is in order to transport relative altitude information.
@@ -1299,7 +1311,7 @@ void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleHighLatency2(mavlink_message_t& message)
+void Vehicle::_handleHighLatency2(const mavlink_message_t& message)
 {
     mavlink_high_latency2_t highLatency2;
     mavlink_msg_high_latency2_decode(&message, &highLatency2);
@@ -1379,16 +1391,16 @@ void Vehicle::_handleHighLatency2(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleAltitude(mavlink_message_t& message)
+void Vehicle::_handleAltitude(const mavlink_message_t& message)
 {
     mavlink_altitude_t altitude;
     mavlink_msg_altitude_decode(&message, &altitude);
 
     // If data from GPS is available it takes precedence over ALTITUDE message
     if (!_globalPositionIntMessageAvailable) {
-        _altitudeRelativeFact.setRawValue(altitude.altitude_relative);
+        _altitudeRelativeFact.setRawDouble(altitude.altitude_relative);
         if (!_gpsRawIntMessageAvailable) {
-            _altitudeAMSLFact.setRawValue(altitude.altitude_amsl);
+            _altitudeAMSLFact.setRawDouble(altitude.altitude_amsl);
         }
     }
 }
@@ -1413,7 +1425,7 @@ void Vehicle::_setCapabilities(uint64_t capabilityBits)
     _setMaxProtoVersionFromBothSources();
 }
 
-void Vehicle::_handleAutopilotVersion(LinkInterface *link, mavlink_message_t& message)
+void Vehicle::_handleAutopilotVersion(LinkInterface *link, const mavlink_message_t& message)
 {
     Q_UNUSED(link);
 
@@ -1464,7 +1476,7 @@ void Vehicle::_handleAutopilotVersion(LinkInterface *link, mavlink_message_t& me
     _startPlanRequest();
 }
 
-void Vehicle::_handleProtocolVersion(LinkInterface *link, mavlink_message_t& message)
+void Vehicle::_handleProtocolVersion(LinkInterface *link, const mavlink_message_t& message)
 {
     Q_UNUSED(link);
 
@@ -1518,7 +1530,7 @@ QString Vehicle::vehicleUIDStr()
     return uid;
 }
 
-void Vehicle::_handleCommandLong(mavlink_message_t& message)
+void Vehicle::_handleCommandLong(const mavlink_message_t& message)
 {
 #ifdef NO_SERIAL_LINK
     // If not using serial link, bail out.
@@ -1547,7 +1559,7 @@ void Vehicle::_handleCommandLong(mavlink_message_t& message)
 #endif
 }
 
-void Vehicle::_handleExtendedSysState(mavlink_message_t& message)
+void Vehicle::_handleExtendedSysState(const mavlink_message_t& message)
 {
     mavlink_extended_sys_state_t extendedState;
     mavlink_msg_extended_sys_state_decode(&message, &extendedState);
@@ -1579,20 +1591,20 @@ void Vehicle::_handleExtendedSysState(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleVibration(mavlink_message_t& message)
+void Vehicle::_handleVibration(const mavlink_message_t& message)
 {
     mavlink_vibration_t vibration;
     mavlink_msg_vibration_decode(&message, &vibration);
 
-    _vibrationFactGroup.xAxis()->setRawValue(vibration.vibration_x);
-    _vibrationFactGroup.yAxis()->setRawValue(vibration.vibration_y);
-    _vibrationFactGroup.zAxis()->setRawValue(vibration.vibration_z);
-    _vibrationFactGroup.clipCount1()->setRawValue(vibration.clipping_0);
-    _vibrationFactGroup.clipCount2()->setRawValue(vibration.clipping_1);
-    _vibrationFactGroup.clipCount3()->setRawValue(vibration.clipping_2);
+    _vibrationFactGroup.xAxis()->setRawDouble(vibration.vibration_x);
+    _vibrationFactGroup.yAxis()->setRawDouble(vibration.vibration_y);
+    _vibrationFactGroup.zAxis()->setRawDouble(vibration.vibration_z);
+    _vibrationFactGroup.clipCount1()->setRawInt(vibration.clipping_0);
+    _vibrationFactGroup.clipCount2()->setRawInt(vibration.clipping_1);
+    _vibrationFactGroup.clipCount3()->setRawInt(vibration.clipping_2);
 }
 
-void Vehicle::_handleWindCov(mavlink_message_t& message)
+void Vehicle::_handleWindCov(const mavlink_message_t& message)
 {
     mavlink_wind_cov_t wind;
     mavlink_msg_wind_cov_decode(&message, &wind);
@@ -1604,13 +1616,13 @@ void Vehicle::_handleWindCov(mavlink_message_t& message)
         direction += 360;
     }
 
-    _windFactGroup.direction()->setRawValue(direction);
-    _windFactGroup.speed()->setRawValue(speed);
-    _windFactGroup.verticalSpeed()->setRawValue(0);
+    _windFactGroup.direction()->setRawDouble(direction);
+    _windFactGroup.speed()->setRawDouble(speed);
+    _windFactGroup.verticalSpeed()->setRawDouble(0);
 }
 
 #if !defined(NO_ARDUPILOT_DIALECT)
-void Vehicle::_handleWind(mavlink_message_t& message)
+void Vehicle::_handleWind(const mavlink_message_t& message)
 {
     mavlink_wind_t wind;
     mavlink_msg_wind_decode(&message, &wind);
@@ -1620,9 +1632,9 @@ void Vehicle::_handleWind(mavlink_message_t& message)
     if (direction < 0) {
         direction += 360;
     }
-    _windFactGroup.direction()->setRawValue(direction);
-    _windFactGroup.speed()->setRawValue(wind.speed);
-    _windFactGroup.verticalSpeed()->setRawValue(wind.speed_z);
+    _windFactGroup.direction()->setRawDouble(direction);
+    _windFactGroup.speed()->setRawDouble(wind.speed);
+    _windFactGroup.verticalSpeed()->setRawDouble(wind.speed_z);
 }
 #endif
 
@@ -1662,7 +1674,7 @@ void Vehicle::_batteryStatusWorker(int batteryId, double voltage, double current
     }
 }
 
-void Vehicle::_handleSysStatus(mavlink_message_t& message)
+void Vehicle::_handleSysStatus(const mavlink_message_t& message)
 {
     mavlink_sys_status_t sysStatus;
     mavlink_msg_sys_status_decode(&message, &sysStatus);
@@ -1701,7 +1713,7 @@ void Vehicle::_handleSysStatus(mavlink_message_t& message)
                          sysStatus.battery_remaining == -1 ? qQNaN() : sysStatus.battery_remaining);
 }
 
-void Vehicle::_handleBatteryStatus(mavlink_message_t& message)
+void Vehicle::_handleBatteryStatus(const mavlink_message_t& message)
 {
     mavlink_battery_status_t bat_status;
     mavlink_msg_battery_status_decode(&message, &bat_status);
@@ -1750,7 +1762,7 @@ void Vehicle::_setHomePosition(QGeoCoordinate& homeCoord)
     }
 }
 
-void Vehicle::_handleHomePosition(mavlink_message_t& message)
+void Vehicle::_handleHomePosition(const mavlink_message_t& message)
 {
     mavlink_home_position_t homePos;
 
@@ -1788,7 +1800,7 @@ void Vehicle::_updateArmed(bool armed)
     }
 }
 
-void Vehicle::_handlePing(LinkInterface* link, mavlink_message_t& message)
+void Vehicle::_handlePing(LinkInterface* link, const mavlink_message_t& message)
 {
     mavlink_ping_t      ping;
     mavlink_message_t   msg;
@@ -1805,7 +1817,7 @@ void Vehicle::_handlePing(LinkInterface* link, mavlink_message_t& message)
     sendMessageOnLink(link, msg);
 }
 
-void Vehicle::_handleHeartbeat(mavlink_message_t& message)
+void Vehicle::_handleHeartbeat(const mavlink_message_t& message)
 {
     if (message.compid != _defaultComponentId) {
         return;
@@ -1845,7 +1857,7 @@ void Vehicle::_handleHeartbeat(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleRadioStatus(mavlink_message_t& message)
+void Vehicle::_handleRadioStatus(const mavlink_message_t& message)
 {
 
     //-- Process telemetry status message
@@ -1905,7 +1917,7 @@ void Vehicle::_handleRadioStatus(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleRCChannels(mavlink_message_t& message)
+void Vehicle::_handleRCChannels(const mavlink_message_t& message)
 {
     mavlink_rc_channels_t channels;
 
@@ -1947,7 +1959,7 @@ void Vehicle::_handleRCChannels(mavlink_message_t& message)
     emit rcChannelsChanged(channels.chancount, pwmValues);
 }
 
-void Vehicle::_handleRCChannelsRaw(mavlink_message_t& message)
+void Vehicle::_handleRCChannelsRaw(const mavlink_message_t& message)
 {
     // We handle both RC_CHANNLES and RC_CHANNELS_RAW since different firmware will only
     // send one or the other.
@@ -1992,19 +2004,19 @@ void Vehicle::_handleRCChannelsRaw(mavlink_message_t& message)
     emit rcChannelsChanged(channelCount, pwmValues);
 }
 
-void Vehicle::_handleScaledPressure(mavlink_message_t& message) {
+void Vehicle::_handleScaledPressure(const mavlink_message_t& message) {
     mavlink_scaled_pressure_t pressure;
     mavlink_msg_scaled_pressure_decode(&message, &pressure);
     _temperatureFactGroup.temperature1()->setRawValue(pressure.temperature / 100.0);
 }
 
-void Vehicle::_handleScaledPressure2(mavlink_message_t& message) {
+void Vehicle::_handleScaledPressure2(const mavlink_message_t& message) {
     mavlink_scaled_pressure2_t pressure;
     mavlink_msg_scaled_pressure2_decode(&message, &pressure);
     _temperatureFactGroup.temperature2()->setRawValue(pressure.temperature / 100.0);
 }
 
-void Vehicle::_handleScaledPressure3(mavlink_message_t& message) {
+void Vehicle::_handleScaledPressure3(const mavlink_message_t& message) {
     mavlink_scaled_pressure3_t pressure;
     mavlink_msg_scaled_pressure3_decode(&message, &pressure);
     _temperatureFactGroup.temperature3()->setRawValue(pressure.temperature / 100.0);
@@ -2080,7 +2092,7 @@ void Vehicle::_sendMessageOnLink(LinkInterface* link, mavlink_message_t message)
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
     int len = mavlink_msg_to_send_buffer(buffer, &message);
 
-    link->writeBytesSafe((const char*)buffer, len);
+    link->writeMessageSafe(message, (const char*)buffer, len);
     _messagesSent++;
     emit messagesSentChanged();
 }
@@ -2650,6 +2662,8 @@ void Vehicle::_clearCameraTriggerPoints()
 
 void Vehicle::_flightTimerStart()
 {
+    // During batch log replay messages arrive much faster than real time, flight time follows the log instead
+    _flightTimerStartReplayUSecs = _mavlink->replayTimeUSecs();
     _flightTimer.start();
     _flightTimeUpdater.start();
     _flightDistanceFact.setRawValue(0);
@@ -2658,11 +2672,19 @@ void Vehicle::_flightTimerStart()
 
 void Vehicle::_flightTimerStop()
 {
+    _updateFlightTime();
     _flightTimeUpdater.stop();
 }
 
 void Vehicle::_updateFlightTime()
 {
+    if (_flightTimerStartReplayUSecs != 0) {
+        quint64 replayTimeUSecs = _mavlink->replayTimeUSecs();
+        if (replayTimeUSecs >= _flightTimerStartReplayUSecs) {
+            _flightTimeFact.setRawValue(static_cast<double>(replayTimeUSecs - _flightTimerStartReplayUSecs) / 1.0e6);
+        }
+        return;
+    }
     _flightTimeFact.setRawValue((double)_flightTimer.elapsed() / 1000.0);
 }
 
@@ -3491,7 +3513,7 @@ void Vehicle::_handleUnsupportedRequestAutopilotCapabilities()
     _startPlanRequest();
 }
 
-void Vehicle::_handleCommandAck(mavlink_message_t& message)
+void Vehicle::_handleCommandAck(const mavlink_message_t& message)
 {
     bool showError = false;
 
@@ -3805,7 +3827,7 @@ void Vehicle::_ackMavlinkLogData(uint16_t sequence)
     sendMessageOnLink(priorityLink(), msg);
 }
 
-void Vehicle::_handleMavlinkLoggingData(mavlink_message_t& message)
+void Vehicle::_handleMavlinkLoggingData(const mavlink_message_t& message)
 {
     mavlink_logging_data_t log;
     mavlink_msg_logging_data_decode(&message, &log);
@@ -3813,7 +3835,7 @@ void Vehicle::_handleMavlinkLoggingData(mavlink_message_t& message)
                         log.first_message_offset, QByteArray((const char*)log.data, log.length), false);
 }
 
-void Vehicle::_handleMavlinkLoggingDataAcked(mavlink_message_t& message)
+void Vehicle::_handleMavlinkLoggingDataAcked(const mavlink_message_t& message)
 {
     mavlink_logging_data_acked_t log;
     mavlink_msg_logging_data_acked_decode(&message, &log);
@@ -4461,6 +4483,7 @@ VehicleClockFactGroup::VehicleClockFactGroup(QObject* parent)
 {
     _addFact(&_currentTimeFact, _currentTimeFactName);
     _addFact(&_currentDateFact, _currentDateFactName);
+    _setPeriodicUpdates();
 
     // Start out as not available "--.--"
     _currentTimeFact.setRawValue    (std::numeric_limits<float>::quiet_NaN());
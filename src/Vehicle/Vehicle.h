@@ -41,6 +41,7 @@ class QGCCameraManager;
 class Joystick;
 class VehicleObjectAvoidance;
 class TrajectoryPoints;
+class TelemetryHistory;
 class TerrainProtocolHandler;
 
 #if defined(QGC_AIRMAP_ENABLED)
@@ -478,6 +479,9 @@ class Vehicle : public FactGroup
 {
     Q_OBJECT
 
+    // MultiVehicleManager routes incoming mavlink traffic directly to the Vehicle which owns the system id
+    friend class MultiVehicleManager;
+
 public:
     Vehicle(LinkInterface*          link,
             int                     vehicleId,
@@ -887,6 +891,9 @@ public:
 
     QmlObjectListModel* cameraTriggerPoints () { return &_cameraTriggerPoints; }
 
+    /// @return History of all numeric Facts of the vehicle, nullptr for the offline editing vehicle
+    TelemetryHistory*   telemetryHistory    () { return _telemetryHistory; }
+
     int  flowImageIndex() { return _flowImageIndex; }
 
     //-- Mavlink Logging
@@ -1129,7 +1136,7 @@ signals:
     void joystickModeChanged            (int mode);
     void joystickEnabledChanged         (bool enabled);
     void activeChanged                  (bool active);
-    void mavlinkMessageReceived         (const mavlink_message_t& message);
+    void mavlinkMessageReceived         (const MAVLinkMessageHandle& message);
     void homePositionChanged            (const QGeoCoordinate& homePosition);
     void armedPositionChanged();
     void armedChanged                   (bool armed);
@@ -1236,7 +1243,7 @@ signals:
     void isROIEnabledChanged            ();
 
 private slots:
-    void _mavlinkMessageReceived        (LinkInterface* link, mavlink_message_t message);
+    void _mavlinkMessageReceived        (LinkInterface* link, const MAVLinkMessageHandle& receivedMessage);
     void _linkInactiveOrDeleted         (LinkInterface* link);
     void _sendMessageOnLink             (LinkInterface* link, mavlink_message_t message);
     void _sendMessageMultipleNext       ();
@@ -1281,36 +1288,36 @@ private:
     void _loadSettings                  ();
     void _saveSettings                  ();
     void _startJoystick                 (bool start);
-    void _handlePing                    (LinkInterface* link, mavlink_message_t& message);
-    void _handleHomePosition            (mavlink_message_t& message);
-    void _handleHeartbeat               (mavlink_message_t& message);
-    void _handleRadioStatus             (mavlink_message_t& message);
-    void _handleRCChannels              (mavlink_message_t& message);
-    void _handleRCChannelsRaw           (mavlink_message_t& message);
-    void _handleBatteryStatus           (mavlink_message_t& message);
-    void _handleSysStatus               (mavlink_message_t& message);
-    void _handleWindCov                 (mavlink_message_t& message);
-    void _handleVibration               (mavlink_message_t& message);
-    void _handleExtendedSysState        (mavlink_message_t& message);
-    void _handleCommandAck              (mavlink_message_t& message);
-    void _handleCommandLong             (mavlink_message_t& message);
-    void _handleAutopilotVersion        (LinkInterface* link, mavlink_message_t& message);
-    void _handleProtocolVersion         (LinkInterface* link, mavlink_message_t& message);
-    void _handleGpsRawInt               (mavlink_message_t& message);
-    void _handleGlobalPositionInt       (mavlink_message_t& message);
-    void _handleAltitude                (mavlink_message_t& message);
-    void _handleVfrHud                  (mavlink_message_t& message);
-    void _handleScaledPressure          (mavlink_message_t& message);
-    void _handleScaledPressure2         (mavlink_message_t& message);
-    void _handleScaledPressure3         (mavlink_message_t& message);
-    void _handleHighLatency2            (mavlink_message_t& message);
+    void _handlePing                    (LinkInterface* link, const mavlink_message_t& message);
+    void _handleHomePosition            (const mavlink_message_t& message);
+    void _handleHeartbeat               (const mavlink_message_t& message);
+    void _handleRadioStatus             (const mavlink_message_t& message);
+    void _handleRCChannels              (const mavlink_message_t& message);
+    void _handleRCChannelsRaw           (const mavlink_message_t& message);
+    void _handleBatteryStatus           (const mavlink_message_t& message);
+    void _handleSysStatus               (const mavlink_message_t& message);
+    void _handleWindCov                 (const mavlink_message_t& message);
+    void _handleVibration               (const mavlink_message_t& message);
+    void _handleExtendedSysState        (const mavlink_message_t& message);
+    void _handleCommandAck              (const mavlink_message_t& message);
+    void _handleCommandLong             (const mavlink_message_t& message);
+    void _handleAutopilotVersion        (LinkInterface* link, const mavlink_message_t& message);
+    void _handleProtocolVersion         (LinkInterface* link, const mavlink_message_t& message);
+    void _handleGpsRawInt               (const mavlink_message_t& message);
+    void _handleGlobalPositionInt       (const mavlink_message_t& message);
+    void _handleAltitude                (const mavlink_message_t& message);
+    void _handleVfrHud                  (const mavlink_message_t& message);
+    void _handleScaledPressure          (const mavlink_message_t& message);
+    void _handleScaledPressure2         (const mavlink_message_t& message);
+    void _handleScaledPressure3         (const mavlink_message_t& message);
+    void _handleHighLatency2            (const mavlink_message_t& message);
     void _handleAttitudeWorker          (double rollRadians, double pitchRadians, double yawRadians);
-    void _handleAttitude                (mavlink_message_t& message);
-    void _handleAttitudeQuaternion      (mavlink_message_t& message);
-    void _handleAttitudeTarget          (mavlink_message_t& message);
-    void _handleDistanceSensor          (mavlink_message_t& message);
-    void _handleEstimatorStatus         (mavlink_message_t& message);
-    void _handleStatusText              (mavlink_message_t& message);
+    void _handleAttitude                (const mavlink_message_t& message);
+    void _handleAttitudeQuaternion      (const mavlink_message_t& message);
+    void _handleAttitudeTarget          (const mavlink_message_t& message);
+    void _handleDistanceSensor          (const mavlink_message_t& message);
+    void _handleEstimatorStatus         (const mavlink_message_t& message);
+    void _handleStatusText              (const mavlink_message_t& message);
     void _handleOrbitExecutionStatus    (const mavlink_message_t& message);
     void _handleMessageInterval         (const mavlink_message_t& message);
     void _handleGimbalOrientation       (const mavlink_message_t& message);
@@ -1318,7 +1325,7 @@ private:
     // ArduPilot dialect messages
 #if !defined(NO_ARDUPILOT_DIALECT)
     void _handleCameraFeedback          (const mavlink_message_t& message);
-    void _handleWind                    (mavlink_message_t& message);
+    void _handleWind                    (const mavlink_message_t& message);
 #endif
     void _handleCameraImageCaptured     (const mavlink_message_t& message);
     void _handleADSBVehicle             (const mavlink_message_t& message);
@@ -1328,8 +1335,8 @@ private:
     void _linkActiveChanged             (LinkInterface* link, bool active, int vehicleID);
     void _say                           (const QString& text);
     QString _vehicleIdSpeech            ();
-    void _handleMavlinkLoggingData      (mavlink_message_t& message);
-    void _handleMavlinkLoggingDataAcked (mavlink_message_t& message);
+    void _handleMavlinkLoggingData      (const mavlink_message_t& message);
+    void _handleMavlinkLoggingDataAcked (const mavlink_message_t& message);
     void _ackMavlinkLogData             (uint16_t sequence);
     void _sendNextQueuedMavCommand      ();
     void _updatePriorityLink            (bool updateActive, bool sendCommand);
@@ -1484,8 +1491,10 @@ private:
     int     _nextSendMessageMultipleIndex;
 
     QTime                           _flightTimer;
+    quint64                         _flightTimerStartReplayUSecs;   ///< Log time at which the flight timer started during batch log replay, 0 otherwise
     QTimer                          _flightTimeUpdater;
     TrajectoryPoints*               _trajectoryPoints;
+    TelemetryHistory*               _telemetryHistory;              ///< nullptr for the offline editing vehicle
     QmlObjectListModel              _cameraTriggerPoints;
     //QMap<QString, ADSBVehicle*>     _trafficVehicleMap;
 
@@ -453,7 +453,7 @@ QQmlApplicationEngine* QGCCorePlugin::createRootWindow(QObject *parent)
     return pEngine;
 }
 
-bool QGCCorePlugin::mavlinkMessage(Vehicle* vehicle, LinkInterface* link, mavlink_message_t message)
+bool QGCCorePlugin::mavlinkMessage(Vehicle* vehicle, LinkInterface* link, const mavlink_message_t& message)
 {
     Q_UNUSED(vehicle);
     Q_UNUSED(link);
@@ -121,7 +121,7 @@ public:
 
     /// Allows the plugin to see all mavlink traffic to a vehicle
     /// @return true: Allow vehicle to continue processing, false: Vehicle should not process message
-    virtual bool mavlinkMessage(Vehicle* vehicle, LinkInterface* link, mavlink_message_t message);
+    virtual bool mavlinkMessage(Vehicle* vehicle, LinkInterface* link, const mavlink_message_t& message);
 
     /// Allows custom builds to add custom items to the FlightMap. Objects put into QmlObjectListModel should derive from QmlComponentInfo and set the url property.
     virtual QmlObjectListModel* customMapItems();
@@ -93,8 +93,8 @@ void BluetoothLink::readBytes()
             QByteArray datagram;
             datagram.resize(_targetSocket->bytesAvailable());
             _targetSocket->read(datagram.data(), datagram.size());
-            emit bytesReceived(this, datagram);
             _logInputDataRate(datagram.length(), QDateTime::currentMSecsSinceEpoch());
+            emit bytesReceived(this, datagram);
         }
     }
 }
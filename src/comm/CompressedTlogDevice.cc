@@ -0,0 +1,317 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "CompressedTlogDevice.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(CompressedTlogDeviceLog, "CompressedTlogDeviceLog")
+
+const char* CompressedTlogDevice::_fileMagic =     "QGCTLOGZ";
+const char* CompressedTlogDevice::_blockMagic =    "QGCB";
+const char* CompressedTlogDevice::_indexMagic =    "QGCTLZIX";
+
+CompressedTlogDevice::CompressedTlogDevice(const QString& filename, QObject* parent)
+    : QIODevice         (parent)
+    , _file             (filename)
+    , _size             (0)
+    , _position         (0)
+    , _currentBlockIndex(-1)
+{
+
+}
+
+CompressedTlogDevice::~CompressedTlogDevice()
+{
+    close();
+}
+
+bool CompressedTlogDevice::isCompressedTlog(const QString& filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return file.read(8) == QByteArray(_fileMagic, 8);
+}
+
+QIODevice* CompressedTlogDevice::openLog(const QString& filename, QString& errorString)
+{
+    QIODevice* device;
+    if (isCompressedTlog(filename)) {
+        device = new CompressedTlogDevice(filename);
+    } else {
+        device = new QFile(filename);
+    }
+    if (!device->open(QIODevice::ReadOnly)) {
+        errorString = tr("Unable to open log file: '%1', error: %2").arg(filename).arg(device->errorString());
+        delete device;
+        return nullptr;
+    }
+    return device;
+}
+
+QByteArray CompressedTlogDevice::fileHeader(void)
+{
+    QByteArray header(fileHeaderSize, 0);
+    memcpy(header.data(), _fileMagic, 8);
+    qToLittleEndian<quint32>(_version, header.data() + 8);
+    return header;
+}
+
+QByteArray CompressedTlogDevice::encodeBlock(const QByteArray& records, quint64 firstTimestampUSecs, Block_t& block)
+{
+    QByteArray payload = qCompress(records);
+    QByteArray encoded(blockHeaderSize, 0);
+    char* header = encoded.data();
+
+    memcpy(header, _blockMagic, 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), header + 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(records.size()), header + 8);
+    qToLittleEndian<quint64>(firstTimestampUSecs, header + 16);
+    encoded.append(payload);
+
+    block.compressedSize        = static_cast<quint32>(payload.size());
+    block.uncompressedSize      = static_cast<quint32>(records.size());
+    block.firstTimestampUSecs   = firstTimestampUSecs;
+    return encoded;
+}
+
+QByteArray CompressedTlogDevice::encodeIndex(const QVector<Block_t>& blocks, qint64 indexOffset)
+{
+    QByteArray encoded(_indexHeaderSize + (blocks.count() * _indexEntrySize) + _trailerSize, 0);
+    char* data = encoded.data();
+
+    memcpy(data, _indexMagic, 8);
+    qToLittleEndian<quint64>(static_cast<quint64>(blocks.count()), data + 8);
+    data += _indexHeaderSize;
+    for (const Block_t& block: blocks) {
+        qToLittleEndian<quint64>(static_cast<quint64>(block.fileOffset),          data);
+        qToLittleEndian<quint64>(static_cast<quint64>(block.uncompressedOffset),  data + 8);
+        qToLittleEndian<quint64>(block.firstTimestampUSecs,                       data + 16);
+        qToLittleEndian<quint32>(block.compressedSize,                            data + 24);
+        qToLittleEndian<quint32>(block.uncompressedSize,                          data + 28);
+        data += _indexEntrySize;
+    }
+    qToLittleEndian<quint64>(static_cast<quint64>(indexOffset), data);
+    memcpy(data + 8, _indexMagic, 8);
+    return encoded;
+}
+
+bool CompressedTlogDevice::open(OpenMode mode)
+{
+    if (mode & QIODevice::WriteOnly) {
+        setErrorString(tr("Compressed logs are read only"));
+        return false;
+    }
+    if (!_file.open(QIODevice::ReadOnly)) {
+        setErrorString(_file.errorString());
+        return false;
+    }
+    if (_file.read(8) != QByteArray(_fileMagic, 8)) {
+        setErrorString(tr("Not a compressed log file"));
+        _file.close();
+        return false;
+    }
+
+    _blocks.clear();
+    if (!_readIndex()) {
+        qCDebug(CompressedTlogDeviceLog) << "No block index, scanning blocks" << _file.fileName();
+        _blocks.clear();
+        if (!_scanBlocks()) {
+            setErrorString(tr("Compressed log file is corrupt"));
+            _file.close();
+            return false;
+        }
+    }
+
+    _size = 0;
+    if (!_blocks.isEmpty()) {
+        _size = _blocks.last().uncompressedOffset + _blocks.last().uncompressedSize;
+    }
+    _position = 0;
+    _currentBlockIndex = -1;
+    _currentBlockData.clear();
+
+    // Unbuffered since each block is already held decompressed in memory
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+void CompressedTlogDevice::close(void)
+{
+    if (isOpen()) {
+        QIODevice::close();
+    }
+    _file.close();
+    _blocks.clear();
+    _currentBlockData.clear();
+    _currentBlockIndex = -1;
+    _size = 0;
+    _position = 0;
+}
+
+bool CompressedTlogDevice::seek(qint64 pos)
+{
+    if (pos < 0 || pos > _size || !QIODevice::seek(pos)) {
+        return false;
+    }
+    _position = pos;
+    return true;
+}
+
+qint64 CompressedTlogDevice::readData(char* data, qint64 maxSize)
+{
+    qint64 cRead = 0;
+
+    while (cRead < maxSize && _position < _size) {
+        int blockIndex = _findBlock(_position);
+        if (blockIndex < 0 || !_loadBlock(blockIndex)) {
+            return cRead ? cRead : -1;
+        }
+        const Block_t& block = _blocks[blockIndex];
+        qint64 blockPos = _position - block.uncompressedOffset;
+        qint64 cCopy = qMin(maxSize - cRead, static_cast<qint64>(block.uncompressedSize) - blockPos);
+        memcpy(data + cRead, _currentBlockData.constData() + blockPos, static_cast<size_t>(cCopy));
+        cRead += cCopy;
+        _position += cCopy;
+    }
+
+    return cRead;
+}
+
+qint64 CompressedTlogDevice::writeData(const char* /*data*/, qint64 /*maxSize*/)
+{
+    return -1;
+}
+
+/// Reads the block index from the end of the file
+bool CompressedTlogDevice::_readIndex(void)
+{
+    qint64 fileSize = _file.size();
+    if (fileSize < fileHeaderSize + _indexHeaderSize + _trailerSize || !_file.seek(fileSize - _trailerSize)) {
+        return false;
+    }
+    QByteArray trailer = _file.read(_trailerSize);
+    if (trailer.size() != _trailerSize || memcmp(trailer.constData() + 8, _indexMagic, 8) != 0) {
+        return false;
+    }
+
+    qint64 indexOffset = static_cast<qint64>(qFromLittleEndian<quint64>(trailer.constData()));
+    if (indexOffset < fileHeaderSize || indexOffset > fileSize - _trailerSize - _indexHeaderSize || !_file.seek(indexOffset)) {
+        return false;
+    }
+    QByteArray index = _file.read(fileSize - _trailerSize - indexOffset);
+    if (index.size() < _indexHeaderSize || memcmp(index.constData(), _indexMagic, 8) != 0) {
+        return false;
+    }
+    quint64 blockCount = qFromLittleEndian<quint64>(index.constData() + 8);
+    if (static_cast<quint64>(index.size()) != _indexHeaderSize + (blockCount * _indexEntrySize)) {
+        return false;
+    }
+
+    const char* entry = index.constData() + _indexHeaderSize;
+    qint64 uncompressedOffset = 0;
+    for (quint64 i=0; i<blockCount; i++) {
+        Block_t block;
+        block.fileOffset            = static_cast<qint64>(qFromLittleEndian<quint64>(entry));
+        block.uncompressedOffset    = static_cast<qint64>(qFromLittleEndian<quint64>(entry + 8));
+        block.firstTimestampUSecs   = qFromLittleEndian<quint64>(entry + 16);
+        block.compressedSize        = qFromLittleEndian<quint32>(entry + 24);
+        block.uncompressedSize      = qFromLittleEndian<quint32>(entry + 28);
+        if (block.uncompressedOffset != uncompressedOffset || block.fileOffset + blockHeaderSize + block.compressedSize > indexOffset) {
+            return false;
+        }
+        uncompressedOffset += block.uncompressedSize;
+        _blocks.append(block);
+        entry += _indexEntrySize;
+    }
+
+    return true;
+}
+
+/// Rebuilds the block list by walking the block headers. Used for files whose recording did not finish cleanly.
+/// A partially written last block is ignored.
+bool CompressedTlogDevice::_scanBlocks(void)
+{
+    qint64 fileSize = _file.size();
+    qint64 fileOffset = fileHeaderSize;
+    qint64 uncompressedOffset = 0;
+
+    while (fileOffset + blockHeaderSize <= fileSize) {
+        if (!_file.seek(fileOffset)) {
+            return false;
+        }
+        QByteArray header = _file.read(blockHeaderSize);
+        if (header.size() != blockHeaderSize || memcmp(header.constData(), _blockMagic, 4) != 0) {
+            break;
+        }
+
+        Block_t block;
+        block.fileOffset            = fileOffset;
+        block.uncompressedOffset    = uncompressedOffset;
+        block.compressedSize        = qFromLittleEndian<quint32>(header.constData() + 4);
+        block.uncompressedSize      = qFromLittleEndian<quint32>(header.constData() + 8);
+        block.firstTimestampUSecs   = qFromLittleEndian<quint64>(header.constData() + 16);
+        if (fileOffset + blockHeaderSize + block.compressedSize > fileSize) {
+            qCWarning(CompressedTlogDeviceLog) << "Ignoring truncated block at" << fileOffset << _file.fileName();
+            break;
+        }
+
+        _blocks.append(block);
+        fileOffset += blockHeaderSize + block.compressedSize;
+        uncompressedOffset += block.uncompressedSize;
+    }
+
+    return _file.seek(0);
+}
+
+/// @return Index of the block which contains the specified uncompressed position, -1 if none
+int CompressedTlogDevice::_findBlock(qint64 position) const
+{
+    if (_currentBlockIndex != -1) {
+        const Block_t& block = _blocks[_currentBlockIndex];
+        if (position >= block.uncompressedOffset && position < block.uncompressedOffset + block.uncompressedSize) {
+            return _currentBlockIndex;
+        }
+    }
+
+    auto iter = std::upper_bound(_blocks.constBegin(), _blocks.constEnd(), position, [](qint64 pos, const Block_t& block) {
+        return pos < block.uncompressedOffset;
+    });
+    if (iter == _blocks.constBegin()) {
+        return -1;
+    }
+    return static_cast<int>(iter - _blocks.constBegin()) - 1;
+}
+
+bool CompressedTlogDevice::_loadBlock(int blockIndex)
+{
+    if (blockIndex == _currentBlockIndex) {
+        return true;
+    }
+
+    const Block_t& block = _blocks[blockIndex];
+    if (!_file.seek(block.fileOffset + blockHeaderSize)) {
+        return false;
+    }
+    QByteArray data = qUncompress(_file.read(block.compressedSize));
+    if (static_cast<quint32>(data.size()) != block.uncompressedSize) {
+        qCWarning(CompressedTlogDeviceLog) << "Block decode failed" << blockIndex << _file.fileName();
+        setErrorString(tr("Compressed log block %1 is corrupt").arg(blockIndex));
+        _currentBlockIndex = -1;
+        return false;
+    }
+
+    _currentBlockData = data;
+    _currentBlockIndex = blockIndex;
+    return true;
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QIODevice>
+#include <QFile>
+#include <QVector>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(CompressedTlogDeviceLog)
+
+/// Read only, random access view of a block compressed telemetry log. Reading the device returns the same byte stream
+/// as a standard tlog (8 byte big endian timestamp followed by the raw packet), so existing tlog readers work
+/// unchanged and file positions are positions in the uncompressed stream.
+///
+/// Container layout, all values little endian:
+///     header      "QGCTLOGZ", u32 version, u32 reserved
+///     blocks      "QGCB", u32 compressed size, u32 uncompressed size, u32 reserved, u64 first timestamp,
+///                 followed by the qCompress output for a run of whole tlog records
+///     index       "QGCTLZIX", u64 block count, per block: u64 file offset, u64 uncompressed offset,
+///                 u64 first timestamp, u32 compressed size, u32 uncompressed size
+///     trailer     u64 index offset, "QGCTLZIX"
+///
+/// Every block holds whole records so it can be decoded on its own. The index and trailer are written when recording
+/// stops. A file without them (for example after a crash) is still readable, the blocks are found by walking the
+/// block headers instead.
+class CompressedTlogDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    CompressedTlogDevice(const QString& filename, QObject* parent = nullptr);
+    ~CompressedTlogDevice();
+
+    typedef struct {
+        qint64  fileOffset;             ///< Offset of the block header in the container
+        qint64  uncompressedOffset;     ///< Offset of the first block byte in the uncompressed stream
+        quint64 firstTimestampUSecs;    ///< Timestamp of the first record in the block
+        quint32 compressedSize;
+        quint32 uncompressedSize;
+    } Block_t;
+
+    QString fileName    (void) const { return _file.fileName(); }
+    int     blockCount  (void) const { return _blocks.count(); }
+    Block_t block       (int blockIndex) const { return _blocks[blockIndex]; }
+
+    /// @return true: file starts with the compressed tlog header
+    static bool isCompressedTlog(const QString& filename);
+
+    /// Opens a tlog for reading, compressed or not
+    /// @return Opened device owned by the caller, nullptr on failure with errorString set
+    static QIODevice* openLog(const QString& filename, QString& errorString);
+
+    // Container encoding, used by the writer
+    static QByteArray fileHeader    (void);
+    static QByteArray encodeBlock   (const QByteArray& records, quint64 firstTimestampUSecs, Block_t& block);
+    static QByteArray encodeIndex   (const QVector<Block_t>& blocks, qint64 indexOffset);
+
+    // Overrides from QIODevice
+    bool    open        (OpenMode mode) override;
+    void    close       (void) override;
+    bool    isSequential(void) const override { return false; }
+    qint64  size        (void) const override { return _size; }
+    bool    seek        (qint64 pos) override;
+
+    static const int fileHeaderSize     = 16;
+    static const int blockHeaderSize    = 24;
+
+protected:
+    // Overrides from QIODevice
+    qint64 readData (char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    bool _readIndex     (void);
+    bool _scanBlocks    (void);
+    int  _findBlock     (qint64 position) const;
+    bool _loadBlock     (int blockIndex);
+
+    QFile               _file;
+    QVector<Block_t>    _blocks;
+    qint64              _size;
+    qint64              _position;
+    int                 _currentBlockIndex;
+    QByteArray          _currentBlockData;
+
+    static const char*      _fileMagic;
+    static const char*      _blockMagic;
+    static const char*      _indexMagic;
+    static const quint32    _version            = 1;
+    static const int        _indexEntrySize     = 32;
+    static const int        _indexHeaderSize    = 16;
+    static const int        _trailerSize        = 16;
+};
@@ -47,7 +47,9 @@ LinkInterface::LinkInterface(SharedLinkConfigurationPointer& config, bool isPX4F
     , _config                   (config)
     , _highLatency              (config->isHighLatency())
     , _mavlinkChannelSet        (false)
-    , _enableRateCollection     (false)
+    , _sendQueueWakePending     (false)
+    , _sendQueueTimerActive     (false)
+    , _enableRateCollection     (true)
     , _decodedFirstMavlinkPacket(false)
     , _isPX4Flow                (isPX4Flow)
 {
@@ -55,123 +57,68 @@ LinkInterface::LinkInterface(SharedLinkConfigurationPointer& config, bool isPX4F
 
     _config->setLink(this);
 
-    // Initialize everything for the data rate calculation buffers.
-    _inDataIndex  = 0;
-    _outDataIndex = 0;
-
-    // Initialize our data rate buffers.
-    memset(_inDataWriteAmounts, 0, sizeof(_inDataWriteAmounts));
-    memset(_inDataWriteTimes,   0, sizeof(_inDataWriteTimes));
-    memset(_outDataWriteAmounts,0, sizeof(_outDataWriteAmounts));
-    memset(_outDataWriteTimes,  0, sizeof(_outDataWriteTimes));
-
-    QObject::connect(this, &LinkInterface::_invokeWriteBytes, this, &LinkInterface::_writeBytes);
+    QObject::connect(this, &LinkInterface::_invokeProcessSendQueue, this, &LinkInterface::_processSendQueue);
     qRegisterMetaType<LinkInterface*>("LinkInterface*");
 }
 
-/// This function logs the send times and amounts of datas for input. Data is used for calculating
-/// the transmission rate.
-///     @param byteCount Number of bytes received
-///     @param time Time in ms send occurred
-void LinkInterface::_logInputDataRate(quint64 byteCount, qint64 time) {
-    if(_enableRateCollection)
-        _logDataRateToBuffer(_inDataWriteAmounts, _inDataWriteTimes, &_inDataIndex, byteCount, time);
+void LinkInterface::_logInputDataRate(quint64 byteCount, qint64 time, int packetCount)
+{
+    if (_enableRateCollection.load(std::memory_order_relaxed)) {
+        _inStats.record(byteCount, static_cast<quint32>(packetCount), time);
+        _dispatchLatency.markReceived();
+    }
 }
 
-/// This function logs the send times and amounts of datas for output. Data is used for calculating
-/// the transmission rate.
-///     @param byteCount Number of bytes sent
-///     @param time Time in ms receive occurred
-void LinkInterface::_logOutputDataRate(quint64 byteCount, qint64 time) {
-    if(_enableRateCollection)
-        _logDataRateToBuffer(_outDataWriteAmounts, _outDataWriteTimes, &_outDataIndex, byteCount, time);
+void LinkInterface::_logOutputDataRate(quint64 byteCount, qint64 time)
+{
+    if (_enableRateCollection.load(std::memory_order_relaxed)) {
+        _outStats.record(byteCount, 1, time);
+    }
 }
 
-/**
-     * @brief logDataRateToBuffer Stores transmission times/amounts for statistics
-     *
-     * This function logs the send times and amounts of datas to the given circular buffers.
-     * This data is used for calculating the transmission rate.
-     *
-     * @param bytesBuffer[out] The buffer to write the bytes value into.
-     * @param timeBuffer[out] The buffer to write the time value into
-     * @param writeIndex[out] The write index used for this buffer.
-     * @param bytes The amount of bytes transmit.
-     * @param time The time (in ms) this transmission occurred.
-     */
-void LinkInterface::_logDataRateToBuffer(quint64 *bytesBuffer, qint64 *timeBuffer, int *writeIndex, quint64 bytes, qint64 time)
+QVariantList LinkInterface::receiveBurstHistogram(void) const
 {
-    QMutexLocker dataRateLocker(&_dataRateMutex);
+    QVariantList histogram;
 
-    int i = *writeIndex;
+    for (quint64 count: _inStats.burstHistogram()) {
+        histogram.append(count);
+    }
 
-    // Now write into the buffer, if there's no room, we just overwrite the first data point.
-    bytesBuffer[i] = bytes;
-    timeBuffer[i] = time;
+    return histogram;
+}
 
-    // Increment and wrap the write index
-    ++i;
-    if (i == _dataRateBufferSize)
-    {
-        i = 0;
+void LinkInterface::_queueBytes(LinkSendQueue::Priority_t priority, quint64 coalesceKey, const QByteArray& bytes)
+{
+    _sendQueue.enqueue(priority, coalesceKey, bytes);
+    if (!_sendQueueWakePending.exchange(true)) {
+        emit _invokeProcessSendQueue();
     }
-    *writeIndex = i;
 }
 
-/**
-     * @brief getCurrentDataRate Get the current data rate given a data rate buffer.
-     *
-     * This function attempts to use the times and number of bytes transmit into a current data rate
-     * estimation. Since it needs to use timestamps to get the timeperiods over when the data was sent,
-     * this is effectively a global data rate over the last _dataRateBufferSize - 1 data points. Also note
-     * that data points older than NOW - dataRateCurrentTimespan are ignored.
-     *
-     * @param index The first valid sample in the data rate buffer. Refers to the oldest time sample.
-     * @param dataWriteTimes The time, in ms since epoch, that each data sample took place.
-     * @param dataWriteAmounts The amount of data (in bits) that was transferred.
-     * @return The bits per second of data transferrence of the interface over the last [-statsCurrentTimespan, 0] timespan.
-     */
-qint64 LinkInterface::_getCurrentDataRate(int index, const qint64 dataWriteTimes[], const quint64 dataWriteAmounts[]) const
+void LinkInterface::_processSendQueue(void)
 {
-    const qint64 now = QDateTime::currentMSecsSinceEpoch();
-
-    // Limit the time we calculate to the recent past
-    const qint64 cutoff = now - _dataRateCurrentTimespan;
-
-    // Grab the mutex for working with the stats variables
-    QMutexLocker dataRateLocker(&_dataRateMutex);
-
-    // Now iterate through the buffer of all received data packets adding up all values
-    // within now and our cutof.
-    qint64 totalBytes = 0;
-    qint64 totalTime = 0;
-    qint64 lastTime = 0;
-    int size = _dataRateBufferSize;
-    while (size-- > 0)
-    {
-        // If this data is within our cutoff time, include it in our calculations.
-        // This also accounts for when the buffer is empty and filled with 0-times.
-        if (dataWriteTimes[index] > cutoff && lastTime > 0) {
-            // Track the total time, using the previous time as our timeperiod.
-            totalTime += dataWriteTimes[index] - lastTime;
-            totalBytes += dataWriteAmounts[index];
-        }
+    _sendQueueWakePending = false;
 
-        // Track the last time sample for doing timespan calculations
-        lastTime = dataWriteTimes[index];
+    // Serial style framing puts 10 bits on the wire for each byte. Fast links end up with budgets so large
+    // that the rate limits never kick in.
+    const qint64    bytesPerSecond  = getConnectionSpeed() / 10;
+    QByteArray      bytes;
+    int             waitMSecs       = 0;
 
-        // Increment and wrap the index if necessary.
-        if (++index == _dataRateBufferSize)
-        {
-            index = 0;
-        }
+    while (_sendQueue.takeNext(QDateTime::currentMSecsSinceEpoch(), bytesPerSecond, bytes, waitMSecs)) {
+        _writeBytes(bytes);
     }
 
-    // Return the final calculated value in bits / s, converted from bytes/ms.
-    qint64 dataRate = (totalTime != 0)?(qint64)((float)totalBytes * 8.0f / ((float)totalTime / 1000.0f)):0;
+    if (waitMSecs > 0 && !_sendQueueTimerActive) {
+        _sendQueueTimerActive = true;
+        QTimer::singleShot(waitMSecs, this, &LinkInterface::_sendQueueTimeout);
+    }
+}
 
-    // Finally return our calculated data rate.
-    return dataRate;
+void LinkInterface::_sendQueueTimeout(void)
+{
+    _sendQueueTimerActive = false;
+    _processSendQueue();
 }
 
 /// Sets the mavlink channel to use for this link
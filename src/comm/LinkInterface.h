@@ -17,10 +17,15 @@
 #include <QSharedPointer>
 #include <QDebug>
 #include <QTimer>
+#include <QVariantList>
 
 #include "QGCMAVLink.h"
 #include "LinkConfiguration.h"
 #include "MavlinkMessagesTimer.h"
+#include "LinkStatistics.h"
+#include "LinkSendQueue.h"
+
+#include <atomic>
 
 class LinkManager;
 
@@ -87,6 +92,8 @@ public:
 
     /**
      * @Brief Enable/Disable data rate collection
+     *
+     * Collection is enabled by default. It only consists of a few relaxed atomic updates per read/write.
      **/
     void enableDataRate(bool enable)
     {
@@ -96,28 +103,50 @@ public:
     /**
      * @Brief Get the current incoming data rate.
      *
-     * This should be over a short timespan, something like 100ms. A precise value isn't necessary,
-     * and this can be filtered, but should be a reasonable estimate of current data rate.
+     * Calculated over a sliding window of roughly one second. Safe to call from any thread, it never blocks
+     * the link thread.
      *
      * @return The data rate of the interface in bits per second, 0 if unknown
      **/
     qint64 getCurrentInputDataRate() const
     {
-        return _getCurrentDataRate(_inDataIndex, _inDataWriteTimes, _inDataWriteAmounts);
+        return static_cast<qint64>(_inStats.bytesPerSecond(QDateTime::currentMSecsSinceEpoch()) * 8.0);
     }
 
     /**
      * @Brief Get the current outgoing data rate.
      *
-     * This should be over a short timespan, something like 100ms. A precise value isn't necessary,
-     * and this can be filtered, but should be a reasonable estimate of current data rate.
+     * Calculated over a sliding window of roughly one second. Safe to call from any thread, it never blocks
+     * the link thread.
      *
      * @return The data rate of the interface in bits per second, 0 if unknown
      **/
     qint64 getCurrentOutputDataRate() const
     {
-        return _getCurrentDataRate(_outDataIndex, _outDataWriteTimes, _outDataWriteAmounts);
+        return static_cast<qint64>(_outStats.bytesPerSecond(QDateTime::currentMSecsSinceEpoch()) * 8.0);
     }
+
+    // Per link traffic statistics. All of these are safe to call from any thread.
+    Q_INVOKABLE double  inputBytesPerSecond     (void) const { return _inStats.bytesPerSecond(QDateTime::currentMSecsSinceEpoch()); }
+    Q_INVOKABLE double  inputPacketsPerSecond   (void) const { return _inStats.packetsPerSecond(QDateTime::currentMSecsSinceEpoch()); }
+    Q_INVOKABLE double  outputBytesPerSecond    (void) const { return _outStats.bytesPerSecond(QDateTime::currentMSecsSinceEpoch()); }
+    Q_INVOKABLE double  outputPacketsPerSecond  (void) const { return _outStats.packetsPerSecond(QDateTime::currentMSecsSinceEpoch()); }
+    Q_INVOKABLE double  dispatchLatencyUSecs    (void) const { return _dispatchLatency.averageUSecs(); }
+    Q_INVOKABLE double  maxDispatchLatencyUSecs (void) const { return _dispatchLatency.maxUSecs(); }
+
+    /// @return Number of receives falling in each burst size bucket, see LinkTrafficStatistics::burstHistogram
+    Q_INVOKABLE QVariantList receiveBurstHistogram(void) const;
+
+    const LinkTrafficStatistics& inputStatistics    (void) const { return _inStats; }
+    const LinkTrafficStatistics& outputStatistics   (void) const { return _outStats; }
+    const LinkLatencyStatistics& dispatchLatency    (void) const { return _dispatchLatency; }
+
+    /// Called by the consumer of bytesReceived when it starts processing received bytes. Used to measure the
+    /// receive to dispatch latency of the link.
+    void logReceiveDispatched(void) { _dispatchLatency.markDispatched(); }
+
+    /// Outbound packet scheduler, packets written with writeBytesSafe/writeMessageSafe go through here
+    const LinkSendQueue& sendQueue(void) const { return _sendQueue; }
     
     /// mavlink channel to use for this link, as used by mavlink_parse_char. The mavlink channel is only
     /// set into the link when it is added to LinkManager
@@ -148,21 +177,40 @@ public slots:
      *
      * @param bytes:  The pointer to the byte array containing the data
      * @param length: The length of the data array
+     *
+     * Raw bytes are queued with command priority, use writeMessageSafe for mavlink packets.
      **/
     void writeBytesSafe(const char *bytes, int length)
     {
-        emit _invokeWriteBytes(QByteArray(bytes, length));
+        _queueBytes(LinkSendQueue::PriorityCommand, 0, QByteArray(bytes, length));
+    }
+
+    /**
+     * @brief Thread safe write of an encoded mavlink message.
+     *
+     * The message is used to pick the send priority class and to coalesce superseded control packets.
+     *
+     * @param message: The message which was encoded into bytes
+     * @param bytes:  The encoded message
+     * @param length: The length of the encoded message
+     **/
+    void writeMessageSafe(const mavlink_message_t& message, const char *bytes, int length)
+    {
+        _queueBytes(LinkSendQueue::priorityForMessage(message), LinkSendQueue::coalesceKeyForMessage(message), QByteArray(bytes, length));
     }
 
 private slots:
     virtual void _writeBytes(const QByteArray) = 0;
 
+    void _processSendQueue(void);
+    void _sendQueueTimeout(void);
+
     void _activeChanged(bool active, int vehicle_id);
     
 signals:
     void autoconnectChanged(bool autoconnect);
     void activeChanged(LinkInterface* link, bool active, int vehicle_id);
-    void _invokeWriteBytes(QByteArray);
+    void _invokeProcessSendQueue(void);
     void highLatencyChanged(bool highLatency);
 
     /// Signalled when a link suddenly goes away due to it being removed by for example pulling the cable to the connection.
@@ -216,51 +264,22 @@ protected:
     // Links are only created by LinkManager so constructor is not public
     LinkInterface(SharedLinkConfigurationPointer& config, bool isPX4Flow = false);
 
-    /// This function logs the send times and amounts of datas for input. Data is used for calculating
-    /// the transmission rate.
+    /// This function logs the receive times and amounts of data for input. Must be called before bytesReceived
+    /// is emitted since it also marks the start of the receive to dispatch latency measurement.
     ///     @param byteCount Number of bytes received
-    ///     @param time Time in ms send occurred
-    void _logInputDataRate(quint64 byteCount, qint64 time);
+    ///     @param time Time in ms receive occurred
+    ///     @param packetCount Number of datagrams/reads making up byteCount
+    void _logInputDataRate(quint64 byteCount, qint64 time, int packetCount = 1);
     
-    /// This function logs the send times and amounts of datas for output. Data is used for calculating
-    /// the transmission rate.
+    /// This function logs the send times and amounts of data for output.
     ///     @param byteCount Number of bytes sent
-    ///     @param time Time in ms receive occurred
+    ///     @param time Time in ms send occurred
     void _logOutputDataRate(quint64 byteCount, qint64 time);
 
     SharedLinkConfigurationPointer _config;
     bool _highLatency;
 
 private:
-    /**
-     * @brief logDataRateToBuffer Stores transmission times/amounts for statistics
-     *
-     * This function logs the send times and amounts of datas to the given circular buffers.
-     * This data is used for calculating the transmission rate.
-     *
-     * @param bytesBuffer[out] The buffer to write the bytes value into.
-     * @param timeBuffer[out] The buffer to write the time value into
-     * @param writeIndex[out] The write index used for this buffer.
-     * @param bytes The amount of bytes transmit.
-     * @param time The time (in ms) this transmission occurred.
-     */
-    void _logDataRateToBuffer(quint64 *bytesBuffer, qint64 *timeBuffer, int *writeIndex, quint64 bytes, qint64 time);
-
-    /**
-     * @brief getCurrentDataRate Get the current data rate given a data rate buffer.
-     *
-     * This function attempts to use the times and number of bytes transmit into a current data rate
-     * estimation. Since it needs to use timestamps to get the timeperiods over when the data was sent,
-     * this is effectively a global data rate over the last _dataRateBufferSize - 1 data points. Also note
-     * that data points older than NOW - dataRateCurrentTimespan are ignored.
-     *
-     * @param index The first valid sample in the data rate buffer. Refers to the oldest time sample.
-     * @param dataWriteTimes The time, in ms since epoch, that each data sample took place.
-     * @param dataWriteAmounts The amount of data (in bits) that was transferred.
-     * @return The bits per second of data transferrence of the interface over the last [-statsCurrentTimespan, 0] timespan.
-     */
-    qint64 _getCurrentDataRate(int index, const qint64 dataWriteTimes[], const quint64 dataWriteAmounts[]) const;
-
     /**
      * @brief Connect this interface logically
      *
@@ -272,6 +291,8 @@ private:
 
     /// Sets the mavlink channel to use for this link
     void _setMavlinkChannel(uint8_t channel);
+
+    void _queueBytes(LinkSendQueue::Priority_t priority, quint64 coalesceKey, const QByteArray& bytes);
     
     /**
      * @brief startMavlinkMessagesTimer
@@ -291,25 +312,16 @@ private:
     bool _mavlinkChannelSet;    ///< true: _mavlinkChannel has been set
     uint8_t _mavlinkChannel;    ///< mavlink channel to use for this link, as used by mavlink_parse_char
     
-    static const int _dataRateBufferSize = 20; ///< Specify how many data points to capture for data rate calculations.
-    
-    static const qint64 _dataRateCurrentTimespan = 500; ///< Set the maximum age of samples to use for data calculations (ms).
-    
-    // Implement a simple circular buffer for storing when and how much data was received.
-    // Used for calculating the incoming data rate. Use with *StatsBuffer() functions.
-    int     _inDataIndex;
-    quint64 _inDataWriteAmounts[_dataRateBufferSize]; // In bytes
-    qint64  _inDataWriteTimes[_dataRateBufferSize]; // in ms
-    
-    // Implement a simple circular buffer for storing when and how much data was transmit.
-    // Used for calculating the outgoing data rate. Use with *StatsBuffer() functions.
-    int     _outDataIndex;
-    quint64 _outDataWriteAmounts[_dataRateBufferSize]; // In bytes
-    qint64  _outDataWriteTimes[_dataRateBufferSize]; // in ms
-    
-    mutable QMutex _dataRateMutex; // Mutex for accessing the data rate member variables
+    // Written from the link thread, read from anywhere without locking
+    LinkTrafficStatistics   _inStats;
+    LinkTrafficStatistics   _outStats;
+    LinkLatencyStatistics   _dispatchLatency;
+
+    LinkSendQueue       _sendQueue;
+    std::atomic<bool>   _sendQueueWakePending;  ///< true: _invokeProcessSendQueue is already on its way to the link thread
+    bool                _sendQueueTimerActive;  ///< true: Waiting on rate limits, only accessed from the link thread
 
-    bool _enableRateCollection;
+    std::atomic<bool> _enableRateCollection;
     bool _decodedFirstMavlinkPacket;    ///< true: link has correctly decoded it's first mavlink packet
     bool _isPX4Flow;
 
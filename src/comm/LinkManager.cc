@@ -85,7 +85,7 @@ void LinkManager::setToolbox(QGCToolbox *toolbox)
     _autoConnectSettings = toolbox->settingsManager()->autoConnectSettings();
     _mavlinkProtocol = _toolbox->mavlinkProtocol();
 
-    connect(_mavlinkProtocol, &MAVLinkProtocol::messageReceived, this, &LinkManager::_mavlinkMessageReceived);
+    connect(_mavlinkProtocol, &MAVLinkProtocol::sharedMessageReceived, this, &LinkManager::_mavlinkMessageReceived);
 
     connect(&_portListTimer, &QTimer::timeout, this, &LinkManager::_updateAutoConnectLinks);
     _portListTimer.start(_autoconnectUpdateTimerMSecs); // timeout must be long enough to get past bootloader on second pass
@@ -198,8 +198,8 @@ void LinkManager::_addLink(LinkInterface* link)
     }
 
     connect(link, &LinkInterface::communicationError,   _app,               &QGCApplication::criticalMessageBoxOnMainThread);
-    connect(link, &LinkInterface::bytesReceived,        _mavlinkProtocol,   &MAVLinkProtocol::receiveBytes);
     connect(link, &LinkInterface::bytesSent,            _mavlinkProtocol,   &MAVLinkProtocol::logSentBytes);
+    _mavlinkProtocol->startLinkParsing(link);
 
     _mavlinkProtocol->resetMetadataForLink(link);
     _mavlinkProtocol->setVersion(_mavlinkProtocol->getCurrentVersion());
@@ -264,6 +264,9 @@ void LinkManager::_deleteLink(LinkInterface* link)
         return;
     }
 
+    // Parser thread must be gone before the channel can be handed out again
+    _mavlinkProtocol->stopLinkParsing(link);
+
     // Free up the mavlink channel associated with this link
     _freeMavlinkChannel(link->mavlinkChannel());
 
@@ -922,7 +925,8 @@ void LinkManager::_activeLinkCheck(void)
         _activeLinkCheckTimer.stop();
     }
     if (!found && link) {
-        // See if we can get an NSH prompt on this link
+        // See if we can get an NSH prompt on this link. Raw bytes go through the send queue at command priority,
+        // which is never dropped.
         bool foundNSHPrompt = false;
         link->writeBytesSafe("\r", 1);
         QSignalSpy spy(link, SIGNAL(bytesReceived(LinkInterface*, QByteArray)));
@@ -1009,8 +1013,8 @@ void LinkManager::_freeMavlinkChannel(int channel)
     _mavlinkChannelsUsedBitMask &= ~(1 << channel);
 }
 
-void LinkManager::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message) {
-    link->startMavlinkMessagesTimer(message.sysid);
+void LinkManager::_mavlinkMessageReceived(LinkInterface* link, MAVLinkMessageHandle message) {
+    link->startMavlinkMessagesTimer(message->sysid);
 }
 
 LogReplayLink* LinkManager::startLogReplay(const QString& logFile)
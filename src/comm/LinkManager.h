@@ -206,7 +206,7 @@ private:
     SerialConfiguration* _autoconnectConfigurationsContainsPort(const QString& portName);
 #endif
 
-    void _mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message);
+    void _mavlinkMessageReceived(LinkInterface* link, MAVLinkMessageHandle message);
 
     bool    _configUpdateSuspended;                     ///< true: stop updating configuration list
     bool    _configurationsLoaded;                      ///< true: Link configurations have been loaded
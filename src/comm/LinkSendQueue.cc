@@ -0,0 +1,213 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkSendQueue.h"
+
+#include <QMutexLocker>
+
+const double LinkSendQueue::_classShare[PriorityCount]      = { 1.0, 1.0, 0.6, 0.4, 0.4 };
+const int    LinkSendQueue::_maxQueuedBytes[PriorityCount]  = { 4 * 1024, 16 * 1024, 64 * 1024, 32 * 1024, 32 * 1024 };
+const bool   LinkSendQueue::_classDroppable[PriorityCount]  = { true, false, false, false, true };
+const double LinkSendQueue::_linkShare                      = 0.9;
+const int    LinkSendQueue::_burstMSecs;
+
+LinkSendQueue::LinkSendQueue(void)
+    : _linkTokens       (0)
+    , _lastRefillMSecs  (0)
+{
+    for (Class_t& sendClass: _classes) {
+        sendClass.tokens = 0;
+        memset(&sendClass.stats, 0, sizeof(sendClass.stats));
+    }
+}
+
+void LinkSendQueue::enqueue(Priority_t priority, quint64 coalesceKey, const QByteArray& bytes)
+{
+    QMutexLocker    locker(&_mutex);
+    Class_t&        sendClass = _classes[priority];
+
+    sendClass.stats.packetsQueued++;
+
+    if (coalesceKey != 0) {
+        for (Entry_t& entry: sendClass.entries) {
+            if (entry.coalesceKey == coalesceKey) {
+                sendClass.stats.bytesQueued += bytes.size() - entry.bytes.size();
+                sendClass.stats.packetsCoalesced++;
+                entry.bytes = bytes;
+                return;
+            }
+        }
+    }
+
+    sendClass.entries.enqueue({ coalesceKey, bytes });
+    sendClass.stats.bytesQueued += bytes.size();
+
+    // A full queue of streamed data is stale by now, drop from the front
+    while (_classDroppable[priority] && sendClass.stats.bytesQueued > _maxQueuedBytes[priority] && sendClass.entries.count() > 1) {
+        sendClass.stats.bytesQueued -= sendClass.entries.dequeue().bytes.size();
+        sendClass.stats.packetsDropped++;
+    }
+}
+
+void LinkSendQueue::_refill(qint64 nowMSecs, qint64 bytesPerSecond)
+{
+    const qint64 elapsedMSecs = qMax(nowMSecs - _lastRefillMSecs, static_cast<qint64>(0));
+    _lastRefillMSecs = nowMSecs;
+
+    // Deep enough for at least one full packet such that very slow links still make progress
+    const double linkDepth = qMax(bytesPerSecond * _linkShare * _burstMSecs / 1000.0, static_cast<double>(MAVLINK_MAX_PACKET_LEN));
+    _linkTokens = qMin(_linkTokens + (bytesPerSecond * _linkShare * elapsedMSecs / 1000.0), linkDepth);
+
+    for (int i=0; i<PriorityCount; i++) {
+        const double depth = qMax(bytesPerSecond * _classShare[i] * _burstMSecs / 1000.0, static_cast<double>(MAVLINK_MAX_PACKET_LEN));
+        _classes[i].tokens = qMin(_classes[i].tokens + (bytesPerSecond * _classShare[i] * elapsedMSecs / 1000.0), depth);
+    }
+}
+
+bool LinkSendQueue::takeNext(qint64 nowMSecs, qint64 bytesPerSecond, QByteArray& bytes, int& waitMSecs)
+{
+    QMutexLocker locker(&_mutex);
+
+    waitMSecs = 0;
+
+    if (bytesPerSecond > 0) {
+        _refill(nowMSecs, bytesPerSecond);
+    }
+
+    double shortestWait = -1;
+    for (int i=0; i<PriorityCount; i++) {
+        Class_t& sendClass = _classes[i];
+
+        if (sendClass.entries.isEmpty()) {
+            continue;
+        }
+
+        if (bytesPerSecond > 0 && i != PriorityControl) {
+            // Control packets always go out immediately. Everything else needs budget in both its own
+            // class and the link, and waits for whichever refills last.
+            double deficitMSecs = 0;
+            if (sendClass.tokens <= 0) {
+                deficitMSecs = (1 - sendClass.tokens) * 1000.0 / (bytesPerSecond * _classShare[i]);
+            }
+            if (_linkTokens <= 0) {
+                deficitMSecs = qMax(deficitMSecs, (1 - _linkTokens) * 1000.0 / (bytesPerSecond * _linkShare));
+            }
+            if (deficitMSecs > 0) {
+                if (shortestWait < 0 || deficitMSecs < shortestWait) {
+                    shortestWait = deficitMSecs;
+                }
+                continue;
+            }
+        }
+
+        bytes = sendClass.entries.dequeue().bytes;
+        sendClass.stats.bytesQueued -= bytes.size();
+        sendClass.stats.packetsSent++;
+        if (bytesPerSecond > 0) {
+            sendClass.tokens -= bytes.size();
+            _linkTokens -= bytes.size();
+        }
+        return true;
+    }
+
+    if (shortestWait > 0) {
+        waitMSecs = qMax(static_cast<int>(shortestWait + 0.5), 1);
+    }
+    return false;
+}
+
+bool LinkSendQueue::isEmpty(void) const
+{
+    QMutexLocker locker(&_mutex);
+
+    for (const Class_t& sendClass: _classes) {
+        if (!sendClass.entries.isEmpty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+LinkSendQueue::ClassStats_t LinkSendQueue::stats(Priority_t priority) const
+{
+    QMutexLocker locker(&_mutex);
+    return _classes[priority].stats;
+}
+
+LinkSendQueue::Priority_t LinkSendQueue::priorityForMessage(const mavlink_message_t& message)
+{
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    case MAVLINK_MSG_ID_MANUAL_CONTROL:
+    case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
+    case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
+    case MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT:
+    case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
+        return PriorityControl;
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+    case MAVLINK_MSG_ID_PARAM_SET:
+    case MAVLINK_MSG_ID_PARAM_MAP_RC:
+    case MAVLINK_MSG_ID_MISSION_ITEM:
+    case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+    case MAVLINK_MSG_ID_MISSION_ACK:
+    case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+    case MAVLINK_MSG_ID_MISSION_SET_CURRENT:
+        return PriorityMissionParam;
+    case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+    case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
+    case MAVLINK_MSG_ID_SERIAL_CONTROL:
+        return PriorityTransfer;
+    case MAVLINK_MSG_ID_GPS_RTCM_DATA:
+    case MAVLINK_MSG_ID_GPS_INJECT_DATA:
+    case MAVLINK_MSG_ID_TERRAIN_DATA:
+        return PriorityBulk;
+    default:
+        return PriorityCommand;
+    }
+}
+
+quint64 LinkSendQueue::coalesceKeyForMessage(const mavlink_message_t& message)
+{
+    quint8 targetSystem     = 0;
+    quint8 targetComponent  = 0;
+
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_MANUAL_CONTROL:
+        targetSystem = mavlink_msg_manual_control_get_target(&message);
+        break;
+    case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
+        targetSystem    = mavlink_msg_rc_channels_override_get_target_system(&message);
+        targetComponent = mavlink_msg_rc_channels_override_get_target_component(&message);
+        break;
+    case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
+        targetSystem    = mavlink_msg_set_position_target_local_ned_get_target_system(&message);
+        targetComponent = mavlink_msg_set_position_target_local_ned_get_target_component(&message);
+        break;
+    case MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT:
+        targetSystem    = mavlink_msg_set_position_target_global_int_get_target_system(&message);
+        targetComponent = mavlink_msg_set_position_target_global_int_get_target_component(&message);
+        break;
+    case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
+        targetSystem    = mavlink_msg_set_attitude_target_get_target_system(&message);
+        targetComponent = mavlink_msg_set_attitude_target_get_target_component(&message);
+        break;
+    default:
+        return 0;
+    }
+
+    // Message id is offset by one such that the key can never be 0
+    return ((static_cast<quint64>(message.msgid) + 1) << 32) |
+            (static_cast<quint64>(message.sysid) << 24) | (static_cast<quint64>(message.compid) << 16) |
+            (static_cast<quint64>(targetSystem) << 8) | targetComponent;
+}
@@ -0,0 +1,92 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QMutex>
+#include <QQueue>
+
+#include "QGCMAVLink.h"
+
+/// Outbound packet scheduler for a single link. Packets are queued into priority classes from any thread and
+/// pulled off by the link thread in priority order. On links with a known, limited bandwidth each class is
+/// rate limited to a share of that bandwidth and the overall send rate is paced slightly below it, such that the
+/// radio/OS buffers never build up a backlog which control packets would have to wait behind.
+///
+/// Control packets which are superseded by newer ones (MANUAL_CONTROL, SET_POSITION_TARGET_*, ...) are coalesced:
+/// a newer packet replaces a still queued older one in place instead of being queued behind it.
+///
+/// Only the streamed classes (control and bulk) drop their oldest packets once their queue is full, newer packets
+/// supersede them anyway. Commands, mission, parameter and transfer packets belong to acknowledged protocols which
+/// would stall on a lost packet or carry console keystrokes, so they are never dropped and stay queued past the limit.
+class LinkSendQueue
+{
+public:
+    LinkSendQueue(void);
+
+    typedef enum {
+        PriorityControl = 0,    ///< Manual control, position targets, heartbeats
+        PriorityCommand,        ///< Commands, mode changes and anything not otherwise classified
+        PriorityMissionParam,   ///< Mission and parameter protocols
+        PriorityTransfer,       ///< FTP, log download requests and the MAVLink console
+        PriorityBulk,           ///< RTCM corrections and terrain data
+        PriorityCount
+    } Priority_t;
+
+    typedef struct {
+        quint64 packetsQueued;
+        quint64 packetsSent;
+        quint64 packetsCoalesced;   ///< Queued packets replaced by a newer version
+        quint64 packetsDropped;     ///< Oldest packets discarded due to the class queue being full, streamed classes only
+        int     bytesQueued;        ///< Bytes currently waiting in the class queue
+    } ClassStats_t;
+
+    /// Queues a packet for sending. Thread safe.
+    ///     @param coalesceKey 0: never coalesce, otherwise a queued packet with the same key is replaced
+    void enqueue(Priority_t priority, quint64 coalesceKey, const QByteArray& bytes);
+
+    /// Pulls the next packet which is allowed to go out. Must only be called from the link thread.
+    ///     @param nowMSecs Current time
+    ///     @param bytesPerSecond Bandwidth of the link, 0 for unlimited
+    ///     @param[out] waitMSecs Set if packets are queued but held back by rate limits: time until the next one may be sent
+    /// @return true: bytes filled with next packet, false: nothing to send right now
+    bool takeNext(qint64 nowMSecs, qint64 bytesPerSecond, QByteArray& bytes, int& waitMSecs);
+
+    bool         isEmpty    (void) const;
+    ClassStats_t stats      (Priority_t priority) const;
+
+    static Priority_t   priorityForMessage      (const mavlink_message_t& message);
+    static quint64      coalesceKeyForMessage   (const mavlink_message_t& message);
+
+private:
+    typedef struct {
+        quint64     coalesceKey;
+        QByteArray  bytes;
+    } Entry_t;
+
+    typedef struct {
+        QQueue<Entry_t> entries;
+        double          tokens;     ///< Token bucket in bytes, may go negative after a large packet
+        ClassStats_t    stats;
+    } Class_t;
+
+    void _refill(qint64 nowMSecs, qint64 bytesPerSecond);
+
+    mutable QMutex  _mutex;
+    Class_t         _classes[PriorityCount];
+    double          _linkTokens;
+    qint64          _lastRefillMSecs;
+
+    static const double _classShare[PriorityCount];     ///< Fraction of link bandwidth each class may use
+    static const int    _maxQueuedBytes[PriorityCount];
+    static const bool   _classDroppable[PriorityCount];     ///< true: oldest packets are dropped beyond _maxQueuedBytes
+    static const double _linkShare;                     ///< Overall pacing as a fraction of link bandwidth
+    static const int    _burstMSecs = 100;              ///< Token bucket depth in msecs of bandwidth
+};
@@ -0,0 +1,123 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkStatistics.h"
+
+#include <QElapsedTimer>
+
+const int       LinkTrafficStatistics::burstBucketCount;
+const int       LinkTrafficStatistics::_slotCount;
+const qint64    LinkTrafficStatistics::_slotMSecs;
+const qint64    LinkTrafficStatistics::_windowMSecs;
+const quint64   LinkTrafficStatistics::_smallestBurstBucket;
+
+LinkTrafficStatistics::LinkTrafficStatistics(void)
+    : _totalBytes   (0)
+    , _totalPackets (0)
+{
+    for (Slot_t& slot: _slots) {
+        slot.slotNumber.store(-1, std::memory_order_relaxed);
+        slot.bytes.store(0, std::memory_order_relaxed);
+        slot.packets.store(0, std::memory_order_relaxed);
+    }
+    for (std::atomic<quint64>& bucket: _burstHistogram) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LinkTrafficStatistics::record(quint64 bytes, quint32 packets, qint64 timeMSecs)
+{
+    const qint64    slotNumber  = timeMSecs / _slotMSecs;
+    Slot_t&         slot        = _slots[slotNumber % _slotCount];
+
+    if (slot.slotNumber.load(std::memory_order_relaxed) != slotNumber) {
+        // Slot is being reused for a new time period. A reader racing with this may see a partially
+        // reset slot for one calculation, which is fine for statistics.
+        slot.bytes.store(0, std::memory_order_relaxed);
+        slot.packets.store(0, std::memory_order_relaxed);
+        slot.slotNumber.store(slotNumber, std::memory_order_release);
+    }
+    slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    slot.packets.fetch_add(packets, std::memory_order_relaxed);
+
+    _totalBytes.fetch_add(bytes, std::memory_order_relaxed);
+    _totalPackets.fetch_add(packets, std::memory_order_relaxed);
+
+    int bucket = 0;
+    while (bucket < burstBucketCount - 1 && bytes >= burstBucketUpperBound(bucket)) {
+        bucket++;
+    }
+    _burstHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+double LinkTrafficStatistics::_windowSum(qint64 nowMSecs, bool packets) const
+{
+    const qint64    currentSlotNumber   = nowMSecs / _slotMSecs;
+    quint64         sum                 = 0;
+
+    for (const Slot_t& slot: _slots) {
+        const qint64 slotNumber = slot.slotNumber.load(std::memory_order_acquire);
+        if (slotNumber < currentSlotNumber && slotNumber >= currentSlotNumber - (_slotCount - 1)) {
+            sum += packets ? slot.packets.load(std::memory_order_relaxed) : slot.bytes.load(std::memory_order_relaxed);
+        }
+    }
+
+    return static_cast<double>(sum);
+}
+
+QVector<quint64> LinkTrafficStatistics::burstHistogram(void) const
+{
+    QVector<quint64> histogram;
+
+    histogram.reserve(burstBucketCount);
+    for (const std::atomic<quint64>& bucket: _burstHistogram) {
+        histogram.append(bucket.load(std::memory_order_relaxed));
+    }
+
+    return histogram;
+}
+
+LinkLatencyStatistics::LinkLatencyStatistics(void)
+    : _pendingNSecs (0)
+    , _lastNSecs    (0)
+    , _averageNSecs (0)
+    , _maxNSecs     (0)
+{
+
+}
+
+qint64 LinkLatencyStatistics::monotonicNSecs(void)
+{
+    // Thread safe initialization, nsecsElapsed only reads the clock after that
+    static QElapsedTimer* timer = []() { QElapsedTimer* t = new QElapsedTimer; t->start(); return t; }();
+    return timer->nsecsElapsed() + 1;   // Never 0 since that means nothing pending
+}
+
+void LinkLatencyStatistics::markReceived(void)
+{
+    qint64 expected = 0;
+    _pendingNSecs.compare_exchange_strong(expected, monotonicNSecs(), std::memory_order_relaxed);
+}
+
+void LinkLatencyStatistics::markDispatched(void)
+{
+    const qint64 pendingNSecs = _pendingNSecs.exchange(0, std::memory_order_relaxed);
+    if (pendingNSecs == 0) {
+        return;
+    }
+
+    // Only the dispatching thread writes the results so plain load/store is enough
+    const qint64 latency = monotonicNSecs() - pendingNSecs;
+    _lastNSecs.store(latency, std::memory_order_relaxed);
+    qint64 average = _averageNSecs.load(std::memory_order_relaxed);
+    _averageNSecs.store(average == 0 ? latency : average + (latency - average) / _averageWeight, std::memory_order_relaxed);
+    if (latency > _maxNSecs.load(std::memory_order_relaxed)) {
+        _maxNSecs.store(latency, std::memory_order_relaxed);
+    }
+}
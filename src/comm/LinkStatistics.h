@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtGlobal>
+#include <QVector>
+
+#include <atomic>
+
+/// Lock-free traffic accounting for one direction of a link. Samples are recorded from the link thread and the
+/// rates can be read from any thread at any time without ever blocking the writer.
+///
+/// Rates are calculated over a sliding window made up of fixed time slots. The slot which is currently being
+/// filled is not included, which keeps the estimate from dipping at the start of each slot.
+class LinkTrafficStatistics
+{
+public:
+    LinkTrafficStatistics(void);
+
+    /// Records a single read/write on the link
+    ///     @param bytes Number of bytes transferred
+    ///     @param packets Number of link level packets (datagrams, reads) making up the transfer
+    ///     @param timeMSecs Time of the transfer in msecs since epoch
+    void record(quint64 bytes, quint32 packets, qint64 timeMSecs);
+
+    double  bytesPerSecond      (qint64 nowMSecs) const { return _windowSum(nowMSecs, false) * 1000.0 / _windowMSecs; }
+    double  packetsPerSecond    (qint64 nowMSecs) const { return _windowSum(nowMSecs, true)  * 1000.0 / _windowMSecs; }
+    quint64 totalBytes          (void) const { return _totalBytes.load(std::memory_order_relaxed); }
+    quint64 totalPackets        (void) const { return _totalPackets.load(std::memory_order_relaxed); }
+
+    /// @return Number of transfers falling into each burst size bucket. Bucket n counts transfers of less than
+    /// burstBucketUpperBound(n) bytes, the last bucket counts everything larger.
+    QVector<quint64> burstHistogram(void) const;
+
+    static quint64 burstBucketUpperBound(int bucket) { return static_cast<quint64>(_smallestBurstBucket) << bucket; }
+
+    static const int burstBucketCount = 10;
+
+private:
+    static const int        _slotCount              = 10;
+    static const qint64     _slotMSecs              = 100;
+    static const qint64     _windowMSecs            = (_slotCount - 1) * _slotMSecs;
+    static const quint64    _smallestBurstBucket    = 64;
+
+    typedef struct {
+        std::atomic<qint64>     slotNumber;     ///< Absolute slot number (time / slot length) the counters belong to
+        std::atomic<quint64>    bytes;
+        std::atomic<quint64>    packets;
+    } Slot_t;
+
+    double _windowSum(qint64 nowMSecs, bool packets) const;
+
+    Slot_t                  _slots[_slotCount];
+    std::atomic<quint64>    _totalBytes;
+    std::atomic<quint64>    _totalPackets;
+    std::atomic<quint64>    _burstHistogram[burstBucketCount];
+};
+
+/// Tracks the time received bytes spend waiting between the link thread and the thread which parses them.
+/// The link marks bytes as pending when it receives them and the consumer marks them dispatched when it picks
+/// them up. Only the oldest undispatched receive is tracked, so no allocation or locking is needed.
+class LinkLatencyStatistics
+{
+public:
+    LinkLatencyStatistics(void);
+
+    /// Called from the link thread when bytes are received
+    void markReceived(void);
+
+    /// Called from the consuming thread when received bytes are picked up
+    void markDispatched(void);
+
+    double lastUSecs    (void) const { return static_cast<double>(_lastNSecs.load(std::memory_order_relaxed)) / 1000.0; }
+    double averageUSecs (void) const { return static_cast<double>(_averageNSecs.load(std::memory_order_relaxed)) / 1000.0; }
+    double maxUSecs     (void) const { return static_cast<double>(_maxNSecs.load(std::memory_order_relaxed)) / 1000.0; }
+
+    /// @return Monotonic time in nsecs shared by all threads
+    static qint64 monotonicNSecs(void);
+
+private:
+    std::atomic<qint64> _pendingNSecs;  ///< Receive time of oldest undispatched bytes, 0 if none
+    std::atomic<qint64> _lastNSecs;
+    std::atomic<qint64> _averageNSecs;  ///< Exponentially weighted moving average
+    std::atomic<qint64> _maxNSecs;
+
+    static const int    _averageWeight = 16;    ///< New samples contribute 1/_averageWeight to the average
+};
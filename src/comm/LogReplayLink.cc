@@ -11,15 +11,27 @@
 #include "LogReplayLink.h"
 #include "LinkManager.h"
 #include "QGCApplication.h"
+#include "QGC.h"
+#include "QGCLoggingCategory.h"
+#include "CompressedTlogDevice.h"
 
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QtEndian>
 #include <QSignalSpy>
 
+QGC_LOGGING_CATEGORY(LogReplayLinkLog, "LogReplayLinkLog")
+
 const char*  LogReplayLinkConfiguration::_logFilenameKey = "logFilename";
+const char*  LogReplayLinkConfiguration::_batchReplayKey = "batchReplay";
+
+const int LogReplayLink::_batchReadSize;
+const int LogReplayLink::_batchMessageCount;
+const int LogReplayLink::_batchMaxInFlight;
 
 LogReplayLinkConfiguration::LogReplayLinkConfiguration(const QString& name)
     : LinkConfiguration(name)
+    , _batchReplay(false)
 {
     
 }
@@ -28,6 +40,7 @@ LogReplayLinkConfiguration::LogReplayLinkConfiguration(LogReplayLinkConfiguratio
     : LinkConfiguration(copy)
 {
     _logFilename = copy->logFilename();
+    _batchReplay = copy->batchReplay();
 }
 
 void LogReplayLinkConfiguration::copyFrom(LinkConfiguration *source)
@@ -36,6 +49,7 @@ void LogReplayLinkConfiguration::copyFrom(LinkConfiguration *source)
     auto* ssource = qobject_cast<LogReplayLinkConfiguration*>(source);
     if (ssource) {
         _logFilename = ssource->logFilename();
+        _batchReplay = ssource->batchReplay();
     } else {
         qWarning() << "Internal error";
     }
@@ -45,6 +59,7 @@ void LogReplayLinkConfiguration::saveSettings(QSettings& settings, const QString
 {
     settings.beginGroup(root);
     settings.setValue(_logFilenameKey, _logFilename);
+    settings.setValue(_batchReplayKey, _batchReplay);
     settings.endGroup();
 }
 
@@ -52,6 +67,7 @@ void LogReplayLinkConfiguration::loadSettings(QSettings& settings, const QString
 {
     settings.beginGroup(root);
     _logFilename = settings.value(_logFilenameKey, "").toString();
+    _batchReplay = settings.value(_batchReplayKey, false).toBool();
     settings.endGroup();
 }
 
@@ -70,7 +86,11 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPointer& config)
     : LinkInterface     (config)
     , _logReplayConfig  (qobject_cast<LogReplayLinkConfiguration*>(config.data()))
     , _connected        (false)
+    , _loadTimeUSecs    (0)
     , _playbackSpeed    (1)
+    , _logFile          (nullptr)
+    , _batchRunning     (false)
+    , _batchStopRequested(false)
 {
     if (!_logReplayConfig) {
         qWarning() << "Internal error";
@@ -91,6 +111,7 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPointer& config)
 LogReplayLink::~LogReplayLink(void)
 {
     _disconnect();
+    delete _logFile;
 }
 
 bool LogReplayLink::_connect(void)
@@ -118,6 +139,7 @@ bool LogReplayLink::_connect(void)
 void LogReplayLink::_disconnect(void)
 {
     if (_connected) {
+        _batchStopRequested = true;
         quit();
         wait();
         _connected = false;
@@ -141,7 +163,11 @@ void LogReplayLink::run(void)
     emit connected();
     
     // Start playback
-    _play();
+    if (_logReplayConfig->batchReplay()) {
+        _runBatchReplay();
+    } else {
+        _play();
+    }
 
     // Run normal event loop until exit
     exec();
@@ -165,16 +191,10 @@ void LogReplayLink::_writeBytes(const QByteArray bytes)
 /// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
 quint64 LogReplayLink::_parseTimestamp(const QByteArray& bytes)
 {
-    quint64 timestamp = qFromBigEndian(*((quint64*)(bytes.constData())));
-    quint64 currentTimestamp = ((quint64)QDateTime::currentMSecsSinceEpoch()) * 1000;
-    
-    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
-    // little endian, so switch it.
-    if (timestamp > currentTimestamp) {
-        timestamp = qbswap(timestamp);
+    if (bytes.count() < cbTimestamp) {
+        return 0;
     }
-    
-    return timestamp;
+    return TlogIndex::parseTimestamp(bytes.constData(), _loadTimeUSecs);
 }
 
 /// Reads the next mavlink message from the log
@@ -187,7 +207,7 @@ quint64 LogReplayLink::_readNextMavlinkMessage(QByteArray& bytes)
 
     bytes.clear();
 
-    while (_logFile.getChar(&nextByte)) { // Loop over every byte
+    while (_logFile->getChar(&nextByte)) { // Loop over every byte
         mavlink_message_t message;
         bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, &message, &status);
 
@@ -199,7 +219,7 @@ quint64 LogReplayLink::_readNextMavlinkMessage(QByteArray& bytes)
 
         if (messageFound) {
             // Return the timestamp for the next message
-            QByteArray rawTime = _logFile.read(cbTimestamp);
+            QByteArray rawTime = _logFile->read(cbTimestamp);
             return _parseTimestamp(rawTime);
         }
     }
@@ -218,19 +238,19 @@ quint64 LogReplayLink::_seekToNextMavlinkMessage(mavlink_message_t* nextMsg)
 
     mavlink_reset_channel_status(_mavlinkChannel);
 
-    while (_logFile.getChar(&nextByte)) {
+    while (_logFile->getChar(&nextByte)) {
         bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, nextMsg, &status);
 
         if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
             // This is the possible beginning of a mavlink message
-            messageStartPos = _logFile.pos() - 1;
+            messageStartPos = _logFile->pos() - 1;
         }
         
         // If we've found a message, jump back to the start of the message, grab the timestamp,
         // and go back to the end of this file.
         if (messageFound && messageStartPos != -1) {
-            _logFile.seek(messageStartPos - cbTimestamp);
-            QByteArray rawTime = _logFile.read(cbTimestamp);
+            _logFile->seek(messageStartPos - cbTimestamp);
+            QByteArray rawTime = _logFile->read(cbTimestamp);
             return _parseTimestamp(rawTime);
         }
     }
@@ -248,14 +268,14 @@ quint64 LogReplayLink::_findLastTimestamp(void)
     // We read through the entire file looking for the last good timestamp. This can be somewhat slow, but trying to work from the
     // end of the file can be way slower due to all the seeking back and forth required. So instead we take the simple reliable approach.
 
-    _logFile.reset();
+    _logFile->reset();
     mavlink_reset_channel_status(_mavlinkChannel);
 
-    while (_logFile.bytesAvailable() > cbTimestamp) {
-        lastTimestamp = _parseTimestamp(_logFile.read(cbTimestamp));
+    while (_logFile->bytesAvailable() > cbTimestamp) {
+        lastTimestamp = _parseTimestamp(_logFile->read(cbTimestamp));
 
         bool endOfMessage = false;
-        while (!endOfMessage && _logFile.getChar(&nextByte)) {
+        while (!endOfMessage && _logFile->getChar(&nextByte)) {
             endOfMessage = mavlink_parse_char(_mavlinkChannel, nextByte, &msg, &status);
         }
     }
@@ -271,22 +291,40 @@ bool LogReplayLink::_loadLogFile(void)
     int logDurationSecondsTotal;
     quint64 startTimeUSecs;
     quint64 endTimeUSecs;
+    QString indexErrorMsg;
+
+    _loadTimeUSecs = QGC::groundTimeUsecs();
 
-    if (_logFile.isOpen()) {
+    if (_logFile) {
         errorMsg = tr("Attempt to load new log while log being played");
         goto Error;
     }
     
-    _logFile.setFileName(logFilename);
-    if (!_logFile.open(QFile::ReadOnly)) {
-        errorMsg = tr("Unable to open log file: '%1', error: %2").arg(logFilename).arg(_logFile.errorString());
+    // Compressed logs are read through a device which presents the uncompressed stream, so everything below
+    // (including index offsets) works in uncompressed positions for both kinds of log.
+    _logFile = CompressedTlogDevice::openLog(logFilename, errorMsg);
+    if (!_logFile) {
         goto Error;
     }
     logFileInfo.setFile(logFilename);
     _logFileSize = logFileInfo.size();
     
-    startTimeUSecs = _parseTimestamp(_logFile.read(cbTimestamp));
-    endTimeUSecs = _findLastTimestamp();
+    // The index is built once per log, later loads just map it. Building takes a single pass over the log which
+    // is no more than the scan for the last timestamp it replaces.
+    if (!_index.open(logFilename)) {
+        if (!TlogIndex::build(logFilename, _mavlinkChannel, indexErrorMsg) || !_index.open(logFilename)) {
+            qWarning() << "Log index not available, seeking will be approximate" << indexErrorMsg;
+        }
+        mavlink_reset_channel_status(_mavlinkChannel);
+    }
+
+    if (_index.isValid()) {
+        startTimeUSecs = _index.startTimeUSecs();
+        endTimeUSecs = _index.endTimeUSecs();
+    } else {
+        startTimeUSecs = _parseTimestamp(_logFile->read(cbTimestamp));
+        endTimeUSecs = _findLastTimestamp();
+    }
 
     if (endTimeUSecs <= startTimeUSecs) {
         errorMsg = tr("The log file '%1' is corrupt or empty.").arg(logFilename);
@@ -300,7 +338,7 @@ bool LogReplayLink::_loadLogFile(void)
     _logCurrentTimeUSecs = startTimeUSecs;
 
     // Reset our log file so when we go to read it for the first time, we start at the beginning.
-    _logFile.reset();
+    _logFile->reset();
 
     logDurationSecondsTotal = (_logDurationUSecs) / 1000000;
     
@@ -309,9 +347,8 @@ bool LogReplayLink::_loadLogFile(void)
     return true;
     
 Error:
-    if (_logFile.isOpen()) {
-        _logFile.close();
-    }
+    delete _logFile;
+    _logFile = nullptr;
     _replayError(errorMsg);
     return false;
 }
@@ -337,7 +374,7 @@ void LogReplayLink::_readNextLogEntry(void)
         emit bytesReceived(this, bytes);
         emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
 
-        if (_logFile.atEnd()) {
+        if (_logFile->atEnd()) {
             _finishPlayback();
             return;
         }
@@ -368,7 +405,7 @@ void LogReplayLink::_play(void)
 #endif
     
     // Make sure we aren't at the end of the file, if we are, reset to the beginning and play from there.
-    if (_logFile.atEnd()) {
+    if (_logFile->atEnd()) {
         _resetPlaybackToBeginning();
     }
     
@@ -393,8 +430,8 @@ void LogReplayLink::_pause(void)
 
 void LogReplayLink::_resetPlaybackToBeginning(void)
 {
-    if (_logFile.isOpen()) {
-        _logFile.reset();
+    if (_logFile) {
+        _logFile->reset();
     }
     
     // And since we haven't starting playback, clear the time of initial playback and the current timestamp.
@@ -405,6 +442,11 @@ void LogReplayLink::_resetPlaybackToBeginning(void)
 
 void LogReplayLink::movePlayhead(qreal percentComplete)
 {
+    if (_batchRunning || !_logFile) {
+        // Batch replay owns the log file until it reaches the end
+        return;
+    }
+
     if (isPlaying()) {
         _pauseOnThread();
         QSignalSpy waitForPause(this, SIGNAL(playbackPaused()));
@@ -422,13 +464,30 @@ void LogReplayLink::movePlayhead(qreal percentComplete)
     }
     
     qreal percentCompleteMult = percentComplete / 100.0;
-    
+
+    if (_index.isValid()) {
+        // Exact seek to the first message at or after the requested time
+        quint64 messageIndex = _index.indexForTime(_logStartTimeUSecs + static_cast<quint64>(percentCompleteMult * _logDurationUSecs));
+        if (!_logFile->seek(_index.offsetAt(messageIndex) + cbTimestamp)) {
+            _replayError(tr("Unable to seek to new position"));
+            return;
+        }
+        mavlink_reset_channel_status(_mavlinkChannel);
+        _logCurrentTimeUSecs = _index.timestampAt(messageIndex);
+        _signalCurrentLogTimeSecs();
+
+        percentComplete = ((qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs) / _logDurationUSecs) * 100;
+        emit playbackPercentCompleteChanged(percentComplete);
+        return;
+    }
+
+    // No index, estimate the position from the average data rate of the log
     // But if we have a timestamped MAVLink log, then actually aim to hit that percentage in terms of
     // time through the file.
-    qint64 newFilePos = (qint64)(percentCompleteMult * (qreal)_logFile.size());
+    qint64 newFilePos = (qint64)(percentCompleteMult * (qreal)_logFile->size());
 
     // Now seek to the appropriate position, failing gracefully if we can't.
-    if (!_logFile.seek(newFilePos)) {
+    if (!_logFile->seek(newFilePos)) {
         _replayError(tr("Unable to seek to new position"));
         return;
     }
@@ -441,14 +500,14 @@ void LogReplayLink::movePlayhead(qreal percentComplete)
     qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
 
     // Calculate the effective baud rate of the file in bytes/s.
-    qreal baudRate = _logFile.size() / (qreal)_logDurationUSecs / 1e6;
+    qreal baudRate = _logFile->size() / (qreal)_logDurationUSecs / 1e6;
 
     // And the desired time is:
     qreal desiredTimeUSecs = percentCompleteMult * _logDurationUSecs;
 
     // And now jump the necessary number of bytes in the proper direction
     qint64 offset = (newRelativeTimeUSecs - desiredTimeUSecs) * baudRate;
-    if (!_logFile.seek(_logFile.pos() + offset)) {
+    if (!_logFile->seek(_logFile->pos() + offset)) {
         _replayError(tr("Unable to seek to new position"));
         return;
     }
@@ -482,6 +541,101 @@ void LogReplayLink::_finishPlayback(void)
     emit playbackAtEnd();
 }
 
+/// Pushes the whole log through the protocol as fast as it can be handled. Messages are parsed on the link thread
+/// and handed to the protocol already decoded together with their log timestamps. The link emits no playback
+/// position signals until the end of the log is reached. Vehicle Facts are still updated by every message, so
+/// their valueChanged signals keep firing at message rate.
+void LogReplayLink::_runBatchReplay(void)
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    _batchRunning = true;
+
+    qgcApp()->toolbox()->linkManager()->setConnectionsSuspended(tr("Connect not allowed during Flight Data replay."));
+#ifndef __mobile__
+    qgcApp()->toolbox()->mavlinkProtocol()->suspendLogForReplay(true);
+#endif
+    emit playbackStarted();
+
+    // Limits how far parsing can run ahead of message handling, which keeps memory bounded regardless of log size.
+    // Shared with the connection since queued batches can outlive the link.
+    QSharedPointer<QSemaphore> batchSlots(new QSemaphore(_batchMaxInFlight));
+    MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
+    QMetaObject::Connection batchConnection = QObject::connect(this, &LogReplayLink::_replayMessagesDecoded, mavlinkProtocol,
+                                                               [mavlinkProtocol, batchSlots](LinkInterface* link, QList<mavlink_message_t> messages, QVector<quint64> timestampsUSecs) {
+        mavlinkProtocol->receiveReplayMessages(link, messages, timestampsUSecs);
+        batchSlots->release();
+    });
+
+    _resetPlaybackToBeginning();
+
+    TlogRecordParser            parser(_mavlinkChannel);
+    mavlink_message_t           message;
+    QList<mavlink_message_t>    messages;
+    QVector<quint64>            timestampsUSecs;
+    quint64                     messageCount = 0;
+    bool                        sendFailed = false;
+
+    messages.reserve(_batchMessageCount);
+    timestampsUSecs.reserve(_batchMessageCount);
+
+    QByteArray chunk;
+    while (!sendFailed && !(chunk = _logFile->read(_batchReadSize)).isEmpty()) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(chunk.constData());
+        for (int i=0; i<chunk.count(); i++) {
+            if (parser.parseByte(bytes[i], &message)) {
+                messages.append(message);
+                timestampsUSecs.append(parser.timestampUSecs());
+                _logCurrentTimeUSecs = parser.timestampUSecs();
+                messageCount++;
+                if (messages.count() == _batchMessageCount && !_sendReplayBatch(batchSlots, messages, timestampsUSecs)) {
+                    sendFailed = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (!sendFailed && !messages.isEmpty()) {
+        sendFailed = !_sendReplayBatch(batchSlots, messages, timestampsUSecs);
+    }
+
+    // Wait for the protocol to finish with everything queued such that the end signals follow the last message
+    while (!sendFailed && !batchSlots->tryAcquire(_batchMaxInFlight, 100)) {
+        sendFailed = _batchStopRequested;
+    }
+    QObject::disconnect(batchConnection);
+    _batchRunning = false;
+
+    if (sendFailed) {
+        qCDebug(LogReplayLinkLog) << "Batch replay stopped";
+        // Not at the end of the log, but connections and telemetry logging must still be given back
+        _pause();
+        return;
+    }
+
+    qCDebug(LogReplayLinkLog) << "Batch replay complete messages:elapsedMSecs" << messageCount << elapsedTimer.elapsed();
+    _signalCurrentLogTimeSecs();
+    emit playbackPercentCompleteChanged(100);
+    emit batchReplayComplete(messageCount, elapsedTimer.elapsed());
+    _finishPlayback();
+}
+
+/// Queues a batch of decoded messages to the protocol, waiting for a free slot if the protocol is behind
+/// @return false: link is being disconnected, batch was not sent
+bool LogReplayLink::_sendReplayBatch(QSharedPointer<QSemaphore>& batchSlots, QList<mavlink_message_t>& messages, QVector<quint64>& timestampsUSecs)
+{
+    while (!batchSlots->tryAcquire(1, 100)) {
+        if (_batchStopRequested) {
+            return false;
+        }
+    }
+
+    emit _replayMessagesDecoded(this, messages, timestampsUSecs);
+    messages.clear();
+    timestampsUSecs.clear();
+    return true;
+}
+
 void LogReplayLink::_signalCurrentLogTimeSecs(void)
 {
     emit currentLogTimeSecs((_logCurrentTimeUSecs - _logStartTimeUSecs) / 1000000);
@@ -11,9 +11,16 @@
 
 #include "LinkManager.h"
 #include "MAVLinkProtocol.h"
+#include "TlogIndex.h"
 
 #include <QTimer>
 #include <QFile>
+#include <QSemaphore>
+#include <QSharedPointer>
+
+#include <atomic>
+
+Q_DECLARE_LOGGING_CATEGORY(LogReplayLinkLog)
 
 class LogReplayLinkConfiguration : public LinkConfiguration
 {
@@ -21,6 +28,7 @@ class LogReplayLinkConfiguration : public LinkConfiguration
 
 public:
     Q_PROPERTY(QString  fileName    READ logFilename    WRITE setLogFilename    NOTIFY fileNameChanged)
+    Q_PROPERTY(bool     batchReplay READ batchReplay    WRITE setBatchReplay    NOTIFY batchReplayChanged)
 
     LogReplayLinkConfiguration(const QString& name);
     LogReplayLinkConfiguration(LogReplayLinkConfiguration* copy);
@@ -30,6 +38,10 @@ public:
 
     QString logFilenameShort(void);
 
+    /// true: The log is pushed through as fast as possible instead of being paced to the log timestamps
+    bool batchReplay(void) const { return _batchReplay; }
+    void setBatchReplay(bool batchReplay) { _batchReplay = batchReplay; emit batchReplayChanged(); }
+
     // Virtuals from LinkConfiguration
     LinkType    type                    () { return LinkConfiguration::TypeLogReplay; }
     void        copyFrom                (LinkConfiguration* source);
@@ -41,10 +53,13 @@ public:
 
 signals:
     void fileNameChanged();
+    void batchReplayChanged();
 
 private:
     static const char*  _logFilenameKey;
+    static const char*  _batchReplayKey;
     QString             _logFilename;
+    bool                _batchReplay;
 };
 
 /// Pseudo link that reads a telemetry log and feeds it into the application.
@@ -90,10 +105,14 @@ signals:
     void playbackPercentCompleteChanged (qreal percentComplete);
     void currentLogTimeSecs             (int secs);
 
+    /// Emitted when a batch replay has pushed the whole log through the protocol
+    void batchReplayComplete            (quint64 messageCount, qint64 elapsedMSecs);
+
     // Internal signals
     void _playOnThread              (void);
     void _pauseOnThread             (void);
     void _setPlaybackSpeedOnThread  (qreal playbackSpeed);
+    void _replayMessagesDecoded     (LinkInterface* link, QList<mavlink_message_t> messages, QVector<quint64> timestampsUSecs);
 
 private slots:
     void _readNextLogEntry  (void);
@@ -115,6 +134,8 @@ private:
     void    _finishPlayback             (void);
     void    _resetPlaybackToBeginning   (void);
     void    _signalCurrentLogTimeSecs   (void);
+    void    _runBatchReplay             (void);
+    bool    _sendReplayBatch            (QSharedPointer<QSemaphore>& batchSlots, QList<mavlink_message_t>& messages, QVector<quint64>& timestampsUSecs);
 
     // Virtuals from LinkInterface
     virtual bool _connect   (void);
@@ -135,16 +156,24 @@ private:
     quint64 _logStartTimeUSecs;     ///< The first timestamp in the current log file.
     quint64 _logEndTimeUSecs;       ///< The last timestamp in the current log file.
     quint64 _logDurationUSecs;
+    quint64 _loadTimeUSecs;         ///< Time the log was loaded, see TlogIndex::parseTimestamp
 
     qreal   _playbackSpeed;
     quint64 _playbackStartTimeMSecs;    ///< The time when the logfile was first played back. This is used to pace out replaying the messages to fix long-term drift/skew. 0 indicates that the player hasn't initiated playback of this log file.
     quint64 _playbackStartLogTimeUSecs;
 
     MAVLinkProtocol*    _mavlink;
-    QFile               _logFile;
+    QIODevice*          _logFile;       ///< Plain QFile or CompressedTlogDevice
     quint64             _logFileSize;
+    TlogIndex           _index;         ///< Sidecar index used for exact seeking, not valid if it could not be built
+
+    std::atomic<bool>   _batchRunning;
+    std::atomic<bool>   _batchStopRequested;
 
     static const int cbTimestamp = sizeof(quint64);
+    static const int _batchReadSize         = 4 * 1024 * 1024;  ///< Bytes read from the log at a time in batch mode
+    static const int _batchMessageCount     = 256;              ///< Messages handed to the protocol at a time in batch mode
+    static const int _batchMaxInFlight      = 8;                ///< Batches queued to the protocol before the reader waits
 };
 
 class LogReplayLinkController : public QObject
@@ -0,0 +1,169 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkHandlerStats.h"
+#include "QGCMAVLink.h"
+#include "QGCLoggingCategory.h"
+
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(MAVLinkHandlerStatsLog, "MAVLinkHandlerStatsLog")
+
+const int MAVLinkHandlerStats::_sysIdRole =         Qt::UserRole;
+const int MAVLinkHandlerStats::_msgIdRole =         Qt::UserRole + 1;
+const int MAVLinkHandlerStats::_nameRole =          Qt::UserRole + 2;
+const int MAVLinkHandlerStats::_countRole =         Qt::UserRole + 3;
+const int MAVLinkHandlerStats::_totalUSecsRole =    Qt::UserRole + 4;
+const int MAVLinkHandlerStats::_averageUSecsRole =  Qt::UserRole + 5;
+const int MAVLinkHandlerStats::_maxUSecsRole =      Qt::UserRole + 6;
+
+MAVLinkHandlerStats::MAVLinkHandlerStats(QObject* parent)
+    : QAbstractListModel(parent)
+{
+    _refreshTimer.setSingleShot(false);
+    _refreshTimer.setInterval(_refreshIntervalMSecs);
+    connect(&_refreshTimer, &QTimer::timeout, this, &MAVLinkHandlerStats::_refresh);
+    _refreshTimer.start();
+}
+
+MAVLinkHandlerStats::Entry_t& MAVLinkHandlerStats::_addEntry(quint32 key, uint8_t sysid, uint32_t msgid)
+{
+    mavlink_message_t message = {};
+    message.msgid = msgid;
+    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&message);
+
+    Entry_t entry;
+    entry.sysid         = sysid;
+    entry.msgid         = msgid;
+    entry.name          = msgInfo ? QString(msgInfo->name) : QString::number(msgid);
+    entry.count         = 0;
+    entry.totalNSecs    = 0;
+    entry.maxNSecs      = 0;
+
+    const int row = _entries.count();
+    beginInsertRows(QModelIndex(), row, row);
+    _entries.append(entry);
+    _keyToRow[key] = row;
+    endInsertRows();
+    emit countChanged(_entries.count());
+
+    return _entries[row];
+}
+
+void MAVLinkHandlerStats::reset(void)
+{
+    beginResetModel();
+    _entries.clear();
+    _keyToRow.clear();
+    endResetModel();
+    emit countChanged(0);
+}
+
+void MAVLinkHandlerStats::_refresh(void)
+{
+    if (_entries.count()) {
+        emit dataChanged(index(0), index(_entries.count() - 1), { _countRole, _totalUSecsRole, _averageUSecsRole, _maxUSecsRole });
+    }
+}
+
+int MAVLinkHandlerStats::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return _entries.count();
+}
+
+QVariant MAVLinkHandlerStats::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= _entries.count()) {
+        return QVariant();
+    }
+
+    const Entry_t& entry = _entries[index.row()];
+
+    if (role == _sysIdRole) {
+        return entry.sysid;
+    } else if (role == _msgIdRole) {
+        return entry.msgid;
+    } else if (role == _nameRole) {
+        return entry.name;
+    } else if (role == _countRole) {
+        return entry.count;
+    } else if (role == _totalUSecsRole) {
+        return static_cast<double>(entry.totalNSecs) / 1000.0;
+    } else if (role == _averageUSecsRole) {
+        return entry.count ? static_cast<double>(entry.totalNSecs) / 1000.0 / static_cast<double>(entry.count) : 0.0;
+    } else if (role == _maxUSecsRole) {
+        return static_cast<double>(entry.maxNSecs) / 1000.0;
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> MAVLinkHandlerStats::roleNames(void) const
+{
+    QHash<int, QByteArray> hash;
+
+    hash[_sysIdRole]        = "sysid";
+    hash[_msgIdRole]        = "msgid";
+    hash[_nameRole]         = "name";
+    hash[_countRole]        = "count";
+    hash[_totalUSecsRole]   = "totalUSecs";
+    hash[_averageUSecsRole] = "averageUSecs";
+    hash[_maxUSecsRole]     = "maxUSecs";
+
+    return hash;
+}
+
+QString MAVLinkHandlerStats::csv(void) const
+{
+    QVector<const Entry_t*> sortedEntries;
+    sortedEntries.reserve(_entries.count());
+    for (const Entry_t& entry: _entries) {
+        sortedEntries.append(&entry);
+    }
+    std::sort(sortedEntries.begin(), sortedEntries.end(), [](const Entry_t* a, const Entry_t* b) { return a->totalNSecs > b->totalNSecs; });
+
+    QString     csv;
+    QTextStream stream(&csv);
+
+    stream << "sysid,msgid,name,count,totalUSecs,averageUSecs,maxUSecs\n";
+    for (const Entry_t* entry: sortedEntries) {
+        stream << entry->sysid << ","
+               << entry->msgid << ","
+               << entry->name << ","
+               << entry->count << ","
+               << QString::number(static_cast<double>(entry->totalNSecs) / 1000.0, 'f', 1) << ","
+               << QString::number(entry->count ? static_cast<double>(entry->totalNSecs) / 1000.0 / static_cast<double>(entry->count) : 0.0, 'f', 2) << ","
+               << QString::number(static_cast<double>(entry->maxNSecs) / 1000.0, 'f', 1) << "\n";
+    }
+    stream.flush();
+
+    return csv;
+}
+
+bool MAVLinkHandlerStats::saveCsv(const QString& filename) const
+{
+    QFile file(filename);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qCWarning(MAVLinkHandlerStatsLog) << "Unable to open file" << filename << file.errorString();
+        return false;
+    }
+
+    QByteArray bytes = csv().toUtf8();
+    if (file.write(bytes) != bytes.count()) {
+        qCWarning(MAVLinkHandlerStatsLog) << "Unable to write file" << filename << file.errorString();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkHandlerStatsLog)
+
+/// Always on cost accounting for received message handling. For every (sysid, msgid) pair it keeps the number of
+/// messages handled along with the total and maximum time spent in the handlers. Recording a sample is a hash
+/// lookup and a few additions, so it is cheap enough to leave on permanently.
+///
+/// Exposed to QML as a list model with one row per (sysid, msgid). Row values are refreshed once a second
+/// rather than on every message.
+class MAVLinkHandlerStats : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    MAVLinkHandlerStats(QObject* parent = nullptr);
+
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    int count(void) const { return _entries.count(); }
+
+    /// Records the time spent handling a single message. Must be called from the thread the model lives on.
+    void record(uint8_t sysid, uint32_t msgid, qint64 elapsedNSecs)
+    {
+        const quint32 key = (static_cast<quint32>(sysid) << 24) | (msgid & 0xFFFFFF);
+        auto iter = _keyToRow.constFind(key);
+        Entry_t& entry = iter != _keyToRow.constEnd() ? _entries[iter.value()] : _addEntry(key, sysid, msgid);
+        entry.count++;
+        entry.totalNSecs += elapsedNSecs;
+        if (elapsedNSecs > entry.maxNSecs) {
+            entry.maxNSecs = elapsedNSecs;
+        }
+    }
+
+    /// Writes all counters to the specified file in CSV format
+    ///     @return false: unable to write file
+    Q_INVOKABLE bool saveCsv(const QString& filename) const;
+
+    /// @return All counters in CSV format, one row per (sysid, msgid), most expensive total first
+    QString csv(void) const;
+
+    /// Clears all counters
+    Q_INVOKABLE void reset(void);
+
+    // Overrides from QAbstractListModel
+    int                     rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant                data        (const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray>  roleNames   (void) const override;
+
+signals:
+    void countChanged(int count);
+
+private slots:
+    void _refresh(void);
+
+private:
+    typedef struct {
+        uint8_t     sysid;
+        uint32_t    msgid;
+        QString     name;
+        quint64     count;
+        qint64      totalNSecs;
+        qint64      maxNSecs;
+    } Entry_t;
+
+    Entry_t& _addEntry(quint32 key, uint8_t sysid, uint32_t msgid);
+
+    QVector<Entry_t>        _entries;
+    QHash<quint32, int>     _keyToRow;
+    QTimer                  _refreshTimer;
+
+    static const int _sysIdRole;
+    static const int _msgIdRole;
+    static const int _nameRole;
+    static const int _countRole;
+    static const int _totalUSecsRole;
+    static const int _averageUSecsRole;
+    static const int _maxUSecsRole;
+
+    static const int _refreshIntervalMSecs = 1000;
+};
@@ -0,0 +1,137 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageHandle.h"
+
+#include <utility>
+
+const mavlink_message_t MAVLinkMessageHandle::_nullMessage = {};
+const quint32           MAVLinkMessagePool::heapIndex;
+const quint32           MAVLinkMessagePool::_defaultCapacity;
+
+MAVLinkMessagePool* MAVLinkMessagePool::instance(void)
+{
+    // The pool is intentionally never destroyed. Handles can be released from any thread at any point
+    // during shutdown, so the pool must outlive every static and every thread.
+    static MAVLinkMessagePool* pool = new MAVLinkMessagePool(_defaultCapacity);
+    return pool;
+}
+
+MAVLinkMessagePool::MAVLinkMessagePool(quint32 capacity)
+    : _capacity         (capacity)
+    , _nodes            (new MAVLinkMessageNode[capacity])
+    , _freeHead         (0)
+    , _available        (static_cast<int>(capacity))
+    , _heapAllocations  (0)
+{
+    for (quint32 i=0; i<_capacity; i++) {
+        _nodes[i].refCount.store(0, std::memory_order_relaxed);
+        _nodes[i].poolIndex = i;
+        _nodes[i].nextFree.store(i + 1 < _capacity ? i + 1 : heapIndex, std::memory_order_relaxed);
+    }
+    _freeHead.store(_packHead(0, _capacity ? 0 : heapIndex), std::memory_order_release);
+}
+
+MAVLinkMessagePool::~MAVLinkMessagePool()
+{
+    delete[] _nodes;
+}
+
+MAVLinkMessageNode* MAVLinkMessagePool::allocate(const mavlink_message_t& message)
+{
+    MAVLinkMessageNode* node = nullptr;
+
+    quint64 head = _freeHead.load(std::memory_order_acquire);
+    while (_headIndex(head) != heapIndex) {
+        MAVLinkMessageNode* candidate = &_nodes[_headIndex(head)];
+        quint32 next = candidate->nextFree.load(std::memory_order_relaxed);
+        if (_freeHead.compare_exchange_weak(head, _packHead(_headTag(head) + 1, next), std::memory_order_acq_rel, std::memory_order_acquire)) {
+            node = candidate;
+            _available.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    if (!node) {
+        // Pool exhausted, this only happens if subscribers are holding on to a large number of messages
+        _heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        node = new MAVLinkMessageNode;
+        node->poolIndex = heapIndex;
+        node->nextFree.store(heapIndex, std::memory_order_relaxed);
+    }
+
+    node->message = message;
+    node->refCount.store(1, std::memory_order_release);
+    return node;
+}
+
+void MAVLinkMessagePool::release(MAVLinkMessageNode* node)
+{
+    if (node->poolIndex == heapIndex) {
+        delete node;
+        return;
+    }
+
+    quint64 head = _freeHead.load(std::memory_order_relaxed);
+    do {
+        node->nextFree.store(_headIndex(head), std::memory_order_relaxed);
+    } while (!_freeHead.compare_exchange_weak(head, _packHead(_headTag(head) + 1, node->poolIndex), std::memory_order_release, std::memory_order_relaxed));
+    _available.fetch_add(1, std::memory_order_relaxed);
+}
+
+MAVLinkMessageHandle::MAVLinkMessageHandle(const mavlink_message_t& message)
+    : _node(MAVLinkMessagePool::instance()->allocate(message))
+{
+
+}
+
+MAVLinkMessageHandle::MAVLinkMessageHandle(const MAVLinkMessageHandle& other)
+    : _node(other._node)
+{
+    if (_node) {
+        _node->refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+MAVLinkMessageHandle::MAVLinkMessageHandle(MAVLinkMessageHandle&& other) noexcept
+    : _node(other._node)
+{
+    other._node = nullptr;
+}
+
+MAVLinkMessageHandle::~MAVLinkMessageHandle()
+{
+    _release();
+}
+
+MAVLinkMessageHandle& MAVLinkMessageHandle::operator=(MAVLinkMessageHandle other)
+{
+    std::swap(_node, other._node);
+    return *this;
+}
+
+mavlink_message_t* MAVLinkMessageHandle::detach(void)
+{
+    if (!_node) {
+        _node = MAVLinkMessagePool::instance()->allocate(_nullMessage);
+    } else if (_node->refCount.load(std::memory_order_acquire) != 1) {
+        MAVLinkMessageNode* copy = MAVLinkMessagePool::instance()->allocate(_node->message);
+        _release();
+        _node = copy;
+    }
+    return &_node->message;
+}
+
+void MAVLinkMessageHandle::_release(void)
+{
+    if (_node && _node->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        MAVLinkMessagePool::instance()->release(_node);
+    }
+    _node = nullptr;
+}
@@ -0,0 +1,105 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QMetaType>
+
+#include <atomic>
+
+#include "QGCMAVLink.h"
+
+/// Storage for a single pooled message. Only used through MAVLinkMessageHandle.
+struct MAVLinkMessageNode {
+    std::atomic<int>        refCount;
+    quint32                 poolIndex;  ///< Index into the pool, MAVLinkMessagePool::heapIndex for overflow allocations
+    std::atomic<quint32>    nextFree;   ///< Index of next free node while on the free list
+    mavlink_message_t       message;
+};
+
+/// Fixed size pool of message nodes with a lock-free free-list. Nodes can be allocated and released from any
+/// thread. The free-list head carries a tag which is bumped on every change to protect against ABA. If the
+/// pool runs dry nodes fall back to the heap so allocation never fails.
+class MAVLinkMessagePool
+{
+public:
+    static MAVLinkMessagePool* instance(void);
+
+    /// @return Node holding a copy of message with a reference count of 1
+    MAVLinkMessageNode* allocate(const mavlink_message_t& message);
+
+    /// Returns the node to the free-list. Called when the last reference goes away.
+    void release(MAVLinkMessageNode* node);
+
+    quint32 capacity        (void) const { return _capacity; }
+    int     available       (void) const { return _available.load(std::memory_order_relaxed); }
+    quint64 heapAllocations (void) const { return _heapAllocations.load(std::memory_order_relaxed); }
+
+    static const quint32 heapIndex = 0xFFFFFFFF;
+
+private:
+    MAVLinkMessagePool(quint32 capacity);
+    ~MAVLinkMessagePool();
+
+    static quint64 _packHead(quint64 tag, quint32 index) { return (tag << 32) | index; }
+    static quint32 _headIndex(quint64 head) { return static_cast<quint32>(head & 0xFFFFFFFF); }
+    static quint64 _headTag(quint64 head) { return head >> 32; }
+
+    const quint32           _capacity;
+    MAVLinkMessageNode*     _nodes;
+    std::atomic<quint64>    _freeHead;          ///< Upper 32 bits: ABA tag, lower 32 bits: index of first free node
+    std::atomic<int>        _available;
+    std::atomic<quint64>    _heapAllocations;   ///< Number of allocations which could not be satisfied by the pool
+
+    static const quint32    _defaultCapacity = 4096;
+};
+
+/// Immutable, reference counted handle to a received message. Copying a handle only bumps a reference count so
+/// all subscribers to a packet share a single buffer, including subscribers on other threads.
+///
+/// Slots which still take a const mavlink_message_t& can be called with a handle directly through the
+/// conversion operator. Slots which take mavlink_message_t by value still get their own copy.
+///
+/// A shared buffer is never written to. Code which needs to rewrite a message calls detach() which copies the
+/// message into a private buffer first, unless this handle is already the only reference.
+class MAVLinkMessageHandle
+{
+public:
+    MAVLinkMessageHandle(void) : _node(nullptr) { }
+    explicit MAVLinkMessageHandle(const mavlink_message_t& message);
+    MAVLinkMessageHandle(const MAVLinkMessageHandle& other);
+    MAVLinkMessageHandle(MAVLinkMessageHandle&& other) noexcept;
+    ~MAVLinkMessageHandle();
+
+    MAVLinkMessageHandle& operator=(MAVLinkMessageHandle other);
+
+    bool isNull(void) const { return _node == nullptr; }
+
+    /// @return Number of handles sharing the message, 0 for a null handle
+    int refCount(void) const { return _node ? _node->refCount.load(std::memory_order_relaxed) : 0; }
+
+    const mavlink_message_t& message    (void) const { return _node ? _node->message : _nullMessage; }
+    const mavlink_message_t* operator-> (void) const { return &message(); }
+    const mavlink_message_t& operator*  (void) const { return message(); }
+    operator const mavlink_message_t&   (void) const { return message(); }
+
+    /// Makes this handle the sole owner of its message, copying it if it is shared. Other handles keep seeing
+    /// the original message.
+    ///     @return Writable message, valid until the handle is changed or destroyed
+    mavlink_message_t* detach(void);
+
+private:
+    void _release(void);
+
+    MAVLinkMessageNode* _node;
+
+    static const mavlink_message_t _nullMessage;
+};
+
+Q_DECLARE_METATYPE(MAVLinkMessageHandle)
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkParserThread.h"
+#include "LinkInterface.h"
+#include "QGCLoggingCategory.h"
+
+QGC_LOGGING_CATEGORY(MAVLinkParserThreadLog, "MAVLinkParserThreadLog")
+
+MAVLinkParserThread::MAVLinkParserThread(LinkInterface* link)
+    : QThread               ()
+    , _link                 (link)
+    , _mavlinkChannel       (link->mavlinkChannel())
+    , _decodedFirstPacket   (false)
+    , _creationThread       (QThread::currentThread())
+{
+    memset(&_message,   0, sizeof(_message));
+    memset(&_status,    0, sizeof(_status));
+
+    qRegisterMetaType<QList<mavlink_message_t>>("QList<mavlink_message_t>");
+
+    setObjectName(QStringLiteral("MAVLinkParser:%1").arg(link->getName()));
+
+    // Same pattern as the links themselves: the thread object lives on the thread it runs such that
+    // _receiveBytes is always called from the parser thread.
+    moveToThread(this);
+
+    connect(link, &LinkInterface::bytesReceived, this, &MAVLinkParserThread::_receiveBytes);
+
+    qCDebug(MAVLinkParserThreadLog) << "Starting parser thread" << objectName() << "channel" << _mavlinkChannel;
+    start(HighPriority);
+}
+
+MAVLinkParserThread::~MAVLinkParserThread()
+{
+    stopParsing();
+}
+
+void MAVLinkParserThread::run(void)
+{
+    exec();
+    moveToThread(_creationThread);
+}
+
+void MAVLinkParserThread::stopParsing(void)
+{
+    if (isRunning()) {
+        if (_link) {
+            disconnect(_link, &LinkInterface::bytesReceived, this, &MAVLinkParserThread::_receiveBytes);
+        }
+        quit();
+        wait();
+        qCDebug(MAVLinkParserThreadLog) << "Stopped parser thread" << objectName();
+    }
+}
+
+void MAVLinkParserThread::setOutboundMavlink1(bool mavlink1)
+{
+    QMetaObject::invokeMethod(this, "_setOutboundMavlink1", Qt::QueuedConnection, Q_ARG(bool, mavlink1));
+}
+
+void MAVLinkParserThread::_setOutboundMavlink1(bool mavlink1)
+{
+    mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(_mavlinkChannel);
+
+    if (mavlink1) {
+        mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    } else {
+        mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    }
+}
+
+void MAVLinkParserThread::_receiveBytes(LinkInterface* link, QByteArray bytes)
+{
+    QList<mavlink_message_t> messages;
+    int nonMavlinkBytes = 0;
+
+    link->logReceiveDispatched();
+
+    for (int position = 0; position < bytes.size(); position++) {
+        if (mavlink_parse_char(_mavlinkChannel, static_cast<uint8_t>(bytes[position]), &_message, &_status)) {
+            if (!_decodedFirstPacket) {
+                _decodedFirstPacket = true;
+                mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(_mavlinkChannel);
+                if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+                    mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+                    emit mavlink2Detected(link);
+                }
+            }
+            messages.append(_message);
+            memset(&_status,  0, sizeof(_status));
+            memset(&_message, 0, sizeof(_message));
+        } else if (!_decodedFirstPacket) {
+            nonMavlinkBytes++;
+        }
+    }
+
+    if (messages.count() || nonMavlinkBytes) {
+        emit messagesDecoded(link, messages, nonMavlinkBytes);
+    }
+}
@@ -0,0 +1,69 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QList>
+#include <QByteArray>
+#include <QPointer>
+#include <QLoggingCategory>
+
+#include "QGCMAVLink.h"
+#include "LinkInterface.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkParserThreadLog)
+
+/// Runs mavlink_parse_char for a single link on its own thread. Each link owns its own mavlink channel and
+/// therefore its own parser state, so links no longer have to wait behind each other for the protocol thread
+/// to frame their bytes. Decoded messages are handed back in the order they arrived on the link.
+///
+/// mavlink_parse_char updates the channel status of the link, so while the thread runs it is the only writer of that
+/// status. Changes from other threads go through setOutboundMavlink1, which is carried out on the parser thread.
+class MAVLinkParserThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    MAVLinkParserThread(LinkInterface* link);
+    ~MAVLinkParserThread();
+
+    LinkInterface* link(void) { return _link; }
+
+    /// Stops the parser event loop and waits for the thread to exit. Bytes which are still queued are dropped.
+    void stopParsing(void);
+
+    /// Sets or clears MAVLINK_STATUS_FLAG_OUT_MAVLINK1 on the link's channel. Thread safe, the change is queued to the
+    /// parser thread.
+    void setOutboundMavlink1(bool mavlink1);
+
+    // Overrides from QThread
+    void run(void) override;
+
+signals:
+    /// Emitted on the parser thread with all messages which were decoded from a single bytesReceived chunk.
+    ///     @param nonMavlinkBytes Number of bytes received on the link before the first valid packet was decoded
+    void messagesDecoded(LinkInterface* link, QList<mavlink_message_t> messages, int nonMavlinkBytes);
+
+    /// Emitted on the parser thread if the first packet on a link sending mavlink 1 is a mavlink 2 packet. Outbound
+    /// on the link has already been switched to mavlink 2. Emitted ahead of the messagesDecoded carrying the packet.
+    void mavlink2Detected(LinkInterface* link);
+
+private slots:
+    void _receiveBytes          (LinkInterface* link, QByteArray bytes);
+    void _setOutboundMavlink1   (bool mavlink1);
+
+private:
+    QPointer<LinkInterface> _link;
+    uint8_t                 _mavlinkChannel;
+    mavlink_message_t       _message;
+    mavlink_status_t        _status;
+    bool                    _decodedFirstPacket;    ///< true: at least one valid packet has been parsed on this link
+    QThread*                _creationThread;        ///< QThread on which the object was created
+};
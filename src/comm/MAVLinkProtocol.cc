@@ -24,10 +24,12 @@
 #include <QStandardPaths>
 #include <QtEndian>
 #include <QMetaType>
+#include <QMetaMethod>
 #include <QDir>
 #include <QFileInfo>
 
 #include "MAVLinkProtocol.h"
+#include "MAVLinkParserThread.h"
 #include "UASInterface.h"
 #include "UASInterface.h"
 #include "UAS.h"
@@ -45,6 +47,7 @@ QGC_LOGGING_CATEGORY(MAVLinkProtocolLog, "MAVLinkProtocolLog")
 
 const char* MAVLinkProtocol::_tempLogFileTemplate = "FlightDataXXXXXX"; ///< Template for temporary log file
 const char* MAVLinkProtocol::_logFileExtension = "mavlink";             ///< Extension for log files
+const int   MAVLinkProtocol::_telemetryLogStatsIntervalMsecs = 1000;
 
 /**
  * The default constructor will create a new MAVLink object sending heartbeats at
@@ -63,9 +66,21 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     , _logSuspendReplay(false)
     , _vehicleWasArmed(false)
     , _tempLogFile(QString("%2.%3").arg(_tempLogFileTemplate).arg(_logFileExtension))
+    , _telemetryLogStats({})
     , _linkMgr(nullptr)
     , _multiVehicleManager(nullptr)
+    , _threadedParsing(false)
+    , _replayTimeUSecs(0)
+    , _nonmavlinkCount(0)
+    , _checkedUserNonMavlink(false)
+    , _warnedUserNonMavlink(false)
 {
+    _handlerTimer.start();
+    connect(&_logWriter, &TelemetryLogWriter::writeError, this, &MAVLinkProtocol::_logWriteError, Qt::QueuedConnection);
+
+    _telemetryLogStatsTimer.setInterval(_telemetryLogStatsIntervalMsecs);
+    connect(&_telemetryLogStatsTimer, &QTimer::timeout, this, &MAVLinkProtocol::_updateTelemetryLogStats);
+
     memset(totalReceiveCounter, 0, sizeof(totalReceiveCounter));
     memset(totalLossCounter,    0, sizeof(totalLossCounter));
     memset(runningLossPercent,  0, sizeof(runningLossPercent));
@@ -77,6 +92,8 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
 MAVLinkProtocol::~MAVLinkProtocol()
 {
     storeSettings();
+    qDeleteAll(_parserThreads);
+    _parserThreads.clear();
     _closeLogFile();
 }
 
@@ -85,6 +102,13 @@ void MAVLinkProtocol::setVersion(unsigned version)
     QList<LinkInterface*> links = _linkMgr->links();
 
     for (int i = 0; i < links.length(); i++) {
+        // A running parser thread owns the channel status
+        MAVLinkParserThread* parserThread = _parserThreads.value(links[i], nullptr);
+        if (parserThread) {
+            parserThread->setOutboundMavlink1(version < 200);
+            continue;
+        }
+
         mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(links[i]->mavlinkChannel());
 
         // Set flags for version
@@ -106,9 +130,16 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    _multiVehicleManager =   _toolbox->multiVehicleManager();
 
    qRegisterMetaType<mavlink_message_t>("mavlink_message_t");
+   qRegisterMetaType<QList<mavlink_message_t>>("QList<mavlink_message_t>");
+   qRegisterMetaType<QVector<quint64>>("QVector<quint64>");
+   qRegisterMetaType<MAVLinkMessageHandle>("MAVLinkMessageHandle");
 
    loadSettings();
 
+   Fact* threadedParsingFact = _toolbox->settingsManager()->appSettings()->mavlinkThreadedParsing();
+   _threadedParsing = threadedParsingFact->rawValue().toBool();
+   connect(threadedParsingFact, &Fact::rawValueChanged, this, &MAVLinkProtocol::_threadedParsingChanged);
+
    // All the *Counter variables are not initialized here, as they should be initialized
    // on a per-link basis before those links are used. @see resetMetadataForLink().
 
@@ -147,6 +178,51 @@ void MAVLinkProtocol::storeSettings()
     // Parameter interface settings
 }
 
+void MAVLinkProtocol::setThreadedParsing(bool threadedParsing)
+{
+    _app->toolbox()->settingsManager()->appSettings()->mavlinkThreadedParsing()->setRawValue(threadedParsing);
+}
+
+void MAVLinkProtocol::_threadedParsingChanged(QVariant value)
+{
+    _threadedParsing = value.toBool();
+}
+
+void MAVLinkProtocol::startLinkParsing(LinkInterface* link)
+{
+    if (!_threadedParsing) {
+        connect(link, &LinkInterface::bytesReceived, this, &MAVLinkProtocol::receiveBytes, Qt::UniqueConnection);
+        return;
+    }
+
+    // Framing moves to the parser thread. Loss accounting, logging and signalling stay on the protocol thread
+    // so everything downstream of messageReceived still runs on the main thread in per link order.
+
+    if (_parserThreads.contains(link)) {
+        return;
+    }
+
+    MAVLinkParserThread* parserThread = new MAVLinkParserThread(link);
+    connect(parserThread, &MAVLinkParserThread::messagesDecoded,   this, &MAVLinkProtocol::_receiveDecodedMessages);
+    connect(parserThread, &MAVLinkParserThread::mavlink2Detected,  this, &MAVLinkProtocol::_mavlink2Detected);
+    _parserThreads[link] = parserThread;
+}
+
+void MAVLinkProtocol::stopLinkParsing(LinkInterface* link)
+{
+    disconnect(link, &LinkInterface::bytesReceived, this, &MAVLinkProtocol::receiveBytes);
+
+    if (link->isLogReplay()) {
+        _replayTimeUSecs = 0;
+    }
+
+    MAVLinkParserThread* parserThread = _parserThreads.take(link);
+    if (parserThread) {
+        parserThread->stopParsing();
+        delete parserThread;
+    }
+}
+
 void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 {
     int channel = link->mavlinkChannel();
@@ -167,26 +243,10 @@ void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 
 void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
 
-    uint8_t bytes_time[sizeof(quint64)];
-
     Q_UNUSED(link);
-    if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-
+    if (!_logSuspendError && !_logSuspendReplay && _logWriter.writing()) {
         quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-
-        qToBigEndian(time,bytes_time);
-
-        b.insert(0,QByteArray((const char*)bytes_time,sizeof(bytes_time)));
-
-        int len = b.count();
-
-        if(_tempLogFile.write(b) != len)
-        {
-            // If there's an error logging data, raise an alert and stop logging.
-            emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-            _stopLogging();
-            _logSuspendError = true;
-        }
+        _logWriter.enqueue(time, reinterpret_cast<const uint8_t*>(b.constData()), b.count());
     }
 
 }
@@ -207,175 +267,239 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
     if (!_linkMgr->containsLink(link)) {
         return;
     }
+    link->logReceiveDispatched();
 
     uint8_t mavlinkChannel = link->mavlinkChannel();
 
-    static int  nonmavlinkCount = 0;
-    static bool checkedUserNonMavlink = false;
-    static bool warnedUserNonMavlink  = false;
-
     for (int position = 0; position < b.size(); position++) {
         if (mavlink_parse_char(mavlinkChannel, static_cast<uint8_t>(b[position]), &_message, &_status)) {
-            // Got a valid message
-            if (!link->decodedFirstMavlinkPacket()) {
-                link->setDecodedFirstMavlinkPacket(true);
-                mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-                if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    qDebug() << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                    mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-                    // Set all links to v2
-                    setVersion(200);
-                }
+            _handleMessage(link, _message);
+            // Reset message parsing
+            memset(&_status,  0, sizeof(_status));
+            memset(&_message, 0, sizeof(_message));
+        } else if (!link->decodedFirstMavlinkPacket()) {
+            // No formed message yet
+            if (!_countNonMavlinkBytes(link, 1)) {
+                return;
             }
+        }
+    }
+}
 
-            //-----------------------------------------------------------------
-            // MAVLink Status
-            uint8_t lastSeq = lastIndex[_message.sysid][_message.compid];
-            uint8_t expectedSeq = lastSeq + 1;
-            // Increase receive counter
-            totalReceiveCounter[mavlinkChannel]++;
-            // Determine what the next expected sequence number is, accounting for
-            // never having seen a message for this system/component pair.
-            if(firstMessage[_message.sysid][_message.compid]) {
-                firstMessage[_message.sysid][_message.compid] = 0;
-                lastSeq     = _message.seq;
-                expectedSeq = _message.seq;
-            }
-            // And if we didn't encounter that sequence number, record the error
-            //int foo = 0;
-            if (_message.seq != expectedSeq)
-            {
-                //foo = 1;
-                int lostMessages = 0;
-                //-- Account for overflow during packet loss
-                if(_message.seq < expectedSeq) {
-                    lostMessages = (_message.seq + 255) - expectedSeq;
-                } else {
-                    lostMessages = _message.seq - expectedSeq;
-                }
-                // Log how many were lost
-                totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
-            }
+/// Called on the protocol thread with the messages framed by a MAVLinkParserThread. Messages are in the
+/// same order as they arrived on the link.
+void MAVLinkProtocol::_receiveDecodedMessages(LinkInterface* link, QList<mavlink_message_t> messages, int nonMavlinkBytes)
+{
+    // Same as receiveBytes, the link may have gone away while the messages were queued
+    if (!_linkMgr->containsLink(link)) {
+        return;
+    }
 
-            // And update the last sequence number for this system/component pair
-            lastIndex[_message.sysid][_message.compid] = _message.seq;;
-            // Calculate new loss ratio
-            uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
-            float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
-            receiveLossPercent *= 100.0f;
-            receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
-            runningLossPercent[mavlinkChannel] = receiveLossPercent;
-
-            //qDebug() << foo << _message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << _message.sysid << _message.compid << ")";
-
-            //-----------------------------------------------------------------
-            // Log data
-            if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-                uint8_t buf[MAVLINK_MAX_PACKET_LEN+sizeof(quint64)];
-
-                // Write the uint64 time in microseconds in big endian format before the message.
-                // This timestamp is saved in UTC time. We are only saving in ms precision because
-                // getting more than this isn't possible with Qt without a ton of extra code.
-                quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-                qToBigEndian(time, buf);
-
-                // Then write the message to the buffer
-                int len = mavlink_msg_to_send_buffer(buf + sizeof(quint64), &_message);
-
-                // Determine how many bytes were written by adding the timestamp size to the message size
-                len += sizeof(quint64);
-
-                // Now write this timestamp/message pair to the log.
-                QByteArray b(reinterpret_cast<const char*>(buf), len);
-                if(_tempLogFile.write(b) != len)
-                {
-                    // If there's an error logging data, raise an alert and stop logging.
-                    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-                    _stopLogging();
-                    _logSuspendError = true;
-                }
-
-                // Check for the vehicle arming going by. This is used to trigger log save.
-                if (!_vehicleWasArmed && _message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                    mavlink_heartbeat_t state;
-                    mavlink_msg_heartbeat_decode(&_message, &state);
-                    if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
-                        _vehicleWasArmed = true;
-                    }
-                }
-            }
+    if (nonMavlinkBytes && !link->decodedFirstMavlinkPacket()) {
+        if (!_countNonMavlinkBytes(link, nonMavlinkBytes)) {
+            return;
+        }
+    }
 
-            if (_message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                _startLogging();
-                mavlink_heartbeat_t heartbeat;
-                mavlink_msg_heartbeat_decode(&_message, &heartbeat);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, heartbeat.autopilot, heartbeat.type);
-            }
+    for (const mavlink_message_t& message: messages) {
+        _handleMessage(link, message);
+    }
+}
 
-            if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
-                _startLogging();
-                mavlink_high_latency2_t highLatency2;
-                mavlink_msg_high_latency2_decode(&_message, &highLatency2);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, highLatency2.autopilot, highLatency2.type);
-            }
+/// Called on the protocol thread once a MAVLinkParserThread switched its link to mavlink 2
+void MAVLinkProtocol::_mavlink2Detected(LinkInterface* link)
+{
+    if (!_linkMgr->containsLink(link)) {
+        return;
+    }
 
-#if 0
-            // Given the current state of SiK Radio firmwares there is no way to make the code below work.
-            // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
-            // packet even if the vehicle is sending Mavlink 2.
+    qDebug() << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << link->mavlinkChannel();
+    // Set all links to v2
+    setVersion(200);
+}
+
+/// Called on the protocol thread with messages decoded by a LogReplayLink in batch mode. The log timestamp of each
+/// message is available from replayTimeUSecs while the message is handled.
+void MAVLinkProtocol::receiveReplayMessages(LinkInterface* link, QList<mavlink_message_t> messages, QVector<quint64> timestampsUSecs)
+{
+    if (!_linkMgr->containsLink(link)) {
+        return;
+    }
 
-            // Detect if we are talking to an old radio not supporting v2
+    for (int i=0; i<messages.count(); i++) {
+        if (i < timestampsUSecs.count()) {
+            _replayTimeUSecs = timestampsUSecs[i];
+        }
+        _handleMessage(link, messages[i]);
+    }
+}
+
+/// Tracks the amount of data received on a link before any valid mavlink packet was decoded.
+/// @return false: link has been disconnected since it is not talking mavlink
+bool MAVLinkProtocol::_countNonMavlinkBytes(LinkInterface* link, int byteCount)
+{
+    _nonmavlinkCount += byteCount;
+    if (_nonmavlinkCount > 1000 && !_warnedUserNonMavlink) {
+        // 1000 bytes with no mavlink message. Are we connected to a mavlink capable device?
+        if (!_checkedUserNonMavlink) {
+            link->requestReset();
+            _checkedUserNonMavlink = true;
+        } else {
+            _warnedUserNonMavlink = true;
+            // Disconnect the link since it's some other device and
+            // QGC clinging on to it and feeding it data might have unintended
+            // side effects (e.g. if its a modem)
+            qDebug() << "disconnected link" << link->getName() << "as it contained no MAVLink data";
+            QMetaObject::invokeMethod(_linkMgr, "disconnectLink", Q_ARG( LinkInterface*, link ) );
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Processes a single fully decoded message: loss accounting, telemetry logging and signalling
+void MAVLinkProtocol::_handleMessage(LinkInterface* link, const mavlink_message_t& message)
+{
+    uint8_t mavlinkChannel = link->mavlinkChannel();
+
+    // Got a valid message
+    if (!link->decodedFirstMavlinkPacket()) {
+        link->setDecodedFirstMavlinkPacket(true);
+        // A parser thread owns the channel status of its link and makes this check itself, see _mavlink2Detected
+        if (!_parserThreads.contains(link)) {
             mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-            if (_message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
-                if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
-                && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    _radio_version_mismatch_count++;
-                }
+            if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+                qDebug() << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
+                mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+                // Set all links to v2
+                setVersion(200);
             }
+        }
+    }
 
-            if (_radio_version_mismatch_count == 5) {
-                // Warn the user if the radio continues to send v1 while the link uses v2
-                emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
-                // Set to flag warning already shown
-                _radio_version_mismatch_count = -1;
-                // Flick link back to v1
-                qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-            }
-#endif
+    //-----------------------------------------------------------------
+    // MAVLink Status
+    uint8_t lastSeq = lastIndex[message.sysid][message.compid];
+    uint8_t expectedSeq = lastSeq + 1;
+    // Increase receive counter
+    totalReceiveCounter[mavlinkChannel]++;
+    // Determine what the next expected sequence number is, accounting for
+    // never having seen a message for this system/component pair.
+    if(firstMessage[message.sysid][message.compid]) {
+        firstMessage[message.sysid][message.compid] = 0;
+        lastSeq     = message.seq;
+        expectedSeq = message.seq;
+    }
+    // And if we didn't encounter that sequence number, record the error
+    //int foo = 0;
+    if (message.seq != expectedSeq)
+    {
+        //foo = 1;
+        int lostMessages = 0;
+        //-- Account for overflow during packet loss
+        if(message.seq < expectedSeq) {
+            lostMessages = (message.seq + 255) - expectedSeq;
+        } else {
+            lostMessages = message.seq - expectedSeq;
+        }
+        // Log how many were lost
+        totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
+    }
 
-            // Update MAVLink status on every 32th packet
-            if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
-                emit mavlinkMessageStatus(_message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
+    // And update the last sequence number for this system/component pair
+    lastIndex[message.sysid][message.compid] = message.seq;;
+    // Calculate new loss ratio
+    uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
+    float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
+    receiveLossPercent *= 100.0f;
+    receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
+    runningLossPercent[mavlinkChannel] = receiveLossPercent;
+
+    //qDebug() << foo << message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << message.sysid << message.compid << ")";
+
+    //-----------------------------------------------------------------
+    // Log data
+    if (!_logSuspendError && !_logSuspendReplay && _logWriter.writing()) {
+        uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+
+        // The uint64 time in microseconds is written in big endian format before the message by the log writer.
+        // This timestamp is saved in UTC time. We are only saving in ms precision because
+        // getting more than this isn't possible with Qt without a ton of extra code.
+        quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
+        int len = mavlink_msg_to_send_buffer(buf, &message);
+
+        // Queue the timestamp/message pair for the writer thread. If the disk can't keep up the record is
+        // dropped and counted in the writer stats, write failures are reported through _logWriteError.
+        _logWriter.enqueue(time, buf, len);
+
+        // Check for the vehicle arming going by. This is used to trigger log save.
+        if (!_vehicleWasArmed && message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            mavlink_heartbeat_t state;
+            mavlink_msg_heartbeat_decode(&message, &state);
+            if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
+                _vehicleWasArmed = true;
             }
+        }
+    }
 
-            // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-            // kind of inefficient, but no issue for a groundstation pc.
-            // It buys as reentrancy for the whole code over all threads
-            emit messageReceived(link, _message);
-            // Reset message parsing
-            memset(&_status,  0, sizeof(_status));
-            memset(&_message, 0, sizeof(_message));
-        } else if (!link->decodedFirstMavlinkPacket()) {
-            // No formed message yet
-            nonmavlinkCount++;
-            if (nonmavlinkCount > 1000 && !warnedUserNonMavlink) {
-                // 1000 bytes with no mavlink message. Are we connected to a mavlink capable device?
-                if (!checkedUserNonMavlink) {
-                    link->requestReset();
-                    checkedUserNonMavlink = true;
-                } else {
-                    warnedUserNonMavlink = true;
-                    // Disconnect the link since it's some other device and
-                    // QGC clinging on to it and feeding it data might have unintended
-                    // side effects (e.g. if its a modem)
-                    qDebug() << "disconnected link" << link->getName() << "as it contained no MAVLink data";
-                    QMetaObject::invokeMethod(_linkMgr, "disconnectLink", Q_ARG( LinkInterface*, link ) );
-                    return;
-                }
-            }
+    if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        _startLogging();
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, heartbeat.autopilot, heartbeat.type);
+    }
+
+    if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
+        _startLogging();
+        mavlink_high_latency2_t highLatency2;
+        mavlink_msg_high_latency2_decode(&message, &highLatency2);
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, highLatency2.autopilot, highLatency2.type);
+    }
+
+#if 0
+    // Given the current state of SiK Radio firmwares there is no way to make the code below work.
+    // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
+    // packet even if the vehicle is sending Mavlink 2.
+
+    // Detect if we are talking to an old radio not supporting v2
+    mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+    if (message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
+        if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
+        && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+            _radio_version_mismatch_count++;
         }
     }
+
+    if (_radio_version_mismatch_count == 5) {
+        // Warn the user if the radio continues to send v1 while the link uses v2
+        emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
+        // Set to flag warning already shown
+        _radio_version_mismatch_count = -1;
+        // Flick link back to v1
+        qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
+        mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    }
+#endif
+
+    // Update MAVLink status on every 32th packet
+    if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
+        emit mavlinkMessageStatus(message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
+    }
+
+    // All directly connected subscribers (vehicle routing, plugins, message handlers) run within the emits
+    // below, so timing them gives the cost of handling this message on the protocol thread.
+    const qint64 handlerStartNSecs = _handlerTimer.nsecsElapsed();
+
+    // The packet is copied once into a pooled buffer which is then shared by all subscribers, including
+    // queued subscribers on other threads. Only legacy subscribers pay for their own copy.
+    emit sharedMessageReceived(link, MAVLinkMessageHandle(message));
+
+    static const QMetaMethod messageReceivedSignal = QMetaMethod::fromSignal(&MAVLinkProtocol::messageReceived);
+    if (isSignalConnected(messageReceivedSignal)) {
+        emit messageReceived(link, message);
+    }
+
+    _handlerStats.record(message.sysid, message.msgid, _handlerTimer.nsecsElapsed() - handlerStartNSecs);
 }
 
 /**
@@ -423,8 +547,12 @@ void MAVLinkProtocol::_vehicleCountChanged(void)
 bool MAVLinkProtocol::_closeLogFile(void)
 {
     if (_tempLogFile.isOpen()) {
-        if (_tempLogFile.size() == 0) {
-            // Don't save zero byte files
+        // Everything still queued must reach the file before it is closed
+        _logWriter.stopWriting();
+        _telemetryLogStatsTimer.stop();
+        _updateTelemetryLogStats();
+        if (_telemetryLogStats.recordsQueued == 0) {
+            // Don't save logs without packets, a compressed one still has its header and index
             _tempLogFile.remove();
             return false;
         } else {
@@ -465,6 +593,8 @@ void MAVLinkProtocol::_startLogging(void)
             }
 
             qDebug() << "Temp log" << _tempLogFile.fileName();
+            _logWriter.startWriting(&_tempLogFile, appSettings->telemetrySaveCompressed()->rawValue().toBool());
+            _telemetryLogStatsTimer.start();
             emit checkTelemetrySavePath();
 
             _logSuspendError = false;
@@ -488,6 +618,21 @@ void MAVLinkProtocol::_stopLogging(void)
     _vehicleWasArmed = false;
 }
 
+void MAVLinkProtocol::_logWriteError(QString errorString)
+{
+    // If there's an error logging data, raise an alert and stop logging.
+    qCWarning(MAVLinkProtocolLog) << "Telemetry log write failed" << errorString;
+    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
+    _stopLogging();
+    _logSuspendError = true;
+}
+
+void MAVLinkProtocol::_updateTelemetryLogStats(void)
+{
+    _telemetryLogStats = _logWriter.stats();
+    emit telemetryLogStatsChanged();
+}
+
 /// @brief Checks the temp directory for log files which may have been left there.
 ///         This could happen if QGC crashes without the temp log file being saved.
 ///         Give the user an option to save these orphaned files.
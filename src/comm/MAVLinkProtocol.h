@@ -17,15 +17,21 @@
 #include <QMap>
 #include <QByteArray>
 #include <QLoggingCategory>
+#include <QElapsedTimer>
+#include <QVector>
 
 #include "LinkInterface.h"
 #include "QGCMAVLink.h"
+#include "MAVLinkHandlerStats.h"
+#include "MAVLinkMessageHandle.h"
 #include "QGC.h"
 #include "QGCTemporaryFile.h"
+#include "TelemetryLogWriter.h"
 #include "QGCToolbox.h"
 
 class LinkManager;
 class MultiVehicleManager;
+class MAVLinkParserThread;
 class QGCApplication;
 
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkProtocolLog)
@@ -41,6 +47,11 @@ class MAVLinkProtocol : public QGCTool
     Q_OBJECT
 
 public:
+    Q_PROPERTY(quint32 telemetryLogBytesWritten         READ telemetryLogBytesWritten           NOTIFY telemetryLogStatsChanged)
+    Q_PROPERTY(quint32 telemetryLogBytesQueued          READ telemetryLogBytesQueued            NOTIFY telemetryLogStatsChanged)
+    Q_PROPERTY(quint32 telemetryLogRecordsDropped       READ telemetryLogRecordsDropped         NOTIFY telemetryLogStatsChanged)
+    Q_PROPERTY(quint32 telemetryLogMaxWriteLatencyUSecs READ telemetryLogMaxWriteLatencyUSecs   NOTIFY telemetryLogStatsChanged)
+
     MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox);
     ~MAVLinkProtocol();
 
@@ -74,6 +85,36 @@ public:
     /// Set protocol version
     void setVersion(unsigned version);
 
+    /// @return true: Each link is parsed on its own MAVLinkParserThread, false: all links are parsed on the protocol thread
+    bool threadedParsing(void) const { return _threadedParsing; }
+
+    /// Enables/disables per-link parser threads, persisted in AppSettings::mavlinkThreadedParsing. Only affects links
+    /// which are added after the change.
+    void setThreadedParsing(bool threadedParsing);
+
+    /// Routes the bytes received on the link to the protocol. Depending on threadedParsing this is either a
+    /// direct connection to receiveBytes or a dedicated parser thread for the link.
+    void startLinkParsing(LinkInterface* link);
+
+    /// Shuts down any parser thread associated with the link
+    void stopLinkParsing(LinkInterface* link);
+
+    /// @return Per (sysid, msgid) message handler cost counters
+    MAVLinkHandlerStats* handlerStats(void) { return &_handlerStats; }
+
+    /// @return Log time of the message most recently dispatched from a batch log replay, 0 if no batch replay is
+    ///         feeding the protocol. Lets time based state such as flight time follow the log instead of the wall clock.
+    quint64 replayTimeUSecs(void) const { return _replayTimeUSecs; }
+
+    /// @return Statistics from the telemetry log writer thread
+    TelemetryLogWriter::Stats_t telemetryLogStats(void) const { return _logWriter.stats(); }
+
+    // Snapshot of telemetryLogStats, refreshed once a second while logging
+    quint32 telemetryLogBytesWritten        (void) const { return static_cast<quint32>(_telemetryLogStats.bytesWritten); }
+    quint32 telemetryLogBytesQueued         (void) const { return static_cast<quint32>(_telemetryLogStats.bytesQueued); }
+    quint32 telemetryLogRecordsDropped      (void) const { return static_cast<quint32>(_telemetryLogStats.recordsDropped); }
+    quint32 telemetryLogMaxWriteLatencyUSecs(void) const { return static_cast<quint32>(_telemetryLogStats.maxWriteLatencyUSecs); }
+
     // Override from QGCTool
     virtual void setToolbox(QGCToolbox *toolbox);
 
@@ -81,6 +122,10 @@ public slots:
     /** @brief Receive bytes from a communication interface */
     void receiveBytes(LinkInterface* link, QByteArray b);
 
+    /// Receives messages which were already decoded by a log replay link in batch mode
+    ///     @param timestampsUSecs Log timestamp for each message
+    void receiveReplayMessages(LinkInterface* link, QList<mavlink_message_t> messages, QVector<quint64> timestampsUSecs);
+
     /** @brief Log bytes sent from a communication interface */
     void logSentBytes(LinkInterface* link, QByteArray b);
     
@@ -121,7 +166,10 @@ signals:
     /// Heartbeat received on link
     void vehicleHeartbeatInfo(LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
 
-    /** @brief Message received and directly copied via signal */
+    /// Message received. All subscribers share the same pooled buffer, new code should use this signal.
+    void sharedMessageReceived(LinkInterface* link, MAVLinkMessageHandle message);
+    /// Message received and copied to each subscriber. Only emitted if something is connected to it. Nothing in
+    /// the tree uses it anymore, it is kept for custom builds which have not moved to sharedMessageReceived.
     void messageReceived(LinkInterface* link, mavlink_message_t message);
     /** @brief Emitted if version check is enabled / disabled */
     void versionCheckChanged(bool enabled);
@@ -152,10 +200,19 @@ signals:
     /// Emitted when a telemetry log is started to save.
     void checkTelemetrySavePath(void);
 
+    void telemetryLogStatsChanged(void);
+
 private slots:
     void _vehicleCountChanged(void);
+    void _receiveDecodedMessages(LinkInterface* link, QList<mavlink_message_t> messages, int nonMavlinkBytes);
+    void _mavlink2Detected      (LinkInterface* link);
+    void _logWriteError         (QString errorString);
+    void _updateTelemetryLogStats(void);
+    void _threadedParsingChanged(QVariant value);
     
 private:
+    void _handleMessage         (LinkInterface* link, const mavlink_message_t& message);
+    bool _countNonMavlinkBytes  (LinkInterface* link, int byteCount);
     bool _closeLogFile(void);
     void _startLogging(void);
     void _stopLogging(void);
@@ -167,8 +224,24 @@ private:
     QGCTemporaryFile    _tempLogFile;            ///< File to log to
     static const char*  _tempLogFileTemplate;    ///< Template for temporary log file
     static const char*  _logFileExtension;       ///< Extension for log files
+    TelemetryLogWriter  _logWriter;              ///< Writes _tempLogFile on its own thread, must be declared after _tempLogFile
+    TelemetryLogWriter::Stats_t _telemetryLogStats;
+    QTimer              _telemetryLogStatsTimer;
 
     LinkManager*            _linkMgr;
     MultiVehicleManager*    _multiVehicleManager;
+
+    bool                                        _threadedParsing;
+    QMap<LinkInterface*, MAVLinkParserThread*>  _parserThreads;
+
+    MAVLinkHandlerStats _handlerStats;
+    QElapsedTimer       _handlerTimer;
+    quint64             _replayTimeUSecs;
+
+    int     _nonmavlinkCount;
+    bool    _checkedUserNonMavlink;
+    bool    _warnedUserNonMavlink;
+
+    static const int   _telemetryLogStatsIntervalMsecs;
 };
 
@@ -52,6 +52,12 @@ const char* MockConfiguration::_vehicleTypeKey =    "VehicleType";
 const char* MockConfiguration::_sendStatusTextKey = "SendStatusText";
 const char* MockConfiguration::_highLatencyKey =    "HighLatency";
 const char* MockConfiguration::_failureModeKey =    "FailureMode";
+const char* MockConfiguration::_swarmVehicleCountKey =  "SwarmVehicleCount";
+const char* MockConfiguration::_swarmFirstSystemIdKey = "SwarmFirstSystemId";
+const char* MockConfiguration::_swarmTelemetryRateKey = "SwarmTelemetryRate";
+const char* MockConfiguration::_swarmMessageMixKey =    "SwarmMessageMix";
+const char* MockConfiguration::_swarmPacketLossKey =    "SwarmPacketLoss";
+const char* MockConfiguration::_swarmJitterMSecsKey =   "SwarmJitterMSecs";
 
 MockLink::MockLink(SharedLinkConfigurationPointer& config)
     : LinkInterface                         (config)
@@ -71,6 +77,7 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
     , _vehicleLongitude                     (_defaultVehicleLongitude + ((_vehicleSystemId - 128) * 0.0001))
     , _vehicleAltitude                      (_defaultVehicleAltitude)
     , _fileServer                           (nullptr)
+    , _swarm                                (nullptr)
     , _sendStatusText                       (false)
     , _apmSendHomePositionOnEmptyList       (false)
     , _failureMode                          (MockConfiguration::FailNone)
@@ -80,6 +87,13 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
     , _currentParamRequestListParamIndex    (-1)
     , _logDownloadCurrentOffset             (0)
     , _logDownloadBytesRemaining            (0)
+    , _logDownloadPendingOffset             (0)
+    , _logDownloadPendingBytes              (0)
+    , _logDownloadInFlight                  (0)
+    , _logDownloadLossy                     (false)
+    , _logDownloadRequestCount              (0)
+    , _logDownloadSentCount                 (0)
+    , _logDownloadDropCount                 (0)
     , _adsbAngle                            (0)
 {
     MockConfiguration* mockConfig = qobject_cast<MockConfiguration*>(_config.data());
@@ -98,6 +112,11 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
     _fileServer = new MockLinkFileServer(_vehicleSystemId, _vehicleComponentId, this);
     Q_CHECK_PTR(_fileServer);
 
+    if (mockConfig->swarmVehicleCount() > 0) {
+        _swarm = new MockLinkSwarm(this, mockConfig);
+        qCDebug(MockLinkLog) << "Swarm vehicles" << _swarm->systemIds();
+    }
+
     moveToThread(this);
 
     _loadParams();
@@ -152,17 +171,27 @@ void MockLink::run(void)
     QTimer  timer1HzTasks;
     QTimer  timer10HzTasks;
     QTimer  timer500HzTasks;
+    QTimer  timerSwarmTasks;
 
     QObject::connect(&timer1HzTasks,  &QTimer::timeout, this, &MockLink::_run1HzTasks);
     QObject::connect(&timer10HzTasks, &QTimer::timeout, this, &MockLink::_run10HzTasks);
     QObject::connect(&timer500HzTasks, &QTimer::timeout, this, &MockLink::_run500HzTasks);
 
-    timer1HzTasks.start(1000);
-    timer10HzTasks.start(100);
-    timer500HzTasks.start(2);
+    if (_swarm) {
+        // The link's own vehicle stays silent in swarm mode
+        QObject::connect(&timerSwarmTasks, &QTimer::timeout, this, &MockLink::_runSwarmTasks);
+        timerSwarmTasks.setTimerType(Qt::PreciseTimer);
+        timerSwarmTasks.start(MockLinkSwarm::tickMSecs);
+    } else {
+        timer1HzTasks.start(1000);
+        timer10HzTasks.start(100);
+        timer500HzTasks.start(2);
+    }
 
     exec();
 
+    QObject::disconnect(&timerSwarmTasks, &QTimer::timeout, this, &MockLink::_runSwarmTasks);
+
     QObject::disconnect(&timer1HzTasks,  &QTimer::timeout, this, &MockLink::_run1HzTasks);
     QObject::disconnect(&timer10HzTasks, &QTimer::timeout, this, &MockLink::_run10HzTasks);
     QObject::disconnect(&timer500HzTasks, &QTimer::timeout, this, &MockLink::_run500HzTasks);
@@ -226,6 +255,13 @@ void MockLink::_run500HzTasks(void)
     }
 }
 
+void MockLink::_runSwarmTasks(void)
+{
+    if (_mavlinkStarted && _connected) {
+        _swarm->tick(static_cast<uint8_t>(_mavlinkChannel));
+    }
+}
+
 void MockLink::_loadParams(void)
 {
     QFile paramFile;
@@ -409,6 +445,11 @@ void MockLink::respondWithMavlinkMessage(const mavlink_message_t& msg)
     emit bytesReceived(this, bytes);
 }
 
+void MockLink::respondWithBytes(const QByteArray& bytes)
+{
+    emit bytesReceived(this, bytes);
+}
+
 /// @brief Called when QGC wants to write bytes to the MAV
 void MockLink::_writeBytes(const QByteArray bytes)
 {
@@ -460,6 +501,10 @@ void MockLink::_handleIncomingMavlinkBytes(const uint8_t* bytes, int cBytes)
             continue;
         }
 
+        if (_swarm && _swarm->handleMessage(msg, static_cast<uint8_t>(_mavlinkChannel))) {
+            continue;
+        }
+
         if (_missionItemHandler.handleMessage(msg)) {
             continue;
         }
@@ -1156,6 +1201,12 @@ MockConfiguration::MockConfiguration(const QString& name)
     , _sendStatusText   (false)
     , _highLatency      (false)
     , _failureMode      (FailNone)
+    , _swarmVehicleCount    (0)
+    , _swarmFirstSystemId   (1)
+    , _swarmTelemetryRate   (10)
+    , _swarmMessageMix      (SwarmMixStandard)
+    , _swarmPacketLoss      (0)
+    , _swarmJitterMSecs     (0)
 {
 
 }
@@ -1168,6 +1219,12 @@ MockConfiguration::MockConfiguration(MockConfiguration* source)
     _sendStatusText =   source->_sendStatusText;
     _highLatency =      source->_highLatency;
     _failureMode =      source->_failureMode;
+    _swarmVehicleCount =    source->_swarmVehicleCount;
+    _swarmFirstSystemId =   source->_swarmFirstSystemId;
+    _swarmTelemetryRate =   source->_swarmTelemetryRate;
+    _swarmMessageMix =      source->_swarmMessageMix;
+    _swarmPacketLoss =      source->_swarmPacketLoss;
+    _swarmJitterMSecs =     source->_swarmJitterMSecs;
 }
 
 void MockConfiguration::copyFrom(LinkConfiguration *source)
@@ -1185,6 +1242,12 @@ void MockConfiguration::copyFrom(LinkConfiguration *source)
     _sendStatusText =   usource->_sendStatusText;
     _highLatency =      usource->_highLatency;
     _failureMode =      usource->_failureMode;
+    _swarmVehicleCount =    usource->_swarmVehicleCount;
+    _swarmFirstSystemId =   usource->_swarmFirstSystemId;
+    _swarmTelemetryRate =   usource->_swarmTelemetryRate;
+    _swarmMessageMix =      usource->_swarmMessageMix;
+    _swarmPacketLoss =      usource->_swarmPacketLoss;
+    _swarmJitterMSecs =     usource->_swarmJitterMSecs;
 }
 
 void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
@@ -1195,6 +1258,12 @@ void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
     settings.setValue(_sendStatusTextKey, _sendStatusText);
     settings.setValue(_highLatencyKey, _highLatency);
     settings.setValue(_failureModeKey, (int)_failureMode);
+    settings.setValue(_swarmVehicleCountKey, _swarmVehicleCount);
+    settings.setValue(_swarmFirstSystemIdKey, _swarmFirstSystemId);
+    settings.setValue(_swarmTelemetryRateKey, _swarmTelemetryRate);
+    settings.setValue(_swarmMessageMixKey, _swarmMessageMix);
+    settings.setValue(_swarmPacketLossKey, _swarmPacketLoss);
+    settings.setValue(_swarmJitterMSecsKey, _swarmJitterMSecs);
     settings.sync();
     settings.endGroup();
 }
@@ -1207,6 +1276,12 @@ void MockConfiguration::loadSettings(QSettings& settings, const QString& root)
     _sendStatusText = settings.value(_sendStatusTextKey, false).toBool();
     _highLatency = settings.value(_highLatencyKey, false).toBool();
     _failureMode = (FailureMode_t)settings.value(_failureModeKey, (int)FailNone).toInt();
+    _swarmVehicleCount = settings.value(_swarmVehicleCountKey, 0).toInt();
+    _swarmFirstSystemId = settings.value(_swarmFirstSystemIdKey, 1).toInt();
+    _swarmTelemetryRate = settings.value(_swarmTelemetryRateKey, 10).toInt();
+    _swarmMessageMix = settings.value(_swarmMessageMixKey, (int)SwarmMixStandard).toInt();
+    _swarmPacketLoss = settings.value(_swarmPacketLossKey, 0.0).toDouble();
+    _swarmJitterMSecs = settings.value(_swarmJitterMSecsKey, 0).toInt();
     settings.endGroup();
 }
 
@@ -1274,6 +1349,22 @@ MockLink*  MockLink::startAPMArduRoverMockLink(bool sendStatusText, MockConfigur
     return _startMockLinkWorker("ArduRover MockLink", MAV_AUTOPILOT_ARDUPILOTMEGA, MAV_TYPE_GROUND_ROVER, sendStatusText, failureMode);
 }
 
+MockLink* MockLink::startSwarmMockLink(int vehicleCount, int firstSystemId, int telemetryRate, MockConfiguration::SwarmMessageMix_t messageMix, double packetLoss, int jitterMSecs)
+{
+    MockConfiguration* mockConfig = new MockConfiguration(QStringLiteral("Swarm MockLink %1").arg(firstSystemId));
+
+    mockConfig->setFirmwareType(MAV_AUTOPILOT_GENERIC);
+    mockConfig->setVehicleType(MAV_TYPE_QUADROTOR);
+    mockConfig->setSwarmVehicleCount(vehicleCount);
+    mockConfig->setSwarmFirstSystemId(firstSystemId);
+    mockConfig->setSwarmTelemetryRate(telemetryRate);
+    mockConfig->setSwarmMessageMix(messageMix);
+    mockConfig->setSwarmPacketLoss(packetLoss);
+    mockConfig->setSwarmJitterMSecs(jitterMSecs);
+
+    return _startMockLink(mockConfig);
+}
+
 void MockLink::_sendRCChannels(void)
 {
     mavlink_message_t   msg;
@@ -1370,37 +1461,63 @@ void MockLink::_handleLogRequestData(const mavlink_message_t& msg)
         return;
     }
 
-    // This will trigger _logDownloadWorker to send data
-    _logDownloadCurrentOffset = request.ofs;
+    _logDownloadRequestCount++;
     if (request.ofs + request.count > _logDownloadFileSize) {
         request.count = _logDownloadFileSize - request.ofs;
     }
+
+    if (_logDownloadLossy && _logDownloadBytesRemaining != 0) {
+        // Packets for the previous request are still on their way, _logDownloadWorker switches over after them
+        if (_logDownloadPendingBytes == 0) {
+            _logDownloadInFlight = _logDownloadInFlightPackets;
+        }
+        _logDownloadPendingOffset = request.ofs;
+        _logDownloadPendingBytes = request.count;
+        return;
+    }
+
+    // This will trigger _logDownloadWorker to send data
+    _logDownloadCurrentOffset = request.ofs;
     _logDownloadBytesRemaining = request.count;
 }
 
 void MockLink::_logDownloadWorker(void)
 {
+    if (_logDownloadPendingBytes != 0 && (_logDownloadInFlight == 0 || _logDownloadBytesRemaining == 0)) {
+        _logDownloadCurrentOffset = _logDownloadPendingOffset;
+        _logDownloadBytesRemaining = _logDownloadPendingBytes;
+        _logDownloadPendingBytes = 0;
+    }
+
     if (_logDownloadBytesRemaining != 0) {
         QFile file(_logDownloadFilename);
         if (file.open(QIODevice::ReadOnly)) {
             uint8_t buffer[MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN];
 
             qint64 bytesToRead = qMin(_logDownloadBytesRemaining, (uint32_t)MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            Q_ASSERT(file.seek(_logDownloadCurrentOffset));
-            Q_ASSERT(file.read((char *)buffer, bytesToRead) == bytesToRead);
-
-            qDebug() << "MockLink::_logDownloadWorker" << _logDownloadCurrentOffset << _logDownloadBytesRemaining;
-
-            mavlink_message_t responseMsg;
-            mavlink_msg_log_data_pack_chan(_vehicleSystemId,
-                                           _vehicleComponentId,
-                                           _mavlinkChannel,
-                                           &responseMsg,
-                                           _logDownloadLogId,
-                                           _logDownloadCurrentOffset,
-                                           bytesToRead,
-                                           &buffer[0]);
-            respondWithMavlinkMessage(responseMsg);
+            bool seekOk = file.seek(_logDownloadCurrentOffset);
+            qint64 bytesRead = file.read((char *)buffer, bytesToRead);
+            Q_ASSERT(seekOk && bytesRead == bytesToRead);
+            Q_UNUSED(seekOk);
+            Q_UNUSED(bytesRead);
+
+            if (_logDownloadPendingBytes != 0) {
+                _logDownloadInFlight--;
+            }
+            if (_logDownloadLossy && ++_logDownloadSentCount % _logDownloadDropInterval == 0) {
+                _logDownloadDropCount++;
+            } else {
+                mavlink_message_t responseMsg;
+                mavlink_msg_log_data_pack_chan(_vehicleSystemId,
+                                               _vehicleComponentId,
+                                               _mavlinkChannel,
+                                               &responseMsg,
+                                               _logDownloadLogId,
+                                               _logDownloadCurrentOffset,
+                                               bytesToRead,
+                                               &buffer[0]);
+                respondWithMavlinkMessage(responseMsg);
+            }
 
             _logDownloadCurrentOffset += bytesToRead;
             _logDownloadBytesRemaining -= bytesToRead;
@@ -16,6 +16,7 @@
 
 #include "MockLinkMissionItemHandler.h"
 #include "MockLinkFileServer.h"
+#include "MockLinkSwarm.h"
 #include "LinkManager.h"
 #include "QGCMAVLink.h"
 
@@ -32,6 +33,12 @@ public:
     Q_PROPERTY(int      vehicle     READ vehicle            WRITE setVehicle        NOTIFY vehicleChanged)
     Q_PROPERTY(bool     sendStatus  READ sendStatusText     WRITE setSendStatusText NOTIFY sendStatusChanged)
     Q_PROPERTY(bool     highLatency READ highLatency        WRITE setHighLatency    NOTIFY highLatencyChanged)
+    Q_PROPERTY(int      swarmVehicleCount   READ swarmVehicleCount  WRITE setSwarmVehicleCount  NOTIFY swarmChanged)
+    Q_PROPERTY(int      swarmFirstSystemId  READ swarmFirstSystemId WRITE setSwarmFirstSystemId NOTIFY swarmChanged)
+    Q_PROPERTY(int      swarmTelemetryRate  READ swarmTelemetryRate WRITE setSwarmTelemetryRate NOTIFY swarmChanged)
+    Q_PROPERTY(int      swarmMessageMix     READ swarmMessageMix    WRITE setSwarmMessageMix    NOTIFY swarmChanged)
+    Q_PROPERTY(double   swarmPacketLoss     READ swarmPacketLoss    WRITE setSwarmPacketLoss    NOTIFY swarmChanged)
+    Q_PROPERTY(int      swarmJitterMSecs    READ swarmJitterMSecs   WRITE setSwarmJitterMSecs   NOTIFY swarmChanged)
 
     // QML Access
     int     firmware        () { return (int)_firmwareType; }
@@ -63,6 +70,27 @@ public:
     FailureMode_t failureMode(void) { return _failureMode; }
     void setFailureMode(FailureMode_t failureMode) { _failureMode = failureMode; }
 
+    typedef enum {
+        SwarmMixMinimal,    // HEARTBEAT, GLOBAL_POSITION_INT
+        SwarmMixStandard,   // Minimal + SYS_STATUS, ATTITUDE, VFR_HUD, GPS_RAW_INT
+        SwarmMixHeavy,      // Standard + LOCAL_POSITION_NED, ALTITUDE, VIBRATION, RC_CHANNELS
+    } SwarmMessageMix_t;
+
+    /// Swarm mode: instead of its own full featured vehicle the link simulates swarmVehicleCount lightweight
+    /// vehicles with consecutive system ids starting at swarmFirstSystemId. 0 disables swarm mode.
+    int     swarmVehicleCount       (void) const { return _swarmVehicleCount; }
+    int     swarmFirstSystemId      (void) const { return _swarmFirstSystemId; }
+    int     swarmTelemetryRate      (void) const { return _swarmTelemetryRate; }    ///< Hz
+    int     swarmMessageMix         (void) const { return _swarmMessageMix; }
+    double  swarmPacketLoss         (void) const { return _swarmPacketLoss; }       ///< Percent of packets dropped
+    int     swarmJitterMSecs        (void) const { return _swarmJitterMSecs; }      ///< Packets are randomly delayed by up to this
+    void    setSwarmVehicleCount    (int count)             { _swarmVehicleCount = count; emit swarmChanged(); }
+    void    setSwarmFirstSystemId   (int systemId)          { _swarmFirstSystemId = systemId; emit swarmChanged(); }
+    void    setSwarmTelemetryRate   (int rate)              { _swarmTelemetryRate = rate; emit swarmChanged(); }
+    void    setSwarmMessageMix      (int mix)               { _swarmMessageMix = mix; emit swarmChanged(); }
+    void    setSwarmPacketLoss      (double packetLoss)     { _swarmPacketLoss = packetLoss; emit swarmChanged(); }
+    void    setSwarmJitterMSecs     (int jitterMSecs)       { _swarmJitterMSecs = jitterMSecs; emit swarmChanged(); }
+
     // Overrides from LinkConfiguration
     LinkType    type            (void) { return LinkConfiguration::TypeMock; }
     void        copyFrom        (LinkConfiguration* source);
@@ -77,6 +105,7 @@ signals:
     void vehicleChanged     ();
     void sendStatusChanged  ();
     void highLatencyChanged ();
+    void swarmChanged       ();
 
 private:
     MAV_AUTOPILOT   _firmwareType;
@@ -84,12 +113,24 @@ private:
     bool            _sendStatusText;
     bool            _highLatency;
     FailureMode_t   _failureMode;
+    int             _swarmVehicleCount;
+    int             _swarmFirstSystemId;
+    int             _swarmTelemetryRate;
+    int             _swarmMessageMix;
+    double          _swarmPacketLoss;
+    int             _swarmJitterMSecs;
 
     static const char* _firmwareTypeKey;
     static const char* _vehicleTypeKey;
     static const char* _sendStatusTextKey;
     static const char* _highLatencyKey;
     static const char* _failureModeKey;
+    static const char* _swarmVehicleCountKey;
+    static const char* _swarmFirstSystemIdKey;
+    static const char* _swarmTelemetryRateKey;
+    static const char* _swarmMessageMixKey;
+    static const char* _swarmPacketLossKey;
+    static const char* _swarmJitterMSecsKey;
 };
 
 class MockLink : public LinkInterface
@@ -118,6 +159,12 @@ public:
     /// Sends the specified mavlink message to QGC
     void respondWithMavlinkMessage(const mavlink_message_t& msg);
 
+    /// Sends already encoded mavlink bytes to QGC
+    void respondWithBytes(const QByteArray& bytes);
+
+    /// @return Swarm simulated on this link, nullptr if swarm mode is off
+    MockLinkSwarm* swarm(void) { return _swarm; }
+
     MockLinkFileServer* getFileServer(void) { return _fileServer; }
 
     // Virtuals from LinkInterface
@@ -152,6 +199,16 @@ public:
     /// Returns the filename for the simulated log file. Only available after a download is requested.
     QString logDownloadFile(void) { return _logDownloadFilename; }
 
+    /// Makes the simulated log download lossy: every _logDownloadDropInterval'th LOG_DATA is dropped and a new
+    /// LOG_REQUEST_DATA only takes over once the packets still in flight for the previous one have been sent.
+    void setLogDownloadLossy(bool lossy) { _logDownloadLossy = lossy; }
+
+    /// Returns the number of LOG_REQUEST_DATA messages received
+    int logDownloadRequestCount(void) const { return _logDownloadRequestCount; }
+
+    /// Returns the number of LOG_DATA messages dropped by a lossy log download
+    int logDownloadDropCount(void) const { return _logDownloadDropCount; }
+
     static MockLink* startPX4MockLink            (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startGenericMockLink        (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startAPMArduCopterMockLink  (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
@@ -159,6 +216,14 @@ public:
     static MockLink* startAPMArduSubMockLink     (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startAPMArduRoverMockLink   (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
 
+    /// Starts a generic MockLink which also simulates a swarm of vehicles, see MockConfiguration swarm settings
+    static MockLink* startSwarmMockLink(int                                 vehicleCount,
+                                        int                                 firstSystemId,
+                                        int                                 telemetryRate,
+                                        MockConfiguration::SwarmMessageMix_t messageMix,
+                                        double                              packetLoss  = 0,
+                                        int                                 jitterMSecs = 0);
+
 private slots:
     virtual void _writeBytes(const QByteArray bytes);
 
@@ -166,6 +231,7 @@ private slots:
     void _run1HzTasks(void);
     void _run10HzTasks(void);
     void _run500HzTasks(void);
+    void _runSwarmTasks(void);
 
 private:
     // From LinkInterface
@@ -239,6 +305,7 @@ private:
     double              _vehicleAltitude;
 
     MockLinkFileServer* _fileServer;
+    MockLinkSwarm*      _swarm;
 
     bool _sendStatusText;
     bool _apmSendHomePositionOnEmptyList;
@@ -251,11 +318,20 @@ private:
     int _currentParamRequestListParamIndex;     // Current parameter index for param request list workflow
 
     static const uint16_t _logDownloadLogId = 0;        ///< Id of siumulated log file
-    static const uint32_t _logDownloadFileSize = 1000;  ///< Size of simulated log file
+    static const uint32_t _logDownloadFileSize = 100000;    ///< Size of simulated log file, spans several download windows
+    static const int _logDownloadDropInterval = 50;         ///< Lossy download: every nth LOG_DATA is dropped
+    static const int _logDownloadInFlightPackets = 4;       ///< Lossy download: LOG_DATA still sent for the previous request
 
     QString _logDownloadFilename;           ///< Filename for log download which is in progress
     uint32_t    _logDownloadCurrentOffset;  ///< Current offset we are sending from
     uint32_t    _logDownloadBytesRemaining; ///< Number of bytes still to send, 0 = send inactive
+    uint32_t    _logDownloadPendingOffset;  ///< Lossy download: offset of the request taking over next
+    uint32_t    _logDownloadPendingBytes;   ///< Lossy download: bytes of the request taking over next, 0 = none
+    int         _logDownloadInFlight;       ///< Lossy download: packets to send before the pending request takes over
+    bool        _logDownloadLossy;
+    int         _logDownloadRequestCount;
+    int         _logDownloadSentCount;
+    int         _logDownloadDropCount;
 
     QGeoCoordinate  _adsbVehicleCoordinate;
     double          _adsbAngle;
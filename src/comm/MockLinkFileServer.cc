@@ -27,6 +27,8 @@ const MockLinkFileServer::FileTestCase MockLinkFileServer::rgFileTestCases[MockL
     { "exact.qgc",      sizeof(((FileManager::Request*)0)->data),         1,    true },
     // File is larger than a single Read Ack packets, requires multiple Reads
     { "multi.qgc",      sizeof(((FileManager::Request*)0)->data) + 1,     2,    false },
+    // File spans many Read Ack packets, enough to fill the read window many times over
+    { "large.qgc",      (sizeof(((FileManager::Request*)0)->data) * 200) + 17,  201,    false },
 };
 
 // We only support a single fixed session
@@ -250,6 +252,52 @@ void MockLinkFileServer::_streamCommand(uint8_t senderSystemId, uint8_t senderCo
     _sendNak(senderSystemId, senderComponentId, FileManager::kErrEOF, outgoingSeqNumber, FileManager::kCmdBurstReadFile);
 }
 
+/// @brief Handles Create command requests. Any path is accepted, the file is held in memory.
+void MockLinkFileServer::_createCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber)
+{
+    FileManager::Request    response;
+    uint16_t                outgoingSeqNumber = _nextSeqNumber(seqNumber);
+
+    ensureNullTemination(request);
+
+    _uploadPath = (char *)request->data;
+    _uploadData.clear();
+
+    response.hdr.opcode = FileManager::kRspAck;
+    response.hdr.req_opcode = FileManager::kCmdCreateFile;
+    response.hdr.session = _sessionId;
+    response.hdr.size = 0;
+
+    _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+}
+
+/// @brief Handles Write command requests. Writes can arrive in any order, each one is placed at its offset.
+void MockLinkFileServer::_writeCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber)
+{
+    FileManager::Request    response;
+    uint16_t                outgoingSeqNumber = _nextSeqNumber(seqNumber);
+
+    if (request->hdr.session != _sessionId) {
+        _sendNak(senderSystemId, senderComponentId, FileManager::kErrInvalidSession, outgoingSeqNumber, FileManager::kCmdWriteFile);
+        return;
+    }
+
+    const int endOffset = static_cast<int>(request->hdr.offset + request->hdr.size);
+    if (_uploadData.size() < endOffset) {
+        _uploadData.resize(endOffset);
+    }
+    _uploadData.replace(static_cast<int>(request->hdr.offset), request->hdr.size, (const char*)request->data, request->hdr.size);
+
+    response.hdr.opcode = FileManager::kRspAck;
+    response.hdr.req_opcode = FileManager::kCmdWriteFile;
+    response.hdr.session = _sessionId;
+    response.hdr.offset = request->hdr.offset;
+    response.hdr.size = sizeof(uint32_t);
+    response.writeFileLength = request->hdr.size;
+
+    _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+}
+
 void MockLinkFileServer::_terminateCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber)
 {
     uint16_t outgoingSeqNumber = _nextSeqNumber(seqNumber);
@@ -348,6 +396,14 @@ void MockLinkFileServer::handleFTPMessage(const mavlink_message_t& message)
             _streamCommand(message.sysid, message.compid, request, incomingSeqNumber);
             break;
 
+        case FileManager::kCmdCreateFile:
+            _createCommand(message.sysid, message.compid, request, incomingSeqNumber);
+            break;
+
+        case FileManager::kCmdWriteFile:
+            _writeCommand(message.sysid, message.compid, request, incomingSeqNumber);
+            break;
+
         case FileManager::kCmdTerminateSession:
             _terminateCommand(message.sysid, message.compid, request, incomingSeqNumber);
             break;
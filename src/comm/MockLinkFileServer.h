@@ -58,19 +58,25 @@ public:
     /// @brief Used to represent a single test case for download testing.
     struct FileTestCase {
         const char* filename;               ///< Filename to download
-        uint8_t     length;                 ///< Length of file in bytes
+        uint32_t    length;                 ///< Length of file in bytes
 		int			packetCount;			///< Number of packets required for data
         bool        exactFit;				///< true: last packet is exact fit, false: last packet is partially filled
     };
     
     /// @brief The numbers of test cases in the rgFileTestCases array.
-    static const size_t cFileTestCases = 3;
+    static const size_t cFileTestCases = 4;
     
     /// @brief The set of files supported by the mock server for testing purposes. Each one represents a different edge case for testing.
     static const FileTestCase rgFileTestCases[cFileTestCases];
     
     void enableRandromDrops(bool enable) { _randomDropsEnabled = enable; }
 
+    /// @return Path of the file last created by the Create command
+    const QString& uploadPath(void) const { return _uploadPath; }
+
+    /// @return Contents written to the file last created by the Create command
+    const QByteArray& uploadData(void) const { return _uploadData; }
+
 signals:
     /// You can connect to this signal to be notified when the server receives a Terminate command.
     void terminateCommandReceived(void);
@@ -86,6 +92,8 @@ private:
     void _openCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
     void _readCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
 	void _streamCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
+    void _createCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
+    void _writeCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
     void _terminateCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
     void _resetCommand(uint8_t senderSystemId, uint8_t senderComponentId, uint16_t seqNumber);
     uint16_t _nextSeqNumber(uint16_t seqNumber);
@@ -96,7 +104,9 @@ private:
     QStringList _fileList;  ///< List of files returned by List command
     
     static const uint8_t    _sessionId;
-    uint8_t                 _readFileLength;    ///< Length of active file being read
+    uint32_t                _readFileLength;    ///< Length of active file being read
+    QString                 _uploadPath;        ///< File created by the Create command
+    QByteArray              _uploadData;        ///< Data written by Write commands
     ErrorMode_t             _errMode;           ///< Currently set error mode, as specified by setErrorMode
     const uint8_t           _systemIdServer;    ///< System ID for server
     const uint8_t           _componentIdServer; ///< Component ID for server
@@ -0,0 +1,323 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MockLinkSwarm.h"
+#include "MockLink.h"
+
+#include <QtMath>
+
+#include <algorithm>
+#include <cstring>
+
+const char* MockLinkSwarm::_paramName = "SWARM_ID";
+
+const int MockLinkSwarm::tickMSecs;
+
+MockLinkSwarm::MockLinkSwarm(MockLink* mockLink, MockConfiguration* config)
+    : QObject               (mockLink)
+    , _mockLink             (mockLink)
+    , _random               (static_cast<quint32>(config->swarmFirstSystemId()))
+    , _vehicleType          (config->vehicleType())
+    , _telemetryPeriodMSecs (1000 / qBound(1, config->swarmTelemetryRate(), 1000 / tickMSecs))
+    , _messageMix           (config->swarmMessageMix())
+    , _packetLossFraction   (qBound(0.0, config->swarmPacketLoss(), 100.0) / 100.0)
+    , _jitterMSecs          (qMax(0, config->swarmJitterMSecs()))
+    , _packetsSent          (0)
+    , _packetsLost          (0)
+{
+    int systemId = config->swarmFirstSystemId();
+
+    for (int i=0; i<config->swarmVehicleCount() && systemId < 255; i++, systemId++) {
+        // Vehicles are spread out on a grid and stagger their send times such that traffic is not bunched up in one tick
+        Vehicle_t vehicle;
+        vehicle.systemId            = static_cast<uint8_t>(systemId);
+        memset(&vehicle.status, 0, sizeof(vehicle.status));
+        vehicle.latitude            = 47.397 + ((i / 16) * 0.001);
+        vehicle.longitude           = 8.5455 + ((i % 16) * 0.001);
+        vehicle.angle               = 0;
+        vehicle.nextTelemetryMSecs  = (i * _telemetryPeriodMSecs) / qMax(1, config->swarmVehicleCount());
+        vehicle.nextHeartbeatMSecs  = (i * 1000) / qMax(1, config->swarmVehicleCount());
+        vehicle.paramValue          = systemId;
+        _vehicles.append(vehicle);
+    }
+
+    _elapsed.start();
+}
+
+QList<int> MockLinkSwarm::systemIds(void) const
+{
+    QList<int> ids;
+
+    for (const Vehicle_t& vehicle: _vehicles) {
+        ids.append(vehicle.systemId);
+    }
+
+    return ids;
+}
+
+MockLinkSwarm::Vehicle_t* MockLinkSwarm::_findVehicle(uint8_t systemId)
+{
+    // Vehicles are created with ascending system ids
+    auto iter = std::lower_bound(_vehicles.begin(), _vehicles.end(), systemId, [](const Vehicle_t& vehicle, uint8_t id) { return vehicle.systemId < id; });
+    if (iter != _vehicles.end() && iter->systemId == systemId) {
+        return &(*iter);
+    }
+    return nullptr;
+}
+
+bool MockLinkSwarm::handleMessage(const mavlink_message_t& msg, uint8_t mavlinkChannel)
+{
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(msg.msgid);
+    if (!entry || !(entry->flags & MAVLINK_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM)) {
+        // Broadcasts such as the GCS heartbeat are left to the main vehicle
+        return false;
+    }
+
+    Vehicle_t* vehicle = _findVehicle(static_cast<uint8_t>(_MAV_PAYLOAD(&msg)[entry->target_system_ofs]));
+    if (!vehicle) {
+        return false;
+    }
+
+    switch (msg.msgid) {
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+        _sendParamValue(*vehicle, mavlinkChannel);
+        break;
+    case MAVLINK_MSG_ID_PARAM_SET:
+    {
+        mavlink_param_set_t request;
+        mavlink_msg_param_set_decode(&msg, &request);
+        mavlink_param_union_t valueUnion;
+        valueUnion.param_float = request.param_value;
+        vehicle->paramValue = valueUnion.param_int32;
+        _sendParamValue(*vehicle, mavlinkChannel);
+    }
+        break;
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+    {
+        // Swarm vehicles never have a mission, geofence or rally points
+        mavlink_mission_count_t missionCount = {};
+        missionCount.target_system      = msg.sysid;
+        missionCount.target_component   = msg.compid;
+        missionCount.count              = 0;
+        missionCount.mission_type       = mavlink_msg_mission_request_list_get_mission_type(&msg);
+        _send(*vehicle, mavlinkChannel, MAVLINK_MSG_ID_MISSION_COUNT, &missionCount, MAVLINK_MSG_ID_MISSION_COUNT_LEN);
+    }
+        break;
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+    {
+        const uint16_t command = mavlink_msg_command_long_get_command(&msg);
+        mavlink_command_ack_t commandAck = {};
+        commandAck.command          = command;
+        commandAck.result           = command == MAV_CMD_COMPONENT_ARM_DISARM ? MAV_RESULT_ACCEPTED : MAV_RESULT_UNSUPPORTED;
+        commandAck.target_system    = msg.sysid;
+        commandAck.target_component = msg.compid;
+        _send(*vehicle, mavlinkChannel, MAVLINK_MSG_ID_COMMAND_ACK, &commandAck, MAVLINK_MSG_ID_COMMAND_ACK_LEN);
+    }
+        break;
+    default:
+        // Everything else is silently dropped, same as a vehicle which does not support it
+        break;
+    }
+
+    return true;
+}
+
+void MockLinkSwarm::_send(Vehicle_t& vehicle, uint8_t mavlinkChannel, uint32_t msgid, const void* payload, uint8_t length)
+{
+    // The channel status is also used by the GCS side of the link to pack outgoing messages on another thread. The
+    // *_pack_chan functions would update its sequence number, so the payload is filled in directly and finalized
+    // against the vehicle's own status. Only the outgoing protocol version is taken from the channel.
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(msgid);
+    if (!entry) {
+        return;
+    }
+
+    mavlink_message_t msg;
+    memcpy(_MAV_PAYLOAD_NON_CONST(&msg), payload, length);
+    msg.msgid = msgid;
+    vehicle.status.flags = mavlink_get_channel_status(mavlinkChannel)->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    mavlink_finalize_message_buffer(&msg, vehicle.systemId, MAV_COMP_ID_AUTOPILOT1, &vehicle.status, entry->min_msg_len, length, entry->crc_extra);
+
+    if (_packetLossFraction > 0 && _random.generateDouble() < _packetLossFraction) {
+        _packetsLost++;
+        return;
+    }
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int     cBuffer = mavlink_msg_to_send_buffer(buffer, &msg);
+
+    if (_jitterMSecs > 0) {
+        _delayedPackets.insert(_elapsed.elapsed() + _random.bounded(_jitterMSecs + 1), QByteArray(reinterpret_cast<const char*>(buffer), cBuffer));
+    } else {
+        _batch.append(reinterpret_cast<const char*>(buffer), cBuffer);
+    }
+    _packetsSent++;
+}
+
+void MockLinkSwarm::tick(uint8_t mavlinkChannel)
+{
+    const qint64 now = _elapsed.elapsed();
+
+    for (Vehicle_t& vehicle: _vehicles) {
+        if (now >= vehicle.nextHeartbeatMSecs) {
+            _sendHeartbeat(vehicle, mavlinkChannel);
+            vehicle.nextHeartbeatMSecs += 1000;
+        }
+        if (now >= vehicle.nextTelemetryMSecs) {
+            _sendTelemetry(vehicle, mavlinkChannel);
+            vehicle.nextTelemetryMSecs += _telemetryPeriodMSecs;
+            if (vehicle.nextTelemetryMSecs < now) {
+                // Fell behind, don't try to catch up with a burst
+                vehicle.nextTelemetryMSecs = now + _telemetryPeriodMSecs;
+            }
+        }
+    }
+
+    while (!_delayedPackets.isEmpty() && _delayedPackets.firstKey() <= now) {
+        _batch.append(_delayedPackets.take(_delayedPackets.firstKey()));
+    }
+
+    // Everything for the tick goes out in one chunk, same as a busy radio or UDP link would deliver it
+    if (!_batch.isEmpty()) {
+        _mockLink->respondWithBytes(_batch);
+        _batch.clear();
+    }
+}
+
+void MockLinkSwarm::_sendHeartbeat(Vehicle_t& vehicle, uint8_t mavlinkChannel)
+{
+    mavlink_heartbeat_t heartbeat = {};
+    heartbeat.type              = _vehicleType;
+    heartbeat.autopilot         = MAV_AUTOPILOT_GENERIC;
+    heartbeat.base_mode         = MAV_MODE_FLAG_CUSTOM_MODE_ENABLED;
+    heartbeat.custom_mode       = 0;
+    heartbeat.system_status     = MAV_STATE_ACTIVE;
+    heartbeat.mavlink_version   = 3;
+    _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_HEARTBEAT, &heartbeat, MAVLINK_MSG_ID_HEARTBEAT_LEN);
+
+    if (_messageMix != MockConfiguration::SwarmMixMinimal) {
+        mavlink_sys_status_t sysStatus = {};
+        sysStatus.load              = 250;
+        sysStatus.voltage_battery   = 4200 * 4;
+        sysStatus.current_battery   = 8000;
+        sysStatus.battery_remaining = 80;
+        _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_SYS_STATUS, &sysStatus, MAVLINK_MSG_ID_SYS_STATUS_LEN);
+    }
+}
+
+void MockLinkSwarm::_sendTelemetry(Vehicle_t& vehicle, uint8_t mavlinkChannel)
+{
+    const uint32_t      timeBootMSecs   = static_cast<uint32_t>(_elapsed.elapsed());
+    const double        radiusDegrees   = 0.0005;
+
+    // Each vehicle flies a slow circle
+    vehicle.angle += 0.01;
+    const double    latitude    = vehicle.latitude  + (radiusDegrees * qCos(vehicle.angle));
+    const double    longitude   = vehicle.longitude + (radiusDegrees * qSin(vehicle.angle));
+    const float     heading     = static_cast<float>(fmod(vehicle.angle + M_PI_2, 2 * M_PI));
+    const int32_t   altitudeMM  = 50000;
+
+    mavlink_global_position_int_t globalPosition = {};
+    globalPosition.time_boot_ms = timeBootMSecs;
+    globalPosition.lat          = static_cast<int32_t>(latitude * 1E7);
+    globalPosition.lon          = static_cast<int32_t>(longitude * 1E7);
+    globalPosition.alt          = altitudeMM + 488000;
+    globalPosition.relative_alt = altitudeMM;
+    globalPosition.hdg          = static_cast<uint16_t>(qRadiansToDegrees(heading) * 100);
+    _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_GLOBAL_POSITION_INT, &globalPosition, MAVLINK_MSG_ID_GLOBAL_POSITION_INT_LEN);
+
+    if (_messageMix == MockConfiguration::SwarmMixMinimal) {
+        return;
+    }
+
+    mavlink_attitude_t attitude = {};
+    attitude.time_boot_ms   = timeBootMSecs;
+    attitude.roll           = 0.05f;
+    attitude.pitch          = -0.05f;
+    attitude.yaw            = heading;
+    attitude.yawspeed       = 0.1f;
+    _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_ATTITUDE, &attitude, MAVLINK_MSG_ID_ATTITUDE_LEN);
+
+    mavlink_vfr_hud_t vfrHud = {};
+    vfrHud.airspeed     = 5.0f;
+    vfrHud.groundspeed  = 5.0f;
+    vfrHud.heading      = static_cast<int16_t>(qRadiansToDegrees(heading));
+    vfrHud.throttle     = 50;
+    vfrHud.alt          = altitudeMM / 1000.0f;
+    _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_VFR_HUD, &vfrHud, MAVLINK_MSG_ID_VFR_HUD_LEN);
+
+    mavlink_gps_raw_int_t gpsRawInt = {};
+    gpsRawInt.time_usec             = static_cast<uint64_t>(timeBootMSecs) * 1000;
+    gpsRawInt.fix_type              = 3;            // 3D fix
+    gpsRawInt.lat                   = static_cast<int32_t>(latitude * 1E7);
+    gpsRawInt.lon                   = static_cast<int32_t>(longitude * 1E7);
+    gpsRawInt.alt                   = altitudeMM + 488000;
+    gpsRawInt.eph                   = UINT16_MAX;   // HDOP not known
+    gpsRawInt.epv                   = UINT16_MAX;   // VDOP not known
+    gpsRawInt.vel                   = 500;
+    gpsRawInt.cog                   = UINT16_MAX;   // course over ground not known
+    gpsRawInt.satellites_visible    = 12;
+    gpsRawInt.yaw                   = 65535;        // Yaw not provided
+    _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_GPS_RAW_INT, &gpsRawInt, MAVLINK_MSG_ID_GPS_RAW_INT_LEN);
+
+    if (_messageMix != MockConfiguration::SwarmMixHeavy) {
+        return;
+    }
+
+    mavlink_local_position_ned_t localPosition = {};
+    localPosition.time_boot_ms  = timeBootMSecs;
+    localPosition.x             = static_cast<float>(qCos(vehicle.angle) * 50);
+    localPosition.y             = static_cast<float>(qSin(vehicle.angle) * 50);
+    localPosition.z             = -50.0f;
+    _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_LOCAL_POSITION_NED, &localPosition, MAVLINK_MSG_ID_LOCAL_POSITION_NED_LEN);
+
+    mavlink_altitude_t altitude = {};
+    altitude.time_usec          = static_cast<uint64_t>(timeBootMSecs) * 1000;
+    altitude.altitude_monotonic = 538.0f;
+    altitude.altitude_amsl      = 538.0f;
+    altitude.altitude_local     = 50.0f;
+    altitude.altitude_relative  = 50.0f;
+    altitude.altitude_terrain   = 50.0f;
+    altitude.bottom_clearance   = 50.0f;
+    _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_ALTITUDE, &altitude, MAVLINK_MSG_ID_ALTITUDE_LEN);
+
+    mavlink_vibration_t vibration = {};
+    vibration.vibration_x   = 10.5f;
+    vibration.vibration_y   = 10.5f;
+    vibration.vibration_z   = 20.0f;
+    _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_VIBRATION, &vibration, MAVLINK_MSG_ID_VIBRATION_LEN);
+
+    mavlink_rc_channels_t rcChannels = {};
+    rcChannels.time_boot_ms = timeBootMSecs;
+    rcChannels.chancount    = 16;
+    rcChannels.chan1_raw    = rcChannels.chan2_raw  = rcChannels.chan3_raw  = rcChannels.chan4_raw  = 1500;
+    rcChannels.chan5_raw    = rcChannels.chan6_raw  = rcChannels.chan7_raw  = rcChannels.chan8_raw  = 1500;
+    rcChannels.chan9_raw    = rcChannels.chan10_raw = rcChannels.chan11_raw = rcChannels.chan12_raw = 1500;
+    rcChannels.chan13_raw   = rcChannels.chan14_raw = rcChannels.chan15_raw = rcChannels.chan16_raw = 1500;
+    rcChannels.chan17_raw   = UINT16_MAX;
+    rcChannels.chan18_raw   = UINT16_MAX;
+    rcChannels.rssi         = 200;
+    _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_RC_CHANNELS, &rcChannels, MAVLINK_MSG_ID_RC_CHANNELS_LEN);
+}
+
+void MockLinkSwarm::_sendParamValue(Vehicle_t& vehicle, uint8_t mavlinkChannel)
+{
+    // A single parameter is enough for the parameter load to complete
+    mavlink_param_union_t valueUnion;
+    valueUnion.param_int32 = vehicle.paramValue;
+
+    mavlink_param_value_t paramValue = {};
+    strncpy(paramValue.param_id, _paramName, sizeof(paramValue.param_id));
+    paramValue.param_value  = valueUnion.param_float;
+    paramValue.param_type   = MAV_PARAM_TYPE_INT32;
+    paramValue.param_count  = 1;
+    paramValue.param_index  = 0;
+    _send(vehicle, mavlinkChannel, MAVLINK_MSG_ID_PARAM_VALUE, &paramValue, MAVLINK_MSG_ID_PARAM_VALUE_LEN);
+}
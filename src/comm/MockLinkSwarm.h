@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMultiMap>
+#include <QRandomGenerator>
+#include <QVector>
+
+#include <atomic>
+
+#include "QGCMAVLink.h"
+
+class MockLink;
+class MockConfiguration;
+
+/// Simulates a swarm of lightweight vehicles on a single MockLink for load testing. Each swarm vehicle sends
+/// telemetry at a configurable rate and message mix, with optional packet loss and latency jitter. Swarm vehicles
+/// answer just enough of the connection sequence (parameters, mission count, commands) for QGC to fully
+/// bring them up. All work happens on the MockLink thread.
+///
+/// A MockLink in swarm mode does not run its own full featured vehicle, so swarm system ids may be anything
+/// from 1 to 254 as long as they do not overlap with other links.
+class MockLinkSwarm : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Swarm settings are taken from the config
+    MockLinkSwarm(MockLink* mockLink, MockConfiguration* config);
+
+    /// @return true: message was targeted at a swarm vehicle and has been handled
+    bool handleMessage(const mavlink_message_t& msg, uint8_t mavlinkChannel);
+
+    /// Generates due telemetry and releases delayed packets. Called every tickMSecs from the MockLink thread.
+    void tick(uint8_t mavlinkChannel);
+
+    QList<int>  systemIds       (void) const;
+    quint64     packetsSent     (void) const { return _packetsSent; }
+    quint64     packetsLost     (void) const { return _packetsLost; }
+
+    static const int tickMSecs = 10;
+
+private:
+    typedef struct {
+        uint8_t     systemId;
+        mavlink_status_t status;        ///< Each vehicle has its own packet sequence, same as a real vehicle
+        double      latitude;           ///< Center of the circle the vehicle flies
+        double      longitude;
+        double      angle;
+        qint64      nextTelemetryMSecs;
+        qint64      nextHeartbeatMSecs;
+        int32_t     paramValue;
+    } Vehicle_t;
+
+    Vehicle_t*  _findVehicle        (uint8_t systemId);
+    void        _send               (Vehicle_t& vehicle, uint8_t mavlinkChannel, uint32_t msgid, const void* payload, uint8_t length);
+    void        _sendHeartbeat      (Vehicle_t& vehicle, uint8_t mavlinkChannel);
+    void        _sendTelemetry      (Vehicle_t& vehicle, uint8_t mavlinkChannel);
+    void        _sendParamValue     (Vehicle_t& vehicle, uint8_t mavlinkChannel);
+
+    MockLink*           _mockLink;
+    QVector<Vehicle_t>  _vehicles;
+    QRandomGenerator    _random;
+    QElapsedTimer       _elapsed;
+
+    MAV_TYPE    _vehicleType;
+    int         _telemetryPeriodMSecs;
+    int         _messageMix;
+    double      _packetLossFraction;
+    int         _jitterMSecs;
+
+    QByteArray  _batch;                                 ///< Packets going out with this tick
+    QMultiMap<qint64, QByteArray> _delayedPackets;      ///< Jittered packets keyed by release time
+
+    std::atomic<quint64> _packetsSent;
+    std::atomic<quint64> _packetsLost;
+
+    static const char* _paramName;
+};
@@ -264,6 +264,7 @@ void SerialLink::_readBytes(void)
             QByteArray buffer;
             buffer.resize(byteCount);
             _port->read(buffer.data(), buffer.size());
+            _logInputDataRate(byteCount, QDateTime::currentMSecsSinceEpoch());
             emit bytesReceived(this, buffer);
         }
     } else {
@@ -101,8 +101,8 @@ void TCPLink::readBytes()
             QByteArray buffer;
             buffer.resize(byteCount);
             _socket->read(buffer.data(), buffer.size());
-            emit bytesReceived(this, buffer);
             _logInputDataRate(byteCount, QDateTime::currentMSecsSinceEpoch());
+            emit bytesReceived(this, buffer);
 #ifdef TCPLINK_READWRITE_DEBUG
             writeDebugBytes(buffer.data(), buffer.size());
 #endif
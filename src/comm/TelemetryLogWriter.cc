@@ -0,0 +1,364 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryLogWriter.h"
+#include "QGCLoggingCategory.h"
+
+#include <QElapsedTimer>
+#include <QtEndian>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#elif defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+QGC_LOGGING_CATEGORY(TelemetryLogWriterLog, "TelemetryLogWriterLog")
+
+const quint64 TelemetryLogWriter::_ringSize;
+const quint64 TelemetryLogWriter::_blockSize;
+
+TelemetryLogWriter::TelemetryLogWriter(QObject* parent)
+    : QThread                   (parent)
+    , _file                     (nullptr)
+    , _compressed               (false)
+    , _ring                     (new uint8_t[_ringSize])
+    , _writePosition            (0)
+    , _readPosition             (0)
+    , _stopRequested            (false)
+    , _writeFailed              (false)
+    , _bytesWritten             (0)
+    , _recordsQueued            (0)
+    , _recordsDropped           (0)
+    , _bytesDropped             (0)
+    , _lastWriteLatencyUSecs    (0)
+    , _maxWriteLatencyUSecs     (0)
+    , _syncCount                (0)
+    , _pendingBlockTimestamp    (0)
+    , _fileOffset               (0)
+    , _uncompressedOffset       (0)
+{
+    setObjectName(QStringLiteral("TelemetryLogWriter"));
+}
+
+TelemetryLogWriter::~TelemetryLogWriter()
+{
+    stopWriting();
+    delete[] _ring;
+}
+
+void TelemetryLogWriter::startWriting(QFile* file, bool compressed)
+{
+    if (_file) {
+        qWarning() << "TelemetryLogWriter::startWriting called while already writing";
+        return;
+    }
+
+    _file = file;
+    _compressed = compressed;
+    _stopRequested = false;
+    _writeFailed = false;
+    _readPosition.store(_writePosition.load());
+    _recordsQueued = 0;
+
+    if (_compressed) {
+        _pendingBlock.clear();
+        _pendingBlock.reserve(_compressedBlockSize * 2);
+        _blocks.clear();
+        _uncompressedOffset = 0;
+        _fileOffset = file->pos() + CompressedTlogDevice::fileHeaderSize;
+        if (!_write(CompressedTlogDevice::fileHeader())) {
+            _file = nullptr;
+            return;
+        }
+    }
+
+    qCDebug(TelemetryLogWriterLog) << "Start writing" << file->fileName() << "compressed" << compressed;
+    start(LowPriority);
+}
+
+void TelemetryLogWriter::stopWriting(void)
+{
+    if (!_file) {
+        return;
+    }
+
+    _stopRequested = true;
+    _wakeWriter();
+    wait();
+
+    qCDebug(TelemetryLogWriterLog) << "Stop writing" << _file->fileName()
+                                   << "bytesWritten" << _bytesWritten
+                                   << "recordsDropped" << _recordsDropped
+                                   << "maxWriteLatencyUSecs" << _maxWriteLatencyUSecs;
+    _file = nullptr;
+}
+
+bool TelemetryLogWriter::enqueue(quint64 timestamp, const uint8_t* data, int length)
+{
+    const quint64 prefixSize = _compressed ? _cbRecordLength : 0;
+    const quint64 recordSize = prefixSize + sizeof(quint64) + static_cast<quint64>(length);
+    const quint64 writePosition = _writePosition.load(std::memory_order_relaxed);
+    const quint64 readPosition = _readPosition.load(std::memory_order_acquire);
+
+    if (!_file || _writeFailed) {
+        return false;
+    }
+
+    if (_ringSize - (writePosition - readPosition) < recordSize) {
+        _recordsDropped.fetch_add(1, std::memory_order_relaxed);
+        _bytesDropped.fetch_add(recordSize, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (_compressed) {
+        // The writer needs record boundaries to cut blocks
+        uint8_t lengthBytes[_cbRecordLength];
+        qToLittleEndian(static_cast<quint32>(sizeof(quint64) + static_cast<quint64>(length)), lengthBytes);
+        _copyIn(writePosition, lengthBytes, sizeof(lengthBytes));
+    }
+
+    uint8_t timestampBytes[sizeof(quint64)];
+    qToBigEndian(timestamp, timestampBytes);
+    _copyIn(writePosition + prefixSize, timestampBytes, sizeof(timestampBytes));
+    _copyIn(writePosition + prefixSize + sizeof(timestampBytes), data, length);
+    _writePosition.store(writePosition + recordSize, std::memory_order_release);
+    _recordsQueued.fetch_add(1, std::memory_order_relaxed);
+
+    // Only bother the writer once a full block is ready, otherwise it picks things up on its flush interval
+    const quint64 queued = writePosition + recordSize - readPosition;
+    if (queued >= _blockSize && queued - recordSize < _blockSize) {
+        _wakeWriter();
+    }
+
+    return true;
+}
+
+TelemetryLogWriter::Stats_t TelemetryLogWriter::stats(void) const
+{
+    Stats_t stats;
+
+    stats.bytesQueued           = _writePosition.load() - _readPosition.load();
+    stats.bytesWritten          = _bytesWritten;
+    stats.recordsQueued         = _recordsQueued;
+    stats.recordsDropped        = _recordsDropped;
+    stats.bytesDropped          = _bytesDropped;
+    stats.lastWriteLatencyUSecs = _lastWriteLatencyUSecs;
+    stats.maxWriteLatencyUSecs  = _maxWriteLatencyUSecs;
+    stats.syncCount             = _syncCount;
+
+    return stats;
+}
+
+void TelemetryLogWriter::run(void)
+{
+    QElapsedTimer syncTimer;
+    syncTimer.start();
+
+    while (true) {
+        // Must be sampled before draining such that everything queued prior to stopWriting makes it to disk
+        bool stopRequested = _stopRequested;
+
+        _drain();
+        if (syncTimer.elapsed() > _syncIntervalMSecs) {
+            _sync();
+            syncTimer.restart();
+        }
+
+        if (stopRequested) {
+            if (_compressed) {
+                _writeBlock();
+                _writeIndex();
+            }
+            break;
+        }
+
+        QMutexLocker locker(&_wakeMutex);
+        if (!_stopRequested && _writePosition.load() - _readPosition.load() < _blockSize) {
+            _wakeCondition.wait(&_wakeMutex, _flushIntervalMSecs);
+        }
+    }
+
+    _sync();
+}
+
+void TelemetryLogWriter::_copyIn(quint64 position, const uint8_t* data, int length)
+{
+    const quint64 offset = position & (_ringSize - 1);
+    const quint64 firstPart = qMin(static_cast<quint64>(length), _ringSize - offset);
+
+    memcpy(_ring + offset, data, firstPart);
+    if (firstPart < static_cast<quint64>(length)) {
+        memcpy(_ring, data + firstPart, length - firstPart);
+    }
+}
+
+void TelemetryLogWriter::_copyOut(quint64 position, uint8_t* data, int length) const
+{
+    const quint64 offset = position & (_ringSize - 1);
+    const quint64 firstPart = qMin(static_cast<quint64>(length), _ringSize - offset);
+
+    memcpy(data, _ring + offset, firstPart);
+    if (firstPart < static_cast<quint64>(length)) {
+        memcpy(data + firstPart, _ring, length - firstPart);
+    }
+}
+
+void TelemetryLogWriter::_drain(void)
+{
+    const quint64 readPosition = _readPosition.load(std::memory_order_relaxed);
+    const quint64 writePosition = _writePosition.load(std::memory_order_acquire);
+
+    if (readPosition == writePosition) {
+        return;
+    }
+
+    if (_writeFailed) {
+        // Nothing more goes to disk, just keep the ring empty
+        _readPosition.store(writePosition, std::memory_order_release);
+        return;
+    }
+
+    if (_compressed) {
+        _drainCompressed(readPosition, writePosition);
+        return;
+    }
+
+    const quint64 offset = readPosition & (_ringSize - 1);
+    const quint64 available = writePosition - readPosition;
+    const quint64 firstPart = qMin(available, _ringSize - offset);
+
+    QElapsedTimer latencyTimer;
+    latencyTimer.start();
+
+    bool success = _file->write(reinterpret_cast<const char*>(_ring + offset), static_cast<qint64>(firstPart)) == static_cast<qint64>(firstPart);
+    if (success && firstPart < available) {
+        const quint64 secondPart = available - firstPart;
+        success = _file->write(reinterpret_cast<const char*>(_ring), static_cast<qint64>(secondPart)) == static_cast<qint64>(secondPart);
+    }
+
+    const quint64 latency = static_cast<quint64>(latencyTimer.nsecsElapsed() / 1000);
+    _lastWriteLatencyUSecs = latency;
+    if (latency > _maxWriteLatencyUSecs) {
+        _maxWriteLatencyUSecs = latency;
+    }
+
+    _readPosition.store(writePosition, std::memory_order_release);
+
+    if (success) {
+        _bytesWritten.fetch_add(available, std::memory_order_relaxed);
+    } else {
+        qCWarning(TelemetryLogWriterLog) << "Write failed" << _file->fileName() << _file->errorString();
+        _writeFailed = true;
+        emit writeError(_file->errorString());
+    }
+}
+
+/// Moves queued records into the pending block, writing blocks as they fill up
+void TelemetryLogWriter::_drainCompressed(quint64 readPosition, quint64 writePosition)
+{
+    while (readPosition != writePosition && !_writeFailed) {
+        uint8_t lengthBytes[_cbRecordLength];
+        _copyOut(readPosition, lengthBytes, sizeof(lengthBytes));
+        const int recordLength = static_cast<int>(qFromLittleEndian<quint32>(lengthBytes));
+
+        if (_pendingBlock.isEmpty()) {
+            uint8_t timestampBytes[sizeof(quint64)];
+            _copyOut(readPosition + _cbRecordLength, timestampBytes, sizeof(timestampBytes));
+            _pendingBlockTimestamp = qFromBigEndian<quint64>(timestampBytes);
+            _pendingBlockTimer.start();
+        }
+        const int pendingSize = _pendingBlock.size();
+        _pendingBlock.resize(pendingSize + recordLength);
+        _copyOut(readPosition + _cbRecordLength, reinterpret_cast<uint8_t*>(_pendingBlock.data() + pendingSize), recordLength);
+
+        readPosition += _cbRecordLength + static_cast<quint64>(recordLength);
+        _readPosition.store(readPosition, std::memory_order_release);
+
+        if (_pendingBlock.size() >= _compressedBlockSize) {
+            _writeBlock();
+        }
+    }
+
+    if (!_pendingBlock.isEmpty() && _pendingBlockTimer.elapsed() > _compressedFlushIntervalMSecs) {
+        _writeBlock();
+    }
+}
+
+/// Compresses and writes the pending block
+void TelemetryLogWriter::_writeBlock(void)
+{
+    if (_pendingBlock.isEmpty() || _writeFailed) {
+        return;
+    }
+
+    QElapsedTimer latencyTimer;
+    latencyTimer.start();
+
+    CompressedTlogDevice::Block_t block;
+    block.fileOffset = _fileOffset;
+    block.uncompressedOffset = _uncompressedOffset;
+    QByteArray encoded = CompressedTlogDevice::encodeBlock(_pendingBlock, _pendingBlockTimestamp, block);
+
+    if (_write(encoded)) {
+        _blocks.append(block);
+        _fileOffset += encoded.size();
+        _uncompressedOffset += block.uncompressedSize;
+    }
+    _pendingBlock.clear();
+
+    const quint64 latency = static_cast<quint64>(latencyTimer.nsecsElapsed() / 1000);
+    _lastWriteLatencyUSecs = latency;
+    if (latency > _maxWriteLatencyUSecs) {
+        _maxWriteLatencyUSecs = latency;
+    }
+}
+
+/// Writes the block index and trailer which allow a reader to seek without scanning the file
+void TelemetryLogWriter::_writeIndex(void)
+{
+    if (_writeFailed) {
+        return;
+    }
+    if (_write(CompressedTlogDevice::encodeIndex(_blocks, _fileOffset))) {
+        qCDebug(TelemetryLogWriterLog) << "Compressed log" << _blocks.count() << "blocks" << _uncompressedOffset << "->" << _bytesWritten << "bytes";
+    }
+}
+
+bool TelemetryLogWriter::_write(const QByteArray& bytes)
+{
+    if (_file->write(bytes) != bytes.size()) {
+        qCWarning(TelemetryLogWriterLog) << "Write failed" << _file->fileName() << _file->errorString();
+        _writeFailed = true;
+        emit writeError(_file->errorString());
+        return false;
+    }
+    _bytesWritten.fetch_add(static_cast<quint64>(bytes.size()), std::memory_order_relaxed);
+    return true;
+}
+
+void TelemetryLogWriter::_sync(void)
+{
+    if (_writeFailed || !_file->flush()) {
+        return;
+    }
+
+#if defined(Q_OS_WIN)
+    _commit(_file->handle());
+#elif defined(Q_OS_UNIX)
+    fsync(_file->handle());
+#endif
+    _syncCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TelemetryLogWriter::_wakeWriter(void)
+{
+    QMutexLocker locker(&_wakeMutex);
+    _wakeCondition.wakeOne();
+}
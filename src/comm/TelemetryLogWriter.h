@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QLoggingCategory>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <atomic>
+
+#include "CompressedTlogDevice.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryLogWriterLog)
+
+/// Writes telemetry log (tlog) records on a dedicated thread. The protocol thread queues records into a lock-free
+/// single producer/single consumer ring buffer and never touches the file itself. The writer thread drains the ring
+/// in large blocks and periodically syncs the file to disk. Records use the standard tlog format: 64 bit big endian
+/// timestamp in microseconds followed by the raw packet bytes.
+///
+/// If the writer falls behind far enough for the ring to fill up, new records are dropped and counted instead of
+/// stalling the protocol thread.
+///
+/// In compressed mode the file is written as a CompressedTlogDevice container. Records are gathered into blocks which
+/// are compressed on the writer thread, so compression cost never reaches the protocol thread. A block is written
+/// once it is full or has been pending for _compressedFlushIntervalMSecs, which bounds how much is lost on a crash.
+class TelemetryLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    TelemetryLogWriter(QObject* parent = nullptr);
+    ~TelemetryLogWriter();
+
+    typedef struct {
+        quint64 bytesQueued;            ///< Bytes currently waiting to be written
+        quint64 bytesWritten;           ///< Total bytes written to the file (after compression)
+        quint64 recordsQueued;          ///< Records accepted since startWriting, all reach the file unless a write fails
+        quint64 recordsDropped;         ///< Records discarded because the ring was full
+        quint64 bytesDropped;
+        quint64 lastWriteLatencyUSecs;  ///< Duration of the most recent block write
+        quint64 maxWriteLatencyUSecs;   ///< Longest block write seen
+        quint64 syncCount;              ///< Number of times the file was synced to disk
+    } Stats_t;
+
+    /// Starts the writer thread on an already opened, empty file. The writer has exclusive use of the file until
+    /// stopWriting is called.
+    ///     @param compressed true: write a block compressed log, see CompressedTlogDevice
+    void startWriting(QFile* file, bool compressed = false);
+
+    /// Writes everything which is still queued, syncs the file and stops the writer thread
+    void stopWriting(void);
+
+    bool writing    (void) const { return _file != nullptr; }
+    bool compressed (void) const { return _compressed; }
+
+    /// Queues a record for writing. Must only be called from a single thread (the protocol thread).
+    ///     @param timestamp Time in microseconds since epoch
+    /// @return false: Ring buffer was full, record was dropped
+    bool enqueue(quint64 timestamp, const uint8_t* data, int length);
+
+    Stats_t stats(void) const;
+
+    // Overrides from QThread
+    void run(void) override;
+
+signals:
+    /// Emitted from the writer thread if a write fails. No further data is written once this is signalled.
+    void writeError(QString errorString);
+
+private:
+    void _copyIn            (quint64 position, const uint8_t* data, int length);
+    void _copyOut           (quint64 position, uint8_t* data, int length) const;
+    void _drain             (void);
+    void _drainCompressed   (quint64 readPosition, quint64 writePosition);
+    void _writeBlock        (void);
+    void _writeIndex        (void);
+    bool _write             (const QByteArray& bytes);
+    void _sync              (void);
+    void _wakeWriter        (void);
+
+    QFile*                  _file;
+    bool                    _compressed;
+    uint8_t*                _ring;
+    std::atomic<quint64>    _writePosition;     ///< Monotonic, only advanced by the producer
+    std::atomic<quint64>    _readPosition;      ///< Monotonic, only advanced by the writer thread
+    std::atomic<bool>       _stopRequested;
+    std::atomic<bool>       _writeFailed;
+
+    QMutex                  _wakeMutex;
+    QWaitCondition          _wakeCondition;
+
+    std::atomic<quint64>    _bytesWritten;
+    std::atomic<quint64>    _recordsQueued;
+    std::atomic<quint64>    _recordsDropped;
+    std::atomic<quint64>    _bytesDropped;
+    std::atomic<quint64>    _lastWriteLatencyUSecs;
+    std::atomic<quint64>    _maxWriteLatencyUSecs;
+    std::atomic<quint64>    _syncCount;
+
+    // Compressed mode state, only touched by the writer thread
+    QByteArray                              _pendingBlock;
+    quint64                                 _pendingBlockTimestamp;
+    QElapsedTimer                           _pendingBlockTimer;
+    qint64                                  _fileOffset;
+    qint64                                  _uncompressedOffset;
+    QVector<CompressedTlogDevice::Block_t>  _blocks;
+
+    static const quint64    _ringSize           = 4 * 1024 * 1024;  ///< Must be a power of two
+    static const quint64    _blockSize          = 64 * 1024;        ///< Writer is woken once this much data is queued
+    static const int        _flushIntervalMSecs = 250;              ///< Partial blocks are written at least this often
+    static const int        _syncIntervalMSecs  = 2000;
+
+    static const int        _compressedBlockSize            = 64 * 1024;    ///< Uncompressed size at which a block is written
+    static const int        _compressedFlushIntervalMSecs   = 5000;         ///< Partial blocks are written at least this often
+    static const int        _cbRecordLength                 = sizeof(quint32);  ///< Length prefix on records in the ring in compressed mode
+};
@@ -0,0 +1,563 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogExporter.h"
+#include "TlogIndex.h"
+#include "CompressedTlogDevice.h"
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+#include "QGC.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QScopedPointer>
+#include <QVector>
+#include <QtConcurrent>
+#include <QtEndian>
+
+QGC_LOGGING_CATEGORY(TlogExporterLog, "TlogExporterLog")
+
+const char* TlogExporter::csvExtension =            "csv";
+const char* TlogExporter::binaryColumnsExtension =  "qgccol";
+
+const qint64 TlogExporter::_defaultChunkSize;
+
+static const qint64 maxRecordSize = TlogIndex::cbTimestamp + MAVLINK_MAX_PACKET_LEN;
+
+TlogExporter::TlogExporter(const QString& logFilename, const QString& outputDirectory, QObject* parent)
+    : QThread           (parent)
+    , _logFilename      (logFilename)
+    , _outputDirectory  (outputDirectory)
+    , _format           (FormatCSV)
+    , _delimiter        (',')
+    , _chunkSize        (_defaultChunkSize)
+    , _cancelRequested  (false)
+{
+    memset(&_stats, 0, sizeof(_stats));
+    setObjectName(QStringLiteral("TlogExporter"));
+    setThreadCount(QThread::idealThreadCount());
+}
+
+TlogExporter::~TlogExporter()
+{
+    _cancelRequested = true;
+    wait();
+    _threadPool.waitForDone();
+    _closeOutputFiles();
+}
+
+void TlogExporter::setThreadCount(int threadCount)
+{
+    _threadPool.setMaxThreadCount(qMax(1, threadCount));
+}
+
+void TlogExporter::startExport(void)
+{
+    if (isRunning()) {
+        qWarning() << "TlogExporter::startExport called while export in progress";
+        return;
+    }
+    _cancelRequested = false;
+    start();
+}
+
+void TlogExporter::run(void)
+{
+    QElapsedTimer                   elapsedTimer;
+    QString                         errorString;
+    QList<QFuture<ChunkResult_t>>   inFlight;
+    bool                            success = true;
+
+    elapsedTimer.start();
+    memset(&_stats, 0, sizeof(_stats));
+    _closeOutputFiles();
+    _outputFilenames.clear();
+
+    QScopedPointer<QIODevice> device(CompressedTlogDevice::openLog(_logFilename, errorString));
+    if (!device) {
+        emit exportFinished(false, errorString);
+        return;
+    }
+    if (!QDir().mkpath(_outputDirectory)) {
+        emit exportFinished(false, tr("Unable to create export directory '%1'").arg(_outputDirectory));
+        return;
+    }
+
+    const qint64    logSize     = device->size();
+    const int       chunkCount  = static_cast<int>((logSize + _chunkSize - 1) / _chunkSize);
+    const int       maxInFlight = _threadPool.maxThreadCount() * _chunksInFlightPerThread;
+    const QString   logFilename = _logFilename;
+    const Format_t  format      = _format;
+    const char      delimiter   = _delimiter;
+    int             nextChunk   = 0;
+    qint64          recordStart = 0;    ///< True start of the next record, carried forward from chunk to chunk
+
+    qCDebug(TlogExporterLog) << "Export start" << _logFilename << "size" << logSize << "chunks" << chunkCount << "threads" << _threadPool.maxThreadCount();
+
+    for (int i=0; i<chunkCount; i++) {
+        while (nextChunk < chunkCount && inFlight.count() < maxInFlight) {
+            Chunk_t chunk;
+            chunk.index     = nextChunk;
+            chunk.start     = nextChunk * _chunkSize;
+            chunk.end       = qMin(logSize, chunk.start + _chunkSize);
+            chunk.synced    = nextChunk == 0;
+            const std::atomic<bool>* cancelRequested = &_cancelRequested;
+            inFlight.append(QtConcurrent::run(&_threadPool, [logFilename, chunk, format, delimiter, cancelRequested]() {
+                return _decodeChunk(logFilename, chunk, format, delimiter, cancelRequested);
+            }));
+            nextChunk++;
+        }
+
+        ChunkResult_t result = inFlight.takeFirst().result();
+        if (_cancelRequested) {
+            errorString = tr("Export cancelled");
+            success = false;
+            break;
+        }
+
+        if (!result.chunk.synced && result.errorString.isEmpty()) {
+            // The speculative sync point is only right if the true parse, continuing from where the previous chunk
+            // left off, ends the first packet this chunk owns at the same place. The previous chunk decoded the
+            // record straddling the boundary, so on a clean log this only needs to parse a single record.
+            qint64 trueFirstEnd = _firstPacketEnd(device.data(), recordStart, result.chunk.end);
+            if (trueFirstEnd != result.firstEnd) {
+                qCDebug(TlogExporterLog) << "Resync chunk" << result.chunk.index << "speculative" << result.firstEnd << "true" << trueFirstEnd;
+                Chunk_t chunk = result.chunk;
+                chunk.start = recordStart;
+                chunk.synced = true;
+                result = _decodeChunk(logFilename, chunk, format, delimiter, &_cancelRequested);
+                _stats.resyncCount++;
+            }
+        }
+        if (!result.errorString.isEmpty()) {
+            errorString = result.errorString;
+            success = false;
+            break;
+        }
+        if (result.lastEnd != -1) {
+            recordStart = result.lastEnd;
+        }
+
+        if (!_writeResult(result, errorString)) {
+            success = false;
+            break;
+        }
+
+        _stats.chunkCount++;
+        _stats.messageCount += result.messageCount;
+        _stats.bytesProcessed = result.chunk.end;
+        _stats.elapsedMSecs = qMax(static_cast<qint64>(1), elapsedTimer.elapsed());
+        _stats.bytesPerSecond = (_stats.bytesProcessed * 1000.0) / _stats.elapsedMSecs;
+        emit exportProgress(_stats.bytesProcessed, logSize, _stats.bytesPerSecond);
+    }
+
+    // Chunks still queued after a failure are not needed, let them finish without doing any work
+    _cancelRequested = true;
+    for (QFuture<ChunkResult_t>& future: inFlight) {
+        future.waitForFinished();
+    }
+
+    _stats.messageTypeCount = _outputFiles.count();
+    _stats.elapsedMSecs = qMax(static_cast<qint64>(1), elapsedTimer.elapsed());
+    _stats.bytesPerSecond = (_stats.bytesProcessed * 1000.0) / _stats.elapsedMSecs;
+    _closeOutputFiles();
+
+    qCDebug(TlogExporterLog) << "Export done" << success << "messages" << _stats.messageCount << "types" << _stats.messageTypeCount
+                             << "resyncs" << _stats.resyncCount << "MB/s" << _stats.bytesPerSecond / (1024 * 1024);
+
+    emit exportFinished(success, errorString);
+}
+
+bool TlogExporter::_writeResult(const ChunkResult_t& result, QString& errorString)
+{
+    for (auto iter = result.output.constBegin(); iter != result.output.constEnd(); iter++) {
+        if (!_outputFiles.contains(iter.key()) && !_openOutputFile(iter.key(), errorString)) {
+            return false;
+        }
+        QFile* file = _outputFiles[iter.key()];
+        if (file->write(iter.value()) != iter.value().size()) {
+            errorString = tr("Error writing export file '%1': %2").arg(file->fileName()).arg(file->errorString());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TlogExporter::_openOutputFile(quint32 msgId, QString& errorString)
+{
+    const mavlink_message_info_t* info = mavlink_get_message_info_by_id(msgId);
+    const char* extension = _format == FormatCSV ? csvExtension : binaryColumnsExtension;
+
+    QFile* file = new QFile(QDir(_outputDirectory).absoluteFilePath(QStringLiteral("%1.%2").arg(info->name).arg(extension)));
+    if (!file->open(QFile::WriteOnly | QFile::Truncate)) {
+        errorString = tr("Unable to open export file '%1': %2").arg(file->fileName()).arg(file->errorString());
+        delete file;
+        return false;
+    }
+    file->write(_format == FormatCSV ? _csvHeader(msgId, _delimiter) : _binaryHeader(msgId));
+
+    _outputFiles[msgId] = file;
+    _outputFilenames.append(file->fileName());
+    return true;
+}
+
+void TlogExporter::_closeOutputFiles(void)
+{
+    qDeleteAll(_outputFiles);
+    _outputFiles.clear();
+}
+
+/// @return Offset one past the first packet of the record stream which starts at recordStart, -1 if the stream has no
+///         packet whose record starts before chunkEnd
+qint64 TlogExporter::_firstPacketEnd(QIODevice* device, qint64 recordStart, qint64 chunkEnd)
+{
+    static const qint64 readSize = 4096;
+
+    TlogChunkParser     parser(true /* synced */);
+    mavlink_message_t   message;
+    qint64              position = recordStart;
+    const qint64        end = qMin(device->size(), chunkEnd + maxRecordSize);
+
+    if (recordStart >= chunkEnd || !device->seek(recordStart)) {
+        return -1;
+    }
+    while (position < end) {
+        QByteArray bytes = device->read(qMin(readSize, end - position));
+        if (bytes.isEmpty()) {
+            return -1;
+        }
+        for (int i=0; i<bytes.size(); i++) {
+            if (parser.parseByte(static_cast<uint8_t>(bytes[i]), &message)) {
+                const qint64 packetEnd = position + i + 1;
+                if (packetEnd - mavlink_msg_get_send_buffer_length(&message) - TlogIndex::cbTimestamp >= chunkEnd) {
+                    return -1;
+                }
+                return packetEnd;
+            }
+        }
+        position += bytes.size();
+    }
+    return -1;
+}
+
+/// Trying each start byte with a fresh parser, rather than running a single parser over the bytes, keeps a start byte
+/// inside a timestamp or payload from swallowing the real packet behind it.
+/// @return Position of the first start byte in [0, to) from which a packet frames with a valid crc, -1 if none
+static int findPacketStart(const uint8_t* data, int size, int to)
+{
+    mavlink_message_t   rxMessage;
+    mavlink_message_t   message;
+    mavlink_status_t    status;
+    mavlink_status_t    returnStatus;
+
+    for (int start=0; start<qMin(to, size); start++) {
+        if (data[start] != MAVLINK_STX && data[start] != MAVLINK_STX_MAVLINK1) {
+            continue;
+        }
+
+        memset(&rxMessage, 0, sizeof(rxMessage));
+        memset(&status, 0, sizeof(status));
+        memset(&returnStatus, 0, sizeof(returnStatus));
+        for (int i=start; i<size; i++) {
+            uint8_t framing = mavlink_frame_char_buffer(&rxMessage, &status, data[i], &message, &returnStatus);
+            if (framing == MAVLINK_FRAMING_OK) {
+                return start;
+            }
+            if (framing != MAVLINK_FRAMING_INCOMPLETE || status.parse_state == MAVLINK_PARSE_STATE_IDLE) {
+                break;
+            }
+        }
+    }
+    return -1;
+}
+
+static void appendCsvField(QByteArray& row, const mavlink_field_info_t& field, const uint8_t* payload, char delimiter)
+{
+    const uint8_t* value = payload + field.wire_offset;
+
+    if (field.type == MAVLINK_TYPE_CHAR) {
+        int length = 0;
+        int maxLength = qMax(1u, field.array_length);
+        while (length < maxLength && value[length] != 0) {
+            length++;
+        }
+        row += delimiter;
+        row += '"';
+        row += QByteArray(reinterpret_cast<const char*>(value), length).replace('"', "\"\"");
+        row += '"';
+        return;
+    }
+
+    const unsigned count = qMax(1u, field.array_length);
+    for (unsigned i=0; i<count; i++) {
+        row += delimiter;
+        switch (field.type) {
+        case MAVLINK_TYPE_UINT8_T:
+            row += QByteArray::number(value[0]);
+            value += 1;
+            break;
+        case MAVLINK_TYPE_INT8_T:
+            row += QByteArray::number(static_cast<int8_t>(value[0]));
+            value += 1;
+            break;
+        case MAVLINK_TYPE_UINT16_T:
+            row += QByteArray::number(qFromLittleEndian<quint16>(value));
+            value += 2;
+            break;
+        case MAVLINK_TYPE_INT16_T:
+            row += QByteArray::number(qFromLittleEndian<qint16>(value));
+            value += 2;
+            break;
+        case MAVLINK_TYPE_UINT32_T:
+            row += QByteArray::number(qFromLittleEndian<quint32>(value));
+            value += 4;
+            break;
+        case MAVLINK_TYPE_INT32_T:
+            row += QByteArray::number(qFromLittleEndian<qint32>(value));
+            value += 4;
+            break;
+        case MAVLINK_TYPE_UINT64_T:
+            row += QByteArray::number(qFromLittleEndian<quint64>(value));
+            value += 8;
+            break;
+        case MAVLINK_TYPE_INT64_T:
+            row += QByteArray::number(qFromLittleEndian<qint64>(value));
+            value += 8;
+            break;
+        case MAVLINK_TYPE_FLOAT:
+        {
+            quint32 bits = qFromLittleEndian<quint32>(value);
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            row += QByteArray::number(static_cast<double>(f), 'g', 9);
+            value += 4;
+            break;
+        }
+        case MAVLINK_TYPE_DOUBLE:
+        {
+            quint64 bits = qFromLittleEndian<quint64>(value);
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            row += QByteArray::number(d, 'g', 17);
+            value += 8;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+TlogExporter::ChunkResult_t TlogExporter::_decodeChunk(const QString& logFilename, Chunk_t chunk, Format_t format, char delimiter, const std::atomic<bool>* cancelRequested)
+{
+    ChunkResult_t result;
+
+    result.chunk        = chunk;
+    result.firstEnd     = -1;
+    result.lastEnd      = -1;
+    result.messageCount = 0;
+
+    if (*cancelRequested || chunk.start >= chunk.end) {
+        return result;
+    }
+
+    QScopedPointer<QIODevice> device(CompressedTlogDevice::openLog(logFilename, result.errorString));
+    if (!device) {
+        return result;
+    }
+
+    // The chunk owns the records which start inside it, the last one is decoded to its end past the chunk end
+    const qint64 readEnd = qMin(device->size(), chunk.end + maxRecordSize);
+    QByteArray bytes;
+    if (device->seek(chunk.start)) {
+        bytes = device->read(readEnd - chunk.start);
+    }
+    if (bytes.size() != readEnd - chunk.start) {
+        result.errorString = tr("Unable to read log file '%1'").arg(logFilename);
+        return result;
+    }
+
+    const uint8_t*                      data = reinterpret_cast<const uint8_t*>(bytes.constData());
+    const int                           ownedEnd = static_cast<int>(chunk.end - chunk.start);
+    TlogChunkParser                     parser(chunk.synced);
+    const quint64                       nowUSecs = QGC::groundTimeUsecs();
+    mavlink_message_t                   message;
+    uint8_t                             payload[MAVLINK_MAX_PAYLOAD_LEN];
+    QMap<quint32, QVector<QByteArray>>  columns;
+
+    int position = 0;
+    if (!chunk.synced) {
+        // A record starting inside the chunk has its packet start byte no further than a timestamp past the chunk end
+        position = findPacketStart(data, bytes.size(), ownedEnd + TlogIndex::cbTimestamp);
+        if (position == -1) {
+            return result;
+        }
+    }
+
+    for (; position<bytes.size(); position++) {
+        if (!parser.parseByte(data[position], &message)) {
+            continue;
+        }
+
+        const int recordStart = position + 1 - mavlink_msg_get_send_buffer_length(&message) - TlogIndex::cbTimestamp;
+        if (recordStart >= ownedEnd) {
+            // Owned by the next chunk
+            break;
+        }
+        if (recordStart < 0) {
+            // Straddles the chunk start, owned by the previous chunk
+            continue;
+        }
+
+        const qint64 packetEnd = chunk.start + position + 1;
+        if (result.firstEnd == -1) {
+            result.firstEnd = packetEnd;
+        }
+        result.lastEnd = packetEnd;
+        result.messageCount++;
+
+        const quint64 timestamp = TlogIndex::parseTimestamp(parser.timestampValid() ? parser.timestamp() : bytes.constData() + recordStart, nowUSecs);
+
+        const mavlink_message_info_t* info = mavlink_get_message_info(&message);
+        if (!info) {
+            continue;
+        }
+
+        // Mavlink 2 trims trailing zeros from the payload
+        memset(payload, 0, sizeof(payload));
+        memcpy(payload, _MAV_PAYLOAD(&message), message.len);
+
+        if (format == FormatCSV) {
+            QByteArray& rows = result.output[message.msgid];
+            rows += QByteArray::number(timestamp);
+            rows += delimiter;
+            rows += QByteArray::number(message.sysid);
+            rows += delimiter;
+            rows += QByteArray::number(message.compid);
+            for (unsigned i=0; i<info->num_fields; i++) {
+                appendCsvField(rows, info->fields[i], payload, delimiter);
+            }
+            rows += '\n';
+        } else {
+            QVector<QByteArray>& messageColumns = columns[message.msgid];
+            if (messageColumns.isEmpty()) {
+                messageColumns.resize(3 + static_cast<int>(info->num_fields));
+            }
+            uint8_t timestampBytes[sizeof(quint64)];
+            qToLittleEndian(timestamp, timestampBytes);
+            messageColumns[0].append(reinterpret_cast<const char*>(timestampBytes), sizeof(timestampBytes));
+            messageColumns[1].append(static_cast<char>(message.sysid));
+            messageColumns[2].append(static_cast<char>(message.compid));
+            for (unsigned i=0; i<info->num_fields; i++) {
+                const mavlink_field_info_t& field = info->fields[i];
+                messageColumns[3 + static_cast<int>(i)].append(reinterpret_cast<const char*>(payload + field.wire_offset),
+                                                               _typeSize(field.type) * static_cast<int>(qMax(1u, field.array_length)));
+            }
+        }
+    }
+
+    if (format == FormatBinaryColumns) {
+        for (auto iter = columns.constBegin(); iter != columns.constEnd(); iter++) {
+            QByteArray& segment = result.output[iter.key()];
+            uint8_t rowCountBytes[sizeof(quint32)];
+            qToLittleEndian(static_cast<quint32>(iter.value()[0].size() / sizeof(quint64)), rowCountBytes);
+            segment.append(reinterpret_cast<const char*>(rowCountBytes), sizeof(rowCountBytes));
+            for (const QByteArray& column: iter.value()) {
+                segment.append(column);
+            }
+        }
+    }
+
+    return result;
+}
+
+QByteArray TlogExporter::_csvHeader(quint32 msgId, char delimiter)
+{
+    const mavlink_message_info_t* info = mavlink_get_message_info_by_id(msgId);
+
+    QByteArray header("timestamp_usec");
+    header += delimiter;
+    header += "sysid";
+    header += delimiter;
+    header += "compid";
+    for (unsigned i=0; i<info->num_fields; i++) {
+        const mavlink_field_info_t& field = info->fields[i];
+        if (field.array_length == 0 || field.type == MAVLINK_TYPE_CHAR) {
+            header += delimiter;
+            header += field.name;
+        } else {
+            for (unsigned j=0; j<field.array_length; j++) {
+                header += delimiter;
+                header += QByteArray(field.name) + '[' + QByteArray::number(j) + ']';
+            }
+        }
+    }
+    header += '\n';
+
+    return header;
+}
+
+QByteArray TlogExporter::_binaryHeader(quint32 msgId)
+{
+    const mavlink_message_info_t* info = mavlink_get_message_info_by_id(msgId);
+
+    typedef struct {
+        QByteArray  name;
+        int         type;
+        int         arrayLength;
+    } Column_t;
+
+    QList<Column_t> columnList = {
+        { "timestamp_usec", MAVLINK_TYPE_UINT64_T,  1 },
+        { "sysid",          MAVLINK_TYPE_UINT8_T,   1 },
+        { "compid",         MAVLINK_TYPE_UINT8_T,   1 },
+    };
+    for (unsigned i=0; i<info->num_fields; i++) {
+        const mavlink_field_info_t& field = info->fields[i];
+        columnList.append({ field.name, field.type, static_cast<int>(qMax(1u, field.array_length)) });
+    }
+
+    QByteArray header("QGCCOLS1");
+    uint8_t value[sizeof(quint32)];
+    qToLittleEndian(static_cast<quint32>(columnList.count()), value);
+    header.append(reinterpret_cast<const char*>(value), sizeof(quint32));
+    for (const Column_t& column: columnList) {
+        header.append(static_cast<char>(column.type));
+        qToLittleEndian(static_cast<quint16>(column.arrayLength), value);
+        header.append(reinterpret_cast<const char*>(value), sizeof(quint16));
+        qToLittleEndian(static_cast<quint16>(column.name.size()), value);
+        header.append(reinterpret_cast<const char*>(value), sizeof(quint16));
+        header.append(column.name);
+    }
+
+    return header;
+}
+
+int TlogExporter::_typeSize(int mavlinkType)
+{
+    switch (mavlinkType) {
+    case MAVLINK_TYPE_CHAR:
+    case MAVLINK_TYPE_UINT8_T:
+    case MAVLINK_TYPE_INT8_T:
+        return 1;
+    case MAVLINK_TYPE_UINT16_T:
+    case MAVLINK_TYPE_INT16_T:
+        return 2;
+    case MAVLINK_TYPE_UINT32_T:
+    case MAVLINK_TYPE_INT32_T:
+    case MAVLINK_TYPE_FLOAT:
+        return 4;
+    case MAVLINK_TYPE_UINT64_T:
+    case MAVLINK_TYPE_INT64_T:
+    case MAVLINK_TYPE_DOUBLE:
+        return 8;
+    }
+    return 0;
+}
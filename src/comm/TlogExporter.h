@@ -0,0 +1,143 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QThreadPool>
+#include <QFile>
+#include <QMap>
+#include <QLoggingCategory>
+
+#include <atomic>
+
+Q_DECLARE_LOGGING_CATEGORY(TlogExporterLog)
+
+/// Exports a telemetry log (tlog or compressed tlog) to one output file per message type. Every decoded message
+/// becomes a row holding the log timestamp, sender ids and every message field as described by the mavlink message
+/// info tables.
+///
+/// The log is split into fixed size chunks which are decoded in parallel on a thread pool. Each chunk owns the records
+/// which start inside it and decodes its last record to the end, past the chunk end. A chunk other than the first does
+/// not know where the first record inside it starts, so it syncs onto the first mavlink packet which frames with a
+/// valid crc and skips it if it belongs to the record straddling the chunk start. Chunks are merged in log order and
+/// each speculative sync point is checked against the true record boundary carried over from the previous chunk. A
+/// chunk which synced wrongly (only seen in logs with corrupt data) is decoded again from the true boundary. The output
+/// is therefore identical to a single sequential pass over the log, independent of chunk size or thread count.
+///
+/// Memory use is bounded by the number of chunks in flight, which is a small multiple of the thread count.
+///
+/// Output formats:
+///     FormatCSV               <MSGNAME>.csv with a header row. Arrays are expanded to one column per element,
+///                             char arrays are written as a quoted string.
+///     FormatBinaryColumns     <MSGNAME>.qgccol, all values little endian:
+///                                 header      "QGCCOLS1", u32 column count, per column: u8 mavlink type,
+///                                             u16 array length, u16 name length, name
+///                                 segments    u32 row count, then each column as a packed array of row count values
+///                             One segment is written per chunk which contained the message type.
+class TlogExporter : public QThread
+{
+    Q_OBJECT
+
+public:
+    typedef enum {
+        FormatCSV,
+        FormatBinaryColumns,
+    } Format_t;
+
+    typedef struct {
+        qint64  bytesProcessed;
+        quint64 messageCount;
+        int     messageTypeCount;
+        int     chunkCount;
+        int     resyncCount;        ///< Chunks which had to be decoded again from the true record boundary
+        qint64  elapsedMSecs;
+        double  bytesPerSecond;
+    } Stats_t;
+
+    /// @param logFilename      Log to export
+    /// @param outputDirectory  Directory for the output files, created if needed. Existing files are overwritten.
+    TlogExporter(const QString& logFilename, const QString& outputDirectory, QObject* parent = nullptr);
+    ~TlogExporter();
+
+    /// Settings must be changed before startExport is called
+    void setFormat      (Format_t format)   { _format = format; }
+    void setDelimiter   (char delimiter)    { _delimiter = delimiter; }
+    void setThreadCount (int threadCount);
+    void setChunkSize   (qint64 chunkSize)  { _chunkSize = qMax(static_cast<qint64>(1), chunkSize); }
+
+    Format_t    format      (void) const { return _format; }
+    qint64      chunkSize   (void) const { return _chunkSize; }
+
+    void startExport(void);
+
+    /// Stops an export which is in progress. exportFinished is signalled with failure.
+    void cancel(void) { _cancelRequested = true; }
+
+    /// @return Statistics for the last export, only valid once exportFinished has been signalled
+    Stats_t stats(void) const { return _stats; }
+
+    /// @return Files written by the last export, only valid once exportFinished has been signalled
+    QStringList outputFiles(void) const { return _outputFilenames; }
+
+    // Overrides from QThread
+    void run(void) override;
+
+    static const char* csvExtension;
+    static const char* binaryColumnsExtension;
+
+signals:
+    /// Signalled after each chunk is written
+    ///     @param bytesPerSecond Log bytes processed per second so far
+    void exportProgress(qint64 bytesProcessed, qint64 bytesTotal, double bytesPerSecond);
+
+    void exportFinished(bool success, QString errorString);
+
+private:
+    typedef struct {
+        int     index;
+        qint64  start;      ///< First byte of the chunk
+        qint64  end;        ///< One past the last byte of the chunk
+        bool    synced;     ///< true: start is known to be a record boundary
+    } Chunk_t;
+
+    typedef struct {
+        Chunk_t                     chunk;
+        qint64                      firstEnd;       ///< Offset one past the first packet owned by the chunk, -1 if none
+        qint64                      lastEnd;        ///< Offset one past the last packet owned by the chunk, -1 if none
+        quint64                     messageCount;
+        QMap<quint32, QByteArray>   output;         ///< Encoded rows (csv) or segment (binary) by message id
+        QString                     errorString;
+    } ChunkResult_t;
+
+    bool _writeResult       (const ChunkResult_t& result, QString& errorString);
+    bool _openOutputFile    (quint32 msgId, QString& errorString);
+    void _closeOutputFiles  (void);
+
+    static ChunkResult_t    _decodeChunk        (const QString& logFilename, Chunk_t chunk, Format_t format, char delimiter, const std::atomic<bool>* cancelRequested);
+    static qint64           _firstPacketEnd     (QIODevice* device, qint64 recordStart, qint64 chunkEnd);
+    static QByteArray       _csvHeader          (quint32 msgId, char delimiter);
+    static QByteArray       _binaryHeader       (quint32 msgId);
+    static int              _typeSize           (int mavlinkType);
+
+    QString                 _logFilename;
+    QString                 _outputDirectory;
+    Format_t                _format;
+    char                    _delimiter;
+    qint64                  _chunkSize;
+    QThreadPool             _threadPool;
+    std::atomic<bool>       _cancelRequested;
+
+    QMap<quint32, QFile*>   _outputFiles;
+    QStringList             _outputFilenames;
+    Stats_t                 _stats;
+
+    static const qint64     _defaultChunkSize       = 4 * 1024 * 1024;
+    static const int        _chunksInFlightPerThread = 2;
+};
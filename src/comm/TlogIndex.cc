@@ -0,0 +1,552 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogIndex.h"
+#include "CompressedTlogDevice.h"
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+#include "QGC.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QMap>
+#include <QScopedPointer>
+#include <QHash>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <QVector>
+#include <QtEndian>
+
+QGC_LOGGING_CATEGORY(TlogIndexLog, "TlogIndexLog")
+
+const char* TlogIndex::_magic =             "QGCTLIDX";
+const char* TlogIndex::_indexExtension =    ".qgcidx";
+
+const int       TlogIndex::cbTimestamp;
+const quint32   TlogIndex::_version;
+const quint64   TlogIndex::_headerSize;
+const quint64   TlogIndex::_blockSize;
+const quint64   TlogIndex::_entrySize;
+const quint64   TlogIndex::_blockEntrySize;
+const quint64   TlogIndex::_overflowEntrySize;
+const quint64   TlogIndex::_directoryEntrySize;
+const quint64   TlogIndex::_listEntrySize;
+const quint32   TlogIndex::_timeDeltaOverflow;
+
+const int TlogRecordParser::_cbTimestamp;
+const int TlogChunkParser::_cbTimestamp;
+
+TlogRecordParser::TlogRecordParser(uint8_t mavlinkChannel)
+    : _mavlinkChannel   (mavlinkChannel)
+    , _nowUSecs         (QGC::groundTimeUsecs())
+    , _timestampCount   (0)
+    , _position         (0)
+    , _recordOffset     (0)
+    , _nextRecordOffset (0)
+{
+    memset(&_status, 0, sizeof(_status));
+    mavlink_reset_channel_status(_mavlinkChannel);
+}
+
+quint64 TlogRecordParser::timestampUSecs(void) const
+{
+    return TlogIndex::parseTimestamp(_timestampBytes, _nowUSecs);
+}
+
+TlogIndex::TlogIndex(void)
+    : _map              (nullptr)
+    , _messageCount     (0)
+    , _startTimeUSecs   (0)
+    , _endTimeUSecs     (0)
+    , _entriesOffset    (0)
+    , _blocksOffset     (0)
+    , _blockCount       (0)
+    , _overflowOffset   (0)
+    , _overflowCount    (0)
+    , _directoryOffset  (0)
+    , _directoryCount   (0)
+    , _listsOffset      (0)
+{
+
+}
+
+TlogIndex::~TlogIndex()
+{
+    close();
+}
+
+bool TlogIndex::open(const QString& logFilename)
+{
+    close();
+
+    QFileInfo logInfo(logFilename);
+    if (!logInfo.exists()) {
+        return false;
+    }
+
+    QStringList candidates = { logFilename + _indexExtension, _cacheIndexFilename(logFilename) };
+    for (const QString& candidate: candidates) {
+        if (!QFile::exists(candidate)) {
+            continue;
+        }
+
+        _indexFile.setFileName(candidate);
+        if (!_indexFile.open(QFile::ReadOnly)) {
+            continue;
+        }
+
+        const quint64 fileSize = static_cast<quint64>(_indexFile.size());
+        if (fileSize >= _headerSize) {
+            _map = _indexFile.map(0, _indexFile.size());
+        }
+        if (!_map || memcmp(_map, _magic, 8) != 0 || _readUInt32(8) != _version) {
+            qCDebug(TlogIndexLog) << "Ignoring unusable index" << candidate;
+            close();
+            continue;
+        }
+
+        if (_readUInt64(16) != static_cast<quint64>(logInfo.size()) ||
+                static_cast<qint64>(_readUInt64(24)) != logInfo.lastModified().toMSecsSinceEpoch()) {
+            qCDebug(TlogIndexLog) << "Index out of date" << candidate;
+            close();
+            continue;
+        }
+
+        _messageCount       = _readUInt64(32);
+        _startTimeUSecs     = _readUInt64(40);
+        _endTimeUSecs       = _readUInt64(48);
+        _entriesOffset      = _readUInt64(56);
+        _blocksOffset       = _readUInt64(64);
+        _overflowOffset     = _readUInt64(72);
+        _overflowCount      = _readUInt64(80);
+        _directoryOffset    = _readUInt64(88);
+        _directoryCount     = _readUInt64(96);
+        _listsOffset        = _readUInt64(104);
+        _blockCount         = (_messageCount + _blockSize - 1) / _blockSize;
+
+        // Guard against a truncated file, everything after this point trusts the offsets
+        if (_entriesOffset + (_messageCount * _entrySize) > fileSize ||
+                _blocksOffset + (_blockCount * _blockEntrySize) > fileSize ||
+                _overflowOffset + (_overflowCount * _overflowEntrySize) > fileSize ||
+                _directoryOffset + (_directoryCount * _directoryEntrySize) > fileSize ||
+                _listsOffset + (_messageCount * _listEntrySize) > fileSize) {
+            qCWarning(TlogIndexLog) << "Truncated index" << candidate;
+            close();
+            continue;
+        }
+
+        qCDebug(TlogIndexLog) << "Opened index" << candidate << "messages" << _messageCount;
+        return true;
+    }
+
+    return false;
+}
+
+void TlogIndex::close(void)
+{
+    if (_map) {
+        _indexFile.unmap(_map);
+        _map = nullptr;
+    }
+    if (_indexFile.isOpen()) {
+        _indexFile.close();
+    }
+    _messageCount = 0;
+    _startTimeUSecs = 0;
+    _endTimeUSecs = 0;
+}
+
+quint64 TlogIndex::_readUInt64(quint64 offset) const
+{
+    return qFromLittleEndian<quint64>(_map + offset);
+}
+
+quint32 TlogIndex::_readUInt32(quint64 offset) const
+{
+    return qFromLittleEndian<quint32>(_map + offset);
+}
+
+quint64 TlogIndex::timestampAt(quint64 messageIndex) const
+{
+    const quint64 blockBase = _blocksOffset + ((messageIndex / _blockSize) * _blockEntrySize);
+    const quint32 timeDelta = _readUInt32(_entriesOffset + (messageIndex * _entrySize));
+
+    if (timeDelta != _timeDeltaOverflow) {
+        return _readUInt64(blockBase) + timeDelta;
+    }
+
+    // Gaps too large for a delta are rare, they live in their own sorted table
+    quint64 low = 0;
+    quint64 high = _overflowCount;
+    while (low < high) {
+        const quint64 mid = low + ((high - low) / 2);
+        const quint64 midIndex = _readUInt64(_overflowOffset + (mid * _overflowEntrySize));
+        if (midIndex == messageIndex) {
+            return _readUInt64(_overflowOffset + (mid * _overflowEntrySize) + 8);
+        } else if (midIndex < messageIndex) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    qCWarning(TlogIndexLog) << "Overflow entry missing for message" << messageIndex;
+    return _readUInt64(blockBase);
+}
+
+qint64 TlogIndex::offsetAt(quint64 messageIndex) const
+{
+    const quint64 blockBase = _blocksOffset + ((messageIndex / _blockSize) * _blockEntrySize);
+    return static_cast<qint64>(_readUInt64(blockBase + 8) + _readUInt32(_entriesOffset + (messageIndex * _entrySize) + 4));
+}
+
+quint64 TlogIndex::indexForTime(quint64 timeUSecs) const
+{
+    if (_messageCount == 0) {
+        return 0;
+    }
+
+    quint64 low = 0;
+    quint64 high = _messageCount;
+    while (low < high) {
+        const quint64 mid = low + ((high - low) / 2);
+        if (timestampAt(mid) < timeUSecs) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return qMin(low, _messageCount - 1);
+}
+
+QList<quint32> TlogIndex::messageIds(void) const
+{
+    QList<quint32> msgIds;
+
+    for (quint64 i=0; i<_directoryCount; i++) {
+        msgIds.append(_readUInt32(_directoryOffset + (i * _directoryEntrySize)));
+    }
+
+    return msgIds;
+}
+
+quint64 TlogIndex::messageCount(quint32 msgId) const
+{
+    const qint64 directoryIndex = _findDirectory(msgId);
+    if (directoryIndex < 0) {
+        return 0;
+    }
+    return _readUInt64(_directoryOffset + (static_cast<quint64>(directoryIndex) * _directoryEntrySize) + 16);
+}
+
+qint64 TlogIndex::nextMessageIndex(quint32 msgId, quint64 fromIndex) const
+{
+    const qint64 directoryIndex = _findDirectory(msgId);
+    if (directoryIndex < 0) {
+        return -1;
+    }
+
+    const quint64 directoryEntry = _directoryOffset + (static_cast<quint64>(directoryIndex) * _directoryEntrySize);
+    const quint64 listStart = _readUInt64(directoryEntry + 8);
+    const quint64 listCount = _readUInt64(directoryEntry + 16);
+    const quint64 position = _listLowerBound(directoryIndex, fromIndex);
+    if (position >= listCount) {
+        return -1;
+    }
+    return _readUInt32(_listsOffset + ((listStart + position) * _listEntrySize));
+}
+
+qint64 TlogIndex::previousMessageIndex(quint32 msgId, quint64 fromIndex) const
+{
+    const qint64 directoryIndex = _findDirectory(msgId);
+    if (directoryIndex < 0) {
+        return -1;
+    }
+
+    const quint64 listStart = _readUInt64(_directoryOffset + (static_cast<quint64>(directoryIndex) * _directoryEntrySize) + 8);
+    const quint64 position = _listLowerBound(directoryIndex, fromIndex);
+    if (position == 0) {
+        return -1;
+    }
+    return _readUInt32(_listsOffset + ((listStart + position - 1) * _listEntrySize));
+}
+
+qint64 TlogIndex::_findDirectory(quint32 msgId) const
+{
+    quint64 low = 0;
+    quint64 high = _directoryCount;
+    while (low < high) {
+        const quint64 mid = low + ((high - low) / 2);
+        const quint32 midMsgId = _readUInt32(_directoryOffset + (mid * _directoryEntrySize));
+        if (midMsgId == msgId) {
+            return static_cast<qint64>(mid);
+        } else if (midMsgId < msgId) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return -1;
+}
+
+quint64 TlogIndex::_listLowerBound(qint64 directoryIndex, quint64 messageIndex) const
+{
+    const quint64 directoryEntry = _directoryOffset + (static_cast<quint64>(directoryIndex) * _directoryEntrySize);
+    const quint64 listStart = _readUInt64(directoryEntry + 8);
+
+    quint64 low = 0;
+    quint64 high = _readUInt64(directoryEntry + 16);
+    while (low < high) {
+        const quint64 mid = low + ((high - low) / 2);
+        if (_readUInt32(_listsOffset + ((listStart + mid) * _listEntrySize)) < messageIndex) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+quint64 TlogIndex::parseTimestamp(const char* bytes, quint64 nowUSecs)
+{
+    quint64 timestamp = qFromBigEndian<quint64>(reinterpret_cast<const uchar*>(bytes));
+
+    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
+    // little endian, so switch it.
+    if (timestamp > nowUSecs) {
+        timestamp = qbswap(timestamp);
+    }
+
+    return timestamp;
+}
+
+QString TlogIndex::indexFilename(const QString& logFilename)
+{
+    QFileInfo logInfo(logFilename);
+    QFileInfo dirInfo(logInfo.absolutePath());
+
+    if (dirInfo.isWritable()) {
+        return logFilename + _indexExtension;
+    }
+    return _cacheIndexFilename(logFilename);
+}
+
+QString TlogIndex::_cacheIndexFilename(const QString& logFilename)
+{
+    QByteArray pathHash = QCryptographicHash::hash(QFileInfo(logFilename).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/TlogIndex/") + QString::fromLatin1(pathHash) + _indexExtension;
+}
+
+bool TlogIndex::build(const QString& logFilename, uint8_t mavlinkChannel, QString& errorString)
+{
+    static const qint64 readChunkSize = 1024 * 1024;
+
+    // Offsets are positions in the uncompressed stream for compressed logs. Staleness is still checked against the
+    // file on disk.
+    QFileInfo                   logInfo(logFilename);
+    QScopedPointer<QIODevice>   logFile(CompressedTlogDevice::openLog(logFilename, errorString));
+    if (!logFile) {
+        return false;
+    }
+
+    const QString indexFilename = TlogIndex::indexFilename(logFilename);
+    QDir().mkpath(QFileInfo(indexFilename).absolutePath());
+
+    // Written under a temporary name such that a partial index is never picked up
+    QFile indexFile(indexFilename + QStringLiteral(".partial"));
+    if (!indexFile.open(QFile::ReadWrite | QFile::Truncate)) {
+        errorString = QObject::tr("Unable to create log index: '%1', error: %2").arg(indexFile.fileName()).arg(indexFile.errorString());
+        return false;
+    }
+
+    // Message ids are spooled to disk, a multi-gigabyte log has too many messages to hold them in memory
+    QTemporaryFile msgIdFile;
+    if (!msgIdFile.open()) {
+        errorString = QObject::tr("Unable to create temporary file, error: %1").arg(msgIdFile.errorString());
+        return false;
+    }
+
+    indexFile.write(QByteArray(static_cast<int>(_headerSize), 0));
+
+    QVector<quint64>        blocks;
+    QVector<quint64>        overflow;
+    QMap<quint32, quint64>  msgIdCounts;
+    QByteArray              entryBuffer;
+    QByteArray              msgIdBuffer;
+
+    quint64 messageCount    = 0;
+    quint64 startTimeUSecs  = 0;
+    quint64 lastTimeUSecs   = 0;
+    quint64 blockTimeUSecs  = 0;
+    qint64  blockOffset     = 0;
+    bool    success         = true;
+
+    mavlink_message_t   message;
+    TlogRecordParser    parser(mavlinkChannel);
+
+    QByteArray chunk;
+    while (success && !(chunk = logFile->read(readChunkSize)).isEmpty()) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(chunk.constData());
+        for (int i=0; i<chunk.count(); i++) {
+            if (!parser.parseByte(bytes[i], &message)) {
+                continue;
+            }
+
+            const qint64  recordOffset      = parser.recordOffset();
+            const quint64 recordTimeUSecs   = parser.timestampUSecs();
+            const quint64 timeUSecs = messageCount == 0 ? recordTimeUSecs : qMax(recordTimeUSecs, lastTimeUSecs);
+            if (messageCount == 0) {
+                startTimeUSecs = timeUSecs;
+            }
+            if (messageCount % _blockSize == 0) {
+                blockTimeUSecs = timeUSecs;
+                blockOffset = recordOffset;
+                blocks.append(blockTimeUSecs);
+                blocks.append(static_cast<quint64>(blockOffset));
+            }
+
+            quint32 timeDelta = _timeDeltaOverflow;
+            if (timeUSecs - blockTimeUSecs < _timeDeltaOverflow) {
+                timeDelta = static_cast<quint32>(timeUSecs - blockTimeUSecs);
+            } else {
+                overflow.append(messageCount);
+                overflow.append(timeUSecs);
+            }
+            if (recordOffset - blockOffset > 0xFFFFFFFFLL || messageCount >= 0xFFFFFFFFULL) {
+                errorString = QObject::tr("The log file '%1' is too large or corrupt to index.").arg(logFilename);
+                success = false;
+                break;
+            }
+
+            uchar entry[_entrySize];
+            qToLittleEndian<quint32>(timeDelta, entry);
+            qToLittleEndian<quint32>(static_cast<quint32>(recordOffset - blockOffset), entry + 4);
+            entryBuffer.append(reinterpret_cast<const char*>(entry), sizeof(entry));
+
+            uchar msgId[_listEntrySize];
+            qToLittleEndian<quint32>(message.msgid, msgId);
+            msgIdBuffer.append(reinterpret_cast<const char*>(msgId), sizeof(msgId));
+            msgIdCounts[message.msgid]++;
+
+            messageCount++;
+            lastTimeUSecs = timeUSecs;
+        }
+
+        if (entryBuffer.count() >= readChunkSize) {
+            success &= indexFile.write(entryBuffer) == entryBuffer.count();
+            success &= msgIdFile.write(msgIdBuffer) == msgIdBuffer.count();
+            entryBuffer.clear();
+            msgIdBuffer.clear();
+        }
+    }
+    success &= indexFile.write(entryBuffer) == entryBuffer.count();
+    success &= msgIdFile.write(msgIdBuffer) == msgIdBuffer.count();
+
+    if (success && messageCount == 0) {
+        errorString = QObject::tr("The log file '%1' is corrupt or empty.").arg(logFilename);
+        success = false;
+    }
+
+    const quint64 blocksOffset      = _headerSize + (messageCount * _entrySize);
+    const quint64 overflowOffset    = blocksOffset + (static_cast<quint64>(blocks.count() / 2) * _blockEntrySize);
+    const quint64 directoryOffset   = overflowOffset + (static_cast<quint64>(overflow.count() / 2) * _overflowEntrySize);
+    const quint64 listsOffset       = directoryOffset + (static_cast<quint64>(msgIdCounts.count()) * _directoryEntrySize);
+
+    if (success) {
+        QByteArray tables;
+        uchar value[sizeof(quint64)];
+
+        for (quint64 blockValue: blocks) {
+            qToLittleEndian<quint64>(blockValue, value);
+            tables.append(reinterpret_cast<const char*>(value), sizeof(quint64));
+        }
+        for (quint64 overflowValue: overflow) {
+            qToLittleEndian<quint64>(overflowValue, value);
+            tables.append(reinterpret_cast<const char*>(value), sizeof(quint64));
+        }
+
+        QHash<quint32, quint64> listCursors;
+        quint64 listStart = 0;
+        for (auto iter = msgIdCounts.constBegin(); iter != msgIdCounts.constEnd(); iter++) {
+            uchar directoryEntry[_directoryEntrySize] = {};
+            qToLittleEndian<quint32>(iter.key(), directoryEntry);
+            qToLittleEndian<quint64>(listStart, directoryEntry + 8);
+            qToLittleEndian<quint64>(iter.value(), directoryEntry + 16);
+            tables.append(reinterpret_cast<const char*>(directoryEntry), sizeof(directoryEntry));
+
+            listCursors[iter.key()] = listStart;
+            listStart += iter.value();
+        }
+        success = indexFile.write(tables) == tables.count();
+
+        // Per message id lists are filled in by scattering the spooled message ids into the mapped list section
+        uchar* lists = nullptr;
+        if (success && indexFile.resize(static_cast<qint64>(listsOffset + (messageCount * _listEntrySize)))) {
+            lists = indexFile.map(static_cast<qint64>(listsOffset), static_cast<qint64>(messageCount * _listEntrySize));
+        }
+        if (lists) {
+            msgIdFile.seek(0);
+            quint64 messageIndex = 0;
+            while (!(chunk = msgIdFile.read(readChunkSize)).isEmpty()) {
+                const uchar* msgIds = reinterpret_cast<const uchar*>(chunk.constData());
+                for (int i=0; i<chunk.count(); i+=static_cast<int>(_listEntrySize), messageIndex++) {
+                    quint64& cursor = listCursors[qFromLittleEndian<quint32>(msgIds + i)];
+                    qToLittleEndian<quint32>(static_cast<quint32>(messageIndex), lists + (cursor++ * _listEntrySize));
+                }
+            }
+            indexFile.unmap(lists);
+        } else if (success) {
+            errorString = QObject::tr("Unable to write log index: '%1', error: %2").arg(indexFile.fileName()).arg(indexFile.errorString());
+            success = false;
+        }
+    } else if (errorString.isEmpty()) {
+        errorString = QObject::tr("Unable to write log index: '%1', error: %2").arg(indexFile.fileName()).arg(indexFile.errorString());
+    }
+
+    if (success) {
+        uchar header[_headerSize] = {};
+        memcpy(header, _magic, 8);
+        qToLittleEndian<quint32>(_version,                                                  header + 8);
+        qToLittleEndian<quint32>(static_cast<quint32>(_blockSize),                          header + 12);
+        qToLittleEndian<quint64>(static_cast<quint64>(logInfo.size()),                      header + 16);
+        qToLittleEndian<quint64>(static_cast<quint64>(logInfo.lastModified().toMSecsSinceEpoch()), header + 24);
+        qToLittleEndian<quint64>(messageCount,                                              header + 32);
+        qToLittleEndian<quint64>(startTimeUSecs,                                            header + 40);
+        qToLittleEndian<quint64>(lastTimeUSecs,                                             header + 48);
+        qToLittleEndian<quint64>(_headerSize,                                               header + 56);
+        qToLittleEndian<quint64>(blocksOffset,                                              header + 64);
+        qToLittleEndian<quint64>(overflowOffset,                                            header + 72);
+        qToLittleEndian<quint64>(static_cast<quint64>(overflow.count() / 2),                header + 80);
+        qToLittleEndian<quint64>(directoryOffset,                                           header + 88);
+        qToLittleEndian<quint64>(static_cast<quint64>(msgIdCounts.count()),                 header + 96);
+        qToLittleEndian<quint64>(listsOffset,                                               header + 104);
+
+        success = indexFile.seek(0) && indexFile.write(reinterpret_cast<const char*>(header), sizeof(header)) == sizeof(header);
+        success &= indexFile.flush();
+    }
+    indexFile.close();
+
+    if (success) {
+        QFile::remove(indexFilename);
+        success = indexFile.rename(indexFilename);
+        if (!success) {
+            errorString = QObject::tr("Unable to write log index: '%1', error: %2").arg(indexFilename).arg(indexFile.errorString());
+        }
+    }
+    if (!success) {
+        indexFile.remove();
+        qCWarning(TlogIndexLog) << "Index build failed" << errorString;
+        return false;
+    }
+
+    qCDebug(TlogIndexLog) << "Built index" << indexFilename << "messages" << messageCount << "msgIds" << msgIdCounts.count();
+    return true;
+}
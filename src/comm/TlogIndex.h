@@ -0,0 +1,235 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QList>
+#include <QLoggingCategory>
+
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TlogIndexLog)
+
+/// Splits a tlog byte stream into records. A record is an 8 byte timestamp followed by bytes up to the next complete
+/// mavlink message, which is the way LogReplayLink has always read logs. Bytes which do not parse are absorbed into
+/// the record they appear in.
+class TlogRecordParser
+{
+public:
+    /// @param mavlinkChannel Channel used for parsing, must be reserved by the caller while the parser is in use
+    TlogRecordParser(uint8_t mavlinkChannel);
+
+    /// Feeds the next byte of the log
+    /// @return true: byte completed a record, message, timestampUSecs and recordOffset describe it
+    bool parseByte(uint8_t byte, mavlink_message_t* message)
+    {
+        _position++;
+        if (_timestampCount < _cbTimestamp) {
+            _timestampBytes[_timestampCount++] = static_cast<char>(byte);
+            return false;
+        }
+        if (!mavlink_parse_char(_mavlinkChannel, byte, message, &_status)) {
+            return false;
+        }
+        _recordOffset = _nextRecordOffset;
+        _nextRecordOffset = _position;
+        _timestampCount = 0;
+        return true;
+    }
+
+    /// @return Timestamp of the last completed record, see TlogIndex::parseTimestamp
+    quint64 timestampUSecs(void) const;
+
+    /// @return File offset of the last completed record
+    qint64 recordOffset(void) const { return _recordOffset; }
+
+private:
+    static const int _cbTimestamp = sizeof(quint64);
+
+    uint8_t             _mavlinkChannel;
+    quint64             _nowUSecs;          ///< Time the parser was created, see TlogIndex::parseTimestamp
+    mavlink_status_t    _status;
+    char                _timestampBytes[_cbTimestamp];
+    int                 _timestampCount;
+    qint64              _position;
+    qint64              _recordOffset;
+    qint64              _nextRecordOffset;
+};
+
+/// Frames tlog records the same way TlogRecordParser does, but with its own parse state instead of a mavlink channel so
+/// that any number of logs, or pieces of one log, can be decoded at the same time. An unsynced parser frames raw bytes
+/// until it finds its first packet and from then on expects a timestamp in front of every packet. Use an unsynced
+/// parser when starting somewhere in the middle of a log.
+class TlogChunkParser
+{
+public:
+    TlogChunkParser(bool synced)
+        : _synced           (synced)
+        , _timestampCount   (0)
+        , _timestampValid   (false)
+    {
+        memset(&_rxMessage, 0, sizeof(_rxMessage));
+        memset(&_status, 0, sizeof(_status));
+        memset(&_returnStatus, 0, sizeof(_returnStatus));
+    }
+
+    /// @return true: byte completed a packet
+    bool parseByte(uint8_t byte, mavlink_message_t* message)
+    {
+        if (_synced && _timestampCount < _cbTimestamp) {
+            _timestampBytes[_timestampCount++] = static_cast<char>(byte);
+            return false;
+        }
+
+        uint8_t framing = mavlink_frame_char_buffer(&_rxMessage, &_status, byte, message, &_returnStatus);
+        if (framing == MAVLINK_FRAMING_BAD_CRC || framing == MAVLINK_FRAMING_BAD_SIGNATURE) {
+            // Same recovery as mavlink_parse_char
+            _status.msg_received = MAVLINK_FRAMING_INCOMPLETE;
+            _status.parse_state = MAVLINK_PARSE_STATE_IDLE;
+            if (byte == MAVLINK_STX) {
+                _status.parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+                _rxMessage.len = 0;
+                mavlink_start_checksum(&_rxMessage);
+            }
+            return false;
+        }
+        if (framing != MAVLINK_FRAMING_OK) {
+            return false;
+        }
+
+        _timestampValid = _synced;
+        _synced = true;
+        _timestampCount = 0;
+        return true;
+    }
+
+    /// @return true: timestamp() holds the timestamp for the last packet. Not the case for the first packet found by an
+    ///                 unsynced parser.
+    bool        timestampValid  (void) const { return _timestampValid; }
+    const char* timestamp       (void) const { return _timestampBytes; }
+
+private:
+    static const int _cbTimestamp = sizeof(quint64);
+
+    bool                _synced;
+    mavlink_message_t   _rxMessage;
+    mavlink_status_t    _status;
+    mavlink_status_t    _returnStatus;
+    char                _timestampBytes[_cbTimestamp];
+    int                 _timestampCount;
+    bool                _timestampValid;
+};
+
+/// Memory mapped sidecar index for a telemetry log (tlog). The index maps every mavlink message in the log to its
+/// timestamp and file offset, plus keeps a sorted list of message indices for each message id. Seeking by time or to
+/// the next message with a given id is a binary search in the mapped file instead of a scan of the log.
+///
+/// The index is built once with a single pass over the log and stored next to it (or in the cache directory if the
+/// log directory is not writable). It is rebuilt automatically if the log size or modification time changes.
+///
+/// Timestamps in the index are made monotonic (a timestamp which goes backwards is clamped to the previous one) such
+/// that binary search is well defined. File offsets point to the start of the tlog record, which is the 8 byte
+/// timestamp preceding the message.
+///
+/// File layout, all values little endian:
+///     header
+///     entries     8 bytes per message: time delta from block base (usecs), offset delta from block base
+///     blocks      16 bytes per _blockSize messages: base timestamp, base offset
+///     overflow    16 bytes per message whose time delta does not fit in 32 bits: message index, timestamp
+///     directory   24 bytes per message id: msgid, list start, list count
+///     lists       4 bytes per message: message index, grouped by message id
+class TlogIndex
+{
+public:
+    TlogIndex(void);
+    ~TlogIndex();
+
+    /// Opens and maps the index for the specified log. Fails if the index does not exist or is out of date.
+    bool open(const QString& logFilename);
+
+    void close(void);
+
+    bool isValid(void) const { return _map != nullptr; }
+
+    quint64 messageCount    (void) const { return _messageCount; }
+    quint64 startTimeUSecs  (void) const { return _startTimeUSecs; }
+    quint64 endTimeUSecs    (void) const { return _endTimeUSecs; }
+
+    /// @return Monotonic timestamp for the specified message
+    quint64 timestampAt(quint64 messageIndex) const;
+
+    /// @return File offset of the tlog record for the specified message
+    qint64 offsetAt(quint64 messageIndex) const;
+
+    /// @return Index of the first message at or after the specified time, clamped to the last message
+    quint64 indexForTime(quint64 timeUSecs) const;
+
+    /// @return All message ids present in the log, sorted
+    QList<quint32> messageIds(void) const;
+
+    /// @return Number of messages with the specified id
+    quint64 messageCount(quint32 msgId) const;
+
+    /// @return Index of the first message with the specified id at or after fromIndex, -1 if there is none
+    qint64 nextMessageIndex(quint32 msgId, quint64 fromIndex) const;
+
+    /// @return Index of the last message with the specified id before fromIndex, -1 if there is none
+    qint64 previousMessageIndex(quint32 msgId, quint64 fromIndex) const;
+
+    /// Builds the index for the specified log, replacing any existing index. Can be called from any thread.
+    ///     @param mavlinkChannel Channel used for parsing, must be reserved by the caller for the duration of the call
+    /// @return false: build failed, errorString is set
+    static bool build(const QString& logFilename, uint8_t mavlinkChannel, QString& errorString);
+
+    /// @return Location of the index for the specified log
+    static QString indexFilename(const QString& logFilename);
+
+    /// Parses a tlog record timestamp. Timestamps in the future are assumed to come from old little endian logs.
+    ///     @param nowUSecs Current time, read once by the caller and reused for every record of a log
+    /// @return Unix timestamp in microseconds
+    static quint64 parseTimestamp(const char* bytes, quint64 nowUSecs);
+
+    static const int cbTimestamp = sizeof(quint64);
+
+private:
+    quint64 _readUInt64     (quint64 offset) const;
+    quint32 _readUInt32     (quint64 offset) const;
+    qint64  _findDirectory  (quint32 msgId) const;
+    quint64 _listLowerBound (qint64 directoryIndex, quint64 messageIndex) const;
+
+    static QString _cacheIndexFilename(const QString& logFilename);
+
+    QFile   _indexFile;
+    uchar*  _map;
+
+    quint64 _messageCount;
+    quint64 _startTimeUSecs;
+    quint64 _endTimeUSecs;
+    quint64 _entriesOffset;
+    quint64 _blocksOffset;
+    quint64 _blockCount;
+    quint64 _overflowOffset;
+    quint64 _overflowCount;
+    quint64 _directoryOffset;
+    quint64 _directoryCount;
+    quint64 _listsOffset;
+
+    static const char*      _magic;
+    static const quint32    _version            = 1;
+    static const quint64    _headerSize         = 112;
+    static const quint64    _blockSize          = 64;
+    static const quint64    _entrySize          = 8;
+    static const quint64    _blockEntrySize     = 16;
+    static const quint64    _overflowEntrySize  = 16;
+    static const quint64    _directoryEntrySize = 24;
+    static const quint64    _listEntrySize      = 4;
+    static const quint32    _timeDeltaOverflow  = 0xFFFFFFFF;
+    static const char*      _indexExtension;
+};
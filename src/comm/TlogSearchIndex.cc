@@ -0,0 +1,707 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogSearchIndex.h"
+#include "TlogIndex.h"
+#include "CompressedTlogDevice.h"
+#include "AppSettings.h"
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+#include "QGC.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QFuture>
+#include <QScopedPointer>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtSql/QSqlQuery>
+#include <QSqlError>
+
+QGC_LOGGING_CATEGORY(TlogSearchIndexLog, "TlogSearchIndexLog")
+
+/// SQLite connections can only be used from the thread which opened them. Every query and every indexing run opens
+/// its own connection under a unique name and removes it again on the same thread when it goes out of scope.
+class TlogSearchConnection
+{
+public:
+    TlogSearchConnection(const QString& databasePath)
+        : _connectionName(QStringLiteral("TlogSearchIndex_%1").arg(_nextConnectionId++))
+    {
+        _database = QSqlDatabase::addDatabase("QSQLITE", _connectionName);
+        _database.setDatabaseName(databasePath);
+        _database.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+        if (!_database.open()) {
+            qCWarning(TlogSearchIndexLog) << "Search index SQL error (open db):" << _database.lastError().text();
+        }
+    }
+
+    ~TlogSearchConnection()
+    {
+        // removeDatabase requires all references to the connection to be gone
+        _database.close();
+        _database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(_connectionName);
+    }
+
+    QSqlDatabase& database(void) { return _database; }
+
+private:
+    QString                         _connectionName;
+    QSqlDatabase                    _database;
+    static std::atomic<quint64>     _nextConnectionId;
+};
+
+std::atomic<quint64> TlogSearchConnection::_nextConnectionId(0);
+
+// Fields whose range is tracked, values are stored in SI units
+enum {
+    FieldGroundSpeed,
+    FieldAirSpeed,
+    FieldAltitude,
+    FieldClimbRate,
+    FieldRelativeAltitude,
+    FieldBatteryVoltage,
+    FieldBatteryRemaining,
+    FieldSatellitesVisible,
+    FieldCount
+};
+
+static const char* _rgFieldNames[FieldCount] = {
+    "VFR_HUD.groundspeed",                  // m/s
+    "VFR_HUD.airspeed",                     // m/s
+    "VFR_HUD.alt",                          // m
+    "VFR_HUD.climb",                        // m/s
+    "GLOBAL_POSITION_INT.relative_alt",     // m
+    "SYS_STATUS.voltage_battery",           // V
+    "SYS_STATUS.battery_remaining",         // %
+    "GPS_RAW_INT.satellites_visible",
+};
+
+TlogSearchIndex::TlogSearchIndex(const QString& databasePath, QObject* parent)
+    : QThread           (parent)
+    , _databasePath     (databasePath)
+    , _valid            (false)
+    , _cancelRequested  (false)
+{
+    setObjectName(QStringLiteral("TlogSearchIndex"));
+
+    QDir().mkpath(QFileInfo(_databasePath).absolutePath());
+    TlogSearchConnection connection(_databasePath);
+    QSqlDatabase& db = connection.database();
+    if (db.isOpen()) {
+        // Readers are not blocked by the indexer writing. The journal mode is stored in the database file.
+        QSqlQuery query(db);
+        query.exec("PRAGMA journal_mode=WAL");
+    }
+    _valid = db.isOpen() && _createTables(db);
+}
+
+TlogSearchIndex::~TlogSearchIndex()
+{
+    _cancelRequested = true;
+    wait();
+}
+
+QString TlogSearchIndex::defaultDatabasePath(void)
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).absoluteFilePath(QStringLiteral("TlogSearchIndex.db"));
+}
+
+QStringList TlogSearchIndex::fieldNames(void)
+{
+    QStringList names;
+    for (int i=0; i<FieldCount; i++) {
+        names.append(_rgFieldNames[i]);
+    }
+    return names;
+}
+
+bool TlogSearchIndex::_createTables(QSqlDatabase& db)
+{
+    static const char* rgCreate[] = {
+        "CREATE TABLE IF NOT EXISTS Logs ("
+            "logID INTEGER PRIMARY KEY NOT NULL, "
+            "path TEXT NOT NULL UNIQUE, "
+            "directory TEXT NOT NULL, "
+            "size INTEGER, "
+            "modified INTEGER, "
+            "startTime INTEGER, "
+            "endTime INTEGER, "
+            "messageCount INTEGER)",
+        "CREATE INDEX IF NOT EXISTS LogsDirectory ON Logs(directory)",
+        "CREATE INDEX IF NOT EXISTS LogsStartTime ON Logs(startTime)",
+        "CREATE TABLE IF NOT EXISTS Vehicles ("
+            "logID INTEGER NOT NULL, "
+            "sysid INTEGER, "
+            "vehicleType INTEGER, "
+            "autopilot INTEGER, "
+            "firstSeen INTEGER, "
+            "lastSeen INTEGER)",
+        "CREATE INDEX IF NOT EXISTS VehiclesLog ON Vehicles(logID)",
+        "CREATE INDEX IF NOT EXISTS VehiclesSysid ON Vehicles(sysid)",
+        "CREATE TABLE IF NOT EXISTS Armings ("
+            "logID INTEGER NOT NULL, "
+            "sysid INTEGER, "
+            "armed INTEGER, "
+            "disarmed INTEGER)",
+        "CREATE INDEX IF NOT EXISTS ArmingsLog ON Armings(logID)",
+        "CREATE INDEX IF NOT EXISTS ArmingsSysid ON Armings(sysid, armed)",
+        "CREATE TABLE IF NOT EXISTS StatusTexts ("
+            "logID INTEGER NOT NULL, "
+            "sysid INTEGER, "
+            "compid INTEGER, "
+            "time INTEGER, "
+            "severity INTEGER, "
+            "text TEXT)",
+        "CREATE INDEX IF NOT EXISTS StatusTextsLog ON StatusTexts(logID)",
+        "CREATE TABLE IF NOT EXISTS FieldRanges ("
+            "logID INTEGER NOT NULL, "
+            "sysid INTEGER, "
+            "field TEXT NOT NULL, "
+            "minValue REAL, "
+            "minTime INTEGER, "
+            "maxValue REAL, "
+            "maxTime INTEGER)",
+        "CREATE INDEX IF NOT EXISTS FieldRangesLog ON FieldRanges(logID)",
+        "CREATE INDEX IF NOT EXISTS FieldRangesMax ON FieldRanges(field, maxValue)",
+        "CREATE INDEX IF NOT EXISTS FieldRangesMin ON FieldRanges(field, minValue)",
+    };
+
+    QSqlQuery query(db);
+    for (const char* create: rgCreate) {
+        if (!query.exec(create)) {
+            qCWarning(TlogSearchIndexLog) << "Search index SQL error (create tables):" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+void TlogSearchIndex::startIndexing(const QString& directory)
+{
+    if (isRunning()) {
+        qWarning() << "TlogSearchIndex::startIndexing called while indexing in progress";
+        return;
+    }
+    _directory = QDir(directory).absolutePath();
+    _cancelRequested = false;
+    start(LowPriority);
+}
+
+void TlogSearchIndex::run(void)
+{
+    typedef struct {
+        qint64 logId;
+        qint64 size;
+        qint64 modifiedMSecs;
+    } IndexedLog_t;
+
+    QString errorString;
+    int     logsIndexed = 0;
+    int     logsRemoved = 0;
+    bool    success     = _valid;
+
+    // The indexer gets its own connection which is dropped again when indexing finishes
+    {
+        TlogSearchConnection connection(_databasePath);
+        QSqlDatabase& db = connection.database();
+        if (!success || !db.isOpen()) {
+            errorString = tr("Unable to open log search index '%1'").arg(_databasePath);
+            success = false;
+        }
+
+        QMap<QString, IndexedLog_t> indexedLogs;
+        if (success) {
+            QSqlQuery query(db);
+            query.prepare("SELECT logID, path, size, modified FROM Logs WHERE directory = ?");
+            query.addBindValue(_directory);
+            if (query.exec()) {
+                while (query.next()) {
+                    indexedLogs[query.value(1).toString()] = { query.value(0).toLongLong(), query.value(2).toLongLong(), query.value(3).toLongLong() };
+                }
+            } else {
+                errorString = query.lastError().text();
+                success = false;
+            }
+        }
+
+        QStringList changedLogs;
+        QStringList logPaths;
+        if (success) {
+            QStringList nameFilters = { QStringLiteral("*.%1").arg(AppSettings::telemetryFileExtension), QStringLiteral("*.%1").arg(AppSettings::telemetryCompressedFileExtension) };
+            for (const QFileInfo& logInfo: QDir(_directory).entryInfoList(nameFilters, QDir::Files, QDir::Name)) {
+                const QString path = logInfo.absoluteFilePath();
+                logPaths.append(path);
+                if (!indexedLogs.contains(path) || indexedLogs[path].size != logInfo.size() || indexedLogs[path].modifiedMSecs != logInfo.lastModified().toMSecsSinceEpoch()) {
+                    changedLogs.append(path);
+                }
+            }
+
+            // Drop logs which are gone
+            for (auto iter = indexedLogs.constBegin(); iter != indexedLogs.constEnd(); iter++) {
+                if (!logPaths.contains(iter.key())) {
+                    db.transaction();
+                    if (_removeLog(db, iter.value().logId)) {
+                        db.commit();
+                        logsRemoved++;
+                    } else {
+                        db.rollback();
+                    }
+                }
+            }
+        }
+
+        // Logs are summarized in parallel and stored in order as they complete
+        QThreadPool                 threadPool;
+        QList<QFuture<Summary_t>>   inFlight;
+        const int                   maxInFlight = threadPool.maxThreadCount() * _logsInFlightPerThread;
+        const std::atomic<bool>*    cancelRequested = &_cancelRequested;
+        int                         nextLog = 0;
+
+        qCDebug(TlogSearchIndexLog) << "Indexing" << _directory << "logs" << logPaths.count() << "changed" << changedLogs.count() << "removed" << logsRemoved;
+
+        for (int i=0; success && i<changedLogs.count(); i++) {
+            while (nextLog < changedLogs.count() && inFlight.count() < maxInFlight) {
+                const QString path = changedLogs[nextLog++];
+                inFlight.append(QtConcurrent::run(&threadPool, [path, cancelRequested]() {
+                    return _summarizeLog(path, cancelRequested);
+                }));
+            }
+
+            Summary_t summary = inFlight.takeFirst().result();
+            if (_cancelRequested) {
+                errorString = tr("Indexing cancelled");
+                success = false;
+                break;
+            }
+
+            db.transaction();
+            bool stored = true;
+            if (indexedLogs.contains(summary.path)) {
+                stored = _removeLog(db, indexedLogs[summary.path].logId);
+            }
+            if (stored && summary.errorString.isEmpty()) {
+                stored = _storeSummary(db, summary);
+            }
+            if (stored) {
+                db.commit();
+                if (summary.errorString.isEmpty()) {
+                    logsIndexed++;
+                }
+            } else {
+                db.rollback();
+                errorString = db.lastError().text();
+                success = false;
+            }
+            if (!summary.errorString.isEmpty()) {
+                // Unreadable logs are skipped, they will be tried again next time
+                qCWarning(TlogSearchIndexLog) << "Unable to index" << summary.path << summary.errorString;
+            }
+
+            emit indexingProgress(logPaths.count() - changedLogs.count() + i + 1, logPaths.count());
+        }
+
+        _cancelRequested = true;
+        threadPool.waitForDone();
+    }
+
+    emit indexingFinished(success, logsIndexed, logsRemoved, errorString);
+}
+
+bool TlogSearchIndex::_removeLog(QSqlDatabase& db, qint64 logId)
+{
+    static const char* rgDelete[] = {
+        "DELETE FROM Vehicles WHERE logID = ?",
+        "DELETE FROM Armings WHERE logID = ?",
+        "DELETE FROM StatusTexts WHERE logID = ?",
+        "DELETE FROM FieldRanges WHERE logID = ?",
+        "DELETE FROM Logs WHERE logID = ?",
+    };
+
+    QSqlQuery query(db);
+    for (const char* deleteStatement: rgDelete) {
+        query.prepare(deleteStatement);
+        query.addBindValue(logId);
+        if (!query.exec()) {
+            qCWarning(TlogSearchIndexLog) << "Search index SQL error (remove log):" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TlogSearchIndex::_storeSummary(QSqlDatabase& db, const Summary_t& summary)
+{
+    QSqlQuery query(db);
+
+    query.prepare("INSERT INTO Logs(path, directory, size, modified, startTime, endTime, messageCount) VALUES(?, ?, ?, ?, ?, ?, ?)");
+    query.addBindValue(summary.path);
+    query.addBindValue(QFileInfo(summary.path).absolutePath());
+    query.addBindValue(summary.size);
+    query.addBindValue(summary.modifiedMSecs);
+    query.addBindValue(static_cast<qint64>(summary.startTimeUSecs));
+    query.addBindValue(static_cast<qint64>(summary.endTimeUSecs));
+    query.addBindValue(static_cast<qint64>(summary.messageCount));
+    if (!query.exec()) {
+        qCWarning(TlogSearchIndexLog) << "Search index SQL error (add log):" << query.lastError().text();
+        return false;
+    }
+    const qint64 logId = query.lastInsertId().toLongLong();
+
+    query.prepare("INSERT INTO Vehicles(logID, sysid, vehicleType, autopilot, firstSeen, lastSeen) VALUES(?, ?, ?, ?, ?, ?)");
+    for (const Vehicle_t& vehicle: summary.vehicles) {
+        query.addBindValue(logId);
+        query.addBindValue(vehicle.systemId);
+        query.addBindValue(vehicle.vehicleType);
+        query.addBindValue(vehicle.autopilot);
+        query.addBindValue(static_cast<qint64>(vehicle.firstSeenUSecs));
+        query.addBindValue(static_cast<qint64>(vehicle.lastSeenUSecs));
+        if (!query.exec()) {
+            qCWarning(TlogSearchIndexLog) << "Search index SQL error (add vehicle):" << query.lastError().text();
+            return false;
+        }
+    }
+
+    query.prepare("INSERT INTO Armings(logID, sysid, armed, disarmed) VALUES(?, ?, ?, ?)");
+    for (const Arming_t& arming: summary.armings) {
+        query.addBindValue(logId);
+        query.addBindValue(arming.systemId);
+        query.addBindValue(static_cast<qint64>(arming.armedUSecs));
+        query.addBindValue(static_cast<qint64>(arming.disarmedUSecs));
+        if (!query.exec()) {
+            qCWarning(TlogSearchIndexLog) << "Search index SQL error (add arming):" << query.lastError().text();
+            return false;
+        }
+    }
+
+    query.prepare("INSERT INTO StatusTexts(logID, sysid, compid, time, severity, text) VALUES(?, ?, ?, ?, ?, ?)");
+    for (const StatusText_t& statusText: summary.statusTexts) {
+        query.addBindValue(logId);
+        query.addBindValue(statusText.systemId);
+        query.addBindValue(statusText.componentId);
+        query.addBindValue(static_cast<qint64>(statusText.timeUSecs));
+        query.addBindValue(statusText.severity);
+        query.addBindValue(statusText.text);
+        if (!query.exec()) {
+            qCWarning(TlogSearchIndexLog) << "Search index SQL error (add statustext):" << query.lastError().text();
+            return false;
+        }
+    }
+
+    query.prepare("INSERT INTO FieldRanges(logID, sysid, field, minValue, minTime, maxValue, maxTime) VALUES(?, ?, ?, ?, ?, ?, ?)");
+    for (const FieldRange_t& fieldRange: summary.fieldRanges) {
+        query.addBindValue(logId);
+        query.addBindValue(fieldRange.systemId);
+        query.addBindValue(fieldRange.field);
+        query.addBindValue(fieldRange.minValue);
+        query.addBindValue(static_cast<qint64>(fieldRange.minTimeUSecs));
+        query.addBindValue(fieldRange.maxValue);
+        query.addBindValue(static_cast<qint64>(fieldRange.maxTimeUSecs));
+        if (!query.exec()) {
+            qCWarning(TlogSearchIndexLog) << "Search index SQL error (add field range):" << query.lastError().text();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Reads a log once and collects everything which goes into the index. Runs on the thread pool.
+TlogSearchIndex::Summary_t TlogSearchIndex::_summarizeLog(const QString& path, const std::atomic<bool>* cancelRequested)
+{
+    static const qint64 readChunkSize = 1024 * 1024;
+
+    typedef struct {
+        Vehicle_t   vehicle;
+        bool        armed;
+        quint64     armedUSecs;
+    } VehicleState_t;
+
+    Summary_t                   summary;
+    QFileInfo                   logInfo(path);
+    QMap<int, VehicleState_t>   vehicleStates;
+    QMap<int, FieldRange_t>     fieldRanges;        ///< Key is (sysid << 8) | field
+    TlogChunkParser             parser(true /* synced */);
+    const quint64               nowUSecs = QGC::groundTimeUsecs();
+    mavlink_message_t           message;
+    QByteArray                  chunk;
+
+    summary.path            = path;
+    summary.size            = logInfo.size();
+    summary.modifiedMSecs   = logInfo.lastModified().toMSecsSinceEpoch();
+    summary.startTimeUSecs  = 0;
+    summary.endTimeUSecs    = 0;
+    summary.messageCount    = 0;
+
+    QScopedPointer<QIODevice> device(CompressedTlogDevice::openLog(path, summary.errorString));
+    if (!device) {
+        return summary;
+    }
+
+    auto updateRange = [&](int systemId, int field, double value, quint64 timeUSecs) {
+        const int key = (systemId << 8) | field;
+        auto iter = fieldRanges.find(key);
+        if (iter == fieldRanges.end()) {
+            fieldRanges[key] = { path, systemId, _rgFieldNames[field], value, timeUSecs, value, timeUSecs };
+            return;
+        }
+        if (value < iter->minValue) {
+            iter->minValue = value;
+            iter->minTimeUSecs = timeUSecs;
+        }
+        if (value > iter->maxValue) {
+            iter->maxValue = value;
+            iter->maxTimeUSecs = timeUSecs;
+        }
+    };
+
+    while (!(chunk = device->read(readChunkSize)).isEmpty()) {
+        if (*cancelRequested) {
+            return summary;
+        }
+
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(chunk.constData());
+        for (int i=0; i<chunk.size(); i++) {
+            if (!parser.parseByte(data[i], &message)) {
+                continue;
+            }
+
+            const quint64 timeUSecs = TlogIndex::parseTimestamp(parser.timestamp(), nowUSecs);
+            if (summary.messageCount++ == 0) {
+                summary.startTimeUSecs = timeUSecs;
+            }
+            summary.endTimeUSecs = qMax(summary.endTimeUSecs, timeUSecs);
+
+            switch (message.msgid) {
+            case MAVLINK_MSG_ID_HEARTBEAT:
+            {
+                mavlink_heartbeat_t heartbeat;
+                mavlink_msg_heartbeat_decode(&message, &heartbeat);
+                if (heartbeat.type == MAV_TYPE_GCS || heartbeat.autopilot == MAV_AUTOPILOT_INVALID) {
+                    break;
+                }
+
+                if (!vehicleStates.contains(message.sysid)) {
+                    vehicleStates[message.sysid] = { { path, message.sysid, heartbeat.type, heartbeat.autopilot, timeUSecs, timeUSecs }, false, 0 };
+                }
+                VehicleState_t& vehicleState = vehicleStates[message.sysid];
+                vehicleState.vehicle.lastSeenUSecs = timeUSecs;
+
+                const bool armed = heartbeat.base_mode & MAV_MODE_FLAG_SAFETY_ARMED;
+                if (armed && !vehicleState.armed) {
+                    vehicleState.armedUSecs = timeUSecs;
+                } else if (!armed && vehicleState.armed) {
+                    summary.armings.append({ path, message.sysid, vehicleState.armedUSecs, timeUSecs });
+                }
+                vehicleState.armed = armed;
+                break;
+            }
+            case MAVLINK_MSG_ID_STATUSTEXT:
+            {
+                mavlink_statustext_t statusText;
+                mavlink_msg_statustext_decode(&message, &statusText);
+                QString text = QString::fromUtf8(statusText.text, static_cast<int>(qstrnlen(statusText.text, sizeof(statusText.text))));
+                summary.statusTexts.append({ path, message.sysid, message.compid, timeUSecs, statusText.severity, text });
+                break;
+            }
+            case MAVLINK_MSG_ID_VFR_HUD:
+            {
+                mavlink_vfr_hud_t vfrHud;
+                mavlink_msg_vfr_hud_decode(&message, &vfrHud);
+                updateRange(message.sysid, FieldGroundSpeed,    static_cast<double>(vfrHud.groundspeed),    timeUSecs);
+                updateRange(message.sysid, FieldAirSpeed,       static_cast<double>(vfrHud.airspeed),       timeUSecs);
+                updateRange(message.sysid, FieldAltitude,       static_cast<double>(vfrHud.alt),            timeUSecs);
+                updateRange(message.sysid, FieldClimbRate,      static_cast<double>(vfrHud.climb),          timeUSecs);
+                break;
+            }
+            case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+                updateRange(message.sysid, FieldRelativeAltitude, mavlink_msg_global_position_int_get_relative_alt(&message) / 1000.0, timeUSecs);
+                break;
+            case MAVLINK_MSG_ID_SYS_STATUS:
+            {
+                mavlink_sys_status_t sysStatus;
+                mavlink_msg_sys_status_decode(&message, &sysStatus);
+                if (sysStatus.voltage_battery != UINT16_MAX) {
+                    updateRange(message.sysid, FieldBatteryVoltage, sysStatus.voltage_battery / 1000.0, timeUSecs);
+                }
+                if (sysStatus.battery_remaining != -1) {
+                    updateRange(message.sysid, FieldBatteryRemaining, sysStatus.battery_remaining, timeUSecs);
+                }
+                break;
+            }
+            case MAVLINK_MSG_ID_GPS_RAW_INT:
+            {
+                uint8_t satellitesVisible = mavlink_msg_gps_raw_int_get_satellites_visible(&message);
+                if (satellitesVisible != UINT8_MAX) {
+                    updateRange(message.sysid, FieldSatellitesVisible, satellitesVisible, timeUSecs);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+
+    for (const VehicleState_t& vehicleState: vehicleStates) {
+        summary.vehicles.append(vehicleState.vehicle);
+        if (vehicleState.armed) {
+            summary.armings.append({ path, vehicleState.vehicle.systemId, vehicleState.armedUSecs, 0 });
+        }
+    }
+    summary.fieldRanges = fieldRanges.values();
+
+    return summary;
+}
+
+QList<TlogSearchIndex::Log_t> TlogSearchIndex::logs(void)
+{
+    QList<Log_t> results;
+
+    TlogSearchConnection connection(_databasePath);
+    QSqlQuery query(connection.database());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT path, size, startTime, endTime, messageCount FROM Logs ORDER BY startTime DESC")) {
+        qCWarning(TlogSearchIndexLog) << "Search index SQL error (logs):" << query.lastError().text();
+        return results;
+    }
+    while (query.next()) {
+        results.append({ query.value(0).toString(), query.value(1).toLongLong(), query.value(2).toULongLong(), query.value(3).toULongLong(), query.value(4).toULongLong() });
+    }
+    return results;
+}
+
+QList<TlogSearchIndex::Vehicle_t> TlogSearchIndex::vehicles(int systemId)
+{
+    QList<Vehicle_t> results;
+
+    TlogSearchConnection connection(_databasePath);
+    QSqlQuery query(connection.database());
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral("SELECT Logs.path, v.sysid, v.vehicleType, v.autopilot, v.firstSeen, v.lastSeen "
+                                 "FROM Vehicles v JOIN Logs ON Logs.logID = v.logID %1 "
+                                 "ORDER BY Logs.startTime DESC, v.firstSeen").arg(systemId == -1 ? QString() : QStringLiteral("WHERE v.sysid = ?")));
+    if (systemId != -1) {
+        query.addBindValue(systemId);
+    }
+    if (!query.exec()) {
+        qCWarning(TlogSearchIndexLog) << "Search index SQL error (vehicles):" << query.lastError().text();
+        return results;
+    }
+    while (query.next()) {
+        results.append({ query.value(0).toString(), query.value(1).toInt(), query.value(2).toInt(), query.value(3).toInt(), query.value(4).toULongLong(), query.value(5).toULongLong() });
+    }
+    return results;
+}
+
+QList<TlogSearchIndex::Arming_t> TlogSearchIndex::armingIntervals(int systemId)
+{
+    QList<Arming_t> results;
+
+    TlogSearchConnection connection(_databasePath);
+    QSqlQuery query(connection.database());
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral("SELECT Logs.path, a.sysid, a.armed, a.disarmed "
+                                 "FROM Armings a JOIN Logs ON Logs.logID = a.logID %1 "
+                                 "ORDER BY Logs.startTime DESC, a.armed").arg(systemId == -1 ? QString() : QStringLiteral("WHERE a.sysid = ?")));
+    if (systemId != -1) {
+        query.addBindValue(systemId);
+    }
+    if (!query.exec()) {
+        qCWarning(TlogSearchIndexLog) << "Search index SQL error (armings):" << query.lastError().text();
+        return results;
+    }
+    while (query.next()) {
+        results.append({ query.value(0).toString(), query.value(1).toInt(), query.value(2).toULongLong(), query.value(3).toULongLong() });
+    }
+    return results;
+}
+
+QList<TlogSearchIndex::StatusText_t> TlogSearchIndex::findStatusText(const QString& text, int systemId)
+{
+    QList<StatusText_t> results;
+
+    QString pattern = text;
+    pattern.replace(QStringLiteral("\\"), QStringLiteral("\\\\")).replace(QStringLiteral("%"), QStringLiteral("\\%")).replace(QStringLiteral("_"), QStringLiteral("\\_"));
+
+    TlogSearchConnection connection(_databasePath);
+    QSqlQuery query(connection.database());
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral("SELECT Logs.path, s.sysid, s.compid, s.time, s.severity, s.text "
+                                 "FROM StatusTexts s JOIN Logs ON Logs.logID = s.logID "
+                                 "WHERE s.text LIKE ? ESCAPE '\\' %1 "
+                                 "ORDER BY Logs.startTime DESC, s.time").arg(systemId == -1 ? QString() : QStringLiteral("AND s.sysid = ?")));
+    query.addBindValue(QStringLiteral("%%1%").arg(pattern));
+    if (systemId != -1) {
+        query.addBindValue(systemId);
+    }
+    if (!query.exec()) {
+        qCWarning(TlogSearchIndexLog) << "Search index SQL error (statustext):" << query.lastError().text();
+        return results;
+    }
+    while (query.next()) {
+        results.append({ query.value(0).toString(), query.value(1).toInt(), query.value(2).toInt(), query.value(3).toULongLong(), query.value(4).toInt(), query.value(5).toString() });
+    }
+    return results;
+}
+
+QList<TlogSearchIndex::FieldRange_t> TlogSearchIndex::findFieldAbove(const QString& field, double threshold, int systemId)
+{
+    QVariantList bindValues = { field, threshold };
+    QString where = QStringLiteral("f.field = ? AND f.maxValue > ?");
+    if (systemId != -1) {
+        where += QStringLiteral(" AND f.sysid = ?");
+        bindValues.append(systemId);
+    }
+    return _fieldRangeQuery(where, bindValues);
+}
+
+QList<TlogSearchIndex::FieldRange_t> TlogSearchIndex::findFieldBelow(const QString& field, double threshold, int systemId)
+{
+    QVariantList bindValues = { field, threshold };
+    QString where = QStringLiteral("f.field = ? AND f.minValue < ?");
+    if (systemId != -1) {
+        where += QStringLiteral(" AND f.sysid = ?");
+        bindValues.append(systemId);
+    }
+    return _fieldRangeQuery(where, bindValues);
+}
+
+QList<TlogSearchIndex::FieldRange_t> TlogSearchIndex::fieldRanges(const QString& path)
+{
+    return _fieldRangeQuery(QStringLiteral("Logs.path = ?"), { QFileInfo(path).absoluteFilePath() });
+}
+
+QList<TlogSearchIndex::FieldRange_t> TlogSearchIndex::_fieldRangeQuery(const QString& where, const QVariantList& bindValues)
+{
+    QList<FieldRange_t> results;
+
+    TlogSearchConnection connection(_databasePath);
+    QSqlQuery query(connection.database());
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral("SELECT Logs.path, f.sysid, f.field, f.minValue, f.minTime, f.maxValue, f.maxTime "
+                                 "FROM FieldRanges f JOIN Logs ON Logs.logID = f.logID "
+                                 "WHERE %1 "
+                                 "ORDER BY Logs.startTime DESC, f.field, f.sysid").arg(where));
+    for (const QVariant& bindValue: bindValues) {
+        query.addBindValue(bindValue);
+    }
+    if (!query.exec()) {
+        qCWarning(TlogSearchIndexLog) << "Search index SQL error (field ranges):" << query.lastError().text();
+        return results;
+    }
+    while (query.next()) {
+        results.append({ query.value(0).toString(), query.value(1).toInt(), query.value(2).toString(),
+                         query.value(3).toDouble(), query.value(4).toULongLong(), query.value(5).toDouble(), query.value(6).toULongLong() });
+    }
+    return results;
+}
@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QStringList>
+#include <QLoggingCategory>
+#include <QtSql/QSqlDatabase>
+
+#include <atomic>
+
+Q_DECLARE_LOGGING_CATEGORY(TlogSearchIndexLog)
+
+/// Searchable summary of every telemetry log in a directory, kept in a local SQLite database.
+///
+/// Indexing reads each log once and stores a summary: the vehicles seen, arming intervals, every STATUSTEXT and the
+/// min/max (and when they happened) of a set of key fields such as ground speed and altitude. Indexing is incremental,
+/// a log is only read again if its size or modification time changed and logs which were deleted are dropped from the
+/// index. Logs are summarized in parallel, the database is only written from the indexing thread.
+///
+/// Queries only touch the database, never the logs, so they stay fast no matter how many logs are indexed. Queries can
+/// be made from any thread, including while indexing is in progress.
+class TlogSearchIndex : public QThread
+{
+    Q_OBJECT
+
+public:
+    /// @param databasePath SQLite database file, created if it does not exist
+    TlogSearchIndex(const QString& databasePath, QObject* parent = nullptr);
+    ~TlogSearchIndex();
+
+    typedef struct {
+        QString path;
+        qint64  size;
+        quint64 startTimeUSecs;
+        quint64 endTimeUSecs;
+        quint64 messageCount;
+    } Log_t;
+
+    typedef struct {
+        QString path;
+        int     systemId;
+        int     vehicleType;        ///< MAV_TYPE
+        int     autopilot;          ///< MAV_AUTOPILOT
+        quint64 firstSeenUSecs;
+        quint64 lastSeenUSecs;
+    } Vehicle_t;
+
+    typedef struct {
+        QString path;
+        int     systemId;
+        quint64 armedUSecs;
+        quint64 disarmedUSecs;      ///< 0 if the vehicle was still armed at the end of the log
+    } Arming_t;
+
+    typedef struct {
+        QString path;
+        int     systemId;
+        int     componentId;
+        quint64 timeUSecs;
+        int     severity;           ///< MAV_SEVERITY
+        QString text;
+    } StatusText_t;
+
+    typedef struct {
+        QString path;
+        int     systemId;
+        QString field;
+        double  minValue;
+        quint64 minTimeUSecs;
+        double  maxValue;
+        quint64 maxTimeUSecs;
+    } FieldRange_t;
+
+    /// Starts an incremental index of all telemetry logs (tlog and compressed tlog) in the specified directory. Logs
+    /// indexed from other directories are left alone.
+    void startIndexing(const QString& directory);
+
+    /// Stops indexing which is in progress. Logs which were already indexed stay in the index.
+    void cancel(void) { _cancelRequested = true; }
+
+    bool isValid(void) const { return _valid; }
+
+    // Queries. Results are ordered newest log first, then by time within the log.
+
+    QList<Log_t>        logs                (void);
+    QList<Vehicle_t>    vehicles            (int systemId = -1);
+    QList<Arming_t>     armingIntervals     (int systemId = -1);
+
+    /// @return STATUSTEXT messages containing the specified text, case insensitive
+    QList<StatusText_t> findStatusText      (const QString& text, int systemId = -1);
+
+    /// @return Logs in which the field went above the threshold, with the time of the maximum
+    QList<FieldRange_t> findFieldAbove      (const QString& field, double threshold, int systemId = -1);
+
+    /// @return Logs in which the field went below the threshold, with the time of the minimum
+    QList<FieldRange_t> findFieldBelow      (const QString& field, double threshold, int systemId = -1);
+
+    /// @return All field ranges for the specified log
+    QList<FieldRange_t> fieldRanges         (const QString& path);
+
+    /// @return Names of the fields which are tracked, for example "VFR_HUD.groundspeed"
+    static QStringList fieldNames(void);
+
+    /// @return Location used for the index when no other is specified
+    static QString defaultDatabasePath(void);
+
+    // Overrides from QThread
+    void run(void) override;
+
+signals:
+    void indexingProgress(int logsChecked, int logCount);
+
+    /// @param logsIndexed Number of new or changed logs which were stored in the index, unreadable logs are not counted
+    /// @param logsRemoved Number of logs dropped from the index since they no longer exist
+    void indexingFinished(bool success, int logsIndexed, int logsRemoved, QString errorString);
+
+private:
+    typedef struct {
+        QString                 path;
+        qint64                  size;
+        qint64                  modifiedMSecs;
+        quint64                 startTimeUSecs;
+        quint64                 endTimeUSecs;
+        quint64                 messageCount;
+        QList<Vehicle_t>        vehicles;
+        QList<Arming_t>         armings;
+        QList<StatusText_t>     statusTexts;
+        QList<FieldRange_t>     fieldRanges;
+        QString                 errorString;
+    } Summary_t;
+
+    bool                _createTables       (QSqlDatabase& db);
+    bool                _storeSummary       (QSqlDatabase& db, const Summary_t& summary);
+    bool                _removeLog          (QSqlDatabase& db, qint64 logId);
+    QList<FieldRange_t> _fieldRangeQuery    (const QString& where, const QVariantList& bindValues);
+
+    static Summary_t    _summarizeLog       (const QString& path, const std::atomic<bool>* cancelRequested);
+
+    QString             _databasePath;
+    QString             _directory;
+    bool                _valid;
+    std::atomic<bool>   _cancelRequested;
+
+    static const int    _logsInFlightPerThread = 2;
+};
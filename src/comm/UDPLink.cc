@@ -25,6 +25,12 @@
 #include <iostream>
 #include <QHostInfo>
 
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+#define QGC_UDP_RECVMMSG
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
 #include "UDPLink.h"
 #include "QGC.h"
 #include "QGCApplication.h"
@@ -35,6 +41,10 @@
 
 static const char* kZeroconfRegistration = "_qgroundcontrol._udp";
 
+const int UDPLink::_maxBatchBytes;
+const int UDPLink::_maxDatagramBytes;
+const int UDPLink::_maxBatchDatagrams;
+
 static bool is_ip(const QString& address)
 {
     int a,b,c,d;
@@ -104,6 +114,7 @@ UDPLink::~UDPLink()
     // Clear client list
     qDeleteAll(_sessionTargets);
     _sessionTargets.clear();
+    _sessionTargetMap.clear();
     quit();
     // Wait for it to exit
     wait();
@@ -205,6 +216,10 @@ void UDPLink::readBytes()
     if (!_socket) {
         return;
     }
+    if (_udpConfig->batchedReceive()) {
+        _readBytesBatched();
+        return;
+    }
     QByteArray databuffer;
     while (_socket->hasPendingDatagrams())
     {
@@ -215,25 +230,17 @@ void UDPLink::readBytes()
         //-- Note: This call is broken in Qt 5.9.3 on Windows. It always returns a blank sender and 0 for the port.
         _socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
         databuffer.append(datagram);
+        _logInputDataRate(datagram.length(), QDateTime::currentMSecsSinceEpoch());
         //-- Wait a bit before sending it over
         if(databuffer.size() > 10 * 1024) {
             emit bytesReceived(this, databuffer);
             databuffer.clear();
         }
-        _logInputDataRate(datagram.length(), QDateTime::currentMSecsSinceEpoch());
         // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
         // added to the list and will start receiving datagrams from here. Even a port scanner
         // would trigger this.
         // Add host to broadcast list if not yet present, or update its port
-        QHostAddress asender = sender;
-        if(_isIpLocal(sender)) {
-            asender = QHostAddress(QString("127.0.0.1"));
-        }
-        if(!contains_target(_sessionTargets, asender, senderPort)) {
-            qDebug() << "Adding target" << asender << senderPort;
-            UDPCLient* target = new UDPCLient(asender, senderPort);
-            _sessionTargets.append(target);
-        }
+        _addSessionTarget(sender, senderPort);
     }
     //-- Send whatever is left
     if(databuffer.size()) {
@@ -241,6 +248,146 @@ void UDPLink::readBytes()
     }
 }
 
+/**
+ * @brief High throughput version of readBytes.
+ *
+ * Drains the socket into reusable buffers and emits a single bytesReceived per batch. Data rate
+ * accounting and the time lookup are also done once per batch instead of once per datagram.
+ **/
+void UDPLink::_readBytesBatched()
+{
+    // If the previous batch is still referenced by a queued bytesReceived the buffer detaches here,
+    // otherwise the existing allocation is reused.
+    _batchBuffer.resize(0);
+    _batchBuffer.reserve(_maxBatchBytes + _maxDatagramBytes);
+    if (_datagramBuffer.size() < _maxBatchDatagrams * _maxDatagramBytes) {
+        _datagramBuffer.resize(_maxBatchDatagrams * _maxDatagramBytes);
+    }
+
+    // The first datagram always goes through QUdpSocket. It only re-arms its read notifier from within
+    // readDatagram, so this must happen even if the socket turns out to be empty.
+    QHostAddress    sender;
+    quint16         senderPort  = 0;
+    qint64          pendingSize = _socket->pendingDatagramSize();
+    if (pendingSize > _datagramBuffer.size()) {
+        _datagramBuffer.resize(static_cast<int>(pendingSize));
+    }
+    int    datagramCount = 0;
+    qint64 bytesRead = _socket->readDatagram(_datagramBuffer.data(), qMax(pendingSize, static_cast<qint64>(0)), &sender, &senderPort);
+    if (bytesRead > 0) {
+        _batchBuffer.append(_datagramBuffer.constData(), static_cast<int>(bytesRead));
+        _addSessionTarget(sender, senderPort);
+        datagramCount++;
+    }
+
+#if defined(QGC_UDP_RECVMMSG)
+    // Pull the rest straight from the socket, many datagrams per system call
+    struct mmsghdr      messages[_maxBatchDatagrams];
+    struct iovec        iovecs[_maxBatchDatagrams];
+    struct sockaddr_in  senders[_maxBatchDatagrams];
+    const int           socketDescriptor = static_cast<int>(_socket->socketDescriptor());
+
+    while (bytesRead > 0 && _batchBuffer.size() < _maxBatchBytes) {
+        memset(messages, 0, sizeof(messages));
+        for (int i=0; i<_maxBatchDatagrams; i++) {
+            iovecs[i].iov_base              = _datagramBuffer.data() + (i * _maxDatagramBytes);
+            iovecs[i].iov_len               = _maxDatagramBytes;
+            messages[i].msg_hdr.msg_iov     = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen  = 1;
+            messages[i].msg_hdr.msg_name    = &senders[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+        }
+
+        int received = recvmmsg(socketDescriptor, messages, _maxBatchDatagrams, MSG_DONTWAIT, nullptr);
+        if (received <= 0) {
+            // EAGAIN, socket is drained
+            break;
+        }
+        datagramCount += received;
+        for (int i=0; i<received; i++) {
+            if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                qWarning() << "UDP datagram larger than" << _maxDatagramBytes << "bytes truncated";
+            }
+            _batchBuffer.append(static_cast<const char*>(iovecs[i].iov_base), static_cast<int>(messages[i].msg_len));
+            if (senders[i].sin_family == AF_INET) {
+                _addSessionTarget(ntohl(senders[i].sin_addr.s_addr), ntohs(senders[i].sin_port));
+            }
+        }
+        if (received < _maxBatchDatagrams) {
+            break;
+        }
+    }
+#else
+    while (bytesRead > 0 && _batchBuffer.size() < _maxBatchBytes && _socket->hasPendingDatagrams()) {
+        pendingSize = _socket->pendingDatagramSize();
+        if (pendingSize > _datagramBuffer.size()) {
+            _datagramBuffer.resize(static_cast<int>(pendingSize));
+        }
+        bytesRead = _socket->readDatagram(_datagramBuffer.data(), pendingSize, &sender, &senderPort);
+        if (bytesRead > 0) {
+            _batchBuffer.append(_datagramBuffer.constData(), static_cast<int>(bytesRead));
+            _addSessionTarget(sender, senderPort);
+            datagramCount++;
+        }
+    }
+#endif
+
+    // Anything left over once the batch is full re-triggers readyRead
+    if (_batchBuffer.size()) {
+        _logInputDataRate(static_cast<quint64>(_batchBuffer.size()), QDateTime::currentMSecsSinceEpoch(), datagramCount);
+        emit bytesReceived(this, _batchBuffer);
+    }
+}
+
+void UDPLink::_addSessionTarget(const QHostAddress& sender, quint16 senderPort)
+{
+    bool    ipv4    = false;
+    quint32 address = sender.toIPv4Address(&ipv4);
+    if (ipv4) {
+        _addSessionTarget(address, senderPort);
+        return;
+    }
+
+    QHostAddress asender = sender;
+    if(_isIpLocal(sender)) {
+        asender = QHostAddress(QString("127.0.0.1"));
+    }
+    if(!contains_target(_sessionTargets, asender, senderPort)) {
+        qDebug() << "Adding target" << asender << senderPort;
+        _sessionTargets.append(new UDPCLient(asender, senderPort));
+    }
+}
+
+void UDPLink::_addSessionTarget(quint32 senderIPv4, quint16 senderPort)
+{
+    const quint64 key = _sessionTargetKey(senderIPv4, senderPort);
+    if (_sessionTargetMap.contains(key)) {
+        return;
+    }
+
+    // New sender, this is the only place the (expensive) local address check happens
+    QHostAddress sender(senderIPv4);
+    QHostAddress asender = sender;
+    if(_isIpLocal(sender)) {
+        asender = QHostAddress(QString("127.0.0.1"));
+    }
+
+    // Different local addresses all map to the same loopback target
+    UDPCLient* target = nullptr;
+    for (UDPCLient* sessionTarget: _sessionTargets) {
+        if (sessionTarget->address == asender && sessionTarget->port == senderPort) {
+            target = sessionTarget;
+            break;
+        }
+    }
+    if (!target) {
+        qDebug() << "Adding target" << asender << senderPort;
+        target = new UDPCLient(asender, senderPort);
+        _sessionTargets.append(target);
+    }
+    _sessionTargetMap[key] = target;
+}
+
 /**
  * @brief Disconnect the connection.
  *
@@ -369,7 +516,9 @@ void UDPLink::_deregisterZeroconf()
 //--------------------------------------------------------------------------
 //-- UDPConfiguration
 
-UDPConfiguration::UDPConfiguration(const QString& name) : LinkConfiguration(name)
+UDPConfiguration::UDPConfiguration(const QString& name)
+    : LinkConfiguration (name)
+    , _batchedReceive   (false)
 {
     AutoConnectSettings* settings = qgcApp()->toolbox()->settingsManager()->autoConnectSettings();
     _localPort = settings->udpListenPort()->rawValue().toInt();
@@ -379,7 +528,9 @@ UDPConfiguration::UDPConfiguration(const QString& name) : LinkConfiguration(name
     }
 }
 
-UDPConfiguration::UDPConfiguration(UDPConfiguration* source) : LinkConfiguration(source)
+UDPConfiguration::UDPConfiguration(UDPConfiguration* source)
+    : LinkConfiguration (source)
+    , _batchedReceive   (false)
 {
     _copyFrom(source);
 }
@@ -400,6 +551,7 @@ void UDPConfiguration::_copyFrom(LinkConfiguration *source)
     auto* usource = qobject_cast<UDPConfiguration*>(source);
     if (usource) {
         _localPort = usource->localPort();
+        _batchedReceive = usource->batchedReceive();
         _clearTargetHosts();
         for(UDPCLient* target: usource->targetHosts()) {
             if(!contains_target(_targetHosts, target->address, target->port)) {
@@ -476,10 +628,19 @@ void UDPConfiguration::setLocalPort(quint16 port)
     _localPort = port;
 }
 
+void UDPConfiguration::setBatchedReceive(bool batchedReceive)
+{
+    if (batchedReceive != _batchedReceive) {
+        _batchedReceive = batchedReceive;
+        emit batchedReceiveChanged();
+    }
+}
+
 void UDPConfiguration::saveSettings(QSettings& settings, const QString& root)
 {
     settings.beginGroup(root);
     settings.setValue("port", (int)_localPort);
+    settings.setValue("batchedReceive", _batchedReceive);
     settings.setValue("hostCount", _targetHosts.size());
     for(int i = 0; i < _targetHosts.size(); i++) {
         UDPCLient* target = _targetHosts.at(i);
@@ -497,6 +658,7 @@ void UDPConfiguration::loadSettings(QSettings& settings, const QString& root)
     _clearTargetHosts();
     settings.beginGroup(root);
     _localPort = (quint16)settings.value("port", acSettings->udpListenPort()->rawValue().toInt()).toUInt();
+    _batchedReceive = settings.value("batchedReceive", false).toBool();
     int hostCount = settings.value("hostCount", 0).toInt();
     for(int i = 0; i < hostCount; i++) {
         QString hkey = QString("host%1").arg(i);
@@ -20,6 +20,7 @@
 #include <QString>
 #include <QList>
 #include <QMap>
+#include <QHash>
 #include <QMutex>
 #include <QUdpSocket>
 #include <QMutexLocker>
@@ -54,6 +55,7 @@ public:
 
     Q_PROPERTY(quint16      localPort   READ localPort  WRITE setLocalPort  NOTIFY localPortChanged)
     Q_PROPERTY(QStringList  hostList    READ hostList                       NOTIFY  hostListChanged)
+    Q_PROPERTY(bool         batchedReceive READ batchedReceive WRITE setBatchedReceive NOTIFY batchedReceiveChanged)
 
     /*!
      * @brief Regular constructor
@@ -111,6 +113,15 @@ public:
      */
     void setLocalPort   (quint16 port);
 
+    /*!
+     * @brief High throughput receive mode
+     *
+     * When enabled the socket is drained in batches into a reusable buffer (using recvmmsg where
+     * available) and a single bytesReceived signal is emitted per batch.
+     */
+    bool batchedReceive     () { return _batchedReceive; }
+    void setBatchedReceive  (bool batchedReceive);
+
     /*!
      * @brief QML Interface
      */
@@ -130,8 +141,9 @@ public:
     QString     settingsTitle        () { return tr("UDP Link Settings"); }
 
 signals:
-    void localPortChanged   ();
-    void hostListChanged    ();
+    void localPortChanged       ();
+    void hostListChanged        ();
+    void batchedReceiveChanged  ();
 
 private:
     void _updateHostList    ();
@@ -142,6 +154,7 @@ private:
     QList<UDPCLient*>   _targetHosts;
     QStringList         _hostList;      ///< Exposed to QML
     quint16             _localPort;
+    bool                _batchedReceive;
 };
 
 class UDPLink : public LinkInterface
@@ -190,6 +203,11 @@ private:
     void    _registerZeroconf       (uint16_t port, const std::string& regType);
     void    _deregisterZeroconf     ();
     void    _writeDataGram          (const QByteArray data, const UDPCLient* target);
+    void    _readBytesBatched       ();
+    void    _addSessionTarget       (const QHostAddress& sender, quint16 senderPort);
+    void    _addSessionTarget       (quint32 senderIPv4, quint16 senderPort);
+
+    static quint64 _sessionTargetKey(quint32 ipv4, quint16 port) { return (static_cast<quint64>(ipv4) << 16) | port; }
 
 #if defined(QGC_ZEROCONF_ENABLED)
     DNSServiceRef  _dnssServiceRef;
@@ -200,7 +218,14 @@ private:
     UDPConfiguration*       _udpConfig;
     bool                    _connectState;
     QList<UDPCLient*>       _sessionTargets;
+    QHash<quint64, UDPCLient*> _sessionTargetMap;   ///< Keyed by raw IPv4 sender address and port, before local remapping
     QList<QHostAddress>     _localAddress;
+    QByteArray              _batchBuffer;           ///< Reused between batches, only reallocated while still shared with a receiver
+    QByteArray              _datagramBuffer;        ///< Scratch space for batched datagram reads
+
+    static const int        _maxBatchBytes      = 64 * 1024;    ///< Batch is emitted once this size is reached
+    static const int        _maxDatagramBytes   = 8 * 1024;     ///< Per datagram slot size for batched reads
+    static const int        _maxBatchDatagrams  = 32;           ///< Maximum number of datagrams per recvmmsg call
 
 };
 
@@ -0,0 +1,184 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "CompressedTlogTest.h"
+#include "CompressedTlogDevice.h"
+#include "TelemetryLogWriter.h"
+#include "TlogIndex.h"
+#include "TlogTestWriter.h"
+#include "LinkManager.h"
+#include "QGCApplication.h"
+#include "QGC.h"
+
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+
+const int CompressedTlogTest::_messageCount;
+
+/// Records a compressed log through TelemetryLogWriter
+/// @return The equivalent uncompressed tlog
+QByteArray CompressedTlogTest::_writeLog(const QString& logFilename)
+{
+    QByteArray expected;
+    QFile logFile(logFilename);
+    if (!logFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        return expected;
+    }
+
+    TelemetryLogWriter writer;
+    writer.startWriting(&logFile, true /* compressed */);
+    if (!writer.writing() || !writer.compressed()) {
+        return expected;
+    }
+
+    TlogTestWriter  tlogWriter;
+    uint8_t         mavlinkChannel = tlogWriter.mavlinkChannel();
+
+    quint64 timestamp = TlogTestWriter::hoursAgoUSecs(1);
+    for (int i=0; i<_messageCount; i++) {
+        mavlink_message_t msg;
+        if (i % 4 == 0) {
+            mavlink_msg_heartbeat_pack_chan(1, 1, mavlinkChannel, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+        } else {
+            mavlink_msg_system_time_pack_chan(1, 1, mavlinkChannel, &msg, timestamp, static_cast<uint32_t>(i));
+        }
+
+        QByteArray record = TlogTestWriter::record(timestamp, msg);
+        const uint8_t* packet = reinterpret_cast<const uint8_t*>(record.constData()) + TlogIndex::cbTimestamp;
+        if (writer.enqueue(timestamp, packet, record.size() - TlogIndex::cbTimestamp)) {
+            expected.append(record);
+        }
+        timestamp += 1000;
+    }
+    writer.stopWriting();
+
+    return expected;
+}
+
+void CompressedTlogTest::_roundTrip_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("roundtrip.tlogz"));
+    QByteArray      expected = _writeLog(logFilename);
+    QVERIFY(!expected.isEmpty());
+
+    QVERIFY(CompressedTlogDevice::isCompressedTlog(logFilename));
+    QVERIFY(QFileInfo(logFilename).size() < expected.size() / 2);
+
+    QString errorString;
+    QScopedPointer<QIODevice> device(CompressedTlogDevice::openLog(logFilename, errorString));
+    QVERIFY2(device, qPrintable(errorString));
+    QVERIFY(qobject_cast<CompressedTlogDevice*>(device.data()));
+    QVERIFY(qobject_cast<CompressedTlogDevice*>(device.data())->blockCount() > 1);
+    QCOMPARE(device->size(), static_cast<qint64>(expected.size()));
+    QCOMPARE(device->readAll(), expected);
+    QVERIFY(device->atEnd());
+
+    // Uncompressed logs come back as plain files
+    QString plainFilename = tempDir.filePath(QStringLiteral("plain.tlog"));
+    QFile plainFile(plainFilename);
+    QVERIFY(plainFile.open(QFile::WriteOnly));
+    plainFile.write(expected);
+    plainFile.close();
+    QVERIFY(!CompressedTlogDevice::isCompressedTlog(plainFilename));
+    device.reset(CompressedTlogDevice::openLog(plainFilename, errorString));
+    QVERIFY2(device, qPrintable(errorString));
+    QVERIFY(!qobject_cast<CompressedTlogDevice*>(device.data()));
+    QCOMPARE(device->readAll(), expected);
+}
+
+void CompressedTlogTest::_seek_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("seek.tlogz"));
+    QByteArray      expected = _writeLog(logFilename);
+    QVERIFY(!expected.isEmpty());
+
+    CompressedTlogDevice device(logFilename);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+
+    // Reads which start and end anywhere, including across block boundaries, in both directions
+    const qint64 readSize = 3000;
+    for (qint64 pos=expected.size() - 1; pos>=0; pos-=7919) {
+        QVERIFY(device.seek(pos));
+        QCOMPARE(device.pos(), pos);
+        QCOMPARE(device.read(readSize), expected.mid(static_cast<int>(pos), static_cast<int>(readSize)));
+    }
+    for (int i=1; i<device.blockCount(); i++) {
+        qint64 boundary = device.block(i).uncompressedOffset;
+        QVERIFY(device.seek(boundary - 10));
+        QCOMPARE(device.read(20), expected.mid(static_cast<int>(boundary - 10), 20));
+        QCOMPARE(device.block(i).firstTimestampUSecs, TlogIndex::parseTimestamp(expected.constData() + boundary, QGC::groundTimeUsecs()));
+    }
+
+    QVERIFY(device.seek(device.size()));
+    QVERIFY(device.atEnd());
+    QVERIFY(device.read(1).isEmpty());
+    QVERIFY(!device.seek(device.size() + 1));
+}
+
+void CompressedTlogTest::_truncated_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("truncated.tlogz"));
+    QByteArray      expected = _writeLog(logFilename);
+    QVERIFY(!expected.isEmpty());
+
+    CompressedTlogDevice::Block_t lastBlock;
+    int blockCount;
+    {
+        CompressedTlogDevice device(logFilename);
+        QVERIFY(device.open(QIODevice::ReadOnly));
+        blockCount = device.blockCount();
+        lastBlock = device.block(blockCount - 1);
+    }
+
+    // Simulate a crash part way through writing the last block: no index, no trailer, partial block
+    QFile logFile(logFilename);
+    QVERIFY(logFile.resize(lastBlock.fileOffset + CompressedTlogDevice::blockHeaderSize + (lastBlock.compressedSize / 2)));
+
+    CompressedTlogDevice device(logFilename);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    QCOMPARE(device.blockCount(), blockCount - 1);
+    QCOMPARE(device.size(), lastBlock.uncompressedOffset);
+    QCOMPARE(device.readAll(), expected.left(static_cast<int>(lastBlock.uncompressedOffset)));
+}
+
+void CompressedTlogTest::_index_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("index.tlogz"));
+    QByteArray      expected = _writeLog(logFilename);
+    QVERIFY(!expected.isEmpty());
+
+    LinkManager*    linkManager = qgcApp()->toolbox()->linkManager();
+    uint8_t         mavlinkChannel = static_cast<uint8_t>(linkManager->_reserveMavlinkChannel());
+    QVERIFY(mavlinkChannel != 0);
+
+    // The sidecar index of a compressed log holds offsets into the uncompressed stream
+    QString errorString;
+    bool built = TlogIndex::build(logFilename, mavlinkChannel, errorString);
+    linkManager->_freeMavlinkChannel(mavlinkChannel);
+    QVERIFY2(built, qPrintable(errorString));
+
+    TlogIndex index;
+    QVERIFY(index.open(logFilename));
+    QCOMPARE(index.messageCount(), static_cast<quint64>(_messageCount));
+
+    CompressedTlogDevice device(logFilename);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    for (quint64 i=0; i<index.messageCount(); i+=997) {
+        qint64 offset = index.offsetAt(i);
+        QVERIFY(device.seek(offset));
+        QByteArray record = device.read(TlogIndex::cbTimestamp + 1);
+        QCOMPARE(record, expected.mid(static_cast<int>(offset), TlogIndex::cbTimestamp + 1));
+        QCOMPARE(TlogIndex::parseTimestamp(record.constData(), QGC::groundTimeUsecs()), index.timestampAt(i));
+    }
+}
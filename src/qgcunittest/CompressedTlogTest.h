@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for compressed telemetry logs: TelemetryLogWriter compressed mode and CompressedTlogDevice
+class CompressedTlogTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    CompressedTlogTest(void) { }
+
+private slots:
+    void _roundTrip_test    (void);
+    void _seek_test         (void);
+    void _truncated_test    (void);
+    void _index_test        (void);
+
+private:
+    QByteArray _writeLog(const QString& logFilename);
+
+    static const int _messageCount = 20000;
+};
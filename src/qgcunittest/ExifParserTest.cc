@@ -0,0 +1,140 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ExifParserTest.h"
+#include "ExifParser.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+const int ExifParserTest::_headerSize;
+const int ExifParserTest::_scanSize;
+
+/// Builds a JPEG with an APP0 segment, a minimal little endian EXIF APP1 segment holding the create date, and
+/// scan data which is larger than the copy chunk size.
+QByteArray ExifParserTest::_jpeg(bool exif)
+{
+    QByteArray jpeg("\xff\xd8", 2);
+
+    // APP0
+    jpeg.append("\xff\xe0\x00\x10JFIF\x00\x01\x01\x00\x00\x01\x00\x01\x00\x00", 18);
+
+    if (exif) {
+        QByteArray tiff("II\x2a\x00", 4);
+        char value[4];
+        qToLittleEndian<quint32>(8, value);                 tiff.append(value, 4);      // IFD0 offset
+        qToLittleEndian<quint16>(1, value);                 tiff.append(value, 2);      // IFD0 entry count
+        tiff.append("\x04\x90\x02\x00", 4);                                             // CreateDate, ascii
+        qToLittleEndian<quint32>(20, value);                tiff.append(value, 4);
+        qToLittleEndian<quint32>(38, value);                tiff.append(value, 4);
+        qToLittleEndian<quint32>(60, value);                tiff.append(value, 4);      // Next IFD offset
+        tiff.append(QByteArray(12, ' '));                                               // Removed when tagging
+        tiff.append("2020:01:02 03:04:05", 20);
+        tiff.append(QByteArray(2 + 32, '\0'));
+
+        QByteArray app1("Exif\0\0", 6);
+        app1.append(tiff);
+        qToBigEndian<quint16>(static_cast<quint16>(app1.size() + 2), value);
+        jpeg.append("\xff\xe1", 2);
+        jpeg.append(value, 2);
+        jpeg.append(app1);
+    }
+
+    // Start of scan, then scan data which contains marker bytes
+    jpeg.append("\xff\xda\x00\x02", 4);
+    QByteArray scan(_scanSize, '\0');
+    for (int i=0; i<scan.size(); i++) {
+        scan[i] = static_cast<char>((i * 7) & 0xff);
+    }
+    jpeg.append(scan);
+    jpeg.append("\xff\xd9", 2);
+    return jpeg;
+}
+
+void ExifParserTest::_readHeader_test(void)
+{
+    QByteArray  jpeg = _jpeg(true /* exif */);
+    QBuffer     image(&jpeg);
+    QByteArray  header;
+    QString     errorString;
+    ExifParser  exifParser;
+
+    // Only the segments up to the end of the EXIF APP1 are read
+    QVERIFY(image.open(QIODevice::ReadOnly));
+    QVERIFY(ExifParser::readHeader(image, header, errorString));
+    QCOMPARE(header.size(), static_cast<int>(_headerSize));
+    QCOMPARE(image.pos(), static_cast<qint64>(_headerSize));
+    QCOMPARE(header, jpeg.left(_headerSize));
+
+    double expectedTime = QDateTime(QDate(2020, 1, 2), QTime(3, 4, 5)).toMSecsSinceEpoch() / 1000.0;
+    QCOMPARE(exifParser.readTime(header), expectedTime);
+    QCOMPARE(exifParser.readTime(jpeg), expectedTime);
+
+    QByteArray noExif = _jpeg(false /* exif */);
+    QBuffer noExifImage(&noExif);
+    QVERIFY(noExifImage.open(QIODevice::ReadOnly));
+    QVERIFY(!ExifParser::readHeader(noExifImage, header, errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(noExifImage.pos() < 64);
+
+    QByteArray notJpeg(100, 'x');
+    QBuffer notJpegImage(&notJpeg);
+    QVERIFY(notJpegImage.open(QIODevice::ReadOnly));
+    QVERIFY(!ExifParser::readHeader(notJpegImage, header, errorString));
+}
+
+void ExifParserTest::_writeTagged_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         sourceFilename = tempDir.filePath(QStringLiteral("source.jpg"));
+    QString         destinationFilename = tempDir.filePath(QStringLiteral("tagged.jpg"));
+    QByteArray      jpeg = _jpeg(true /* exif */);
+    QString         errorString;
+    qint64          bytesCopied;
+    ExifParser      exifParser;
+
+    QFile source(sourceFilename);
+    QVERIFY(source.open(QIODevice::WriteOnly));
+    QCOMPARE(source.write(jpeg), static_cast<qint64>(jpeg.size()));
+    source.close();
+
+    GeoTagWorker::cameraFeedbackPacket geotag;
+    memset(&geotag, 0, sizeof(geotag));
+    geotag.latitude = 47.397742;
+    geotag.longitude = 8.545594;
+    geotag.altitude = 488.0f;
+
+    // Patching only the header must give exactly what patching the whole image in memory gives
+    QByteArray expected = jpeg;
+    GeoTagWorker::cameraFeedbackPacket expectedGeotag = geotag;
+    QVERIFY(exifParser.write(expected, expectedGeotag));
+    QVERIFY(expected.contains("WGS-84"));
+
+    QVERIFY(exifParser.writeTagged(sourceFilename, destinationFilename, geotag, bytesCopied, errorString));
+    QCOMPARE(bytesCopied, static_cast<qint64>(jpeg.size()));
+    QFile destination(destinationFilename);
+    QVERIFY(destination.open(QIODevice::ReadOnly));
+    QByteArray tagged = destination.readAll();
+    QCOMPARE(tagged.size(), expected.size());
+    QVERIFY(tagged == expected);
+    QVERIFY(tagged.endsWith(jpeg.right(_scanSize + 2)));
+
+    // Failure does not leave a partial image behind
+    QString noExifFilename = tempDir.filePath(QStringLiteral("noexif.jpg"));
+    QString noExifDestination = tempDir.filePath(QStringLiteral("noexif_tagged.jpg"));
+    QFile noExif(noExifFilename);
+    QVERIFY(noExif.open(QIODevice::WriteOnly));
+    noExif.write(_jpeg(false /* exif */));
+    noExif.close();
+    QVERIFY(!exifParser.writeTagged(noExifFilename, noExifDestination, geotag, bytesCopied, errorString));
+    QVERIFY(!QFile::exists(noExifDestination));
+}
@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for ExifParser header only reads and streamed tagging
+class ExifParserTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ExifParserTest(void) { }
+
+private slots:
+    void _readHeader_test   (void);
+    void _writeTagged_test  (void);
+
+private:
+    QByteArray _jpeg(bool exif);
+
+    static const int _headerSize = 2 + 18 + 102;
+    static const int _scanSize = 3 * 1024 * 1024 + 17;
+};
@@ -16,6 +16,8 @@
 #include "UAS.h"
 #include "QGCApplication.h"
 
+#include <QTemporaryDir>
+
 FileManagerTest::FileManagerTest(void)
     : _fileServer(NULL)
     , _fileManager(NULL)
@@ -36,6 +38,8 @@ void FileManagerTest::init(void)
     
     _fileManager = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle()->uas()->getFileManager();
     QVERIFY(_fileManager != NULL);
+    _fileManager->_ackTimerTimeoutMsecs = _testAckTimeoutMsecs;
+    _fileManager->_ackTimerMaxRetries = _testAckMaxRetries;
     
     Q_ASSERT(_multiSpy == NULL);
     
@@ -199,6 +203,111 @@ void FileManagerTest::_listTest(void)
     _fileServer->enableRandromDrops(false);
 }
 
+void FileManagerTest::_windowedDownloadTest(void)
+{
+    Q_ASSERT(_fileManager);
+    Q_ASSERT(_multiSpy);
+    Q_ASSERT(_multiSpy->checkNoSignals() == true);
+
+    const MockLinkFileServer::FileTestCase* testCase = &MockLinkFileServer::rgFileTestCases[MockLinkFileServer::cFileTestCases - 1];
+    QString filePath = QDir::temp().absoluteFilePath(testCase->filename);
+
+    // Clean run, then with packets dropped in both directions which must be repaired
+    for (int drops=0; drops<2; drops++) {
+        QSignalSpy resetSpy(_fileServer, &MockLinkFileServer::resetCommandReceived);
+        QFile::remove(filePath);
+        _fileServer->enableRandromDrops(drops != 0);
+        _fileManager->_ackTimerMaxRetries = drops ? 50 : _testAckMaxRetries;
+
+        _fileManager->downloadPath(testCase->filename, QDir::temp());
+        QVERIFY(_multiSpy->waitForSignalByIndex(commandCompleteSignalIndex, _transferTimeoutMsecs));
+        QCOMPARE(_multiSpy->checkOnlySignalByMask(commandCompleteSignalMask), true);
+        _multiSpy->clearAllSignals();
+        _validateFileContents(filePath, testCase->length);
+        _waitForSessionReset(resetSpy);
+
+        const FileManager::TransferStats_t& stats = _fileManager->transferStats();
+        QVERIFY(stats.bytes >= testCase->length);
+        QVERIFY(stats.windowSize >= 1 && stats.windowSize <= FileManager::maxWindowSize);
+        if (drops) {
+            QVERIFY(stats.retransmits > 0);
+        } else {
+            // Nothing lost so the window only grows
+            QCOMPARE(stats.retransmits, 0);
+            QVERIFY(stats.windowSize > FileManager::initialWindowSize);
+        }
+    }
+
+    _fileServer->enableRandromDrops(false);
+    _fileManager->_ackTimerMaxRetries = _testAckMaxRetries;
+    QFile::remove(filePath);
+}
+
+void FileManagerTest::_windowedUploadTest(void)
+{
+    Q_ASSERT(_fileManager);
+    Q_ASSERT(_multiSpy);
+    Q_ASSERT(_multiSpy->checkNoSignals() == true);
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // Spans many Write requests with a short last one
+    QByteArray uploadData;
+    for (int i=0; i<20000; i++) {
+        uploadData.append(static_cast<char>(i & 0xFF));
+    }
+    QFile file(tempDir.filePath("upload.qgc"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(uploadData), static_cast<qint64>(uploadData.size()));
+    file.close();
+
+    for (int drops=0; drops<2; drops++) {
+        QSignalSpy resetSpy(_fileServer, &MockLinkFileServer::resetCommandReceived);
+        _fileServer->enableRandromDrops(drops != 0);
+        _fileManager->_ackTimerMaxRetries = drops ? 50 : _testAckMaxRetries;
+
+        _fileManager->uploadPath("/fs/microsd", QFileInfo(file.fileName()));
+        QVERIFY(_multiSpy->waitForSignalByIndex(commandCompleteSignalIndex, _transferTimeoutMsecs));
+        QCOMPARE(_multiSpy->checkOnlySignalByMask(commandCompleteSignalMask), true);
+        _multiSpy->clearAllSignals();
+
+        QCOMPARE(_fileServer->uploadPath(), QStringLiteral("/fs/microsd/upload.qgc"));
+        QVERIFY(_fileServer->uploadData() == uploadData);
+        QCOMPARE(_fileManager->transferStats().bytes, static_cast<quint64>(uploadData.size()));
+        _waitForSessionReset(resetSpy);
+    }
+
+    _fileServer->enableRandromDrops(false);
+    _fileManager->_ackTimerMaxRetries = _testAckMaxRetries;
+}
+
+/// A finished transfer closes its session with a Reset, which must be acked before the next command can be sent
+void FileManagerTest::_waitForSessionReset(QSignalSpy& resetSpy)
+{
+    QVERIFY(resetSpy.count() != 0 || resetSpy.wait(_ackTimerTimeoutMsecs));
+    QTest::qWait(_testAckTimeoutMsecs);
+}
+
+void FileManagerTest::_validateFileContents(const QString& filePath, uint32_t length)
+{
+	QFile file(filePath);
+	
+	// Make sure file size is correct
+	QCOMPARE(file.size(), (qint64)length);
+	
+	// Read data
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QByteArray bytes = file.readAll();
+	file.close();
+	
+	// Validate file contents:
+	//      Repeating 0x00, 0x01 .. 0xFF until file is full
+	for (int i=0; i<bytes.length(); i++) {
+		QCOMPARE((uint8_t)bytes[i], (uint8_t)(i & 0xFF));
+	}
+}
+
 #if 0
 // Trying to write test code for read and burst mode download as well as implement support in MockLineFileServer reached a point
 // of diminishing returns where the test code and mock server were generating more bugs in themselves than finding problems.
@@ -374,22 +483,4 @@ void FileManagerTest::_streamDownloadTest(void)
     }
 }
 
-void FileManagerTest::_validateFileContents(const QString& filePath, uint8_t length)
-{
-	QFile file(filePath);
-	
-	// Make sure file size is correct
-	QCOMPARE(file.size(), (qint64)length);
-	
-	// Read data
-	QVERIFY(file.open(QIODevice::ReadOnly));
-	QByteArray bytes = file.readAll();
-	file.close();
-	
-	// Validate file contents:
-	//      Repeating 0x00, 0x01 .. 0xFF until file is full
-	for (uint8_t i=0; i<bytes.length(); i++) {
-		QCOMPARE((uint8_t)bytes[i], (uint8_t)(i & 0xFF));
-	}
-}
 #endif
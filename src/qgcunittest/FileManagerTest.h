@@ -39,12 +39,15 @@ private slots:
     void _ackTest(void);
     void _noAckTest(void);
     void _listTest(void);
+    void _windowedDownloadTest(void);
+    void _windowedUploadTest(void);
 	
     // Connected to FileManager listEntry signal
     void listEntry(const QString& entry);
     
 private:
-    void _validateFileContents(const QString& filePath, uint8_t length);
+    void _validateFileContents(const QString& filePath, uint32_t length);
+    void _waitForSessionReset(QSignalSpy& resetSpy);
 
     enum {
         listEntrySignalIndex = 0,
@@ -69,9 +72,17 @@ private:
     static const size_t _cSignals = maxSignalIndex;
     const char*         _rgSignals[_cSignals];
     
+    /// Ack timeout and retries the FileManager is set up with. The timeout is short so the timeout tests run quickly,
+    /// there are enough retries that random drops don't fail a command.
+    static const int _testAckTimeoutMsecs = 100;
+    static const int _testAckMaxRetries = 20;
+
     /// @brief This is the amount of time to wait to allow the FileManager enough time to timeout waiting for an Ack.
     /// As such it must be larger than the Ack Timeout used by the FileManager.
-    static const int _ackTimerTimeoutMsecs = FileManager::ackTimerMaxRetries * FileManager::ackTimerTimeoutMsecs * 2;
+    static const int _ackTimerTimeoutMsecs = _testAckMaxRetries * _testAckTimeoutMsecs * 2;
+
+    /// Upper bound for a whole windowed transfer with random drops
+    static const int _transferTimeoutMsecs = 30000;
     
     QStringList _fileListReceived;
 };
@@ -0,0 +1,161 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkSendQueueTest.h"
+#include "LinkSendQueue.h"
+
+void LinkSendQueueTest::_priority_test(void)
+{
+    LinkSendQueue   queue;
+    QByteArray      bytes;
+    int             waitMSecs;
+
+    queue.enqueue(LinkSendQueue::PriorityBulk,          0, QByteArray("bulk"));
+    queue.enqueue(LinkSendQueue::PriorityTransfer,      0, QByteArray("transfer"));
+    queue.enqueue(LinkSendQueue::PriorityMissionParam,  0, QByteArray("param"));
+    queue.enqueue(LinkSendQueue::PriorityCommand,       0, QByteArray("command1"));
+    queue.enqueue(LinkSendQueue::PriorityControl,       0, QByteArray("control"));
+    queue.enqueue(LinkSendQueue::PriorityCommand,       0, QByteArray("command2"));
+
+    const char* expected[] = { "control", "command1", "command2", "param", "transfer", "bulk" };
+    for (const char* packet: expected) {
+        QVERIFY(queue.takeNext(0, 0, bytes, waitMSecs));
+        QCOMPARE(bytes, QByteArray(packet));
+    }
+    QVERIFY(!queue.takeNext(0, 0, bytes, waitMSecs));
+    QCOMPARE(waitMSecs, 0);
+    QVERIFY(queue.isEmpty());
+
+    // Classification
+    mavlink_message_t message;
+    mavlink_msg_manual_control_pack(255, 190, &message, 1, 0, 0, 0, 0, 0);
+    QCOMPARE(LinkSendQueue::priorityForMessage(message), LinkSendQueue::PriorityControl);
+    mavlink_msg_param_request_list_pack(255, 190, &message, 1, 1);
+    QCOMPARE(LinkSendQueue::priorityForMessage(message), LinkSendQueue::PriorityMissionParam);
+    mavlink_msg_command_long_pack(255, 190, &message, 1, 1, MAV_CMD_COMPONENT_ARM_DISARM, 0, 1, 0, 0, 0, 0, 0, 0);
+    QCOMPARE(LinkSendQueue::priorityForMessage(message), LinkSendQueue::PriorityCommand);
+    QCOMPARE(LinkSendQueue::coalesceKeyForMessage(message), static_cast<quint64>(0));
+    mavlink_msg_log_request_data_pack(255, 190, &message, 1, 1, 0, 0, 1000);
+    QCOMPARE(LinkSendQueue::priorityForMessage(message), LinkSendQueue::PriorityTransfer);
+    uint8_t rtcm[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN] = { };
+    mavlink_msg_gps_rtcm_data_pack(255, 190, &message, 0, sizeof(rtcm), rtcm);
+    QCOMPARE(LinkSendQueue::priorityForMessage(message), LinkSendQueue::PriorityBulk);
+}
+
+void LinkSendQueueTest::_coalesce_test(void)
+{
+    LinkSendQueue       queue;
+    QByteArray          bytes;
+    int                 waitMSecs;
+    mavlink_message_t   message;
+
+    mavlink_msg_manual_control_pack(255, 190, &message, 1, 100, 0, 0, 0, 0);
+    const quint64 vehicle1Key = LinkSendQueue::coalesceKeyForMessage(message);
+    mavlink_msg_manual_control_pack(255, 190, &message, 2, 100, 0, 0, 0, 0);
+    const quint64 vehicle2Key = LinkSendQueue::coalesceKeyForMessage(message);
+    QVERIFY(vehicle1Key != 0);
+    QVERIFY(vehicle1Key != vehicle2Key);
+
+    queue.enqueue(LinkSendQueue::PriorityControl, vehicle1Key,  QByteArray("v1 old"));
+    queue.enqueue(LinkSendQueue::PriorityControl, 0,            QByteArray("heartbeat"));
+    queue.enqueue(LinkSendQueue::PriorityControl, vehicle2Key,  QByteArray("v2"));
+    queue.enqueue(LinkSendQueue::PriorityControl, vehicle1Key,  QByteArray("v1 new"));
+
+    // Newer packet takes the place of the old one
+    const char* expected[] = { "v1 new", "heartbeat", "v2" };
+    for (const char* packet: expected) {
+        QVERIFY(queue.takeNext(0, 0, bytes, waitMSecs));
+        QCOMPARE(bytes, QByteArray(packet));
+    }
+    QVERIFY(!queue.takeNext(0, 0, bytes, waitMSecs));
+
+    LinkSendQueue::ClassStats_t stats = queue.stats(LinkSendQueue::PriorityControl);
+    QCOMPARE(stats.packetsQueued,       static_cast<quint64>(4));
+    QCOMPARE(stats.packetsCoalesced,    static_cast<quint64>(1));
+    QCOMPARE(stats.packetsSent,         static_cast<quint64>(3));
+    QCOMPARE(stats.bytesQueued,         0);
+}
+
+void LinkSendQueueTest::_rateLimit_test(void)
+{
+    LinkSendQueue   queue;
+    QByteArray      bytes;
+    int             waitMSecs;
+    const qint64    bytesPerSecond = 5760;  // 57600 baud
+    const QByteArray rtcm(180, 'r');
+
+    for (int i=0; i<20; i++) {
+        queue.enqueue(LinkSendQueue::PriorityBulk, 0, rtcm);
+    }
+
+    // Bulk class gets to burst its bucket and is then held back
+    qint64 now = 100000;
+    int sentCount = 0;
+    while (queue.takeNext(now, bytesPerSecond, bytes, waitMSecs)) {
+        sentCount++;
+    }
+    QVERIFY(sentCount > 0);
+    QVERIFY(sentCount < 20);
+    QVERIFY(waitMSecs > 0);
+
+    // Control still goes out right away
+    queue.enqueue(LinkSendQueue::PriorityControl, 0, QByteArray("control"));
+    QVERIFY(queue.takeNext(now, bytesPerSecond, bytes, waitMSecs));
+    QCOMPARE(bytes, QByteArray("control"));
+
+    // Over one second bulk traffic stays within its share of the bandwidth
+    int bulkBytes = 0;
+    for (qint64 time = now + 10; time <= now + 1000; time += 10) {
+        while (queue.takeNext(time, bytesPerSecond, bytes, waitMSecs)) {
+            bulkBytes += bytes.size();
+        }
+    }
+    QVERIFY(bulkBytes > 0);
+    QVERIFY(bulkBytes <= bytesPerSecond * 0.4 + rtcm.size());
+
+    // Unlimited link drains everything
+    while (queue.takeNext(now, 0, bytes, waitMSecs)) { }
+    QVERIFY(queue.isEmpty());
+}
+
+void LinkSendQueueTest::_overflow_test(void)
+{
+    LinkSendQueue   queue;
+    QByteArray      bytes;
+    int             waitMSecs;
+
+    for (int i=0; i<1000; i++) {
+        queue.enqueue(LinkSendQueue::PriorityBulk, 0, QByteArray(100, static_cast<char>(i)));
+    }
+
+    LinkSendQueue::ClassStats_t stats = queue.stats(LinkSendQueue::PriorityBulk);
+    QVERIFY(stats.packetsDropped > 0);
+    QVERIFY(stats.bytesQueued <= 32 * 1024);
+
+    // Oldest packets are the ones which were dropped
+    QVERIFY(queue.takeNext(0, 0, bytes, waitMSecs));
+    QCOMPARE(bytes[0], static_cast<char>(stats.packetsDropped));
+
+    // Command, mission, parameter and transfer packets are never dropped, no matter how far behind the link is
+    const LinkSendQueue::Priority_t reliablePriorities[] = { LinkSendQueue::PriorityCommand, LinkSendQueue::PriorityMissionParam, LinkSendQueue::PriorityTransfer };
+    for (LinkSendQueue::Priority_t priority: reliablePriorities) {
+        const int packetCount = 2000;
+        for (int i=0; i<packetCount; i++) {
+            queue.enqueue(priority, 0, QByteArray(100, static_cast<char>(i)));
+        }
+
+        stats = queue.stats(priority);
+        QCOMPARE(stats.packetsDropped, static_cast<quint64>(0));
+        QCOMPARE(stats.bytesQueued, packetCount * 100);
+
+        QVERIFY(queue.takeNext(0, 0, bytes, waitMSecs));
+        QCOMPARE(bytes[0], static_cast<char>(0));
+        while (queue.takeNext(0, 0, bytes, waitMSecs)) { }
+    }
+}
@@ -0,0 +1,27 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for LinkSendQueue
+class LinkSendQueueTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LinkSendQueueTest(void) { }
+
+private slots:
+    void _priority_test     (void);
+    void _coalesce_test     (void);
+    void _rateLimit_test    (void);
+    void _overflow_test     (void);
+};
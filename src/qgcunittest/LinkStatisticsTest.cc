@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkStatisticsTest.h"
+#include "LinkStatistics.h"
+
+#include <QThread>
+
+void LinkStatisticsTest::_rate_test(void)
+{
+    LinkTrafficStatistics   stats;
+    const qint64            start = 100000;
+
+    // 100 bytes in 2 packets every 100 msecs for two seconds
+    for (qint64 time = start; time < start + 2000; time += 100) {
+        stats.record(100, 2, time);
+    }
+
+    QCOMPARE(stats.totalBytes(),    static_cast<quint64>(2000));
+    QCOMPARE(stats.totalPackets(),  static_cast<quint64>(40));
+
+    // Slot currently being filled is not included
+    const qint64 now = start + 2000 - 50;
+    QCOMPARE(stats.bytesPerSecond(now),     1000.0);
+    QCOMPARE(stats.packetsPerSecond(now),   20.0);
+
+    // Old data ages out of the window
+    QCOMPARE(stats.bytesPerSecond(now + 500),   500.0 * 1000.0 / 900.0);
+    QCOMPARE(stats.bytesPerSecond(now + 5000),  0.0);
+
+    // Slots are reused once the window wraps around
+    stats.record(300, 1, now + 5000);
+    QCOMPARE(stats.bytesPerSecond(now + 5100), 300.0 * 1000.0 / 900.0);
+}
+
+void LinkStatisticsTest::_burst_test(void)
+{
+    LinkTrafficStatistics stats;
+
+    stats.record(10,        1, 0);
+    stats.record(63,        1, 0);
+    stats.record(64,        1, 0);
+    stats.record(200,       1, 0);
+    stats.record(1000000,   1, 0);
+
+    QVector<quint64> histogram = stats.burstHistogram();
+    QCOMPARE(histogram.count(), LinkTrafficStatistics::burstBucketCount);
+    QCOMPARE(histogram[0], static_cast<quint64>(2));    // < 64
+    QCOMPARE(histogram[1], static_cast<quint64>(1));    // < 128
+    QCOMPARE(histogram[2], static_cast<quint64>(1));    // < 256
+    QCOMPARE(histogram[LinkTrafficStatistics::burstBucketCount - 1], static_cast<quint64>(1));
+}
+
+void LinkStatisticsTest::_latency_test(void)
+{
+    LinkLatencyStatistics latency;
+
+    // Dispatch without a receive is ignored
+    latency.markDispatched();
+    QCOMPARE(latency.maxUSecs(), 0.0);
+
+    // Only the oldest pending receive counts
+    latency.markReceived();
+    QThread::msleep(20);
+    latency.markReceived();
+    latency.markDispatched();
+
+    QVERIFY(latency.lastUSecs() >= 20000.0);
+    QCOMPARE(latency.averageUSecs(),    latency.lastUSecs());
+    QCOMPARE(latency.maxUSecs(),        latency.lastUSecs());
+
+    const double firstLatency = latency.lastUSecs();
+    latency.markReceived();
+    latency.markDispatched();
+    QVERIFY(latency.lastUSecs() < firstLatency);
+    QVERIFY(latency.averageUSecs() < firstLatency);
+    QCOMPARE(latency.maxUSecs(), firstLatency);
+}
@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for LinkTrafficStatistics and LinkLatencyStatistics
+class LinkStatisticsTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LinkStatisticsTest(void) { }
+
+private slots:
+    void _rate_test     (void);
+    void _burst_test    (void);
+    void _latency_test  (void);
+};
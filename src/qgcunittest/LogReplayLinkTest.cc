@@ -0,0 +1,117 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogReplayLinkTest.h"
+#include "LogReplayLink.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+#include "TlogTestWriter.h"
+#include "Vehicle.h"
+
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+
+const int LogReplayLinkTest::_logDurationSecs;
+const int LogReplayLinkTest::_armedSecs;
+const int LogReplayLinkTest::_disarmedSecs;
+
+LogReplayLinkTest::LogReplayLinkTest(void)
+    : _systemTimeCount          (0)
+    , _replayTimeMismatchCount  (0)
+{
+
+}
+
+void LogReplayLinkTest::_messageReceived(LinkInterface* link, MAVLinkMessageHandle message)
+{
+    Q_UNUSED(link);
+
+    if (message->msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
+        mavlink_system_time_t systemTime;
+        mavlink_msg_system_time_decode(&message.message(), &systemTime);
+
+        _systemTimeCount++;
+        if (systemTime.time_unix_usec != qgcApp()->toolbox()->mavlinkProtocol()->replayTimeUSecs()) {
+            _replayTimeMismatchCount++;
+        }
+    }
+}
+
+/// Batch replay must run much faster than real time while still handing log time to the vehicle
+void LogReplayLinkTest::_batchReplay_test(void)
+{
+    LinkManager*        linkManager         = qgcApp()->toolbox()->linkManager();
+    MAVLinkProtocol*    mavlinkProtocol     = qgcApp()->toolbox()->mavlinkProtocol();
+    MultiVehicleManager* multiVehicleManager = qgcApp()->toolbox()->multiVehicleManager();
+
+    // Ten minute log: 1Hz heartbeat, armed for part of it, and 10Hz SYSTEM_TIME which carries its own log time
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("batch.tlog"));
+    TlogTestWriter  writer;
+    uint8_t         mavlinkChannel = writer.mavlinkChannel();
+    QVERIFY(mavlinkChannel != 0);
+    QVERIFY(writer.open(logFilename));
+
+    const quint64   logStartUSecs   = TlogTestWriter::hoursAgoUSecs(24);
+    int             systemTimeCount = 0;
+    for (int tenths=0; tenths<=_logDurationSecs * 10; tenths++) {
+        const quint64 timeUSecs = logStartUSecs + (static_cast<quint64>(tenths) * 100000);
+
+        mavlink_message_t msg;
+        if (tenths % 10 == 0) {
+            const int   secs    = tenths / 10;
+            uint8_t     armed   = secs >= _armedSecs && secs < _disarmedSecs ? MAV_MODE_FLAG_SAFETY_ARMED : 0;
+            mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, mavlinkChannel, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_GENERIC, MAV_MODE_FLAG_CUSTOM_MODE_ENABLED | armed, 0, MAV_STATE_ACTIVE);
+        } else {
+            mavlink_msg_system_time_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, mavlinkChannel, &msg, timeUSecs, static_cast<uint32_t>(tenths * 100));
+            systemTimeCount++;
+        }
+
+        writer.write(timeUSecs, msg);
+    }
+    writer.close();
+
+    _systemTimeCount = 0;
+    _replayTimeMismatchCount = 0;
+    connect(mavlinkProtocol, &MAVLinkProtocol::sharedMessageReceived, this, &LogReplayLinkTest::_messageReceived);
+
+    LogReplayLinkConfiguration* replayConfig = new LogReplayLinkConfiguration(QStringLiteral("Batch Replay"));
+    replayConfig->setLogFilename(logFilename);
+    replayConfig->setBatchReplay(true);
+    replayConfig->setDynamic(true);
+    SharedLinkConfigurationPointer config = linkManager->addConfiguration(replayConfig);
+
+    QElapsedTimer replayTimer;
+    replayTimer.start();
+
+    LogReplayLink* link = qobject_cast<LogReplayLink*>(linkManager->createConnectedLink(config));
+    QVERIFY(link);
+
+    // Completion can't be signalled until this thread has handled every message, so the spy can't miss it
+    QSignalSpy completeSpy(link, SIGNAL(batchReplayComplete(quint64, qint64)));
+    QVERIFY(completeSpy.wait(30000));
+    QVERIFY(replayTimer.elapsed() < _logDurationSecs * 1000);
+    QCOMPARE(completeSpy[0][0].toULongLong(), static_cast<quint64>((_logDurationSecs * 10) + 1));
+
+    QCOMPARE(_systemTimeCount,          systemTimeCount);
+    QCOMPARE(_replayTimeMismatchCount,  0);
+
+    // Flight time follows the log, not the few milliseconds of wall time the replay took
+    Vehicle* vehicle = multiVehicleManager->activeVehicle();
+    QVERIFY(vehicle);
+    QVERIFY(!vehicle->armed());
+    QCOMPARE(vehicle->getFact(QStringLiteral("flightTime"))->rawValue().toDouble(), static_cast<double>(_disarmedSecs - _armedSecs));
+
+    disconnect(mavlinkProtocol, &MAVLinkProtocol::sharedMessageReceived, this, &LogReplayLinkTest::_messageReceived);
+
+    QSignalSpy linkDeletedSpy(linkManager, SIGNAL(linkDeleted(LinkInterface*)));
+    linkManager->disconnectLink(link);
+    QVERIFY(linkDeletedSpy.wait(10000));
+    QCOMPARE(mavlinkProtocol->replayTimeUSecs(), static_cast<quint64>(0));
+}
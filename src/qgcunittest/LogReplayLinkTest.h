@@ -0,0 +1,37 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "MAVLinkMessageHandle.h"
+
+class LinkInterface;
+
+/// Unit test for LogReplayLink
+class LogReplayLinkTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LogReplayLinkTest(void);
+
+private slots:
+    void _batchReplay_test(void);
+
+    void _messageReceived(LinkInterface* link, MAVLinkMessageHandle message);
+
+private:
+    int _systemTimeCount;
+    int _replayTimeMismatchCount;
+
+    static const int _logDurationSecs   = 600;
+    static const int _armedSecs         = 100;
+    static const int _disarmedSecs      = 400;
+};
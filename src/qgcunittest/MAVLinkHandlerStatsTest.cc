@@ -0,0 +1,62 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkHandlerStatsTest.h"
+#include "MAVLinkHandlerStats.h"
+
+#include <QTemporaryFile>
+
+void MAVLinkHandlerStatsTest::_record_test(void)
+{
+    MAVLinkHandlerStats stats;
+    QSignalSpy          spyCount(&stats, &MAVLinkHandlerStats::countChanged);
+
+    stats.record(1, MAVLINK_MSG_ID_HEARTBEAT,   1000);
+    stats.record(1, MAVLINK_MSG_ID_HEARTBEAT,   3000);
+    stats.record(2, MAVLINK_MSG_ID_HEARTBEAT,   500);
+    stats.record(1, MAVLINK_MSG_ID_ATTITUDE,    2000);
+
+    // One row per (sysid, msgid)
+    QCOMPARE(stats.count(), 3);
+    QCOMPARE(stats.rowCount(), 3);
+    QCOMPARE(spyCount.count(), 3);
+
+    QHash<int, QByteArray> roles = stats.roleNames();
+    QModelIndex row = stats.index(0);
+    QCOMPARE(stats.data(row, roles.key("sysid")).toInt(),           1);
+    QCOMPARE(stats.data(row, roles.key("msgid")).toInt(),           MAVLINK_MSG_ID_HEARTBEAT);
+    QCOMPARE(stats.data(row, roles.key("name")).toString(),         QStringLiteral("HEARTBEAT"));
+    QCOMPARE(stats.data(row, roles.key("count")).toULongLong(),     static_cast<qulonglong>(2));
+    QCOMPARE(stats.data(row, roles.key("totalUSecs")).toDouble(),   4.0);
+    QCOMPARE(stats.data(row, roles.key("averageUSecs")).toDouble(), 2.0);
+    QCOMPARE(stats.data(row, roles.key("maxUSecs")).toDouble(),     3.0);
+
+    stats.reset();
+    QCOMPARE(stats.count(), 0);
+}
+
+void MAVLinkHandlerStatsTest::_csv_test(void)
+{
+    MAVLinkHandlerStats stats;
+
+    stats.record(1, MAVLINK_MSG_ID_HEARTBEAT,   1000);
+    stats.record(1, MAVLINK_MSG_ID_ATTITUDE,    5000);
+
+    // Most expensive handler first
+    QStringList lines = stats.csv().split(QStringLiteral("\n"), QString::SkipEmptyParts);
+    QCOMPARE(lines.count(), 3);
+    QCOMPARE(lines[0], QStringLiteral("sysid,msgid,name,count,totalUSecs,averageUSecs,maxUSecs"));
+    QVERIFY(lines[1].startsWith(QStringLiteral("1,%1,ATTITUDE,1,5.0,").arg(MAVLINK_MSG_ID_ATTITUDE)));
+    QVERIFY(lines[2].startsWith(QStringLiteral("1,%1,HEARTBEAT,1,1.0,").arg(MAVLINK_MSG_ID_HEARTBEAT)));
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QVERIFY(stats.saveCsv(file.fileName()));
+    QCOMPARE(QString::fromUtf8(file.readAll()), stats.csv());
+}
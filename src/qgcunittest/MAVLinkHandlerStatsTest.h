@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for MAVLinkHandlerStats
+class MAVLinkHandlerStatsTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkHandlerStatsTest(void) { }
+
+private slots:
+    void _record_test   (void);
+    void _csv_test      (void);
+};
@@ -0,0 +1,238 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkIngestBenchmark.h"
+#include "MAVLinkProtocol.h"
+#include "MockLink.h"
+#include "QGCApplication.h"
+#include "Vehicle.h"
+
+#include <algorithm>
+
+const char* MAVLinkIngestBenchmark::_rateEnvKey =       "QGC_INGEST_BENCH_RATE";
+const char* MAVLinkIngestBenchmark::_durationEnvKey =   "QGC_INGEST_BENCH_DURATION_MSECS";
+const char* MAVLinkIngestBenchmark::_mixEnvKey =        "QGC_INGEST_BENCH_MIX";
+const char* MAVLinkIngestBenchmark::_batchEnvKey =      "QGC_INGEST_BENCH_BATCH";
+
+const qint64 MAVLinkIngestBenchmark::_maxLatencyNSecs;
+
+MAVLinkIngestBenchmark::MAVLinkIngestBenchmark(void)
+    : _probesReceived   (0)
+    , _lastProbeSeen    (0)
+{
+
+}
+
+void MAVLinkIngestBenchmark::_ingest_test_data(void)
+{
+    QTest::addColumn<QString>   ("mix");
+    QTest::addColumn<int>       ("rate");
+    QTest::addColumn<int>       ("batch");
+    QTest::addColumn<int>       ("durationMSecs");
+    QTest::addColumn<bool>      ("liveUpdates");
+    QTest::addColumn<int>       ("metric");
+
+    static const struct {
+        const char* name;
+        Metric_t    metric;
+    } rgMetrics[] = {
+        { "msgs_per_sec",   MetricThroughput },
+        { "latency_p99",    MetricLatencyP99 },
+    };
+
+    for (const auto& metric: rgMetrics) {
+        QTest::newRow(QStringLiteral("serial_like:%1").arg(metric.name).toLatin1().constData())     << QStringLiteral("attitude,global_position_int")                                   << 500  << 1    << 1000 << false  << static_cast<int>(metric.metric);
+        QTest::newRow(QStringLiteral("mixed_live:%1").arg(metric.name).toLatin1().constData())      << QStringLiteral("attitude,global_position_int,gps_raw_int,sys_status,heartbeat")  << 2000 << 8    << 1000 << true   << static_cast<int>(metric.metric);
+        QTest::newRow(QStringLiteral("udp_saturated:%1").arg(metric.name).toLatin1().constData())   << QStringLiteral("attitude,global_position_int,gps_raw_int,sys_status,heartbeat")  << 0    << 32   << 1000 << false  << static_cast<int>(metric.metric);
+    }
+}
+
+void MAVLinkIngestBenchmark::_ingest_test(void)
+{
+    QFETCH(QString, mix);
+    QFETCH(int,     rate);
+    QFETCH(int,     batch);
+    QFETCH(int,     durationMSecs);
+    QFETCH(bool,    liveUpdates);
+    QFETCH(int,     metric);
+
+    if (qEnvironmentVariableIsSet(_rateEnvKey)) {
+        rate = qEnvironmentVariableIntValue(_rateEnvKey);
+    }
+    if (qEnvironmentVariableIsSet(_durationEnvKey)) {
+        durationMSecs = qEnvironmentVariableIntValue(_durationEnvKey);
+    }
+    if (qEnvironmentVariableIsSet(_mixEnvKey)) {
+        mix = QString::fromLocal8Bit(qgetenv(_mixEnvKey));
+    }
+    if (qEnvironmentVariableIsSet(_batchEnvKey)) {
+        batch = qMax(1, qEnvironmentVariableIntValue(_batchEnvKey));
+    }
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _vehicle->setLiveUpdates(liveUpdates);
+
+    MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
+    connect(mavlinkProtocol, &MAVLinkProtocol::sharedMessageReceived, this, &MAVLinkIngestBenchmark::_messageReceived, Qt::UniqueConnection);
+    connect(_vehicle->groundSpeed(), &Fact::valueChanged, this, &MAVLinkIngestBenchmark::_groundSpeedChanged);
+
+    // Every pass through the mix ends with the VFR_HUD latency probe
+    QStringList messageTypes = mix.split(QStringLiteral(","), QString::SkipEmptyParts);
+    messageTypes.append(QStringLiteral("vfr_hud"));
+
+    // Sequence 0 is never sent since it matches the initial ground speed and would not signal a change
+    _probeSendNSecs.clear();
+    _probeSendNSecs.append(0);
+    _latenciesNSecs.clear();
+    _probesReceived = 0;
+    _lastProbeSeen = 0;
+
+    quint64         messagesSent    = 0;
+    int             typeIndex       = 0;
+    QVector<int>    batchProbes;
+
+    _clock.start();
+
+    while (_clock.elapsed() < durationMSecs) {
+        quint64 messagesDue = rate > 0 ? static_cast<quint64>(_clock.elapsed()) * static_cast<quint64>(rate) / 1000 : messagesSent + static_cast<quint64>(batch);
+        if (messagesSent >= messagesDue) {
+            QTest::qWait(1);
+            continue;
+        }
+
+        QByteArray bytes;
+        batchProbes.clear();
+        for (int i=0; i<batch && messagesSent<messagesDue; i++) {
+            const QString& messageType = messageTypes[typeIndex++ % messageTypes.count()];
+            if (messageType == QStringLiteral("vfr_hud")) {
+                batchProbes.append(_probeSendNSecs.count());
+                _probeSendNSecs.append(0);
+            }
+            bytes.append(_packMessage(messageType, static_cast<quint32>(_probeSendNSecs.count() - 1)));
+            messagesSent++;
+        }
+
+        qint64 sendNSecs = _clock.nsecsElapsed();
+        for (int probe: batchProbes) {
+            _probeSendNSecs[probe] = sendNSecs;
+        }
+        emit _mockLink->bytesReceived(_mockLink, bytes);
+
+        if (rate == 0) {
+            // Still give queued connections and timers a chance to run while saturating
+            QCoreApplication::processEvents();
+        }
+    }
+
+    // Wait for the final probe to make it all the way through, including any FactGroup update interval
+    const quint32 lastProbeSent = static_cast<quint32>(_probeSendNSecs.count() - 1);
+    QElapsedTimer drainTimer;
+    drainTimer.start();
+    while (_lastProbeSeen < lastProbeSent && drainTimer.elapsed() < 5000) {
+        QTest::qWait(5);
+    }
+
+    const double wallSecs       = static_cast<double>(_clock.nsecsElapsed()) / 1.0e9;
+    const double messagesPerSec = static_cast<double>(messagesSent) / wallSecs;
+
+    disconnect(_vehicle->groundSpeed(), &Fact::valueChanged, this, &MAVLinkIngestBenchmark::_groundSpeedChanged);
+    disconnect(mavlinkProtocol, &MAVLinkProtocol::sharedMessageReceived, this, &MAVLinkIngestBenchmark::_messageReceived);
+
+    std::sort(_latenciesNSecs.begin(), _latenciesNSecs.end());
+    const qint64 p99NSecs = _percentile(_latenciesNSecs, 0.99);
+
+    // Timing depends on machine load so the bounds are loose, but every probe has to make it through
+    QVERIFY(messagesSent > 0);
+    QCOMPARE(_probesReceived, lastProbeSent);
+    QCOMPARE(_lastProbeSeen, lastProbeSent);
+    QVERIFY(p99NSecs > 0);
+    QVERIFY2(p99NSecs < _maxLatencyNSecs, qPrintable(QStringLiteral("p99 latency %1us").arg(p99NSecs / 1000)));
+
+    if (metric == MetricThroughput) {
+        QTest::setBenchmarkResult(messagesPerSec, QTest::Events);
+    } else {
+        QTest::setBenchmarkResult(static_cast<qreal>(p99NSecs), QTest::WalltimeNanoseconds);
+    }
+}
+
+void MAVLinkIngestBenchmark::_messageReceived(LinkInterface* link, MAVLinkMessageHandle message)
+{
+    if (link == _mockLink && message->msgid == MAVLINK_MSG_ID_VFR_HUD) {
+        _probesReceived++;
+    }
+}
+
+void MAVLinkIngestBenchmark::_groundSpeedChanged(void)
+{
+    // With FactGroup update throttling only the most recent probe is signalled, older ones are coalesced
+    quint32 probe = static_cast<quint32>(_vehicle->groundSpeed()->rawValue().toDouble());
+    if (probe > _lastProbeSeen && probe < static_cast<quint32>(_probeSendNSecs.count())) {
+        _lastProbeSeen = probe;
+        _latenciesNSecs.append(_clock.nsecsElapsed() - _probeSendNSecs[static_cast<int>(probe)]);
+    }
+}
+
+QByteArray MAVLinkIngestBenchmark::_packMessage(const QString& type, quint32 sequence)
+{
+    mavlink_message_t   msg;
+    const uint8_t       sysid       = static_cast<uint8_t>(_vehicle->id());
+    const uint8_t       compid      = MAV_COMP_ID_AUTOPILOT1;
+    const uint8_t       channel     = _mockLink->mavlinkChannel();
+    const uint32_t      timeBootMS  = static_cast<uint32_t>(_clock.elapsed());
+    const float         variation   = static_cast<float>(sequence % 100) / 100.0f;
+
+    if (type == QStringLiteral("attitude")) {
+        mavlink_msg_attitude_pack_chan(sysid, compid, channel, &msg, timeBootMS, variation, -variation, variation * 2.0f, 0, 0, 0);
+    } else if (type == QStringLiteral("global_position_int")) {
+        mavlink_msg_global_position_int_pack_chan(sysid, compid, channel, &msg, timeBootMS,
+                                                  473977418 + static_cast<int32_t>(sequence % 1000),
+                                                  85455938,
+                                                  488000 + static_cast<int32_t>(sequence % 1000),
+                                                  10000,
+                                                  0, 0, 0,
+                                                  static_cast<uint16_t>((sequence * 10) % 36000));
+    } else if (type == QStringLiteral("gps_raw_int")) {
+        mavlink_msg_gps_raw_int_pack_chan(sysid, compid, channel, &msg,
+                                          static_cast<uint64_t>(timeBootMS) * 1000,
+                                          3,                                    // 3D fix
+                                          473977418, 85455938, 488000,
+                                          UINT16_MAX, UINT16_MAX,               // HDOP/VDOP not known
+                                          UINT16_MAX,                           // velocity not known
+                                          UINT16_MAX,                           // course over ground not known
+                                          static_cast<uint8_t>(8 + sequence % 4),
+                                          0, 0, 0, 0, 0,                        // Extensions
+                                          65535);                               // Yaw not provided
+    } else if (type == QStringLiteral("sys_status")) {
+        mavlink_msg_sys_status_pack_chan(sysid, compid, channel, &msg,
+                                         0, 0, 0,
+                                         250,
+                                         4200 * 4,
+                                         8000,
+                                         static_cast<int8_t>(100 - (sequence % 50)),
+                                         0,0,0,0,0,0);
+    } else if (type == QStringLiteral("heartbeat")) {
+        mavlink_msg_heartbeat_pack_chan(sysid, compid, channel, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_STANDBY);
+    } else {
+        // vfr_hud latency probe, groundspeed carries the sequence number
+        mavlink_msg_vfr_hud_pack_chan(sysid, compid, channel, &msg, 0, static_cast<float>(sequence), 0, 0, 0, 0);
+    }
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int     cBuffer = mavlink_msg_to_send_buffer(buffer, &msg);
+    return QByteArray(reinterpret_cast<const char*>(buffer), cBuffer);
+}
+
+qint64 MAVLinkIngestBenchmark::_percentile(const QVector<qint64>& sortedValues, double percentile)
+{
+    if (sortedValues.isEmpty()) {
+        return 0;
+    }
+    int index = qMin(sortedValues.count() - 1, static_cast<int>(sortedValues.count() * percentile));
+    return sortedValues[index];
+}
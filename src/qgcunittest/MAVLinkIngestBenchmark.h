@@ -0,0 +1,70 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "MAVLinkMessageHandle.h"
+
+#include <QElapsedTimer>
+#include <QVector>
+
+/// End to end benchmark of the LinkManager -> MAVLinkProtocol -> Vehicle -> FactGroup ingest pipeline.
+///
+/// Synthetic telemetry is injected into a connected MockLink as raw bytes at a configurable rate and message mix.
+/// Every injected VFR_HUD carries a sequence number in its groundspeed field which allows the latency from
+/// bytesReceived to the Vehicle groundSpeed Fact::valueChanged to be measured.
+///
+/// Each scenario is run once per reported metric since a data row can only report a single benchmark result:
+///     msgs_per_sec    Messages pushed through the pipeline per second of wall time
+///     latency_p99     99th percentile bytesReceived to Fact::valueChanged latency
+///
+/// The data rows can be overridden from the environment:
+///     QGC_INGEST_BENCH_RATE           Messages per second, 0 for as fast as possible
+///     QGC_INGEST_BENCH_DURATION_MSECS Length of each run
+///     QGC_INGEST_BENCH_MIX            Comma separated list of: attitude, global_position_int, gps_raw_int, sys_status, heartbeat
+///     QGC_INGEST_BENCH_BATCH          Messages per bytesReceived
+///
+/// Run with: QGroundControl --unittest:MAVLinkIngestBenchmark
+class MAVLinkIngestBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkIngestBenchmark(void);
+
+private slots:
+    void _ingest_test_data  (void);
+    void _ingest_test       (void);
+
+    void _messageReceived   (LinkInterface* link, MAVLinkMessageHandle message);
+    void _groundSpeedChanged(void);
+
+private:
+    QByteArray  _packMessage    (const QString& type, quint32 sequence);
+    qint64      _percentile     (const QVector<qint64>& sortedValues, double percentile);
+
+    typedef enum {
+        MetricThroughput,
+        MetricLatencyP99,
+    } Metric_t;
+
+    QElapsedTimer       _clock;
+    QVector<qint64>     _probeSendNSecs;    ///< Send time of each VFR_HUD probe indexed by sequence number
+    QVector<qint64>     _latenciesNSecs;
+    quint32             _probesReceived;
+    quint32             _lastProbeSeen;
+
+    static const char*  _rateEnvKey;
+    static const char*  _durationEnvKey;
+    static const char*  _mixEnvKey;
+    static const char*  _batchEnvKey;
+
+    static const qint64 _maxLatencyNSecs = 2000000000;   ///< Generous upper bound so only a stalled pipeline fails
+};
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogProcessorTest.h"
+#include "MAVLinkLogManager.h"
+#include "QGCApplication.h"
+
+#include <QTemporaryDir>
+
+const int MAVLinkLogProcessorTest::_packetCount;
+
+/// @return ULog header followed by one data message per packet, as the processor should write them
+QByteArray MAVLinkLogProcessorTest::_expectedLog(int packetCount, int droppedSequence)
+{
+    QByteArray log(16, 'U');
+    for (int sequence=0; sequence<packetCount; sequence++) {
+        if (sequence == droppedSequence) {
+            // Dropout message for a single drop
+            const char dropout[] = { 2, 0, 'O', 10, 0 };
+            log.append(dropout, sizeof(dropout));
+        } else {
+            log.append(_packet(sequence));
+        }
+    }
+    return log;
+}
+
+/// @return Complete ULog data message for the packet
+QByteArray MAVLinkLogProcessorTest::_packet(int sequence)
+{
+    QByteArray message;
+    message.append(static_cast<char>(4));
+    message.append(static_cast<char>(0));
+    message.append('D');
+    message.append(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+    return message;
+}
+
+/// Streams the packets in the specified order and checks the resulting log file
+///     @param lateSequence Sequence sent again once all others were sent, -1 for none
+///     @return Log file contents, empty if processing failed or the stats are not as expected
+QByteArray MAVLinkLogProcessorTest::_stream(const QList<int>& sequences, int lateSequence, int expectedDrops, int expectedReordered)
+{
+    QTemporaryDir tempDir;
+    MAVLinkLogProcessor processor;
+    MAVLinkLogManager* manager = qgcApp()->toolbox()->mavlinkLogManager();
+
+    if (!tempDir.isValid() || !processor.create(manager, tempDir.path(), 1)) {
+        return QByteArray();
+    }
+    for (int sequence: sequences) {
+        QByteArray data = _packet(sequence);
+        if (sequence == 0) {
+            data.prepend(QByteArray(16, 'U'));
+        }
+        if (!processor.processStreamData(static_cast<uint16_t>(sequence), 0, data)) {
+            return QByteArray();
+        }
+    }
+    if (lateSequence >= 0) {
+        processor.processStreamData(static_cast<uint16_t>(lateSequence), 0, _packet(lateSequence));
+    }
+    processor.close();
+
+    const MAVLinkLogProcessor::Stats_t stats = processor.stats();
+    QFile file(processor.fileName());
+    file.open(QIODevice::ReadOnly);
+    QByteArray log = file.readAll();
+    file.close();
+    delete processor.record();
+
+    if (stats.droppedSequences != expectedDrops || stats.reorderedSequences != expectedReordered ||
+            stats.lateSequences != (lateSequence >= 0 ? 1 : 0) || stats.writerLagBytes != 0) {
+        qWarning() << "Unexpected stats" << stats.droppedSequences << stats.reorderedSequences << stats.lateSequences << stats.writerLagBytes;
+        return QByteArray();
+    }
+    return log;
+}
+
+void MAVLinkLogProcessorTest::_reorder_test(void)
+{
+    // Swap every 100th pair, each swap is one packet which shows up late but in time
+    QList<int> sequences;
+    int swaps = 0;
+    for (int sequence=0; sequence<_packetCount; sequence++) {
+        if (sequence % 100 == 1 && sequence + 1 < _packetCount) {
+            sequences.append(sequence + 1);
+            sequences.append(sequence);
+            sequence++;
+            swaps++;
+        } else {
+            sequences.append(sequence);
+        }
+    }
+
+    const QByteArray log = _stream(sequences, -1, 0, swaps);
+    QVERIFY(log == _expectedLog(_packetCount, -1));
+}
+
+void MAVLinkLogProcessorTest::_drop_test(void)
+{
+    // Sequence 1000 never shows up in time, more than reorderDepth packets arrive after it
+    const int droppedSequence = 1000;
+    QList<int> sequences;
+    for (int sequence=0; sequence<_packetCount; sequence++) {
+        if (sequence != droppedSequence) {
+            sequences.append(sequence);
+        }
+    }
+
+    const QByteArray log = _stream(sequences, droppedSequence, 1, 0);
+    QVERIFY(log == _expectedLog(_packetCount, droppedSequence));
+}
@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for reordering and buffered writing of streamed ULog data in MAVLinkLogProcessor
+class MAVLinkLogProcessorTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkLogProcessorTest(void) { }
+
+private slots:
+    void _reorder_test  (void);
+    void _drop_test     (void);
+
+private:
+    QByteArray  _packet         (int sequence);
+    QByteArray  _expectedLog    (int packetCount, int droppedSequence);
+    QByteArray  _stream         (const QList<int>& sequences, int lateSequence, int expectedDrops, int expectedReordered);
+
+    static const int _packetCount = 20000;  ///< Enough for several writer blocks
+};
@@ -0,0 +1,123 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageHandleTest.h"
+#include "MAVLinkMessageHandle.h"
+
+#include <QtConcurrent>
+
+mavlink_message_t MAVLinkMessageHandleTest::_heartbeat(uint8_t sysid)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack_chan(sysid, MAV_COMP_ID_AUTOPILOT1, 0, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    return message;
+}
+
+void MAVLinkMessageHandleTest::_refCount_test(void)
+{
+    MAVLinkMessageHandle nullHandle;
+    QVERIFY(nullHandle.isNull());
+    QCOMPARE(nullHandle.refCount(), 0);
+
+    MAVLinkMessageHandle handle(_heartbeat(42));
+    QVERIFY(!handle.isNull());
+    QCOMPARE(handle.refCount(), 1);
+    QCOMPARE(handle->sysid, static_cast<uint8_t>(42));
+    QCOMPARE(handle->msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+
+    {
+        MAVLinkMessageHandle copy(handle);
+        QCOMPARE(handle.refCount(), 2);
+        // Copies share the same buffer
+        QCOMPARE(&copy.message(), &handle.message());
+
+        MAVLinkMessageHandle moved(std::move(copy));
+        QVERIFY(copy.isNull());
+        QCOMPARE(handle.refCount(), 2);
+    }
+    QCOMPARE(handle.refCount(), 1);
+
+    // Conversion operator allows existing const mavlink_message_t& code to take a handle
+    const mavlink_message_t& message = handle;
+    QCOMPARE(message.sysid, static_cast<uint8_t>(42));
+}
+
+void MAVLinkMessageHandleTest::_poolReuse_test(void)
+{
+    MAVLinkMessagePool* pool = MAVLinkMessagePool::instance();
+    int available = pool->available();
+
+    const mavlink_message_t* buffer = nullptr;
+    {
+        MAVLinkMessageHandle handle(_heartbeat(1));
+        QCOMPARE(pool->available(), available - 1);
+        buffer = &handle.message();
+    }
+    QCOMPARE(pool->available(), available);
+
+    // Free-list is LIFO so the same node comes back out
+    MAVLinkMessageHandle handle(_heartbeat(2));
+    QCOMPARE(&handle.message(), buffer);
+    QCOMPARE(handle->sysid, static_cast<uint8_t>(2));
+}
+
+void MAVLinkMessageHandleTest::_detach_test(void)
+{
+    MAVLinkMessagePool* pool = MAVLinkMessagePool::instance();
+    int available = pool->available();
+
+    MAVLinkMessageHandle handle(_heartbeat(3));
+    const mavlink_message_t* buffer = &handle.message();
+
+    // Sole owner writes in place
+    QCOMPARE(handle.detach(), buffer);
+    QCOMPARE(pool->available(), available - 1);
+
+    // Shared message is copied, the other handle keeps the original
+    MAVLinkMessageHandle shared(handle);
+    mavlink_message_t* writable = handle.detach();
+    QVERIFY(writable != buffer);
+    QCOMPARE(pool->available(), available - 2);
+    QCOMPARE(handle.refCount(), 1);
+    QCOMPARE(shared.refCount(), 1);
+    writable->sysid = 4;
+    QCOMPARE(handle->sysid, static_cast<uint8_t>(4));
+    QCOMPARE(shared->sysid, static_cast<uint8_t>(3));
+}
+
+void MAVLinkMessageHandleTest::_crossThreadRelease_test(void)
+{
+    MAVLinkMessagePool* pool = MAVLinkMessagePool::instance();
+    int available = pool->available();
+
+    const int cHandles = 1000;
+    QList<MAVLinkMessageHandle> handles;
+    for (int i=0; i<cHandles; i++) {
+        handles.append(MAVLinkMessageHandle(_heartbeat(static_cast<uint8_t>(i % 255 + 1))));
+    }
+
+    // Release the last reference to each handle from a set of worker threads while allocating
+    // new handles concurrently.
+    QList<QFuture<void>> futures;
+    for (int thread=0; thread<4; thread++) {
+        QList<MAVLinkMessageHandle> slice = handles.mid(thread * (cHandles / 4), cHandles / 4);
+        futures.append(QtConcurrent::run([slice]() mutable {
+            while (!slice.isEmpty()) {
+                MAVLinkMessageHandle replacement(slice.takeLast().message());
+                Q_UNUSED(replacement);
+            }
+        }));
+    }
+    handles.clear();
+    for (QFuture<void>& future: futures) {
+        future.waitForFinished();
+    }
+
+    QCOMPARE(pool->available(), available);
+}
@@ -0,0 +1,30 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for MAVLinkMessageHandle and MAVLinkMessagePool
+class MAVLinkMessageHandleTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkMessageHandleTest(void) { }
+
+private slots:
+    void _refCount_test         (void);
+    void _poolReuse_test        (void);
+    void _detach_test           (void);
+    void _crossThreadRelease_test(void);
+
+private:
+    mavlink_message_t _heartbeat(uint8_t sysid);
+};
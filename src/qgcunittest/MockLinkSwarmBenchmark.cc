@@ -0,0 +1,251 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MockLinkSwarmBenchmark.h"
+#include "MAVLinkProtocol.h"
+#include "MockLink.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+#include "Vehicle.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <ctime>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#elif defined(Q_OS_MAC)
+#include <mach/mach.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+const char* MockLinkSwarmBenchmark::_vehiclesEnvKey =   "QGC_SWARM_BENCH_VEHICLES";
+const char* MockLinkSwarmBenchmark::_linksEnvKey =      "QGC_SWARM_BENCH_LINKS";
+const char* MockLinkSwarmBenchmark::_rateEnvKey =       "QGC_SWARM_BENCH_RATE";
+const char* MockLinkSwarmBenchmark::_mixEnvKey =        "QGC_SWARM_BENCH_MIX";
+const char* MockLinkSwarmBenchmark::_lossEnvKey =       "QGC_SWARM_BENCH_LOSS";
+const char* MockLinkSwarmBenchmark::_jitterEnvKey =     "QGC_SWARM_BENCH_JITTER_MSECS";
+const char* MockLinkSwarmBenchmark::_durationEnvKey =   "QGC_SWARM_BENCH_DURATION_MSECS";
+
+MockLinkSwarmBenchmark::MockLinkSwarmBenchmark(void)
+    : _messagesReceived(0)
+{
+
+}
+
+void MockLinkSwarmBenchmark::_swarm_test_data(void)
+{
+    QTest::addColumn<int>       ("vehicles");
+    QTest::addColumn<int>       ("links");
+    QTest::addColumn<int>       ("rate");
+    QTest::addColumn<QString>   ("mix");
+    QTest::addColumn<double>    ("loss");
+    QTest::addColumn<int>       ("jitterMSecs");
+    QTest::addColumn<int>       ("durationMSecs");
+
+    QTest::newRow("50_one_link")        << 50   << 1    << 10   << QStringLiteral("standard")   << 0.0  << 0    << 5000;
+    QTest::newRow("100_heavy")          << 100  << 2    << 20   << QStringLiteral("heavy")      << 0.0  << 0    << 5000;
+    QTest::newRow("200_lossy_radios")   << 200  << 8    << 5    << QStringLiteral("standard")   << 2.0  << 50   << 5000;
+}
+
+void MockLinkSwarmBenchmark::_swarm_test(void)
+{
+    QFETCH(int,     vehicles);
+    QFETCH(int,     links);
+    QFETCH(int,     rate);
+    QFETCH(QString, mix);
+    QFETCH(double,  loss);
+    QFETCH(int,     jitterMSecs);
+    QFETCH(int,     durationMSecs);
+
+    if (qEnvironmentVariableIsSet(_vehiclesEnvKey)) {
+        vehicles = qEnvironmentVariableIntValue(_vehiclesEnvKey);
+    }
+    if (qEnvironmentVariableIsSet(_linksEnvKey)) {
+        links = qEnvironmentVariableIntValue(_linksEnvKey);
+    }
+    if (qEnvironmentVariableIsSet(_rateEnvKey)) {
+        rate = qEnvironmentVariableIntValue(_rateEnvKey);
+    }
+    if (qEnvironmentVariableIsSet(_mixEnvKey)) {
+        mix = QString::fromLocal8Bit(qgetenv(_mixEnvKey));
+    }
+    if (qEnvironmentVariableIsSet(_lossEnvKey)) {
+        loss = QString::fromLocal8Bit(qgetenv(_lossEnvKey)).toDouble();
+    }
+    if (qEnvironmentVariableIsSet(_jitterEnvKey)) {
+        jitterMSecs = qEnvironmentVariableIntValue(_jitterEnvKey);
+    }
+    if (qEnvironmentVariableIsSet(_durationEnvKey)) {
+        durationMSecs = qEnvironmentVariableIntValue(_durationEnvKey);
+    }
+    vehicles    = qBound(1, vehicles, 254);
+    links       = qBound(1, links, vehicles);
+
+    MockConfiguration::SwarmMessageMix_t messageMix = MockConfiguration::SwarmMixStandard;
+    if (mix == QStringLiteral("minimal")) {
+        messageMix = MockConfiguration::SwarmMixMinimal;
+    } else if (mix == QStringLiteral("heavy")) {
+        messageMix = MockConfiguration::SwarmMixHeavy;
+    }
+
+    MultiVehicleManager*    multiVehicleManager = qgcApp()->toolbox()->multiVehicleManager();
+    MAVLinkProtocol*        mavlinkProtocol     = qgcApp()->toolbox()->mavlinkProtocol();
+
+    const quint64   rssBaseline = _residentBytes();
+    QElapsedTimer   connectTimer;
+    connectTimer.start();
+
+    // Vehicles are spread evenly across the links with consecutive system ids
+    int firstSystemId = 1;
+    for (int i=0; i<links; i++) {
+        int linkVehicles = (vehicles / links) + (i < vehicles % links ? 1 : 0);
+        MockLink* link = MockLink::startSwarmMockLink(linkVehicles, firstSystemId, rate, messageMix, loss, jitterMSecs);
+        QVERIFY(link);
+        _swarmLinks.append(link);
+        firstSystemId += linkVehicles;
+    }
+
+    // Wait for every vehicle to make it through the initial connection sequence
+    int connectedCount = 0;
+    while (connectTimer.elapsed() < 60000) {
+        connectedCount = 0;
+        for (int i=0; i<multiVehicleManager->vehicles()->count(); i++) {
+            Vehicle* vehicle = multiVehicleManager->vehicles()->value<Vehicle*>(i);
+            if (vehicle->initialPlanRequestComplete()) {
+                connectedCount++;
+            }
+        }
+        if (connectedCount >= vehicles) {
+            break;
+        }
+        QTest::qWait(100);
+    }
+    const qint64 connectMSecs = connectTimer.elapsed();
+
+    // Measure steady state
+    connect(mavlinkProtocol, &MAVLinkProtocol::sharedMessageReceived, this, &MockLinkSwarmBenchmark::_messageReceived, Qt::UniqueConnection);
+    _messagesReceived = 0;
+
+    const quint64   rssStart    = _residentBytes();
+    quint64         rssPeak     = rssStart;
+    QElapsedTimer   wallTimer;
+    const qint64    cpuStart    = _threadCpuNSecs();
+
+    wallTimer.start();
+    while (wallTimer.elapsed() < durationMSecs) {
+        QTest::qWait(100);
+        rssPeak = qMax(rssPeak, _residentBytes());
+    }
+
+    const double wallSecs       = static_cast<double>(wallTimer.nsecsElapsed()) / 1.0e9;
+    const qint64 cpuEnd         = _threadCpuNSecs();
+    const double cpuPercent     = cpuStart >= 0 && cpuEnd >= 0 ? (static_cast<double>(cpuEnd - cpuStart) / 1.0e9 / wallSecs) * 100.0 : -1;
+    const double messagesPerSec = static_cast<double>(_messagesReceived) / wallSecs;
+    const double mb             = 1024.0 * 1024.0;
+
+    disconnect(mavlinkProtocol, &MAVLinkProtocol::sharedMessageReceived, this, &MockLinkSwarmBenchmark::_messageReceived);
+
+    quint64 packetsLost = 0;
+    for (MockLink* link: _swarmLinks) {
+        packetsLost += link->swarm()->packetsLost();
+    }
+
+    qDebug().noquote() << QStringLiteral("MockLinkSwarmBenchmark %1: vehicles(%2/%3) links(%4) rate(%5Hz) mix(%6) loss(%7%) jitter(%8ms) connect(%9ms) msgs/sec(%10) gui thread cpu(%11% of one core) rss baseline/start/peak(%12/%13/%14 MB) simulatedLoss(%15)")
+                          .arg(QString::fromLatin1(QTest::currentDataTag()))
+                          .arg(connectedCount)
+                          .arg(vehicles)
+                          .arg(links)
+                          .arg(rate)
+                          .arg(mix)
+                          .arg(loss)
+                          .arg(jitterMSecs)
+                          .arg(connectMSecs)
+                          .arg(messagesPerSec, 0, 'f', 0)
+                          .arg(cpuPercent, 0, 'f', 1)
+                          .arg(rssBaseline / mb, 0, 'f', 1)
+                          .arg(rssStart / mb, 0, 'f', 1)
+                          .arg(rssPeak / mb, 0, 'f', 1)
+                          .arg(packetsLost);
+
+    _disconnectSwarmLinks();
+
+    // With simulated loss or jitter a vehicle may legitimately not finish connecting in time, that is a result to
+    // report, not a failure
+    if (loss == 0 && jitterMSecs == 0) {
+        QCOMPARE(connectedCount, vehicles);
+    } else if (connectedCount != vehicles) {
+        qWarning() << "MockLinkSwarmBenchmark: vehicles not connected within wait" << connectedCount << vehicles;
+    }
+    QVERIFY(_messagesReceived > 0);
+}
+
+void MockLinkSwarmBenchmark::_messageReceived(LinkInterface* link, MAVLinkMessageHandle message)
+{
+    Q_UNUSED(link);
+    Q_UNUSED(message);
+    _messagesReceived++;
+}
+
+void MockLinkSwarmBenchmark::_disconnectSwarmLinks(void)
+{
+    LinkManager* linkManager = qgcApp()->toolbox()->linkManager();
+
+    for (MockLink* link: _swarmLinks) {
+        QSignalSpy linkSpy(linkManager, SIGNAL(linkDeleted(LinkInterface*)));
+        linkManager->disconnectLink(link);
+        linkSpy.wait(1000);
+    }
+    _swarmLinks.clear();
+
+    // Let the vehicles go away before the next row
+    QTest::qWait(500);
+}
+
+/// @return CPU time used by the calling thread, -1 if not supported on this platform
+qint64 MockLinkSwarmBenchmark::_threadCpuNSecs(void)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return static_cast<qint64>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+#elif defined(Q_OS_WIN)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        // FILETIME is in 100ns units
+        const quint64 kernel    = (static_cast<quint64>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+        const quint64 user      = (static_cast<quint64>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+        return static_cast<qint64>((kernel + user) * 100);
+    }
+#endif
+    return -1;
+}
+
+quint64 MockLinkSwarmBenchmark::_residentBytes(void)
+{
+#if defined(Q_OS_LINUX)
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (statm.open(QIODevice::ReadOnly)) {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.count() > 1) {
+            return fields[1].toULongLong() * static_cast<quint64>(sysconf(_SC_PAGESIZE));
+        }
+    }
+#elif defined(Q_OS_MAC)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t      count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return info.resident_size;
+    }
+#endif
+    return 0;
+}
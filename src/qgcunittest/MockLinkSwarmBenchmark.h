@@ -0,0 +1,59 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "MAVLinkMessageHandle.h"
+
+class MockLink;
+
+/// Headless load test which connects a swarm of simulated vehicles spread across one or more MockLinks and measures
+/// the memory used by QGC and the CPU used by the GUI thread while the swarm runs. The GUI thread is where the
+/// protocol, vehicles and UI work happens; the MockLink threads simulating the swarm are not counted.
+///
+/// The data rows can be overridden from the environment:
+///     QGC_SWARM_BENCH_VEHICLES        Total number of simulated vehicles (max 254)
+///     QGC_SWARM_BENCH_LINKS           Number of links the vehicles are spread across
+///     QGC_SWARM_BENCH_RATE            Telemetry rate per vehicle in Hz
+///     QGC_SWARM_BENCH_MIX             Message mix: minimal, standard, heavy
+///     QGC_SWARM_BENCH_LOSS            Packet loss percentage
+///     QGC_SWARM_BENCH_JITTER_MSECS    Maximum random packet delay
+///     QGC_SWARM_BENCH_DURATION_MSECS  Length of the measurement once all vehicles are up
+///
+/// Run with: QGroundControl --unittest:MockLinkSwarmBenchmark
+class MockLinkSwarmBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MockLinkSwarmBenchmark(void);
+
+private slots:
+    void _swarm_test_data   (void);
+    void _swarm_test        (void);
+
+    void _messageReceived   (LinkInterface* link, MAVLinkMessageHandle message);
+
+private:
+    void            _disconnectSwarmLinks   (void);
+    static quint64  _residentBytes          (void);
+    static qint64   _threadCpuNSecs         (void);
+
+    QList<MockLink*>    _swarmLinks;
+    quint64             _messagesReceived;
+
+    static const char*  _vehiclesEnvKey;
+    static const char*  _linksEnvKey;
+    static const char*  _rateEnvKey;
+    static const char*  _mixEnvKey;
+    static const char*  _lossEnvKey;
+    static const char*  _jitterEnvKey;
+    static const char*  _durationEnvKey;
+};
@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryLogWriterTest.h"
+#include "TelemetryLogWriter.h"
+
+#include <QTemporaryFile>
+#include <QtEndian>
+
+void TelemetryLogWriterTest::_recordFormat_test(void)
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    TelemetryLogWriter writer;
+    writer.startWriting(&file);
+    QVERIFY(writer.writing());
+
+    const uint8_t packet[] = { 0xFD, 0x01, 0x02, 0x03 };
+    QVERIFY(writer.enqueue(0x0102030405060708ULL, packet, sizeof(packet)));
+    QVERIFY(writer.enqueue(42, packet, 2));
+
+    writer.stopWriting();
+    QVERIFY(!writer.writing());
+
+    TelemetryLogWriter::Stats_t stats = writer.stats();
+    QCOMPARE(stats.bytesQueued,     static_cast<quint64>(0));
+    QCOMPARE(stats.bytesWritten,    static_cast<quint64>(8 + sizeof(packet) + 8 + 2));
+    QCOMPARE(stats.recordsQueued,   static_cast<quint64>(2));
+    QCOMPARE(stats.recordsDropped,  static_cast<quint64>(0));
+    QVERIFY(stats.syncCount > 0);
+
+    QVERIFY(file.seek(0));
+    QByteArray bytes = file.readAll();
+    QCOMPARE(bytes.count(), static_cast<int>(stats.bytesWritten));
+
+    // Big endian timestamp followed by the raw packet
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(bytes.constData());
+    QCOMPARE(qFromBigEndian<quint64>(data), 0x0102030405060708ULL);
+    QVERIFY(memcmp(data + 8, packet, sizeof(packet)) == 0);
+    QCOMPARE(qFromBigEndian<quint64>(data + 8 + sizeof(packet)), static_cast<quint64>(42));
+    QVERIFY(memcmp(data + 8 + sizeof(packet) + 8, packet, 2) == 0);
+}
+
+void TelemetryLogWriterTest::_ringWrap_test(void)
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    TelemetryLogWriter writer;
+    writer.startWriting(&file);
+
+    // Push well past the ring size such that records straddle the wrap point
+    const int       packetSize  = 280;
+    const quint64   recordCount = (8 * 1024 * 1024) / (packetSize + 8);
+    quint64         accepted    = 0;
+    QByteArray      packet(packetSize, 0);
+    for (quint64 i=0; i<recordCount; i++) {
+        memset(packet.data(), static_cast<int>(i & 0xFF), packetSize);
+        if (writer.enqueue(i, reinterpret_cast<const uint8_t*>(packet.constData()), packetSize)) {
+            accepted++;
+        }
+    }
+    writer.stopWriting();
+
+    TelemetryLogWriter::Stats_t stats = writer.stats();
+    QCOMPARE(accepted + stats.recordsDropped, recordCount);
+    QCOMPARE(stats.recordsQueued, accepted);
+    QCOMPARE(stats.bytesWritten, accepted * (packetSize + 8));
+    QCOMPARE(static_cast<quint64>(file.size()), stats.bytesWritten);
+
+    // Every record which made it to disk must be intact
+    QVERIFY(file.seek(0));
+    QByteArray bytes = file.readAll();
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(bytes.constData());
+    for (quint64 i=0; i<accepted; i++) {
+        const uint8_t*  record      = data + i * (packetSize + 8);
+        quint64         timestamp   = qFromBigEndian<quint64>(record);
+        QCOMPARE(record[8], static_cast<uint8_t>(timestamp & 0xFF));
+        QCOMPARE(record[8 + packetSize - 1], static_cast<uint8_t>(timestamp & 0xFF));
+    }
+}
+
+void TelemetryLogWriterTest::_emptyCompressed_test(void)
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    TelemetryLogWriter writer;
+    writer.startWriting(&file, true /* compressed */);
+    writer.stopWriting();
+
+    // A compressed log without packets is not empty on disk, the record count is what tells it apart
+    QVERIFY(file.size() > 0);
+    QCOMPARE(writer.stats().recordsQueued, static_cast<quint64>(0));
+
+    // Counts start over with the next file
+    QTemporaryFile nextFile;
+    QVERIFY(nextFile.open());
+    const uint8_t packet[] = { 0xFD, 0x01 };
+    writer.startWriting(&nextFile, true /* compressed */);
+    QVERIFY(writer.enqueue(1, packet, sizeof(packet)));
+    writer.stopWriting();
+    QCOMPARE(writer.stats().recordsQueued, static_cast<quint64>(1));
+}
@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for TelemetryLogWriter
+class TelemetryLogWriterTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TelemetryLogWriterTest(void) { }
+
+private slots:
+    void _recordFormat_test (void);
+    void _ringWrap_test     (void);
+    void _emptyCompressed_test(void);
+};
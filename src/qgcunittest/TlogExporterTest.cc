@@ -0,0 +1,229 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogExporterTest.h"
+#include "TlogTestWriter.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+const int TlogExporterTest::_recordCount;
+
+/// Writes a log with a mix of scalar, array and string messages. Some timestamps contain packet start bytes which
+/// chunks must not sync onto.
+///     @param junk true: Separate some records with junk, after which replay loses sync for a while
+void TlogExporterTest::_writeLog(const QString& logFilename, bool junk)
+{
+    TlogTestWriter  writer;
+    uint8_t         mavlinkChannel = writer.mavlinkChannel();
+
+    QVERIFY(mavlinkChannel != 0);
+    QVERIFY(writer.open(logFilename));
+
+    _msgCounts.clear();
+    _systemTimeTimestamps.clear();
+
+    quint64 timestamp = TlogTestWriter::hoursAgoUSecs(1);
+    for (int i=0; i<_recordCount; i++) {
+        mavlink_message_t msg;
+        switch (i % 5) {
+        case 0:
+            mavlink_msg_heartbeat_pack_chan(1, 1, mavlinkChannel, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+            break;
+        case 1:
+            mavlink_msg_system_time_pack_chan(1, 1, mavlinkChannel, &msg, timestamp, static_cast<uint32_t>(i));
+            _systemTimeTimestamps.append(timestamp);
+            break;
+        case 2:
+            mavlink_msg_attitude_pack_chan(1, 1, mavlinkChannel, &msg, static_cast<uint32_t>(i), 0.5f, -0.25f, 3.0f * i, 0, 0, 0);
+            break;
+        case 3:
+        {
+            uint8_t prn[20] = { 1, 2, 3 };
+            uint8_t used[20] = { 1, 0, 1 };
+            uint8_t elevation[20] = { 10, 20, 30 };
+            uint8_t azimuth[20] = { 100, 200, 250 };
+            uint8_t snr[20] = { 40, 41, static_cast<uint8_t>(i) };
+            mavlink_msg_gps_status_pack_chan(1, 1, mavlinkChannel, &msg, 3, prn, used, elevation, azimuth, snr);
+            break;
+        }
+        case 4:
+            mavlink_msg_statustext_pack_chan(1, 1, mavlinkChannel, &msg, MAV_SEVERITY_INFO, "Say \"hello\", world", 0, 0);
+            break;
+        }
+        _msgCounts[msg.msgid]++;
+
+        // Low byte of the timestamp is a mavlink 2 start byte every so often
+        quint64 recordTimestamp = (i % 7 == 0) ? ((timestamp & ~0xFFULL) | MAVLINK_STX) : timestamp;
+        if (msg.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
+            _systemTimeTimestamps.last() = recordTimestamp;
+        }
+
+        writer.write(recordTimestamp, msg);
+        if (junk && i % 97 == 0) {
+            writer.writeBytes(QByteArray(13, static_cast<char>(MAVLINK_STX)));
+        }
+
+        timestamp += 1000;
+    }
+}
+
+bool TlogExporterTest::_export(const QString& logFilename, const QString& outputDirectory, TlogExporter::Format_t format, qint64 chunkSize, int threadCount, TlogExporter::Stats_t* stats)
+{
+    TlogExporter exporter(logFilename, outputDirectory);
+    QSignalSpy spyFinished(&exporter, &TlogExporter::exportFinished);
+
+    exporter.setFormat(format);
+    exporter.setChunkSize(chunkSize);
+    exporter.setThreadCount(threadCount);
+    exporter.startExport();
+    if (!exporter.wait(60000) || spyFinished.count() != 1 || !spyFinished[0][0].toBool()) {
+        return false;
+    }
+    if (stats) {
+        *stats = exporter.stats();
+    }
+    return true;
+}
+
+void TlogExporterTest::_chunking_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("chunking.tlog"));
+    _writeLog(logFilename, true /* junk */);
+
+    // A single chunk is a plain sequential pass, every other chunking must produce exactly the same output
+    QString referenceDir = tempDir.filePath(QStringLiteral("reference"));
+    TlogExporter::Stats_t stats;
+    QVERIFY(_export(logFilename, referenceDir, TlogExporter::FormatCSV, QFileInfo(logFilename).size(), 1, &stats));
+    QCOMPARE(stats.chunkCount,          1);
+    QCOMPARE(stats.resyncCount,         0);
+    QCOMPARE(stats.bytesProcessed,      QFileInfo(logFilename).size());
+    QVERIFY(stats.messageCount > static_cast<quint64>(_recordCount / 2));
+    QVERIFY(stats.bytesPerSecond > 0);
+    const quint64 referenceMessageCount = stats.messageCount;
+
+    QStringList referenceFiles = QDir(referenceDir).entryList(QDir::Files, QDir::Name);
+    QCOMPARE(referenceFiles.count(), stats.messageTypeCount);
+
+    for (qint64 chunkSize: { 7, 61, 1000, 64 * 1024 }) {
+        QString chunkedDir = tempDir.filePath(QStringLiteral("chunked%1").arg(chunkSize));
+        QVERIFY(_export(logFilename, chunkedDir, TlogExporter::FormatCSV, chunkSize, 4, &stats));
+        QCOMPARE(stats.messageCount, referenceMessageCount);
+        QCOMPARE(QDir(chunkedDir).entryList(QDir::Files, QDir::Name), referenceFiles);
+        for (const QString& filename: referenceFiles) {
+            QFile referenceFile(QDir(referenceDir).filePath(filename));
+            QFile chunkedFile(QDir(chunkedDir).filePath(filename));
+            QVERIFY(referenceFile.open(QFile::ReadOnly));
+            QVERIFY(chunkedFile.open(QFile::ReadOnly));
+            QVERIFY2(referenceFile.readAll() == chunkedFile.readAll(), qPrintable(QStringLiteral("%1 chunk size %2").arg(filename).arg(chunkSize)));
+        }
+    }
+}
+
+void TlogExporterTest::_csv_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("csv.tlog"));
+    QString         outputDir = tempDir.filePath(QStringLiteral("csv"));
+    _writeLog(logFilename, false /* junk */);
+
+    TlogExporter::Stats_t stats;
+    QVERIFY(_export(logFilename, outputDir, TlogExporter::FormatCSV, 4096, 2, &stats));
+    QCOMPARE(stats.messageCount,        static_cast<quint64>(_recordCount));
+    QCOMPARE(stats.messageTypeCount,    _msgCounts.count());
+
+    // Chunk boundaries fall inside records and onto the start bytes planted in timestamps, none of which may need a
+    // chunk to be decoded again on a clean log
+    QVERIFY(stats.chunkCount > 10);
+    QCOMPARE(stats.resyncCount,         0);
+    TlogExporter::Stats_t smallChunkStats;
+    QVERIFY(_export(logFilename, tempDir.filePath(QStringLiteral("csv61")), TlogExporter::FormatCSV, 61, 4, &smallChunkStats));
+    QCOMPARE(smallChunkStats.messageCount,  static_cast<quint64>(_recordCount));
+    QCOMPARE(smallChunkStats.resyncCount,   0);
+
+    QFile gpsFile(QDir(outputDir).filePath(QStringLiteral("GPS_STATUS.csv")));
+    QVERIFY(gpsFile.open(QFile::ReadOnly));
+    QList<QByteArray> gpsLines = gpsFile.readAll().split('\n');
+    QCOMPARE(gpsLines.count(), _msgCounts[MAVLINK_MSG_ID_GPS_STATUS] + 2 /* header, trailing newline */);
+    QList<QByteArray> header = gpsLines[0].split(',');
+    QCOMPARE(header.mid(0, 4), QList<QByteArray>({ "timestamp_usec", "sysid", "compid", "satellites_visible" }));
+    QCOMPARE(header.count(), 4 + (5 * 20));
+    QVERIFY(header.contains("satellite_snr[2]"));
+    QList<QByteArray> row = gpsLines[1].split(',');
+    QCOMPARE(row.count(), header.count());
+    QCOMPARE(row[header.indexOf("satellite_prn[1]")],     QByteArray("2"));
+    QCOMPARE(row[header.indexOf("satellite_azimuth[2]")], QByteArray("250"));
+
+    QFile textFile(QDir(outputDir).filePath(QStringLiteral("STATUSTEXT.csv")));
+    QVERIFY(textFile.open(QFile::ReadOnly));
+    QList<QByteArray> textLines = textFile.readAll().split('\n');
+    QVERIFY(textLines[1].contains("\"Say \"\"hello\"\", world\""));
+
+    QFile systemTimeFile(QDir(outputDir).filePath(QStringLiteral("SYSTEM_TIME.csv")));
+    QVERIFY(systemTimeFile.open(QFile::ReadOnly));
+    QList<QByteArray> systemTimeLines = systemTimeFile.readAll().split('\n');
+    for (int i=0; i<_systemTimeTimestamps.count(); i++) {
+        QCOMPARE(systemTimeLines[i + 1].split(',')[0].toULongLong(), _systemTimeTimestamps[i]);
+    }
+}
+
+void TlogExporterTest::_binary_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("binary.tlog"));
+    QString         outputDir = tempDir.filePath(QStringLiteral("binary"));
+    _writeLog(logFilename, false /* junk */);
+
+    QVERIFY(_export(logFilename, outputDir, TlogExporter::FormatBinaryColumns, 4096, 3));
+
+    QFile file(QDir(outputDir).filePath(QStringLiteral("SYSTEM_TIME.%1").arg(TlogExporter::binaryColumnsExtension)));
+    QVERIFY(file.open(QFile::ReadOnly));
+    QByteArray bytes = file.readAll();
+    const char* data = bytes.constData();
+    const char* dataEnd = data + bytes.size();
+
+    QCOMPARE(QByteArray(data, 8), QByteArray("QGCCOLS1"));
+    quint32 columnCount = qFromLittleEndian<quint32>(data + 8);
+    QCOMPARE(columnCount, 3u + 2u /* time_unix_usec, time_boot_ms */);
+    data += 12;
+
+    QList<int> columnWidths;
+    QList<QByteArray> columnNames;
+    for (quint32 i=0; i<columnCount; i++) {
+        int type = static_cast<uint8_t>(data[0]);
+        int arrayLength = qFromLittleEndian<quint16>(data + 1);
+        int nameLength = qFromLittleEndian<quint16>(data + 3);
+        columnNames.append(QByteArray(data + 5, nameLength));
+        columnWidths.append((type == MAVLINK_TYPE_UINT64_T ? 8 : (type == MAVLINK_TYPE_UINT32_T ? 4 : 1)) * arrayLength);
+        data += 5 + nameLength;
+    }
+    QCOMPARE(columnNames[0], QByteArray("timestamp_usec"));
+    QVERIFY(columnNames.contains("time_unix_usec"));
+
+    // Walk the segments collecting the timestamp column
+    QList<quint64> timestamps;
+    int segmentCount = 0;
+    while (data < dataEnd) {
+        quint32 rowCount = qFromLittleEndian<quint32>(data);
+        data += 4;
+        for (quint32 row=0; row<rowCount; row++) {
+            timestamps.append(qFromLittleEndian<quint64>(data + (row * 8)));
+        }
+        for (int width: columnWidths) {
+            data += width * static_cast<int>(rowCount);
+        }
+        segmentCount++;
+    }
+    QVERIFY(data == dataEnd);
+    QVERIFY(segmentCount > 1);
+    QCOMPARE(timestamps, _systemTimeTimestamps);
+}
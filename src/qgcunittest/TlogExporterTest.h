@@ -0,0 +1,36 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "TlogExporter.h"
+
+/// Unit test for TlogExporter
+class TlogExporterTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TlogExporterTest(void) { }
+
+private slots:
+    void _chunking_test (void);
+    void _csv_test      (void);
+    void _binary_test   (void);
+
+private:
+    void _writeLog  (const QString& logFilename, bool junk);
+    bool _export    (const QString& logFilename, const QString& outputDirectory, TlogExporter::Format_t format, qint64 chunkSize, int threadCount, TlogExporter::Stats_t* stats = nullptr);
+
+    QMap<quint32, int>  _msgCounts;
+    QList<quint64>      _systemTimeTimestamps;
+
+    static const int _recordCount = 3000;
+};
@@ -0,0 +1,183 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogIndexTest.h"
+#include "TlogIndex.h"
+#include "TlogTestWriter.h"
+#include "LinkManager.h"
+#include "QGCApplication.h"
+
+#include <QTemporaryDir>
+
+const int TlogIndexTest::_messageCount;
+
+/// Writes a log with heartbeats interleaved with SYSTEM_TIME, a timestamp which goes backwards and a gap which is
+/// too large for a 32 bit delta.
+void TlogIndexTest::_writeLog(const QString& logFilename)
+{
+    TlogTestWriter  writer;
+    uint8_t         mavlinkChannel = writer.mavlinkChannel();
+    QVERIFY(mavlinkChannel != 0);
+    QVERIFY(writer.open(logFilename));
+
+    _offsets.clear();
+    _timestamps.clear();
+    _msgIds.clear();
+
+    quint64 timestamp = TlogTestWriter::hoursAgoUSecs(24);
+    quint64 lastTimestamp = 0;
+    for (int i=0; i<_messageCount; i++) {
+        quint64 recordTimestamp = timestamp;
+        if (i == 100) {
+            recordTimestamp -= 500;
+        } else if (i == 500) {
+            timestamp += 0x100000005ULL;
+            recordTimestamp = timestamp;
+        }
+
+        mavlink_message_t msg;
+        if (i % 3 == 0) {
+            mavlink_msg_system_time_pack_chan(1, 1, mavlinkChannel, &msg, recordTimestamp, static_cast<uint32_t>(i));
+        } else {
+            mavlink_msg_heartbeat_pack_chan(1, 1, mavlinkChannel, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+        }
+
+        _offsets.append(writer.write(recordTimestamp, msg));
+        _timestamps.append(qMax(recordTimestamp, lastTimestamp));
+        _msgIds.append(msg.msgid);
+        lastTimestamp = _timestamps.last();
+
+        timestamp += 1000;
+    }
+}
+
+void TlogIndexTest::_seek_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("seek.tlog"));
+    LinkManager*    linkManager = qgcApp()->toolbox()->linkManager();
+    uint8_t         mavlinkChannel = static_cast<uint8_t>(linkManager->_reserveMavlinkChannel());
+    QVERIFY(mavlinkChannel != 0);
+
+    _writeLog(logFilename);
+
+    QString errorString;
+    TlogIndex index;
+    QVERIFY(!index.open(logFilename));
+    QVERIFY2(TlogIndex::build(logFilename, mavlinkChannel, errorString), qPrintable(errorString));
+    linkManager->_freeMavlinkChannel(mavlinkChannel);
+    QVERIFY(index.open(logFilename));
+    QVERIFY(index.isValid());
+
+    QCOMPARE(index.messageCount(),      static_cast<quint64>(_messageCount));
+    QCOMPARE(index.startTimeUSecs(),    _timestamps.first());
+    QCOMPARE(index.endTimeUSecs(),      _timestamps.last());
+
+    for (int i=0; i<_messageCount; i++) {
+        QCOMPARE(index.offsetAt(i),     _offsets[i]);
+        QCOMPARE(index.timestampAt(i),  _timestamps[i]);
+
+        // Seeking lands on the first message with that time, clamped timestamps can repeat
+        quint64 expectedIndex = static_cast<quint64>(_timestamps.indexOf(_timestamps[i]));
+        QCOMPARE(index.indexForTime(_timestamps[i]), expectedIndex);
+        if (i > 0 && _timestamps[i] != _timestamps[i - 1]) {
+            QCOMPARE(index.indexForTime(_timestamps[i] - 1), static_cast<quint64>(i));
+        }
+    }
+
+    // Out of range times clamp to the ends of the log
+    QCOMPARE(index.indexForTime(0),                         static_cast<quint64>(0));
+    QCOMPARE(index.indexForTime(_timestamps.last() + 1),    static_cast<quint64>(_messageCount - 1));
+}
+
+void TlogIndexTest::_msgId_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("msgid.tlog"));
+    LinkManager*    linkManager = qgcApp()->toolbox()->linkManager();
+    uint8_t         mavlinkChannel = static_cast<uint8_t>(linkManager->_reserveMavlinkChannel());
+    QVERIFY(mavlinkChannel != 0);
+
+    _writeLog(logFilename);
+
+    QString errorString;
+    QVERIFY2(TlogIndex::build(logFilename, mavlinkChannel, errorString), qPrintable(errorString));
+    linkManager->_freeMavlinkChannel(mavlinkChannel);
+
+    TlogIndex index;
+    QVERIFY(index.open(logFilename));
+
+    QList<quint32> expectedMsgIds = { MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_SYSTEM_TIME };
+    QCOMPARE(index.messageIds(), expectedMsgIds);
+    QCOMPARE(index.messageCount(MAVLINK_MSG_ID_SYSTEM_TIME),    static_cast<quint64>(_msgIds.count(MAVLINK_MSG_ID_SYSTEM_TIME)));
+    QCOMPARE(index.messageCount(MAVLINK_MSG_ID_HEARTBEAT),      static_cast<quint64>(_msgIds.count(MAVLINK_MSG_ID_HEARTBEAT)));
+    QCOMPARE(index.messageCount(MAVLINK_MSG_ID_ATTITUDE),       static_cast<quint64>(0));
+
+    for (int i=0; i<_messageCount; i++) {
+        for (quint32 msgId: expectedMsgIds) {
+            qint64 expectedNext = -1;
+            for (int j=i; j<_messageCount; j++) {
+                if (_msgIds[j] == msgId) {
+                    expectedNext = j;
+                    break;
+                }
+            }
+            qint64 expectedPrevious = -1;
+            for (int j=i-1; j>=0; j--) {
+                if (_msgIds[j] == msgId) {
+                    expectedPrevious = j;
+                    break;
+                }
+            }
+            QCOMPARE(index.nextMessageIndex(msgId, i),      expectedNext);
+            QCOMPARE(index.previousMessageIndex(msgId, i),  expectedPrevious);
+        }
+    }
+
+    QCOMPARE(index.nextMessageIndex(MAVLINK_MSG_ID_ATTITUDE, 0), static_cast<qint64>(-1));
+}
+
+void TlogIndexTest::_stale_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("stale.tlog"));
+    LinkManager*    linkManager = qgcApp()->toolbox()->linkManager();
+    uint8_t         mavlinkChannel = static_cast<uint8_t>(linkManager->_reserveMavlinkChannel());
+    QVERIFY(mavlinkChannel != 0);
+
+    _writeLog(logFilename);
+
+    QString errorString;
+    QVERIFY2(TlogIndex::build(logFilename, mavlinkChannel, errorString), qPrintable(errorString));
+
+    TlogIndex index;
+    QVERIFY(index.open(logFilename));
+    index.close();
+
+    // A log which changed after indexing must not use the old index
+    QFile logFile(logFilename);
+    QVERIFY(logFile.open(QFile::Append));
+    logFile.write(QByteArray(16, 0));
+    logFile.close();
+    QVERIFY(!index.open(logFilename));
+
+    QVERIFY2(TlogIndex::build(logFilename, mavlinkChannel, errorString), qPrintable(errorString));
+    QVERIFY(index.open(logFilename));
+    QCOMPARE(index.messageCount(), static_cast<quint64>(_messageCount));
+
+    // Empty logs can't be indexed
+    QString emptyFilename = tempDir.filePath(QStringLiteral("empty.tlog"));
+    QFile emptyFile(emptyFilename);
+    QVERIFY(emptyFile.open(QFile::WriteOnly));
+    emptyFile.close();
+    QVERIFY(!TlogIndex::build(emptyFilename, mavlinkChannel, errorString));
+    QVERIFY(!errorString.isEmpty());
+
+    linkManager->_freeMavlinkChannel(mavlinkChannel);
+}
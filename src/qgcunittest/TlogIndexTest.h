@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for TlogIndex
+class TlogIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TlogIndexTest(void) { }
+
+private slots:
+    void _seek_test     (void);
+    void _msgId_test    (void);
+    void _stale_test    (void);
+
+private:
+    void _writeLog(const QString& logFilename);
+
+    QList<qint64>   _offsets;
+    QList<quint64>  _timestamps;    ///< Monotonic timestamps as the index should report them
+    QList<quint32>  _msgIds;
+
+    static const int _messageCount = 1000;
+};
@@ -0,0 +1,195 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogSearchIndexTest.h"
+#include "TlogTestWriter.h"
+#include "AppSettings.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+const int       TlogSearchIndexTest::_recordCount;
+const quint64   TlogSearchIndexTest::_startUSecs;
+const quint64   TlogSearchIndexTest::_hourUSecs;
+
+/// Writes a log of one vehicle which arms a third of the way in, disarms two thirds of the way in and reaches
+/// maxGroundSpeed half way through. A GCS heartbeat is mixed in which must not show up as a vehicle.
+void TlogSearchIndexTest::_writeLog(const QString& logFilename, uint8_t systemId, quint64 startUSecs, float maxGroundSpeed, bool append)
+{
+    TlogTestWriter  writer;
+    uint8_t         mavlinkChannel = writer.mavlinkChannel();
+
+    QVERIFY(mavlinkChannel != 0);
+    QVERIFY(writer.open(logFilename, append));
+
+    quint64 timestamp = startUSecs;
+    for (int i=0; i<_recordCount; i++) {
+        mavlink_message_t msg;
+        switch (i % 4) {
+        case 0:
+        {
+            uint8_t baseMode = (i >= _recordCount / 3 && i < (_recordCount * 2) / 3) ? MAV_MODE_FLAG_SAFETY_ARMED : 0;
+            mavlink_msg_heartbeat_pack_chan(systemId, 1, mavlinkChannel, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, baseMode, 0, MAV_STATE_ACTIVE);
+            break;
+        }
+        case 1:
+            mavlink_msg_heartbeat_pack_chan(255, MAV_COMP_ID_MISSIONPLANNER, mavlinkChannel, &msg, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, MAV_STATE_ACTIVE);
+            break;
+        case 2:
+        {
+            float groundSpeed = (i == (_recordCount / 2) + 2) ? maxGroundSpeed : 1.0f;
+            mavlink_msg_vfr_hud_pack_chan(systemId, 1, mavlinkChannel, &msg, 0, groundSpeed, 0, 0, 10.0f + i, 0);
+            break;
+        }
+        case 3:
+            if (i == _recordCount - 1) {
+                mavlink_msg_statustext_pack_chan(systemId, 1, mavlinkChannel, &msg, MAV_SEVERITY_CRITICAL, "Failsafe: RC 100% lost", 0, 0);
+            } else {
+                mavlink_msg_sys_status_pack_chan(systemId, 1, mavlinkChannel, &msg, 0, 0, 0, 0, 12600, -1, -1, 0, 0, 0, 0, 0, 0);
+            }
+            break;
+        }
+
+        writer.write(timestamp, msg);
+        timestamp += 1000;
+    }
+}
+
+bool TlogSearchIndexTest::_index(TlogSearchIndex& index, const QString& directory, int& logsIndexed, int& logsRemoved)
+{
+    QSignalSpy spyFinished(&index, &TlogSearchIndex::indexingFinished);
+
+    index.startIndexing(directory);
+    if (!index.wait(60000) || spyFinished.count() != 1 || !spyFinished[0][0].toBool()) {
+        return false;
+    }
+    logsIndexed = spyFinished[0][1].toInt();
+    logsRemoved = spyFinished[0][2].toInt();
+    return true;
+}
+
+void TlogSearchIndexTest::_query_test(void)
+{
+    QTemporaryDir   tempDir;
+    QDir            logDir(tempDir.filePath(QStringLiteral("logs")));
+    QVERIFY(logDir.mkpath(QStringLiteral(".")));
+
+    _writeLog(logDir.filePath(QStringLiteral("a.tlog")), 7, _startUSecs,                 35.0f);
+    _writeLog(logDir.filePath(QStringLiteral("b.tlog")), 7, _startUSecs + _hourUSecs,    20.0f);
+    _writeLog(logDir.filePath(QStringLiteral("c.tlog")), 3, _startUSecs + 2 * _hourUSecs, 40.0f);
+    QFile notLog(logDir.filePath(QStringLiteral("notes.txt")));
+    QVERIFY(notLog.open(QFile::WriteOnly));
+    notLog.close();
+    // Unreadable logs are skipped and not counted as indexed
+    QFile brokenLog(logDir.filePath(QStringLiteral("broken.%1").arg(AppSettings::telemetryCompressedFileExtension)));
+    QVERIFY(brokenLog.open(QFile::WriteOnly));
+    brokenLog.write("not a compressed tlog");
+    brokenLog.close();
+
+    TlogSearchIndex index(tempDir.filePath(QStringLiteral("index.db")));
+    QVERIFY(index.isValid());
+    int logsIndexed, logsRemoved;
+    QVERIFY(_index(index, logDir.absolutePath(), logsIndexed, logsRemoved));
+    QCOMPARE(logsIndexed, 3);
+    QCOMPARE(logsRemoved, 0);
+
+    // Newest first
+    QList<TlogSearchIndex::Log_t> logs = index.logs();
+    QCOMPARE(logs.count(), 3);
+    QCOMPARE(logs[0].path,              logDir.absoluteFilePath(QStringLiteral("c.tlog")));
+    QCOMPARE(logs[2].path,              logDir.absoluteFilePath(QStringLiteral("a.tlog")));
+    QCOMPARE(logs[2].startTimeUSecs,    _startUSecs);
+    QCOMPARE(logs[2].endTimeUSecs,      _startUSecs + (_recordCount - 1) * 1000);
+    QCOMPARE(logs[2].messageCount,      static_cast<quint64>(_recordCount));
+
+    // GCS heartbeats are not vehicles
+    QCOMPARE(index.vehicles().count(), 3);
+    QList<TlogSearchIndex::Vehicle_t> vehicles = index.vehicles(7);
+    QCOMPARE(vehicles.count(), 2);
+    QCOMPARE(vehicles[0].vehicleType,   static_cast<int>(MAV_TYPE_QUADROTOR));
+    QCOMPARE(vehicles[0].autopilot,     static_cast<int>(MAV_AUTOPILOT_PX4));
+
+    QList<TlogSearchIndex::Arming_t> armings = index.armingIntervals(3);
+    QCOMPARE(armings.count(), 1);
+    QCOMPARE(armings[0].armedUSecs,     _startUSecs + 2 * _hourUSecs + 200 * 1000);
+    QCOMPARE(armings[0].disarmedUSecs,  _startUSecs + 2 * _hourUSecs + 400 * 1000);
+
+    // Case insensitive and '%' is not a wildcard
+    QCOMPARE(index.findStatusText(QStringLiteral("FAILSAFE")).count(), 3);
+    QCOMPARE(index.findStatusText(QStringLiteral("100% lost"), 3).count(), 1);
+    QCOMPARE(index.findStatusText(QStringLiteral("100%% lost")).count(), 0);
+    QCOMPARE(index.findStatusText(QStringLiteral("failsafe"), 3)[0].severity, static_cast<int>(MAV_SEVERITY_CRITICAL));
+
+    // When did vehicle 7 last go faster than 30 m/s
+    QList<TlogSearchIndex::FieldRange_t> fast = index.findFieldAbove(QStringLiteral("VFR_HUD.groundspeed"), 30.0, 7);
+    QCOMPARE(fast.count(), 1);
+    QCOMPARE(fast[0].path,          logDir.absoluteFilePath(QStringLiteral("a.tlog")));
+    QCOMPARE(fast[0].maxValue,      35.0);
+    QCOMPARE(fast[0].maxTimeUSecs,  _startUSecs + 302 * 1000);
+    QCOMPARE(index.findFieldAbove(QStringLiteral("VFR_HUD.groundspeed"), 30.0).count(), 2);
+
+    QList<TlogSearchIndex::FieldRange_t> low = index.findFieldBelow(QStringLiteral("SYS_STATUS.voltage_battery"), 13.0);
+    QCOMPARE(low.count(), 3);
+    QCOMPARE(low[0].minValue, 12.6);
+    QCOMPARE(index.findFieldBelow(QStringLiteral("SYS_STATUS.voltage_battery"), 12.0).count(), 0);
+
+    // battery_remaining of -1 is not a value
+    QStringList fields;
+    for (const TlogSearchIndex::FieldRange_t& range: index.fieldRanges(logDir.filePath(QStringLiteral("b.tlog")))) {
+        fields.append(range.field);
+        QVERIFY(TlogSearchIndex::fieldNames().contains(range.field));
+    }
+    QVERIFY(fields.contains(QStringLiteral("VFR_HUD.alt")));
+    QVERIFY(!fields.contains(QStringLiteral("SYS_STATUS.battery_remaining")));
+}
+
+void TlogSearchIndexTest::_incremental_test(void)
+{
+    QTemporaryDir   tempDir;
+    QDir            logDir(tempDir.filePath(QStringLiteral("logs")));
+    QString         databasePath = tempDir.filePath(QStringLiteral("index.db"));
+    QVERIFY(logDir.mkpath(QStringLiteral(".")));
+
+    _writeLog(logDir.filePath(QStringLiteral("a.tlog")), 1, _startUSecs,                 10.0f);
+    _writeLog(logDir.filePath(QStringLiteral("b.tlog")), 2, _startUSecs + _hourUSecs,    10.0f);
+
+    int logsIndexed, logsRemoved;
+    {
+        TlogSearchIndex index(databasePath);
+        QVERIFY(_index(index, logDir.absolutePath(), logsIndexed, logsRemoved));
+        QCOMPARE(logsIndexed, 2);
+    }
+
+    // Index persists and nothing changed
+    TlogSearchIndex index(databasePath);
+    QVERIFY(_index(index, logDir.absolutePath(), logsIndexed, logsRemoved));
+    QCOMPARE(logsIndexed, 0);
+    QCOMPARE(logsRemoved, 0);
+    QCOMPARE(index.logs().count(), 2);
+
+    // Only the changed log is read again and its old rows are replaced
+    _writeLog(logDir.filePath(QStringLiteral("b.tlog")), 2, _startUSecs + 2 * _hourUSecs, 50.0f, true /* append */);
+    QVERIFY(_index(index, logDir.absolutePath(), logsIndexed, logsRemoved));
+    QCOMPARE(logsIndexed, 1);
+    QCOMPARE(logsRemoved, 0);
+    QCOMPARE(index.logs().count(), 2);
+    QCOMPARE(index.vehicles(2).count(), 1);
+    QCOMPARE(index.armingIntervals(2).count(), 2);
+    QCOMPARE(index.findFieldAbove(QStringLiteral("VFR_HUD.groundspeed"), 30.0).count(), 1);
+
+    QVERIFY(QFile::remove(logDir.filePath(QStringLiteral("a.tlog"))));
+    QVERIFY(_index(index, logDir.absolutePath(), logsIndexed, logsRemoved));
+    QCOMPARE(logsIndexed, 0);
+    QCOMPARE(logsRemoved, 1);
+    QCOMPARE(index.logs().count(), 1);
+    QCOMPARE(index.vehicles(1).count(), 0);
+    QCOMPARE(index.findStatusText(QStringLiteral("failsafe")).count(), 2);
+}
@@ -0,0 +1,34 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "TlogSearchIndex.h"
+
+/// Unit test for TlogSearchIndex
+class TlogSearchIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TlogSearchIndexTest(void) { }
+
+private slots:
+    void _query_test        (void);
+    void _incremental_test  (void);
+
+private:
+    void _writeLog  (const QString& logFilename, uint8_t systemId, quint64 startUSecs, float maxGroundSpeed, bool append = false);
+    bool _index     (TlogSearchIndex& index, const QString& directory, int& logsIndexed, int& logsRemoved);
+
+    static const int        _recordCount = 600;
+    static const quint64    _startUSecs = 1500000000000000ULL;
+    static const quint64    _hourUSecs = 60ULL * 60ULL * 1000000ULL;
+};
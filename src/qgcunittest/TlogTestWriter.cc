@@ -0,0 +1,57 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogTestWriter.h"
+#include "TlogIndex.h"
+#include "LinkManager.h"
+#include "QGCApplication.h"
+#include "QGC.h"
+
+#include <QtEndian>
+
+TlogTestWriter::TlogTestWriter(void)
+    : _mavlinkChannel(static_cast<uint8_t>(qgcApp()->toolbox()->linkManager()->_reserveMavlinkChannel()))
+{
+
+}
+
+TlogTestWriter::~TlogTestWriter()
+{
+    _logFile.close();
+    if (_mavlinkChannel != 0) {
+        qgcApp()->toolbox()->linkManager()->_freeMavlinkChannel(_mavlinkChannel);
+    }
+}
+
+bool TlogTestWriter::open(const QString& logFilename, bool append)
+{
+    _logFile.close();
+    _logFile.setFileName(logFilename);
+    return _logFile.open(append ? (QFile::WriteOnly | QFile::Append) : (QFile::WriteOnly | QFile::Truncate));
+}
+
+qint64 TlogTestWriter::write(quint64 timestampUSecs, const mavlink_message_t& message)
+{
+    qint64 offset = _logFile.pos();
+    _logFile.write(record(timestampUSecs, message));
+    return offset;
+}
+
+QByteArray TlogTestWriter::record(quint64 timestampUSecs, const mavlink_message_t& message)
+{
+    uint8_t buffer[TlogIndex::cbTimestamp + MAVLINK_MAX_PACKET_LEN];
+    qToBigEndian(timestampUSecs, buffer);
+    int cBuffer = mavlink_msg_to_send_buffer(buffer + TlogIndex::cbTimestamp, &message);
+    return QByteArray(reinterpret_cast<const char*>(buffer), TlogIndex::cbTimestamp + cBuffer);
+}
+
+quint64 TlogTestWriter::hoursAgoUSecs(int hours)
+{
+    return QGC::groundTimeUsecs() - (static_cast<quint64>(hours) * 60ULL * 60ULL * 1000000ULL);
+}
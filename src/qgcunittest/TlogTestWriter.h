@@ -0,0 +1,52 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include "QGCMAVLink.h"
+
+/// Writes telemetry logs for unit tests. Each record is a big endian timestamp followed by the packed message, the same
+/// layout MAVLinkProtocol writes. Messages should be packed on mavlinkChannel, which is reserved for the lifetime of
+/// the writer.
+class TlogTestWriter
+{
+public:
+    TlogTestWriter(void);
+    ~TlogTestWriter();
+
+    /// @return Channel to pack messages on, 0 if none could be reserved
+    uint8_t mavlinkChannel(void) const { return _mavlinkChannel; }
+
+    /// Opens the log for writing, a new log replaces any existing file
+    bool open(const QString& logFilename, bool append = false);
+
+    void close(void) { _logFile.close(); }
+
+    /// Writes a record to the open log
+    /// @return File offset of the record
+    qint64 write(quint64 timestampUSecs, const mavlink_message_t& message);
+
+    /// Writes bytes which are not a record, for example junk between records
+    void writeBytes(const QByteArray& bytes) { _logFile.write(bytes); }
+
+    /// @return Record as it is written to the log
+    static QByteArray record(quint64 timestampUSecs, const mavlink_message_t& message);
+
+    /// @return Unix time in microseconds the specified number of hours ago. Log timestamps must not be in the future,
+    ///         else they are read as old little endian timestamps.
+    static quint64 hoursAgoUSecs(int hours);
+
+private:
+    uint8_t _mavlinkChannel;
+    QFile   _logFile;
+};
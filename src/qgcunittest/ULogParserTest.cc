@@ -0,0 +1,370 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogParserTest.h"
+#include "ULogParser.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+const int ULogParserTest::_sensor0Count;
+const int ULogParserTest::_sensor1Count;
+const int ULogParserTest::_cameraCount;
+
+template<typename T>
+static void appendValue(QByteArray& bytes, T value)
+{
+    char buffer[sizeof(T)];
+    qToLittleEndian(value, buffer);
+    bytes.append(buffer, sizeof(T));
+}
+
+static void appendFloat(QByteArray& bytes, float value)
+{
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void appendDouble(QByteArray& bytes, double value)
+{
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+QByteArray ULogParserTest::_message(char msgType, const QByteArray& payload)
+{
+    QByteArray bytes;
+    appendValue<quint16>(bytes, static_cast<quint16>(payload.size()));
+    bytes.append(msgType);
+    bytes.append(payload);
+    return bytes;
+}
+
+QByteArray ULogParserTest::_keyValue(const QByteArray& key, const QByteArray& value)
+{
+    QByteArray payload;
+    payload.append(static_cast<char>(key.size()));
+    payload.append(key);
+    payload.append(value);
+    return payload;
+}
+
+/// sensor: timestamp, accel (vec3_s), gyro[2] (vec3_s), temp, name. Trailing padding is not logged.
+QByteArray ULogParserTest::_sensorData(uint16_t msgId, int i)
+{
+    QByteArray payload;
+    appendValue<quint16>(payload, msgId);
+    appendValue<quint64>(payload, static_cast<quint64>(i) * 1000);
+    for (int vec=0; vec<3; vec++) {
+        appendFloat(payload, vec == 0 ? static_cast<float>(i) : 0.0f);
+        appendFloat(payload, 0.0f);
+        appendFloat(payload, vec == 2 ? static_cast<float>(-i) : 0.0f);
+        payload.append(QByteArray(4, 0));   // vec3_s padding
+    }
+    appendValue<qint16>(payload, static_cast<qint16>(i - 50));
+    payload.append(QByteArray("imu0\0\0", 6));
+    return _message('D', payload);
+}
+
+QByteArray ULogParserTest::_cameraData(uint16_t msgId, uint32_t seq)
+{
+    QByteArray payload;
+    appendValue<quint16>(payload, msgId);
+    appendValue<quint64>(payload, 2000000 + seq * 1000000);
+    appendValue<quint64>(payload, 1600000000000000ULL + seq * 1000000);
+    appendValue<quint32>(payload, seq);
+    appendDouble(payload, 47.0 + seq);
+    appendDouble(payload, 190.0);
+    appendFloat(payload, 500.0f + seq);
+    appendFloat(payload, 20.0f);
+    for (int i=0; i<4; i++) {
+        appendFloat(payload, i == 0 ? 1.0f : 0.0f);
+    }
+    payload.append(static_cast<char>(1));
+    return _message('D', payload);
+}
+
+/// Writes a log with nested types, padding, two instances of the same topic, info and parameter messages, an unknown
+/// message type, a corrupt stretch followed by a sync message and a truncated last message.
+void ULogParserTest::_writeLog(const QString& logFilename)
+{
+    QByteArray log("ULog\x01\x12\x35", 7);
+    log.append(static_cast<char>(1));
+    appendValue<quint64>(log, 1234567);
+
+    log.append(_message('B', QByteArray(40, 0)));
+    log.append(_message('I', _keyValue("char[7] sys_name", "PX4_SIM")));
+    QByteArray swRelease;
+    appendValue<quint32>(swRelease, 0x01020300);
+    log.append(_message('I', _keyValue("uint32_t ver_sw_release", swRelease)));
+    QByteArray velMax;
+    appendFloat(velMax, 12.5f);
+    log.append(_message('P', _keyValue("float MPC_XY_VEL_MAX", velMax)));
+    log.append(_message('F', "vec3_s:float x;float y;float z;uint8_t[4] _padding0;"));
+    log.append(_message('F', "sensor:uint64_t timestamp;vec3_s accel;vec3_s[2] gyro;int16_t temp;char[6] name;uint8_t[2] _padding0;"));
+    log.append(_message('F', "camera_capture:uint64_t timestamp;uint64_t timestamp_utc;uint32_t seq;double lat;double lon;float alt;float ground_distance;float[4] q;int8_t result;"));
+
+    QByteArray addLogged;
+    addLogged.append(static_cast<char>(0));
+    appendValue<quint16>(addLogged, 0);
+    log.append(_message('A', addLogged + "sensor"));
+    addLogged.clear();
+    addLogged.append(static_cast<char>(1));
+    appendValue<quint16>(addLogged, 1);
+    log.append(_message('A', addLogged + "sensor"));
+    for (uint16_t msgId: { 2, 3 }) {
+        addLogged.clear();
+        addLogged.append(static_cast<char>(msgId - 2));
+        appendValue<quint16>(addLogged, msgId);
+        log.append(_message('A', addLogged + "camera_capture"));
+    }
+
+    // Parameter changes after logging starts are not initial values
+    QByteArray velMaxChanged;
+    appendFloat(velMaxChanged, 3.0f);
+
+    for (int i=0; i<_sensor0Count - 1; i++) {
+        log.append(_sensorData(0, i));
+        if (i < _sensor1Count) {
+            log.append(_sensorData(1, i));
+        }
+        if (i == 10) {
+            log.append(_message('P', _keyValue("float MPC_XY_VEL_MAX", velMaxChanged)));
+            QByteArray logging;
+            logging.append('6');
+            appendValue<quint64>(logging, 10000);
+            log.append(_message('L', logging + "Takeoff detected"));
+
+            // Data for a msg id which was never subscribed
+            QByteArray unknown;
+            appendValue<quint16>(unknown, 9);
+            log.append(_message('D', unknown + QByteArray(8, 0)));
+
+            // Message type from a newer logger, skipped by its size
+            log.append(_message('Y', QByteArray(16, 'y')));
+        }
+        if (i % 20 == 5 && i / 20 < _cameraCount) {
+            log.append(_cameraData(2 + ((i / 20) % 2), static_cast<uint32_t>(i / 20)));
+        }
+    }
+
+    // Corrupt data, then a sync message, then the last sensor message
+    log.append(QByteArray("\x05\x00\x01garbage\x12\x35", 12));
+    log.append(_message('S', QByteArray("\x2F\x73\x13\x20\x25\x0C\xBB\x12", 8)));
+    log.append(_sensorData(0, _sensor0Count - 1));
+
+    // Writer interrupted in the middle of a message
+    log.append(_sensorData(0, _sensor0Count).left(20));
+
+    QFile logFile(logFilename);
+    QVERIFY(logFile.open(QFile::WriteOnly | QFile::Truncate));
+    QCOMPARE(logFile.write(log), static_cast<qint64>(log.size()));
+}
+
+void ULogParserTest::_index_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("index.ulg"));
+    QString         errorMessage;
+    ULogParser      parser;
+    _writeLog(logFilename);
+
+    QVERIFY(parser.open(logFilename, errorMessage));
+    QVERIFY(errorMessage.isEmpty());
+    QVERIFY(parser.isOpen());
+    QVERIFY(parser.truncated());
+    QCOMPARE(parser.version(),          1);
+    QCOMPARE(parser.startTimeUSecs(),   static_cast<quint64>(1234567));
+
+    QCOMPARE(parser.infos()[QStringLiteral("sys_name")].toString(),                 QStringLiteral("PX4_SIM"));
+    QCOMPARE(parser.infos()[QStringLiteral("ver_sw_release")].toUInt(),             0x01020300u);
+    QCOMPARE(parser.parameters()[QStringLiteral("MPC_XY_VEL_MAX")].toDouble(),      12.5);
+
+    QCOMPARE(parser.formatNames(), QStringList({ QStringLiteral("camera_capture"), QStringLiteral("sensor"), QStringLiteral("vec3_s") }));
+    QCOMPARE(parser.subscriptions(QStringLiteral("sensor")),            QList<uint16_t>({ 0, 1 }));
+    QCOMPARE(parser.subscriptions(QStringLiteral("camera_capture")),    QList<uint16_t>({ 2, 3 }));
+    QCOMPARE(parser.subscription(1)->multiId, static_cast<uint8_t>(1));
+    QVERIFY(!parser.subscription(9));
+
+    // The last sensor message after the resync is found, the truncated one is not
+    QCOMPARE(parser.messageCount(0), _sensor0Count);
+    QCOMPARE(parser.messageCount(1), _sensor1Count);
+    QCOMPARE(parser.messageCount(2) + parser.messageCount(3), _cameraCount);
+
+    QCOMPARE(parser.findTimestamp(0, 0),        0);
+    QCOMPARE(parser.findTimestamp(0, 10000),    10);
+    QCOMPARE(parser.findTimestamp(0, 10500),    11);
+    QCOMPARE(parser.findTimestamp(0, 1000000),  _sensor0Count);
+
+    parser.close();
+    QVERIFY(!parser.isOpen());
+    QCOMPARE(parser.messageCount(0), 0);
+}
+
+void ULogParserTest::_fields_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("fields.ulg"));
+    QString         errorMessage;
+    ULogParser      parser;
+    _writeLog(logFilename);
+    QVERIFY(parser.open(logFilename, errorMessage));
+
+    // Nested types are flattened, padding inside nested types is part of the layout
+    const ULogParser::Format_t* sensorFormat = parser.format(QStringLiteral("sensor"));
+    QVERIFY(sensorFormat);
+    QCOMPARE(sensorFormat->fields.count(), 1 + 3 + 6 + 2);
+    QCOMPARE(parser.format(QStringLiteral("vec3_s"))->size, 16);
+    QVERIFY(!parser.field(QStringLiteral("sensor"), QStringLiteral("accel._padding0")));
+
+    const ULogParser::Field_t* timestampField   = parser.field(QStringLiteral("sensor"), QStringLiteral("timestamp"));
+    const ULogParser::Field_t* accelXField      = parser.field(QStringLiteral("sensor"), QStringLiteral("accel.x"));
+    const ULogParser::Field_t* gyroZField       = parser.field(QStringLiteral("sensor"), QStringLiteral("gyro[1].z"));
+    const ULogParser::Field_t* tempField        = parser.field(QStringLiteral("sensor"), QStringLiteral("temp"));
+    const ULogParser::Field_t* nameField        = parser.field(QStringLiteral("sensor"), QStringLiteral("name"));
+    QVERIFY(timestampField && accelXField && gyroZField && tempField && nameField);
+    QCOMPARE(accelXField->offset,   8);
+    QCOMPARE(gyroZField->offset,    48);
+    QCOMPARE(gyroZField->type,      ULogParser::TypeFloat);
+    QCOMPARE(tempField->offset,     56);
+    QCOMPARE(nameField->arraySize,  6);
+
+    for (int i: { 0, 10, _sensor0Count - 1 }) {
+        QCOMPARE(parser.value<quint64>(0, i, *timestampField),  static_cast<quint64>(i) * 1000);
+        QCOMPARE(parser.value<float>(0, i, *accelXField),       static_cast<float>(i));
+        QCOMPARE(parser.doubleValue(0, i, *gyroZField),         static_cast<double>(-i));
+        QCOMPARE(parser.value<qint16>(0, i, *tempField),        static_cast<qint16>(i - 50));
+        QCOMPARE(parser.stringValue(0, i, *nameField),          QStringLiteral("imu0"));
+    }
+    QCOMPARE(parser.doubleValue(1, _sensor1Count - 1, *accelXField), static_cast<double>(_sensor1Count - 1));
+
+    // Out of range access does not touch the log
+    QVERIFY(qIsNaN(parser.doubleValue(0, _sensor0Count, *accelXField)));
+    QVERIFY(qIsNaN(parser.doubleValue(0, 0, *nameField, 6)));
+    QCOMPARE(parser.value<quint64>(7, 0, *timestampField), static_cast<quint64>(0));
+}
+
+void ULogParserTest::_geotag_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("geotag.ulg"));
+    QString         errorMessage;
+    ULogParser      parser;
+    _writeLog(logFilename);
+    QVERIFY(parser.open(logFilename, errorMessage));
+
+    // Both camera_capture instances are merged in log order
+    QList<GeoTagWorker::cameraFeedbackPacket> cameraFeedback;
+    QVERIFY(parser.getTagsFromLog(cameraFeedback, errorMessage));
+    QCOMPARE(cameraFeedback.count(), _cameraCount);
+    for (int i=0; i<_cameraCount; i++) {
+        const GeoTagWorker::cameraFeedbackPacket& feedback = cameraFeedback[i];
+        QCOMPARE(feedback.imageSequence,            static_cast<uint32_t>(i));
+        QCOMPARE(feedback.timestamp,                2.0 + i);
+        QCOMPARE(feedback.timestampUTC,             1600000000.0 + i);
+        QCOMPARE(feedback.latitude,                 47.0 + i);
+        QCOMPARE(feedback.longitude,                -170.0);
+        QCOMPARE(feedback.altitude,                 500.0f + i);
+        QCOMPARE(feedback.groundDistance,           20.0f);
+        QCOMPARE(feedback.attitudeQuaternion[0],    1.0f);
+        QCOMPARE(feedback.captureResult,            static_cast<uint8_t>(1));
+    }
+}
+
+void ULogParserTest::_invalid_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         errorMessage;
+    ULogParser      parser;
+
+    QVERIFY(!parser.open(tempDir.filePath(QStringLiteral("missing.ulg")), errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+
+    QString notULogFilename = tempDir.filePath(QStringLiteral("notulog.ulg"));
+    QFile notULog(notULogFilename);
+    QVERIFY(notULog.open(QFile::WriteOnly));
+    notULog.write(QByteArray(64, 'x'));
+    notULog.close();
+    QVERIFY(!parser.open(notULogFilename, errorMessage));
+    QVERIFY(!parser.isOpen());
+
+    // Incompatible flag bits other than appended data
+    QString incompatFilename = tempDir.filePath(QStringLiteral("incompat.ulg"));
+    QByteArray log("ULog\x01\x12\x35\x01", 8);
+    log.append(QByteArray(8, 0));
+    QByteArray flagBits(40, 0);
+    flagBits[8] = 0x02;
+    log.append(_message('B', flagBits));
+    QFile incompatFile(incompatFilename);
+    QVERIFY(incompatFile.open(QFile::WriteOnly));
+    incompatFile.write(log);
+    incompatFile.close();
+    QVERIFY(!parser.open(incompatFilename, errorMessage));
+
+    // No camera_capture
+    QString emptyFilename = tempDir.filePath(QStringLiteral("empty.ulg"));
+    QFile emptyFile(emptyFilename);
+    QVERIFY(emptyFile.open(QFile::WriteOnly));
+    emptyFile.write(log.left(16));
+    emptyFile.close();
+    QVERIFY(parser.open(emptyFilename, errorMessage));
+    QList<GeoTagWorker::cameraFeedbackPacket> cameraFeedback;
+    QVERIFY(!parser.getTagsFromLog(cameraFeedback, errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+}
+
+void ULogParserTest::_appended_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath(QStringLiteral("appended.ulg"));
+    QString         errorMessage;
+    ULogParser      parser;
+    const int       originalCount = 10;
+    const int       appendedCount = 5;
+
+    QByteArray log("ULog\x01\x12\x35", 7);
+    log.append(static_cast<char>(1));
+    appendValue<quint64>(log, 0);
+
+    // The appended data offset is filled in once it is known
+    const int flagBitsOffset = log.size() + 3;
+    QByteArray flagBits(40, 0);
+    flagBits[8] = 0x01;
+    log.append(_message('B', flagBits));
+    log.append(_message('F', "vec3_s:float x;float y;float z;uint8_t[4] _padding0;"));
+    log.append(_message('F', "sensor:uint64_t timestamp;vec3_s accel;vec3_s[2] gyro;int16_t temp;char[6] name;uint8_t[2] _padding0;"));
+    QByteArray addLogged;
+    addLogged.append(static_cast<char>(0));
+    appendValue<quint16>(addLogged, 0);
+    log.append(_message('A', addLogged + "sensor"));
+
+    for (int i=0; i<originalCount; i++) {
+        log.append(_sensorData(0, i));
+    }
+
+    // Writer interrupted in the middle of a message, the logger continued with appended data after it. The header of
+    // the cut message claims more bytes than there are before the appended data.
+    log.append(_sensorData(0, originalCount).left(20));
+    QByteArray appendedOffset;
+    appendValue<quint64>(appendedOffset, static_cast<quint64>(log.size()));
+    log.replace(flagBitsOffset + 16, appendedOffset.size(), appendedOffset);
+    for (int i=0; i<appendedCount; i++) {
+        log.append(_sensorData(0, originalCount + 1 + i));
+    }
+
+    QFile logFile(logFilename);
+    QVERIFY(logFile.open(QFile::WriteOnly | QFile::Truncate));
+    QCOMPARE(logFile.write(log), static_cast<qint64>(log.size()));
+    logFile.close();
+
+    QVERIFY(parser.open(logFilename, errorMessage));
+    QVERIFY(!parser.truncated());
+    QCOMPARE(parser.messageCount(0), originalCount + appendedCount);
+    QCOMPARE(parser.findTimestamp(0, (originalCount - 1) * 1000),  originalCount - 1);
+    QCOMPARE(parser.findTimestamp(0, (originalCount + 1) * 1000),  originalCount);
+}
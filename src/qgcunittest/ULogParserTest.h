@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for ULogParser
+class ULogParserTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ULogParserTest(void) { }
+
+private slots:
+    void _index_test    (void);
+    void _fields_test   (void);
+    void _geotag_test   (void);
+    void _invalid_test  (void);
+    void _appended_test (void);
+
+private:
+    void        _writeLog       (const QString& logFilename);
+    QByteArray  _message        (char msgType, const QByteArray& payload);
+    QByteArray  _keyValue       (const QByteArray& key, const QByteArray& value);
+    QByteArray  _sensorData     (uint16_t msgId, int i);
+    QByteArray  _cameraData     (uint16_t msgId, uint32_t seq);
+
+    static const int _sensor0Count = 100;
+    static const int _sensor1Count = 50;
+    static const int _cameraCount = 4;
+};
@@ -57,9 +57,9 @@ UnitTest::~UnitTest()
     }
 }
 
-void UnitTest::_addTest(QObject* test)
+void UnitTest::_addTest(QObject* test, bool benchmark)
 {
-	QList<QObject*>& tests = _testList();
+	QList<QObject*>& tests = benchmark ? _benchmarkList() : _testList();
 
     Q_ASSERT(!tests.contains(test));
     
@@ -78,11 +78,23 @@ QList<QObject*>& UnitTest::_testList(void)
 	return tests;
 }
 
+/// @brief Returns the list of benchmarks, these are not part of a full unit test run.
+QList<QObject*>& UnitTest::_benchmarkList(void)
+{
+	static QList<QObject*> benchmarks;
+	return benchmarks;
+}
+
 int UnitTest::run(QString& singleTest)
 {
     int ret = 0;
     
-    for (QObject* test: _testList()) {
+    QList<QObject*> tests = _testList();
+    if (!singleTest.isEmpty()) {
+        tests += _benchmarkList();
+    }
+
+    for (QObject* test: tests) {
         if (singleTest.isEmpty() || singleTest == test->objectName()) {
             QStringList args;
             args << "*" << "-maxwarnings" << "0";
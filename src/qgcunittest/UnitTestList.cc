@@ -11,6 +11,7 @@
 // We keep the list of all unit tests in a global location so it's easier to see which
 // ones are enabled/disabled
 
+#include "FactGroupTest.h"
 #include "FactSystemTestGeneric.h"
 #include "FactSystemTestPX4.h"
 //#include "FileDialogTest.h"
@@ -24,14 +25,32 @@
 #include "MissionControllerTest.h"
 #include "MissionManagerTest.h"
 //#include "RadioConfigTest.h"
+#include "LinkSendQueueTest.h"
+#include "LinkStatisticsTest.h"
+#include "LogReplayLinkTest.h"
 #include "MavlinkLogTest.h"
+#include "MAVLinkHandlerStatsTest.h"
+#include "MAVLinkIngestBenchmark.h"
+#include "MAVLinkLogProcessorTest.h"
+#include "MAVLinkMessageHandleTest.h"
+#include "MockLinkSwarmBenchmark.h"
 //#include "MainWindowTest.h"
-//#include "FileManagerTest.h"
+#include "FileManagerTest.h"
 #include "TCPLinkTest.h"
+#include "TelemetryLogWriterTest.h"
+#include "TlogExporterTest.h"
+#include "TlogIndexTest.h"
+#include "TlogSearchIndexTest.h"
+#include "ULogParserTest.h"
+#include "ExifParserTest.h"
+#include "CompressedTlogTest.h"
+#include "ParameterDownloadEngineTest.h"
 #include "ParameterManagerTest.h"
 #include "MissionCommandTreeTest.h"
-//#include "LogDownloadTest.h"
+#include "LogDownloadTest.h"
 #include "SendMavCommandTest.h"
+#include "TelemetryHistoryTest.h"
+#include "TrajectoryPointsTest.h"
 #include "VisualMissionItemTest.h"
 #include "CameraSectionTest.h"
 #include "SpeedSectionTest.h"
@@ -46,12 +65,16 @@
 #include "CameraCalcTest.h"
 #include "FWLandingPatternTest.h"
 
+UT_REGISTER_TEST(FactGroupTest)
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
 //UT_REGISTER_TEST(FileDialogTest)
 //UT_REGISTER_TEST(FlightGearUnitTest)
 UT_REGISTER_TEST(GeoTest)
 UT_REGISTER_TEST(LinkManagerTest)
+UT_REGISTER_TEST(LinkSendQueueTest)
+UT_REGISTER_TEST(LinkStatisticsTest)
+UT_REGISTER_TEST(LogReplayLinkTest)
 //UT_REGISTER_TEST(MessageBoxTest)
 UT_REGISTER_TEST(MissionItemTest)
 UT_REGISTER_TEST(SimpleMissionItemTest)
@@ -59,11 +82,24 @@ UT_REGISTER_TEST(MissionControllerTest)
 UT_REGISTER_TEST(MissionManagerTest)
 //UT_REGISTER_TEST(RadioConfigTest)
 UT_REGISTER_TEST(TCPLinkTest)
-//UT_REGISTER_TEST(FileManagerTest)
+UT_REGISTER_TEST(TelemetryLogWriterTest)
+UT_REGISTER_TEST(TlogExporterTest)
+UT_REGISTER_TEST(TlogIndexTest)
+UT_REGISTER_TEST(TlogSearchIndexTest)
+UT_REGISTER_TEST(ULogParserTest)
+UT_REGISTER_TEST(ExifParserTest)
+UT_REGISTER_TEST(CompressedTlogTest)
+UT_REGISTER_TEST(MAVLinkMessageHandleTest)
+UT_REGISTER_TEST(MAVLinkHandlerStatsTest)
+UT_REGISTER_TEST(MAVLinkLogProcessorTest)
+UT_REGISTER_TEST(FileManagerTest)
+UT_REGISTER_TEST(ParameterDownloadEngineTest)
 UT_REGISTER_TEST(ParameterManagerTest)
 UT_REGISTER_TEST(MissionCommandTreeTest)
-//UT_REGISTER_TEST(LogDownloadTest)
+UT_REGISTER_TEST(LogDownloadTest)
 UT_REGISTER_TEST(SendMavCommandTest)
+UT_REGISTER_TEST(TelemetryHistoryTest)
+UT_REGISTER_TEST(TrajectoryPointsTest)
 UT_REGISTER_TEST(SurveyComplexItemTest)
 UT_REGISTER_TEST(CameraSectionTest)
 UT_REGISTER_TEST(SpeedSectionTest)
@@ -78,6 +114,10 @@ UT_REGISTER_TEST(QGCMapPolylineTest)
 UT_REGISTER_TEST(CameraCalcTest)
 UT_REGISTER_TEST(FWLandingPatternTest)
 
+// Benchmarks, only run when named explicitly: --unittest:<name>
+UT_REGISTER_BENCHMARK(MAVLinkIngestBenchmark)
+UT_REGISTER_BENCHMARK(MockLinkSwarmBenchmark)
+
 // List of unit test which are currently disabled.
 // If disabling a new test, include reason in comment.
 
@@ -20,14 +20,23 @@
 
 QGC_LOGGING_CATEGORY(FileManagerLog, "FileManagerLog")
 
+const int       FileManager::minWindowTimeoutMsecs;
+const uint32_t  FileManager::_blockSize;
+
 FileManager::FileManager(QObject* parent, Vehicle* vehicle)
     : QObject(parent)
     , _currentOperation(kCOIdle)
     , _vehicle(vehicle)
     , _dedicatedLink(nullptr)
     , _activeSession(0)
-    , _missingDownloadedBytes(0)
-    , _downloadingMissingParts(false)
+    , _writeFileSize(0)
+    , _downloadOffset(0)
+    , _downloadFileSize(0)
+    , _windowBlocksDoneCount(0)
+    , _windowNextBlock(0)
+    , _windowSize(initialWindowSize)
+    , _rttVarMsecs(0)
+    , _transferStats()
     , _systemIdQGC(0)
 {
     connect(&_ackTimer, &QTimer::timeout, this, &FileManager::_ackTimeout);
@@ -53,72 +62,323 @@ void FileManager::_openAckResponse(Request* openAck)
     Q_ASSERT(openAck->hdr.size == sizeof(uint32_t));
     _downloadFileSize = openAck->openFileLength;
     
-    // Start the sequence of read commands
+    _downloadOffset = 0;
+    _readFileAccumulator.fill(0, static_cast<int>(_downloadFileSize));
+
+    if (_currentOperation == kCORead) {
+        // Windowed reads, many blocks in flight
+        _windowStart(_downloadFileSize, true /* resetStats */);
+        return;
+    }
 
-    _downloadOffset = 0;            // Start reading at beginning of file
-    _readFileAccumulator.clear();   // Start with an empty file
-    _missingDownloadedBytes = 0;
-    _downloadingMissingParts = false;
-    _missingData.clear();
+    // Burst reads, the server streams the file. Anything the burst misses is repaired with windowed reads.
+    _windowBlocksDone = QBitArray(static_cast<int>((_downloadFileSize + _blockSize - 1) / _blockSize));
+    _windowBlocksDoneCount = 0;
+    _transferStats = TransferStats_t();
+    _transferTimer.start();
 
     Request request;
     request.hdr.session = _activeSession;
-	Q_ASSERT(_currentOperation == kCORead || _currentOperation == kCOBurst);
-	request.hdr.opcode = _currentOperation == kCORead ? kCmdReadFile : kCmdBurstReadFile;
+    request.hdr.opcode = kCmdBurstReadFile;
     request.hdr.offset = _downloadOffset;
     request.hdr.size = sizeof(request.data);
 
     _sendRequest(&request);
 }
 
-/// request the next missing part of a (partially) downloaded file
-void FileManager::_requestMissingData()
+/// Starts a windowed download (kCORead) or upload (kCOWrite) of the whole file
+///     @param resetStats false: continuing a burst download, only repairing what it missed
+void FileManager::_windowStart(uint32_t fileSize, bool resetStats)
 {
-    if (_missingData.empty()) {
-        _downloadingMissingParts = false;
-        _missingDownloadedBytes = 0;
-        // there might be more data missing at the end
-        if ((uint32_t)_readFileAccumulator.length() != _downloadFileSize) {
-            _downloadOffset = _readFileAccumulator.length();
-            qCDebug(FileManagerLog) << QString("_requestMissingData: missing parts done, downloadOffset(%1) downloadFileSize(%2)")
-                    .arg(_downloadOffset).arg(_downloadFileSize);
+    const int blockCount = static_cast<int>((fileSize + _blockSize - 1) / _blockSize);
+
+    if (resetStats) {
+        _windowBlocksDone = QBitArray(blockCount);
+        _windowBlocksDoneCount = 0;
+        _transferStats = TransferStats_t();
+        _transferTimer.start();
+    }
+    _windowRequests.clear();
+    _windowRepairBlocks.clear();
+    _windowRetries.clear();
+    _windowNextBlock = 0;
+    _windowSize = initialWindowSize;
+    _rttVarMsecs = 0;
+    _statsTimer.start();
+    _transferStats.windowSize = initialWindowSize;
+
+    if (!resetStats) {
+        // Only the blocks the burst missed
+        for (int block=0; block<blockCount; block++) {
+            if (!_windowBlocksDone.testBit(block)) {
+                _windowRepairBlocks.append(static_cast<uint32_t>(block));
+            }
+        }
+        _windowNextBlock = static_cast<uint32_t>(blockCount);
+        qCDebug(FileManagerLog) << "_windowStart: repairing blocks" << _windowRepairBlocks.count();
+    }
+
+    if (_windowBlocksDoneCount == blockCount) {
+        if (_currentOperation == kCORead) {
+            _closeDownloadSession(true /* success */);
         } else {
-            _closeDownloadSession(true);
-            return;
+            _closeUploadSession(true /* success */);
         }
-    } else {
-        qCDebug(FileManagerLog) << QString("_requestMissingData: offset(%1) size(%2)").arg(_missingData.head().offset).arg(_missingData.head().size);
+        return;
+    }
 
-        _downloadOffset = _missingData.head().offset;
+    _ackTimer.setSingleShot(false);
+    _ackTimer.start(_windowTimeoutMsecs());
+    _windowFill();
+}
+
+/// Sends requests until the window is full
+void FileManager::_windowFill(void)
+{
+    const uint32_t blockCount = static_cast<uint32_t>(_windowBlocksDone.size());
+
+    while (_windowRequests.count() < static_cast<int>(_windowSize)) {
+        if (!_windowRepairBlocks.isEmpty()) {
+            const uint32_t block = _windowRepairBlocks.takeFirst();
+            if (block < blockCount && !_windowBlocksDone.testBit(static_cast<int>(block))) {
+                _windowSendBlock(block, true /* retransmit */);
+            }
+        } else if (_windowNextBlock < blockCount) {
+            _windowSendBlock(_windowNextBlock++, false /* retransmit */);
+        } else {
+            break;
+        }
     }
+}
 
+void FileManager::_windowSendBlock(uint32_t block, bool retransmit)
+{
     Request request;
-    _currentOperation = kCORead;
     request.hdr.session = _activeSession;
-    request.hdr.opcode = kCmdReadFile;
-    request.hdr.offset = _downloadOffset;
-    request.hdr.size = sizeof(request.data);
+    request.hdr.offset = block * _blockSize;
+    if (_currentOperation == kCORead) {
+        request.hdr.opcode = kCmdReadFile;
+        request.hdr.size = sizeof(request.data);
+    } else {
+        request.hdr.opcode = kCmdWriteFile;
+        request.hdr.size = static_cast<uint8_t>(qMin(_blockSize, _writeFileSize - request.hdr.offset));
+        memcpy(request.data, &_writeFileAccumulator.constData()[request.hdr.offset], request.hdr.size);
+    }
+    request.hdr.seqNumber = ++_lastOutgoingRequest.hdr.seqNumber;
 
-    _sendRequest(&request);
+    WindowRequest_t windowRequest;
+    windowRequest.block = block;
+    windowRequest.sent.start();
+    windowRequest.retransmit = retransmit;
+    _windowRequests[request.hdr.seqNumber] = windowRequest;
+
+    _sendRequestNoAck(&request);
+}
+
+/// Handles the response to a windowed Read or Write request. Responses can come back in any order, stale responses
+/// to requests which already timed out are ignored.
+void FileManager::_windowReceive(Request* response, uint16_t seqNumber)
+{
+    const uint16_t requestSeqNumber = seqNumber - 1;
+    if (!_windowRequests.contains(requestSeqNumber)) {
+        qCDebug(FileManagerLog) << "_windowReceive: ignoring response to unknown request" << requestSeqNumber;
+        return;
+    }
+    const WindowRequest_t windowRequest = _windowRequests.take(requestSeqNumber);
+    const uint32_t block = windowRequest.block;
+    const bool read = _currentOperation == kCORead;
+
+    if (block >= static_cast<uint32_t>(_windowBlocksDone.size())) {
+        // File turned out to be shorter
+        _windowFill();
+        return;
+    }
+
+    if (response->hdr.opcode == kRspNak) {
+        const uint8_t errorCode = response->data[0];
+        if (read && errorCode == kErrEOF) {
+            // The file is shorter than the size returned by Open, it ends at this block
+            qCDebug(FileManagerLog) << "_windowReceive: EOF at block" << block;
+            _downloadFileSize = block * _blockSize;
+            _windowBlocksDone.resize(static_cast<int>(block));
+            _windowBlocksDoneCount = _windowBlocksDone.count(true);
+            _windowNextBlock = qMin(_windowNextBlock, block);
+        } else {
+            _windowFailed(tr("Nak received, error: %1").arg(errorString(errorCode)));
+            return;
+        }
+    } else if (response->hdr.opcode != kRspAck || response->hdr.req_opcode != (read ? kCmdReadFile : kCmdWriteFile)) {
+        _windowFailed(tr("Unknown opcode returned from server: %1").arg(response->hdr.opcode));
+        return;
+    } else if (response->hdr.session != _activeSession) {
+        _windowFailed(read ? tr("Download: Incorrect session returned") : tr("Write: Incorrect session returned"));
+        return;
+    } else if (response->hdr.offset != block * _blockSize) {
+        _windowFailed(read ?
+                          tr("Download: Offset returned (%1) differs from offset requested/expected (%2)").arg(response->hdr.offset).arg(block * _blockSize) :
+                          tr("Write: Offset returned (%1) differs from offset requested (%2)").arg(response->hdr.offset).arg(block * _blockSize));
+        return;
+    } else if (read) {
+        const uint32_t expectedSize = qMin(_blockSize, _downloadFileSize - block * _blockSize);
+        if (response->hdr.size == 0 || response->hdr.size > expectedSize) {
+            _windowFailed(tr("Download: Invalid size returned (%1)").arg(response->hdr.size));
+            return;
+        }
+        if (response->hdr.size < expectedSize && block + 1 < static_cast<uint32_t>(_windowBlocksDone.size())) {
+            // Short read in the middle of the file, try again
+            if (++_windowRetries[block] > _ackTimerMaxRetries) {
+                _windowFailed(tr("Download: Short read at offset %1").arg(block * _blockSize));
+                return;
+            }
+            _windowRepairBlocks.append(block);
+            _transferStats.retransmits++;
+        } else if (!_windowBlocksDone.testBit(static_cast<int>(block))) {
+            if (response->hdr.size < expectedSize) {
+                // Short last block, file is shorter than returned by Open
+                _downloadFileSize = block * _blockSize + response->hdr.size;
+            }
+            memcpy(_readFileAccumulator.data() + block * _blockSize, response->data, response->hdr.size);
+            _windowBlocksDone.setBit(static_cast<int>(block));
+            _windowBlocksDoneCount++;
+            _windowUpdateStats(response->hdr.size, windowRequest.retransmit ? -1 : windowRequest.sent.elapsed());
+        }
+    } else {
+        const uint32_t expectedSize = qMin(_blockSize, _writeFileSize - block * _blockSize);
+        if (response->hdr.size != sizeof(uint32_t)) {
+            _windowFailed(tr("Write: Returned invalid size of write size data"));
+            return;
+        }
+        if (response->writeFileLength != expectedSize) {
+            _windowFailed(tr("Write: Size returned (%1) differs from size requested (%2)").arg(response->writeFileLength).arg(expectedSize));
+            return;
+        }
+        if (!_windowBlocksDone.testBit(static_cast<int>(block))) {
+            _windowBlocksDone.setBit(static_cast<int>(block));
+            _windowBlocksDoneCount++;
+            _windowUpdateStats(static_cast<int>(expectedSize), windowRequest.retransmit ? -1 : windowRequest.sent.elapsed());
+        }
+    }
+
+    if (_windowBlocksDoneCount == _windowBlocksDone.size()) {
+        _clearAckTimeout();
+        _windowRequests.clear();
+        emit transferStatsChanged();
+        if (read) {
+            _closeDownloadSession(true /* success */);
+        } else {
+            _closeUploadSession(true /* success */);
+        }
+        return;
+    }
+
+    // Additive increase: one more outstanding request per window of responses
+    _windowSize = qMin(_windowSize + (1.0 / _windowSize), static_cast<double>(maxWindowSize));
+    _transferStats.windowSize = static_cast<int>(_windowSize);
+
+    _windowFill();
+}
+
+/// Called periodically by the ack timer while a windowed transfer is in progress. Requests outstanding for longer
+/// than the timeout are considered lost and requested again.
+void FileManager::_windowTimeout(void)
+{
+    const int timeoutMsecs = _windowTimeoutMsecs();
+    bool lost = false;
+
+    auto iter = _windowRequests.begin();
+    while (iter != _windowRequests.end()) {
+        if (iter.value().sent.elapsed() < timeoutMsecs) {
+            iter++;
+            continue;
+        }
+        const uint32_t block = iter.value().block;
+        iter = _windowRequests.erase(iter);
+        if (++_windowRetries[block] > _ackTimerMaxRetries) {
+            _windowFailed(_currentOperation == kCORead ? tr("Timeout waiting for ack: Download failed") : tr("Timeout waiting for ack: Upload failed"));
+            return;
+        }
+        qCDebug(FileManagerLog) << "_windowTimeout: block lost" << block;
+        _windowRepairBlocks.append(block);
+        _transferStats.retransmits++;
+        lost = true;
+    }
+
+    if (lost) {
+        // Multiplicative decrease, the link or server is overrun
+        _windowSize = qMax(_windowSize / 2, 1.0);
+        _transferStats.windowSize = static_cast<int>(_windowSize);
+        emit transferStatsChanged();
+        _windowFill();
+    }
+    _ackTimer.start(timeoutMsecs);
+}
+
+///     @param rttSampleMsecs Round trip of the request, -1 if it can't be measured
+void FileManager::_windowUpdateStats(int bytes, qint64 rttSampleMsecs)
+{
+    if (rttSampleMsecs >= 0) {
+        if (_transferStats.rttMsecs == 0) {
+            _transferStats.rttMsecs = rttSampleMsecs;
+            _rttVarMsecs = rttSampleMsecs / 2.0;
+        } else {
+            _rttVarMsecs = (0.75 * _rttVarMsecs) + (0.25 * qAbs(_transferStats.rttMsecs - rttSampleMsecs));
+            _transferStats.rttMsecs = (0.875 * _transferStats.rttMsecs) + (0.125 * rttSampleMsecs);
+        }
+    }
+
+    _transferStats.bytes += static_cast<quint64>(bytes);
+    const qint64 elapsedMsecs = _transferTimer.elapsed();
+    if (elapsedMsecs > 0) {
+        _transferStats.bytesPerSecond = _transferStats.bytes * 1000.0 / elapsedMsecs;
+    }
+
+    if (_statsTimer.elapsed() >= _statsIntervalMsecs) {
+        _statsTimer.start();
+        if (_windowBlocksDone.size() != 0) {
+            emit commandProgress(100 * _windowBlocksDoneCount / _windowBlocksDone.size());
+        }
+        emit transferStatsChanged();
+    }
+}
+
+/// @return Timeout for an outstanding request, based on the measured round trip
+int FileManager::_windowTimeoutMsecs(void) const
+{
+    if (_transferStats.rttMsecs == 0) {
+        return _ackTimerTimeoutMsecs;
+    }
+    return qBound(minWindowTimeoutMsecs, static_cast<int>(_transferStats.rttMsecs + (4 * _rttVarMsecs)), _ackTimerTimeoutMsecs);
+}
+
+void FileManager::_windowFailed(const QString& msg)
+{
+    _clearAckTimeout();
+    _windowRequests.clear();
+    if (_currentOperation == kCORead) {
+        _closeDownloadSession(false /* failure */);
+    } else {
+        _closeUploadSession(false /* failure */);
+    }
+    _emitErrorMessage(msg);
 }
 
 /// Closes out a download session by writing the file and doing cleanup.
 ///     @param success true: successful download completion, false: error during download
 void FileManager::_closeDownloadSession(bool success)
 {
-    qCDebug(FileManagerLog) << QString("_closeDownloadSession: success(%1) missingBytes(%2)").arg(success).arg(_missingDownloadedBytes);
+    qCDebug(FileManagerLog) << QString("_closeDownloadSession: success(%1) blocks(%2/%3)").arg(success).arg(_windowBlocksDoneCount).arg(_windowBlocksDone.size());
     
+    if (success && _currentOperation == kCOBurst && _windowBlocksDoneCount != _windowBlocksDone.size()) {
+        // The burst missed some blocks (or the last few before EOF), repair them all with windowed reads
+        _clearAckTimeout();
+        _currentOperation = kCORead;
+        _windowStart(_downloadFileSize, false /* resetStats */);
+        return;
+    }
+
     _currentOperation = kCOIdle;
     
     if (success) {
-        if (_missingDownloadedBytes > 0 || (uint32_t)_readFileAccumulator.length() < _downloadFileSize) {
-            // we're not done yet: request the missing parts individually (either we had missing parts or
-            // the last (few) packets right before the EOF got dropped)
-            _downloadingMissingParts = true;
-            _requestMissingData();
-            return;
-        }
-
         QString downloadFilePath = _readFileDownloadDir.absoluteFilePath(_readFileDownloadFilename);
 
         QFile file(downloadFilePath);
@@ -127,6 +387,7 @@ void FileManager::_closeDownloadSession(bool success)
             return;
         }
 
+        _readFileAccumulator.truncate(static_cast<int>(_downloadFileSize));
         qint64 bytesWritten = file.write((const char *)_readFileAccumulator, _readFileAccumulator.length());
         if (bytesWritten != _readFileAccumulator.length()) {
             file.close();
@@ -162,72 +423,43 @@ void FileManager::_closeUploadSession(bool success)
     _sendResetCommand();
 }
 
-/// Respond to the Ack associated with the Read or Stream commands.
-///		@param readFile: true: read file, false: stream file
-void FileManager::_downloadAckResponse(Request* readAck, bool readFile)
+/// Respond to the Ack associated with the Burst Read command.
+void FileManager::_burstAckResponse(Request* burstAck)
 {
-    if (readAck->hdr.session != _activeSession) {
+    if (burstAck->hdr.session != _activeSession) {
         _closeDownloadSession(false /* failure */);
         _emitErrorMessage(tr("Download: Incorrect session returned"));
         return;
     }
 
-    if (readAck->hdr.offset != _downloadOffset) {
-        if (readFile) {
-            _closeDownloadSession(false /* failure */);
-            _emitErrorMessage(tr("Download: Offset returned (%1) differs from offset requested/expected (%2)").arg(readAck->hdr.offset).arg(_downloadOffset));
-            return;
-        } else { // burst
-            if (readAck->hdr.offset < _downloadOffset) { // old data: ignore it
-                _setupAckTimeout();
-                return;
-            }
-            // keep track of missing data chunks
-            MissingData missingData;
-            missingData.offset = _downloadOffset;
-            missingData.size = readAck->hdr.offset - _downloadOffset;
-            _missingData.push_back(missingData);
-            _missingDownloadedBytes += readAck->hdr.offset - _downloadOffset;
-            qCDebug(FileManagerLog) << QString("_downloadAckResponse: missing data: offset(%1) size(%2)").arg(missingData.offset).arg(missingData.size);
-            _downloadOffset = readAck->hdr.offset;
-            _readFileAccumulator.resize(_downloadOffset); // placeholder for the missing data
-        }
-    }
-    
-    qCDebug(FileManagerLog) << QString("_downloadAckResponse: offset(%1) size(%2) burstComplete(%3)").arg(readAck->hdr.offset).arg(readAck->hdr.size).arg(readAck->hdr.burstComplete);
-
-    if (_downloadingMissingParts) {
-        Q_ASSERT(_missingData.head().offset == _downloadOffset);
-        _missingDownloadedBytes -= readAck->hdr.size;
-        _readFileAccumulator.replace(_downloadOffset, readAck->hdr.size, (const char*)readAck->data, readAck->hdr.size);
-        if (_missingData.head().size <= readAck->hdr.size) {
-            _missingData.pop_front();
-        } else {
-            _missingData.head().size -= readAck->hdr.size;
-            _missingData.head().offset += readAck->hdr.size;
+    qCDebug(FileManagerLog) << QString("_burstAckResponse: offset(%1) size(%2) burstComplete(%3)").arg(burstAck->hdr.offset).arg(burstAck->hdr.size).arg(burstAck->hdr.burstComplete);
+
+    // Bursts start on a block boundary and send whole blocks, so data lines up with the blocks used to repair gaps.
+    // Dropped packets simply leave their block missing.
+    const uint32_t block = burstAck->hdr.offset / _blockSize;
+    if (burstAck->hdr.offset % _blockSize == 0 && block < static_cast<uint32_t>(_windowBlocksDone.size()) &&
+            burstAck->hdr.size <= _downloadFileSize - burstAck->hdr.offset) {
+        if (!_windowBlocksDone.testBit(static_cast<int>(block))) {
+            memcpy(_readFileAccumulator.data() + burstAck->hdr.offset, burstAck->data, burstAck->hdr.size);
+            _windowBlocksDone.setBit(static_cast<int>(block));
+            _windowBlocksDoneCount++;
+            _windowUpdateStats(burstAck->hdr.size, -1);
         }
+        _downloadOffset = burstAck->hdr.offset + burstAck->hdr.size;
     } else {
-        _downloadOffset += readAck->hdr.size;
-        _readFileAccumulator.append((const char*)readAck->data, readAck->hdr.size);
+        qCDebug(FileManagerLog) << "_burstAckResponse: ignoring unaligned data" << burstAck->hdr.offset;
     }
-    
-    if (_downloadFileSize != 0) {
-        emit commandProgress(100 * ((float)(_readFileAccumulator.length() - _missingDownloadedBytes) / (float)_downloadFileSize));
-    }
-
-    if (_downloadingMissingParts) {
-        _requestMissingData();
-    } else if (readFile || readAck->hdr.burstComplete) {
-        // Possibly still more data to read, send next read request
 
+    if (burstAck->hdr.burstComplete) {
+        // Possibly still more data to read, start the next burst
         Request request;
         request.hdr.session = _activeSession;
-        request.hdr.opcode = readFile ? kCmdReadFile : kCmdBurstReadFile;
+        request.hdr.opcode = kCmdBurstReadFile;
         request.hdr.offset = _downloadOffset;
         request.hdr.size = 0;
 
         _sendRequest(&request);
-    } else if (!readFile) {
+    } else {
         // Streaming, so next ack should come automatically
         _setupAckTimeout();
     }
@@ -301,79 +533,14 @@ void FileManager::_createAckResponse(Request* createAck)
     _currentOperation = kCOWrite;
     _activeSession = createAck->hdr.session;
 
-    // Start the sequence of write commands from the beginning of the file
-
-    _writeOffset = 0;
-    _writeSize = 0;
-    
-    _writeFileDatablock();
+    // Windowed writes of the whole file
+    _windowStart(_writeFileSize, true /* resetStats */);
 }
 
-/// @brief Respond to the Ack associated with the write command.
-void FileManager::_writeAckResponse(Request* writeAck)
+void FileManager::receiveMessage(const MAVLinkMessageHandle& messageHandle)
 {
-    if(_writeOffset + _writeSize >= _writeFileSize){
-        _closeUploadSession(true /* success */);
-        return;
-    }
-
-    if (writeAck->hdr.session != _activeSession) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Incorrect session returned"));
-        return;
-    }
+    const mavlink_message_t& message = messageHandle.message();
 
-    if (writeAck->hdr.offset != _writeOffset) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Offset returned (%1) differs from offset requested (%2)").arg(writeAck->hdr.offset).arg(_writeOffset));
-        return;
-    }
-
-    if (writeAck->hdr.size != sizeof(uint32_t)) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Returned invalid size of write size data"));
-        return;
-    }
-
-
-    if( writeAck->writeFileLength !=_writeSize) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Size returned (%1) differs from size requested (%2)").arg(writeAck->writeFileLength).arg(_writeSize));
-        return;
-    }
-
-    _writeFileDatablock();
-}
-
-/// @brief Send next write file data block.
-void FileManager::_writeFileDatablock(void)
-{
-    if (_writeOffset + _writeSize >= _writeFileSize){
-        _closeUploadSession(true /* success */);
-        return;
-    }
-
-    _writeOffset += _writeSize;
-
-    Request request;
-    request.hdr.session = _activeSession;
-    request.hdr.opcode = kCmdWriteFile;
-    request.hdr.offset = _writeOffset;
-
-    if(_writeFileSize -_writeOffset > sizeof(request.data) )
-        _writeSize = sizeof(request.data);
-    else
-        _writeSize = _writeFileSize - _writeOffset;
-
-    request.hdr.size = _writeSize;
-
-    memcpy(request.data, &_writeFileAccumulator.data()[_writeOffset], _writeSize);
-
-    _sendRequest(&request);
-}
-
-void FileManager::receiveMessage(mavlink_message_t message)
-{
     // receiveMessage is signalled will all mavlink messages so we need to filter everything else out but ours.
     if (message.msgid != MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL) {
         return;
@@ -391,6 +558,12 @@ void FileManager::receiveMessage(mavlink_message_t message)
     Request* request = (Request*)&data.payload[0];
 
     uint16_t incomingSeqNumber = request->hdr.seqNumber;
+
+    if (_windowActive()) {
+        // Many requests in flight, responses are matched by sequence number and may come back in any order
+        _windowReceive(request, incomingSeqNumber);
+        return;
+    }
     
     // Make sure we have a good sequence number
     uint16_t expectedSeqNumber = _lastOutgoingRequest.hdr.seqNumber + 1;
@@ -408,16 +581,9 @@ void FileManager::receiveMessage(mavlink_message_t message)
     if (incomingSeqNumber != expectedSeqNumber) {
         bool doAbort = true;
         switch (_currentOperation) {
-            case kCOBurst: // burst download drops are handled in _downloadAckResponse()
+            case kCOBurst: // burst download drops are handled in _burstAckResponse()
                 doAbort = false;
                 break;
-            case kCORead:
-                _closeDownloadSession(false /* failure */);
-                break;
-            
-            case kCOWrite:
-                _closeUploadSession(false /* failure */);
-                break;
                 
             case kCOOpenRead:
             case kCOOpenBurst:
@@ -453,20 +619,12 @@ void FileManager::receiveMessage(mavlink_message_t message)
 				_openAckResponse(request);
 				break;
 				
-			case kCmdReadFile:
-				_downloadAckResponse(request, true /* read file */);
-				break;
-				
 			case kCmdBurstReadFile:
-				_downloadAckResponse(request, false /* stream file */);
+				_burstAckResponse(request);
 				break;
 				
             case kCmdCreateFile:
                 _createAckResponse(request);
-                break;
-                
-            case kCmdWriteFile:
-                _writeAckResponse(request);
                 break;
                 
 			default:
@@ -480,14 +638,16 @@ void FileManager::receiveMessage(mavlink_message_t message)
         // Nak's normally have 1 byte of data for error code, except for kErrFailErrno which has additional byte for errno
         Q_ASSERT((errorCode == kErrFailErrno && request->hdr.size == 2) || request->hdr.size == 1);
         
+        OperationState previousOperation = _currentOperation;
         _currentOperation = kCOIdle;
 
         if (request->hdr.req_opcode == kCmdListDirectory && errorCode == kErrEOF) {
             // This is not an error, just the end of the list loop
             emit commandComplete();
             return;
-        } else if ((request->hdr.req_opcode == kCmdReadFile || request->hdr.req_opcode == kCmdBurstReadFile) && errorCode == kErrEOF) {
-            // This is not an error, just the end of the download loop
+        } else if (request->hdr.req_opcode == kCmdBurstReadFile && errorCode == kErrEOF) {
+            // This is not an error, just the end of the download loop. Any gaps are repaired before the session closes.
+            _currentOperation = previousOperation;
             _closeDownloadSession(true /* success */);
             return;
         } else if (request->hdr.req_opcode == kCmdCreateFile) {
@@ -498,12 +658,9 @@ void FileManager::receiveMessage(mavlink_message_t message)
             return;
         } else {
             // Generic Nak handling
-            if (request->hdr.req_opcode == kCmdReadFile || request->hdr.req_opcode == kCmdBurstReadFile) {
+            if (request->hdr.req_opcode == kCmdBurstReadFile) {
                 // Nak error during download loop, download failed
                 _closeDownloadSession(false /* failure */);
-            } else if (request->hdr.req_opcode == kCmdWriteFile) {
-                // Nak error during upload loop, upload failed
-                _closeUploadSession(false /* failure */);
             }
             _emitErrorMessage(tr("Nak received, error: %1").arg(errorString(request->data[0])));
         }
@@ -753,7 +910,7 @@ void FileManager::_setupAckTimeout(void)
 
     _ackNumTries = 0;
     _ackTimer.setSingleShot(false);
-    _ackTimer.start(ackTimerTimeoutMsecs);
+    _ackTimer.start(_ackTimerTimeoutMsecs);
 }
 
 /// @brief Clears the ack timeout timer
@@ -767,8 +924,13 @@ void FileManager::_clearAckTimeout(void)
 void FileManager::_ackTimeout(void)
 {
     qCDebug(FileManagerLog) << "_ackTimeout";
+
+    if (_windowActive()) {
+        _windowTimeout();
+        return;
+    }
     
-    if (++_ackNumTries <= ackTimerMaxRetries) {
+    if (++_ackNumTries <= _ackTimerMaxRetries) {
         qCDebug(FileManagerLog) << "ack timeout - retrying";
         if (_currentOperation == kCOBurst) {
             // for burst downloads try to initiate a new burst
@@ -793,7 +955,6 @@ void FileManager::_ackTimeout(void)
     // to idle. FileView UI works this way with the List command.
 
     switch (_currentOperation) {
-        case kCORead:
         case kCOBurst:
             _closeDownloadSession(false /* failure */);
             _emitErrorMessage(tr("Timeout waiting for ack: Download failed"));
@@ -811,11 +972,7 @@ void FileManager::_ackTimeout(void)
             _emitErrorMessage(tr("Timeout waiting for ack: Upload failed"));
             _sendResetCommand();
             break;
-            
-        case kCOWrite:
-            _closeUploadSession(false /* failure */);
-            _emitErrorMessage(tr("Timeout waiting for ack: Upload failed"));
-            break;
+
 			
         default:
         {
@@ -13,9 +13,13 @@
 #include <QObject>
 #include <QDir>
 #include <QTimer>
-#include <QQueue>
+#include <QMap>
+#include <QHash>
+#include <QBitArray>
+#include <QElapsedTimer>
 
 #include "UASInterface.h"
+#include "MAVLinkMessageHandle.h"
 #include "QGCLoggingCategory.h"
 
 #ifdef __GNUC__
@@ -51,6 +55,25 @@ public:
 
     int _ackTimerMaxRetries = ackTimerMaxRetries;
 
+    /// Limits for the number of Read or Write requests which are outstanding at the same time during a download or
+    /// upload. The window grows while requests are answered and halves when they time out.
+    static const int initialWindowSize = 4;
+    static const int maxWindowSize = 32;
+
+    /// Shortest timeout for an outstanding Read or Write request, no matter how short the measured round trip
+    static const int minWindowTimeoutMsecs = 50;
+
+    typedef struct {
+        quint64 bytes;              ///< Bytes transferred by the current/last download or upload
+        double  bytesPerSecond;
+        double  rttMsecs;           ///< Smoothed request round trip time, 0 if not measured yet
+        int     windowSize;         ///< Number of requests allowed to be outstanding
+        int     retransmits;        ///< Requests sent again since they timed out or came back short
+    } TransferStats_t;
+
+    /// Throughput and latency of the current/last download or upload
+    const TransferStats_t& transferStats(void) const { return _transferStats; }
+
 
 	/// Downloads the specified file.
 	///     @param from File to download from UAS, fully qualified path
@@ -91,11 +114,14 @@ signals:
     ///     @param value Amount of progress: 0.0 = none, 1.0 = complete
     void commandProgress(int value);
 
+    /// Signalled during a download or upload when transferStats has changed
+    void transferStatsChanged(void);
+
     /// Used internally to move sendMessage call to main thread
     void _sendMessageOnLinkOnThread(LinkInterface* link, mavlink_message_t message);
 
 public slots:
-    void receiveMessage(mavlink_message_t message);
+    void receiveMessage(const MAVLinkMessageHandle& messageHandle);
 	
 private slots:
 	void _ackTimeout(void);
@@ -201,17 +227,23 @@ private:
     void _sendMessageOnLink(LinkInterface* link, mavlink_message_t message);
     void _fillRequestWithString(Request* request, const QString& str);
     void _openAckResponse(Request* openAck);
-    void _downloadAckResponse(Request* readAck, bool readFile);
+    void _burstAckResponse(Request* burstAck);
     void _listAckResponse(Request* listAck);
     void _createAckResponse(Request* createAck);
-    void _writeAckResponse(Request* writeAck);
-    void _writeFileDatablock(void);
     void _sendListCommand(void);
     void _sendResetCommand(void);
     void _closeDownloadSession(bool success);
     void _closeUploadSession(bool success);
     void _downloadWorker(const QString& from, const QDir& downloadDir, bool readFile);
-    void _requestMissingData();
+    bool _windowActive(void) const { return _currentOperation == kCORead || _currentOperation == kCOWrite; }
+    void _windowStart(uint32_t fileSize, bool resetStats);
+    void _windowFill(void);
+    void _windowSendBlock(uint32_t block, bool retransmit);
+    void _windowReceive(Request* response, uint16_t seqNumber);
+    void _windowTimeout(void);
+    void _windowUpdateStats(int bytes, qint64 rttSampleMsecs);
+    int  _windowTimeoutMsecs(void) const;
+    void _windowFailed(const QString& msg);
     
     static QString errorString(uint8_t errorCode);
 
@@ -229,26 +261,38 @@ private:
     
     uint8_t     _activeSession;             ///< currently active session, 0 for none
     
-    uint32_t    _readOffset;                ///< current read offset
-    
-    uint32_t    _writeOffset;               ///< current write offset
-    uint32_t    _writeSize;                 ///< current write data size
     uint32_t    _writeFileSize;             ///< Size of file being uploaded
     QByteArray  _writeFileAccumulator;      ///< Holds file being uploaded
     
-    struct MissingData {
-        uint32_t offset;
-        uint32_t size;
-    };
-    uint32_t    _downloadOffset;            ///< current download offset
-    uint32_t    _missingDownloadedBytes;    ///< number of missing bytes for burst download
-    QQueue<MissingData> _missingData;       ///< missing chunks of downloaded file (for burst downloads)
-    bool        _downloadingMissingParts;   ///< true if we are currently downloading missing parts
-    QByteArray  _readFileAccumulator;       ///< Holds file being downloaded
+    uint32_t    _downloadOffset;            ///< Offset the next burst continues from
+    QByteArray  _readFileAccumulator;       ///< Holds file being downloaded, sized to the file
     QDir        _readFileDownloadDir;       ///< Directory to download file to
     QString     _readFileDownloadFilename;  ///< Filename (no path) for download file
     uint32_t    _downloadFileSize;          ///< Size of file being downloaded
 
+    // Windowed transfers: the file is split into blocks of _blockSize bytes, each block is read or written by its own
+    // request. Requests are matched to responses by sequence number so they can be answered in any order.
+    typedef struct {
+        uint32_t        block;
+        QElapsedTimer   sent;
+        bool            retransmit;     ///< Round trip is ambiguous, not used to measure it
+    } WindowRequest_t;
+
+    QMap<uint16_t, WindowRequest_t> _windowRequests;        ///< Outstanding requests, by sequence number
+    QBitArray                       _windowBlocksDone;      ///< Blocks which were transferred
+    int                             _windowBlocksDoneCount;
+    uint32_t                        _windowNextBlock;       ///< First block which was never requested
+    QList<uint32_t>                 _windowRepairBlocks;    ///< Blocks to request again, lost or missed by a burst
+    QHash<uint32_t, int>            _windowRetries;         ///< Timeouts and short reads per block
+    double                          _windowSize;            ///< Fractional, grows by 1 per window of responses
+    double                          _rttVarMsecs;
+    QElapsedTimer                   _transferTimer;
+    QElapsedTimer                   _statsTimer;
+    TransferStats_t                 _transferStats;
+
+    static const uint32_t _blockSize = sizeof(Request::data);
+    static const int      _statsIntervalMsecs = 100;  ///< Minimum time between progress/stats signals
+
     uint8_t     _systemIdQGC;               ///< System ID for QGC
     uint8_t     _systemIdServer;            ///< System ID for server
     
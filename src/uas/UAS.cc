@@ -127,7 +127,7 @@ int UAS::getUASID() const
     return uasId;
 }
 
-void UAS::receiveMessage(mavlink_message_t message)
+void UAS::receiveMessage(const mavlink_message_t& message)
 {
     // Only accept messages from this system (condition 1)
     // and only then if a) attitudeStamped is disabled OR b) attitudeStamped is enabled
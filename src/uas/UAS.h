@@ -202,7 +202,7 @@ public slots:
 #endif
 
     /** @brief Receive a message from one of the communication links. */
-    virtual void receiveMessage(mavlink_message_t message);
+    virtual void receiveMessage(const mavlink_message_t& message);
 
     void startCalibration(StartCalibrationType calType);
     void stopCalibration(void);
@@ -42,7 +42,7 @@ MAVLinkDecoder::MAVLinkDecoder(MAVLinkProtocol* protocol) :
     textMessageFilter.insert(MAVLINK_MSG_ID_NAMED_VALUE_INT, false);
 //    textMessageFilter.insert(MAVLINK_MSG_ID_HIGHRES_IMU, false);
 
-    connect(protocol, &MAVLinkProtocol::messageReceived, this, &MAVLinkDecoder::receiveMessage);
+    connect(protocol, &MAVLinkProtocol::sharedMessageReceived, this, &MAVLinkDecoder::receiveMessage);
     connect(this, &MAVLinkDecoder::finish, this, &QThread::quit);
 
     start(LowestPriority);
@@ -58,10 +58,12 @@ void MAVLinkDecoder::run()
     moveToThread(creationThread);
 }
 
-void MAVLinkDecoder::receiveMessage(LinkInterface* link,mavlink_message_t message)
+void MAVLinkDecoder::receiveMessage(LinkInterface* link, MAVLinkMessageHandle messageHandle)
 {
     Q_UNUSED(link);
 
+    const mavlink_message_t& message = messageHandle.message();
+
     uint32_t msgid = message.msgid;
     const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&message);
     if(!msgInfo) {
@@ -191,7 +193,7 @@ quint64 MAVLinkDecoder::getUnixTimeFromMs(int systemID, quint64 time)
     return ret;
 }
 
-void MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time)
+void MAVLinkDecoder::emitFieldValue(const mavlink_message_t* msg, int fieldid, quint64 time)
 {
     bool multiComponentSourceDetected = false;
     const mavlink_message_info_t* msgInfo = mavlink_get_message_info(msg);
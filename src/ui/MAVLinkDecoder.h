@@ -38,10 +38,10 @@ signals:
 
 public slots:
     /** @brief Receive one message from the protocol and decode it */
-    void receiveMessage(LinkInterface* link,mavlink_message_t message);
+    void receiveMessage(LinkInterface* link, MAVLinkMessageHandle messageHandle);
 protected:
     /** @brief Emit the value of one message field */
-    void emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time);
+    void emitFieldValue(const mavlink_message_t* msg, int fieldid, quint64 time);
     /** @brief Shift a timestamp in Unix time if necessary */
     quint64 getUnixTimeFromMs(int systemID, quint64 time);
 
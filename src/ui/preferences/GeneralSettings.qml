@@ -424,7 +424,7 @@ Rectangle {
                         Layout.preferredWidth:  loggingCol.width + (_margins * 2)
                         color:                  qgcPal.windowShade
                         Layout.fillWidth:       true
-                        visible:                promptSaveLog._telemetrySave.visible || logIfNotArmed._telemetrySaveNotArmed.visible || promptSaveCsv._saveCsvTelemetry.visible
+                        visible:                promptSaveLog._telemetrySave.visible || logIfNotArmed._telemetrySaveNotArmed.visible || compressLog._telemetrySaveCompressed.visible || promptSaveCsv._saveCsvTelemetry.visible
                         ColumnLayout {
                             id:                         loggingCol
                             anchors.margins:            _margins
@@ -447,6 +447,14 @@ Rectangle {
                                 enabled:    promptSaveLog.checked && !disableDataPersistence.checked
                                 property Fact _telemetrySaveNotArmed: QGroundControl.settingsManager.appSettings.telemetrySaveNotArmed
                             }
+                            FactCheckBox {
+                                id:         compressLog
+                                text:       qsTr("Compress telemetry logs")
+                                fact:       _telemetrySaveCompressed
+                                visible:    _telemetrySaveCompressed.visible
+                                enabled:    promptSaveLog.checked && !disableDataPersistence.checked
+                                property Fact _telemetrySaveCompressed: QGroundControl.settingsManager.appSettings.telemetrySaveCompressed
+                            }
                             FactCheckBox {
                                 id:         promptSaveCsv
                                 text:       qsTr("Save CSV log of telemetry data")
@@ -23,6 +23,7 @@ Column {
     function saveSettings() {
         if(subEditConfig) {
             subEditConfig.filename = logField.text
+            subEditConfig.batchReplay = batchReplayCheckBox.checked
         }
     }
     Row {
@@ -45,6 +46,11 @@ Column {
             }
         }
     }
+    QGCCheckBox {
+        id:         batchReplayCheckBox
+        text:       qsTr("Replay as fast as possible")
+        checked:    subEditConfig && subEditConfig.linkType === LinkConfiguration.TypeLogReplay ? subEditConfig.batchReplay : false
+    }
     FileDialog {
         id:             fileDialog
         title:          qsTr("Please choose a file")
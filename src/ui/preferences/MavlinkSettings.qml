@@ -36,6 +36,7 @@ Rectangle {
     property bool _showAPMStreamRates:  QGroundControl.apmFirmwareSupported && QGroundControl.settingsManager.apmMavlinkStreamRateSettings.visible
     property Fact _disableDataPersistenceFact: QGroundControl.settingsManager.appSettings.disableAllPersistence
     property bool _disableDataPersistence:     _disableDataPersistenceFact ? _disableDataPersistenceFact.rawValue : false
+    property var  _mavlinkProtocol:     QGroundControl.mavlinkProtocol
 
     QGCPalette { id: qgcPal }
 
@@ -153,6 +154,13 @@ Rectangle {
                             QGroundControl.isVersionCheckEnabled = checked
                         }
                     }
+
+                    FactCheckBox {
+                        text:       qsTr("Parse each link on its own thread")
+                        fact:       _mavlinkThreadedParsing
+                        visible:    _mavlinkThreadedParsing.visible
+                        property Fact _mavlinkThreadedParsing: QGroundControl.settingsManager.appSettings.mavlinkThreadedParsing
+                    }
                 }
             }
             //-----------------------------------------------------------------
@@ -333,6 +341,92 @@ Rectangle {
                 }
             }
             //-----------------------------------------------------------------
+            //-- Telemetry Log Writer
+            Item {
+                width:              __mavlinkRoot.width * 0.8
+                height:             telemetryLogLabel.height
+                anchors.margins:    ScreenTools.defaultFontPixelWidth
+                anchors.horizontalCenter: parent.horizontalCenter
+                QGCLabel {
+                    id:             telemetryLogLabel
+                    text:           qsTr("Telemetry Log Writer")
+                    font.family:    ScreenTools.demiboldFontFamily
+                }
+            }
+            Rectangle {
+                height:         telemetryLogColumn.height + (ScreenTools.defaultFontPixelHeight * 2)
+                width:          __mavlinkRoot.width * 0.8
+                color:          qgcPal.windowShade
+                anchors.margins: ScreenTools.defaultFontPixelWidth
+                anchors.horizontalCenter: parent.horizontalCenter
+                Column {
+                    id:         telemetryLogColumn
+                    width:      gcsColumn.width
+                    spacing:    _columnSpacing
+                    anchors.centerIn: parent
+                    //-----------------------------------------------------------------
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        anchors.horizontalCenter: parent.horizontalCenter
+                        QGCLabel {
+                            width:              _labelWidth
+                            text:               qsTr("Bytes written:")
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                        QGCLabel {
+                            width:              _valueWidth
+                            text:               _mavlinkProtocol.telemetryLogBytesWritten
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+                    //-----------------------------------------------------------------
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        anchors.horizontalCenter: parent.horizontalCenter
+                        QGCLabel {
+                            width:              _labelWidth
+                            text:               qsTr("Bytes queued:")
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                        QGCLabel {
+                            width:              _valueWidth
+                            text:               _mavlinkProtocol.telemetryLogBytesQueued
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+                    //-----------------------------------------------------------------
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        anchors.horizontalCenter: parent.horizontalCenter
+                        QGCLabel {
+                            width:              _labelWidth
+                            text:               qsTr("Records dropped:")
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                        QGCLabel {
+                            width:              _valueWidth
+                            text:               _mavlinkProtocol.telemetryLogRecordsDropped
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+                    //-----------------------------------------------------------------
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        anchors.horizontalCenter: parent.horizontalCenter
+                        QGCLabel {
+                            width:              _labelWidth
+                            text:               qsTr("Max write latency:")
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                        QGCLabel {
+                            width:              _valueWidth
+                            text:               (_mavlinkProtocol.telemetryLogMaxWriteLatencyUSecs / 1000).toFixed(1) + qsTr(" ms")
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+                }
+            }
+            //-----------------------------------------------------------------
             //-- Mavlink Logging
             Item {
                 width:              __mavlinkRoot.width * 0.8
@@ -384,6 +478,13 @@ Rectangle {
                         }
                     }
                     //-----------------------------------------------------------------
+                    //-- Stream stats
+                    QGCLabel {
+                        text:       qsTr("Dropped: %1  Reordered: %2  Late: %3  Writer lag: %4 KB").arg(QGroundControl.mavlinkLogManager.droppedSequences).arg(QGroundControl.mavlinkLogManager.reorderedSequences).arg(QGroundControl.mavlinkLogManager.lateSequences).arg(Math.round(QGroundControl.mavlinkLogManager.writerLagBytes / 1024))
+                        visible:    QGroundControl.mavlinkLogManager.logRunning
+                        anchors.horizontalCenter: parent.horizontalCenter
+                    }
+                    //-----------------------------------------------------------------
                     //-- Enable auto log on arming
                     QGCCheckBox {
                         text:       qsTr("Enable automatic logging")
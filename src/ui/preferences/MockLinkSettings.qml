@@ -34,6 +34,8 @@ Column {
         else
             subEditConfig.firmware = 0
         subEditConfig.sendStatus = sendStatus.checked
+        subEditConfig.swarmVehicleCount = swarmCountField.text.length ? parseInt(swarmCountField.text) : 0
+        subEditConfig.swarmTelemetryRate = swarmRateField.text.length ? parseInt(swarmRateField.text) : 10
     }
     Component.onCompleted: {
         if(subEditConfig.firmware === 12)       // Hardcoded MAV_AUTOPILOT_PX4
@@ -47,6 +49,8 @@ Column {
         else
             copterVehicle.checked = true
         sendStatus.checked = subEditConfig.sendStatus
+        swarmCountField.text = subEditConfig.swarmVehicleCount.toString()
+        swarmRateField.text = subEditConfig.swarmTelemetryRate.toString()
     }
     QGCCheckBox {
         id:             sendStatus
@@ -95,4 +99,21 @@ Column {
             checked:    false
         }
     }
+    Item {
+        height: ScreenTools.defaultFontPixelHeight / 2
+        width:  parent.width
+    }
+    GridLayout {
+        columns: 2
+        QGCLabel { text: qsTr("Swarm Vehicles") }
+        QGCTextField {
+            id:                 swarmCountField
+            inputMethodHints:   Qt.ImhFormattedNumbersOnly
+        }
+        QGCLabel { text: qsTr("Swarm Telemetry Rate (Hz)") }
+        QGCTextField {
+            id:                 swarmRateField
+            inputMethodHints:   Qt.ImhFormattedNumbersOnly
+        }
+    }
 }
@@ -51,6 +51,15 @@ Column {
             }
         }
     }
+    QGCCheckBox {
+        text:       qsTr("High Throughput Receive")
+        checked:    subEditConfig && subEditConfig.linkType === LinkConfiguration.TypeUdp ? subEditConfig.batchedReceive : false
+        onCheckedChanged: {
+            if(subEditConfig && subEditConfig.linkType === LinkConfiguration.TypeUdp) {
+                subEditConfig.batchedReceive = checked
+            }
+        }
+    }
     Item {
         height: ScreenTools.defaultFontPixelHeight / 2
         width:  parent.width
@@ -288,11 +288,21 @@ Item {
         }
 
         QGCLabel {
+            id:                 downloadingLabel
             anchors.centerIn:   parent
             text:               qsTr("Downloading Parameters")
             font.pointSize:     ScreenTools.largeFontPointSize
         }
 
+        QGCLabel {
+            anchors.top:                downloadingLabel.bottom
+            anchors.horizontalCenter:   parent.horizontalCenter
+            text:                       qsTr("%1 params/sec").arg(_downloadRate.toFixed(0))
+            visible:                    _downloadRate > 0
+
+            property real _downloadRate: activeVehicle ? activeVehicle.parameterManager.downloadRate : 0
+        }
+
         QGCLabel {
             anchors.margins:    _margin
             anchors.right:      parent.right